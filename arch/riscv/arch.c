@@ -23,3 +23,11 @@ void arch_enable_software_interrupts(void)
   csr_set(sie, SIE_SSIE);
   csr_set(sstatus, SSTATUS_SIE);
 }
+
+/* 允许 U-mode 直接读 time/cycle/instret（vdso clock_gettime 用 rdtime）。
+ * mcounteren 由 OpenSBI 负责放开到 S-mode。
+ */
+void arch_enable_user_counters(void)
+{
+  csr_write(scounteren, SCOUNTEREN_CY | SCOUNTEREN_TM | SCOUNTEREN_IR);
+}
@@ -6,8 +6,27 @@
 void arch_enable_timer_interrupts(void);
 void arch_enable_external_interrupts(void);
 void arch_enable_software_interrupts(void);
+void arch_enable_user_counters(void);
 
 struct trapframe;
 void arch_first_switch(struct trapframe *tf);
 
+/* vector.S：调用前 sstatus.VS 必须不是 Off。
+ * buf 布局：vstart, vl, vtype, vcsr（各 8 字节），然后 v0..v31（32 * vlenb）。
+ */
+#define ARCH_VSTATE_HDR 32
+uint64_t arch_vector_vlenb(void);
+void arch_vector_save(void *buf);
+void arch_vector_restore(const void *buf);
+void arch_vector_clear(void);
+
+/* fpu.S：调用前 sstatus.FS 必须不是 Off（只在 RISCV_FP=YES 构建里用到） */
+struct arch_fpstate {
+  uint64_t f[32];
+  uint64_t fcsr;
+};
+void arch_fp_save(struct arch_fpstate *st);
+void arch_fp_restore(const struct arch_fpstate *st);
+void arch_fp_clear(void);
+
 #endif /* ARCH_H */
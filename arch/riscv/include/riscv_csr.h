@@ -83,6 +83,22 @@ static inline reg_t scause_code(reg_t scause) {
 
 #define SSTATUS_SPP       MSTATUS_SPP /* sstatus.SPP */
 
+/* sstatus.VS：向量单元状态（Off/Initial/Clean/Dirty），WARL，没有 V 时读回 0 */
+#define SSTATUS_VS_SHIFT   9
+#define SSTATUS_VS_MASK    (3UL << SSTATUS_VS_SHIFT)
+#define SSTATUS_VS_OFF     (0UL << SSTATUS_VS_SHIFT)
+#define SSTATUS_VS_INITIAL (1UL << SSTATUS_VS_SHIFT)
+#define SSTATUS_VS_CLEAN   (2UL << SSTATUS_VS_SHIFT)
+#define SSTATUS_VS_DIRTY   (3UL << SSTATUS_VS_SHIFT)
+
+/* sstatus.FS：浮点单元状态，编码同 VS；没有 F 时读回 0 */
+#define SSTATUS_FS_SHIFT   13
+#define SSTATUS_FS_MASK    (3UL << SSTATUS_FS_SHIFT)
+#define SSTATUS_FS_OFF     (0UL << SSTATUS_FS_SHIFT)
+#define SSTATUS_FS_INITIAL (1UL << SSTATUS_FS_SHIFT)
+#define SSTATUS_FS_CLEAN   (2UL << SSTATUS_FS_SHIFT)
+#define SSTATUS_FS_DIRTY   (3UL << SSTATUS_FS_SHIFT)
+
 /* ===================== mie / mip / sie / sip bits ===================== */
 /* 参考: RISC-V Privileged Spec / 五嵌 quick-ref。 */
 
@@ -124,6 +140,11 @@ static inline reg_t scause_code(reg_t scause) {
 #define SIE_STIE          MIE_STIE
 #define SIE_SEIE          MIE_SEIE
 
+/* scounteren：允许 U-mode 读 cycle/time/instret */
+#define SCOUNTEREN_CY     (1UL << 0)
+#define SCOUNTEREN_TM     (1UL << 1)
+#define SCOUNTEREN_IR     (1UL << 2)
+
 /* ===================== 异常 / 中断 code ===================== */
 /* 参考: RISC-V Privileged Spec Table "Cause Register". */
 
@@ -0,0 +1,111 @@
+#ifndef RISCV_INSN_H
+#define RISCV_INSN_H
+
+#include <stdint.h>
+
+/*
+ * 非法指令陷入时的指令分类：惰性打开 FS / VS 之前先确认陷入的真是
+ * FP / 向量指令，别的非法指令照常报错。
+ */
+
+#define RISCV_OP_LOAD_FP  0x07u
+#define RISCV_OP_STORE_FP 0x27u
+#define RISCV_OP_FMADD    0x43u
+#define RISCV_OP_FMSUB    0x47u
+#define RISCV_OP_FNMSUB   0x4bu
+#define RISCV_OP_FNMADD   0x4fu
+#define RISCV_OP_FP       0x53u
+#define RISCV_OP_V        0x57u
+#define RISCV_OP_SYSTEM   0x73u
+
+/* OP-V 的 funct3：OPFVV / OPFVF 是向量浮点，还要求 FS != Off */
+#define RISCV_OPFVV 1u
+#define RISCV_OPFVF 5u
+
+/* 取 pc 处的指令（没有 MMU，用户 pc 直接可读）；压缩指令只返回低 16 位 */
+static inline uint32_t
+riscv_insn_fetch(uintptr_t pc)
+{
+  uint16_t lo = *(const volatile uint16_t *)pc;
+  if ((lo & 3u) != 3u) return lo;
+  uint16_t hi = *(const volatile uint16_t *)(pc + 2u);
+  return (uint32_t)lo | ((uint32_t)hi << 16);
+}
+
+static inline uint32_t riscv_insn_opcode(uint32_t insn) { return insn & 0x7fu; }
+static inline uint32_t riscv_insn_funct3(uint32_t insn) { return (insn >> 12) & 7u; }
+
+/* SYSTEM 里的 CSR 访问（csrr* / csrr*i）；返回 CSR 号，不是返回 -1 */
+static inline int
+riscv_insn_csr(uint32_t insn)
+{
+  if (riscv_insn_opcode(insn) != RISCV_OP_SYSTEM) return -1;
+  uint32_t f3 = riscv_insn_funct3(insn);
+  if (f3 == 0u || f3 == 4u) return -1;
+  return (int)(insn >> 20);
+}
+
+/* 压缩的 FP load/store：c.fld / c.fsd / c.fldsp / c.fsdsp（RV32 还有 c.flw 系列） */
+static inline int
+riscv_cinsn_is_fp(uint32_t insn)
+{
+  uint32_t q  = insn & 3u;
+  uint32_t f3 = (insn >> 13) & 7u;
+  if (q != 0u && q != 2u) return 0;
+  if (f3 == 1u || f3 == 5u) return 1;
+#if __riscv_xlen == 32
+  if (q == 0u && (f3 == 3u || f3 == 7u)) return 1;
+  if (q == 2u && (f3 == 3u || f3 == 7u)) return 1;
+#endif
+  return 0;
+}
+
+/* 需要 FS != Off 的指令：标量 FP、FP 的 CSR、向量浮点 */
+static inline int
+riscv_insn_is_fp(uint32_t insn)
+{
+  if ((insn & 3u) != 3u) return riscv_cinsn_is_fp(insn);
+
+  uint32_t f3 = riscv_insn_funct3(insn);
+  switch (riscv_insn_opcode(insn)) {
+    case RISCV_OP_LOAD_FP:
+    case RISCV_OP_STORE_FP:
+      return f3 >= 1u && f3 <= 4u;  /* H / W / D / Q；其余宽度是向量 */
+    case RISCV_OP_FMADD:
+    case RISCV_OP_FMSUB:
+    case RISCV_OP_FNMSUB:
+    case RISCV_OP_FNMADD:
+    case RISCV_OP_FP:
+      return 1;
+    case RISCV_OP_V:
+      return f3 == RISCV_OPFVV || f3 == RISCV_OPFVF;
+    default: {
+      int csr = riscv_insn_csr(insn);
+      return csr >= 0x001 && csr <= 0x003;  /* fflags / frm / fcsr */
+    }
+  }
+}
+
+/* 需要 VS != Off 的指令：OP-V（含 vset*）、向量 load/store、向量 CSR */
+static inline int
+riscv_insn_is_vector(uint32_t insn)
+{
+  if ((insn & 3u) != 3u) return 0;
+
+  uint32_t f3 = riscv_insn_funct3(insn);
+  switch (riscv_insn_opcode(insn)) {
+    case RISCV_OP_V:
+      return 1;
+    case RISCV_OP_LOAD_FP:
+    case RISCV_OP_STORE_FP:
+      return f3 == 0u || f3 >= 5u;  /* 8 / 16 / 32 / 64 位元素宽度 */
+    default: {
+      int csr = riscv_insn_csr(insn);
+      /* vstart / vxsat / vxrm / vcsr / vl / vtype / vlenb */
+      return (csr >= 0x008 && csr <= 0x00a) || csr == 0x00f ||
+             (csr >= 0xc20 && csr <= 0xc22);
+    }
+  }
+}
+
+#endif /* RISCV_INSN_H */
@@ -4,12 +4,266 @@
 #define IRQSTAT_MAX_NAME 16
 #define IRQSTAT_MAX_IRQ  64
 
+#define IRQSTAT_F_REGISTERED (1u << 0)
+#define IRQSTAT_F_THREADED   (1u << 1)  /* handler 在内核线程里跑（irq/N） */
+
 struct irqstat_user {
   uint32_t irq;
-  uint32_t _pad;
+  uint32_t affinity;  /* PLIC 使能的 hart 位图 */
   uint64_t count;
   uint64_t first_tick;
   uint64_t last_tick;
   uint64_t max_delta;
   char name[IRQSTAT_MAX_NAME];
+  uint32_t flags;     /* IRQSTAT_F_* */
+  uint32_t _pad;
+  uint64_t hart_count[MAX_HARTS];  /* 各 hart 处理的次数 */
+};
+
+/* SYS_IRQ_AFFINITY(irq, hart_mask, op)：返回新的位图 / 迁移的源个数，或 -errno */
+enum {
+  IRQ_AFF_SET      = 0,  /* 把 irq 的使能改成 hart_mask（只保留 online hart） */
+  IRQ_AFF_BALANCE  = 1,  /* 立即按最近的中断频率重新分配所有源 */
+  IRQ_AFF_AUTO_ON  = 2,  /* 周期性自动 balance */
+  IRQ_AFF_AUTO_OFF = 3,
+};
+
+/* SYS_SYSSTAT：每行是一个 (syscall, hart) 的统计，只返回 count != 0 的行。
+ * 延迟单位是 time CSR tick，统计的是内核里处理该 syscall 的时间
+ * （阻塞型 syscall 只算到切走为止，不含等待时间）。
+ */
+#define SYSSTAT_MAX_NR   64           /* >= SYS_NR */
+#define SYSSTAT_F_RESET  (1u << 0)    /* 拷贝后清零 */
+
+struct sysstat_user {
+  uint32_t nr;    /* syscall 号；0 = 未知号（-ENOSYS） */
+  uint32_t hart;
+  uint64_t count;
+  uint64_t total_ticks;
+  uint64_t max_ticks;
+};
+
+/* SYS_LOCKSTAT：每把登记过的锁一行（内核带 CONFIG_LOCKSTAT 构建才有，否则 -ENOSYS）。
+ * 时间单位是 time CSR tick。
+ */
+#define LOCKSTAT_MAX_LOCKS 16
+#define LOCKSTAT_F_RESET   (1u << 0)  /* 拷贝后清零 */
+
+struct lockstat_user {
+  char     name[16];
+  uint32_t kind;          /* 0 = ticket, 1 = MCS */
+  uint32_t _pad;
+  uint64_t acquisitions;
+  uint64_t contended;     /* 需要等待的次数 */
+  uint64_t spin_ticks;    /* 等待总时长 */
+  uint64_t spin_max;
+  uint64_t hold_max;      /* 最长一次持有 */
+};
+
+/* SYS_CPUSTAT：每个 hart 一行。
+ *  - trap_*：按 trap 类型统计在 trap 里停留的时间（trap 期间 SIE 关闭，
+ *    也就是硬中断上下文里“关中断”的时长）。
+ *  - softirq_* / work_*：kworker 线程里（开中断）跑下半部的次数和耗时。
+ * 时间单位是 time CSR tick。
+ */
+#define CPUSTAT_TRAP_EXT     0  /* PLIC 外部中断 */
+#define CPUSTAT_TRAP_TIMER   1
+#define CPUSTAT_TRAP_IPI     2
+#define CPUSTAT_TRAP_SYSCALL 3
+#define CPUSTAT_TRAP_OTHER   4  /* 断点 / 非法指令 / fault */
+#define CPUSTAT_TRAP_NR      5
+#define CPUSTAT_SOFTIRQ_MAX  4
+
+#define CPUSTAT_F_RESET     (1u << 0)  /* 拷贝后清零 */
+#define CPUSTAT_F_BH_INLINE (1u << 1)  /* 下半部改回在硬中断里直接做（对比用） */
+#define CPUSTAT_F_BH_DEFER  (1u << 2)  /* 下半部交给 kworker（默认） */
+
+struct cpustat_user {
+  uint32_t hart;
+  uint32_t bh_inline;                     /* 当前是否 inline 模式 */
+  uint64_t trap_count[CPUSTAT_TRAP_NR];
+  uint64_t trap_ticks[CPUSTAT_TRAP_NR];   /* 关中断总时长 */
+  uint64_t trap_max[CPUSTAT_TRAP_NR];     /* 最长一次 */
+  uint64_t softirq_count[CPUSTAT_SOFTIRQ_MAX];
+  uint64_t softirq_ticks;
+  uint64_t work_count;
+  uint64_t work_ticks;
+  uint64_t kworker_wakeups;               /* 硬中断出口唤醒 kworker 的次数 */
+};
+
+/* SYS_BLK_IO(dev, iov, n)：一次提交 n 个请求（相当于队列深度 n），全部完成才返回。
+ * 扇区连续、方向相同的请求会被合并成一个设备请求。buf 直接给设备 DMA（没有 MMU）。
+ * 返回 n，或第一个失败请求的 -errno；每个请求的结果写回 result。
+ */
+#define BLK_SECTOR_SIZE  512u
+#define BLK_IO_MAX_BATCH 32u
+#define BLK_IO_MAX_SECT  256u  /* 单个请求最多 128 KiB */
+
+#define BLK_OP_READ  0u
+#define BLK_OP_WRITE 1u
+#define BLK_OP_FLUSH 2u  /* 之前完成的写落盘；sector/nsect/buf 不用 */
+#define BLK_OP_NR    3u
+
+struct blk_io {
+  uint32_t op;      /* BLK_OP_* */
+  uint32_t nsect;
+  uint64_t sector;
+  uint64_t buf;
+  int64_t  result;  /* 0 或 -errno（内核写） */
+};
+
+/* SYS_BLK_STAT(dev, out, flags)：0 或 -ENODEV。时间单位是 time CSR tick。 */
+#define BLKSTAT_F_RESET (1u << 0)  /* 拷贝后清零计数 */
+
+struct blkstat_user {
+  char     name[8];
+  uint64_t nsectors;
+  uint32_t max_inflight;          /* 设备同时在飞的请求上限 */
+  uint32_t max_segs;              /* 一个设备请求最多合并几段 */
+  uint64_t reqs[BLK_OP_NR];       /* 提交的请求数（合并前） */
+  uint64_t sectors[BLK_OP_NR];
+  uint64_t merges;                /* 被合并进前一个请求的个数 */
+  uint64_t hw_reqs;               /* 真正下发给设备的请求数 */
+  uint64_t dispatch_rounds;       /* 下发批次（每批最多一次门铃） */
+  uint64_t inflight_peak;
+  uint64_t lat_ticks;             /* 提交到完成的总延迟 */
+  uint64_t lat_max;
+  uint64_t kicks;                 /* 驱动：写门铃次数 */
+  uint64_t kicks_suppressed;      /* 驱动：设备说不用通知 */
+  uint64_t irqs;                  /* 驱动：完成中断 */
+};
+
+/*
+ * SYS_BCACHE_IO(dev, op, blockno, buf)：经块缓存读写一个 BCACHE_BLOCK_SIZE
+ * （1 KiB）的块。READ/WRITE 返回块大小，SYNC 写回 dev 的脏块并 FLUSH，返回 0；
+ * 或 -errno。WRITE 只标脏，由写回线程延迟落盘。
+ */
+#define BCACHE_OP_READ  0u
+#define BCACHE_OP_WRITE 1u
+#define BCACHE_OP_SYNC  2u
+
+/* SYS_CACHESTAT(out, flags)：0 或 -EINVAL */
+#define CACHESTAT_F_RESET (1u << 0)  /* 拷贝后清零计数（nbuf/ndirty 不清） */
+
+struct cachestat_user {
+  uint32_t nbuf;
+  uint32_t block_size;
+  uint32_t ndirty;         /* 当前脏块 */
+  uint32_t nvalid;         /* 当前有效块 */
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;      /* 换出的有效块 */
+  uint64_t ra_issued;      /* 发出的预读块 */
+  uint64_t ra_hits;        /* 预读块后来被读到 */
+  uint64_t writebacks;     /* bflush 写回的块 */
+  uint64_t flush_batches;  /* bflush 下发批次 */
+  uint64_t sync_writes;    /* bwrite 同步写 */
+  uint64_t lock_waits;     /* 等 buf 睡眠锁 */
+  uint64_t alloc_waits;    /* 没有空闲块、等写回 */
+  uint64_t direct_reqs;    /* 大块读绕过缓存的设备请求 */
+  uint64_t direct_blocks;
+};
+
+/*
+ * 文件（vfs.c）：SYS_OPEN(path, flags) 返回 fd；路径都是绝对路径（没有 cwd）。
+ * fd 表由同一个线程组（thread_create 出来的线程和创建者）共享，
+ * 0/1/2 是控制台。
+ */
+#define OPEN_MAX 16   /* 每张 fd 表 */
+#define PATH_MAX 128  /* 含结尾 '\0' */
+
+#define O_RDONLY  0x000u
+#define O_WRONLY  0x001u
+#define O_RDWR    0x002u
+#define O_ACCMODE 0x003u
+#define O_CREAT   0x040u
+#define O_TRUNC   0x200u
+#define O_APPEND  0x400u
+
+#define SEEK_SET 0
+#define SEEK_CUR 1
+#define SEEK_END 2
+
+#define STAT_T_FILE 1u
+#define STAT_T_DIR  2u
+#define STAT_T_CHR  3u  /* 控制台 */
+#define STAT_T_FIFO 4u  /* 管道：size = 缓冲里的字节数 */
+#define STAT_T_ANON 5u  /* eventfd / timerfd：size = 当前计数 */
+
+/* SYS_FSTAT(fd, out)：0 或 -errno */
+struct stat_user {
+  uint32_t type;    /* STAT_T_* */
+  uint32_t dev;     /* 块设备号；控制台为 0，tmpfs 为 STAT_DEV_NONE */
+  uint64_t ino;
+  uint64_t size;    /* 字节 */
+  uint64_t blocks;  /* 占用的 1 KiB 块 */
+  uint64_t mtime;   /* 秒 */
+};
+
+#define STAT_DEV_NONE 0xffffffffu  /* 不在块设备上（tmpfs） */
+
+/* SYS_GETDENTS(fd, ents, n)：从目录的当前位置最多读 n 项，返回项数（0 = 读完）
+ * 或 -errno。挂载点不会出现在上一级目录里。 */
+#define DIRENT_NAME_MAX 27u
+
+struct dirent_user {
+  uint64_t ino;
+  uint32_t type;  /* STAT_T_FILE / STAT_T_DIR */
+  char name[DIRENT_NAME_MAX + 1u];
 };
+
+/* 管道：SYS_PIPE(int fds[2]) 给出读端 fds[0] / 写端 fds[1]；0 或 -errno。
+ * 读到有数据就返回（写端全关且读空返回 0），写全部写完才返回（读端全关
+ * 返回已写字节数，一个都没写则 -EPIPE）。 */
+#define PIPE_BUF_SIZE 4096u
+
+/* SYS_THREAD_SPAWN(entry, arg, name, stdio)：和 thread_create 一样，但新线程
+ * 用一张新的 fd 表（新线程组），其中 0/1/2 = 调用者的 stdio[0..2]（-1 =
+ * 调用者自己的 0/1/2），其余 fd 不继承。stdio 为 NULL 时照抄 0/1/2。 */
+
+/* SYS_PIPESTAT(out, flags)：0 或 -EINVAL */
+#define PIPESTAT_F_RESET (1u << 0)  /* 拷贝后清零计数（npipes 不清） */
+
+struct pipestat_user {
+  uint32_t npipes;         /* 当前打开的管道 */
+  uint32_t _pad;
+  uint64_t created;
+  uint64_t bytes_ring;     /* 经环形缓冲（两次拷贝） */
+  uint64_t bytes_direct;   /* 写端直接交给已在等的读端（一次拷贝） */
+  uint64_t read_blocks;    /* 读端阻塞次数 */
+  uint64_t write_blocks;   /* 写端阻塞次数（缓冲满） */
+};
+
+/* SYS_FUTEX(addr, op, val)：addr 必须 4 字节对齐。
+ *   FUTEX_WAIT：*addr == val 时阻塞到被 WAKE，返回 0；不等立即 -EAGAIN。
+ *   FUTEX_WAKE：最多唤醒 val 个等在 addr 上的线程，返回个数。
+ * 比较和入队在内核锁下完成：先改 *addr 再 WAKE 不会丢唤醒。 */
+#define FUTEX_WAIT 0u
+#define FUTEX_WAKE 1u
+
+/* SYS_POLL(fds, nfds, timeout)：timeout 单位 tick（同 sleep），< 0 一直等，
+ * 0 只查不等。返回 revents 非零的项数（超时为 0）或 -errno。fd < 0 的项忽略；
+ * POLLERR / POLLHUP / POLLNVAL 不用订阅也会报告。普通文件总是可读写。 */
+#define POLL_MAX_FDS 8u
+
+#define POLLIN   0x001u
+#define POLLOUT  0x004u
+#define POLLERR  0x008u  /* 管道写端：读端已全关 */
+#define POLLHUP  0x010u  /* 管道读端：写端已全关 */
+#define POLLNVAL 0x020u  /* fd 没打开 */
+
+struct pollfd_user {
+  int32_t fd;
+  uint16_t events;
+  uint16_t revents;
+};
+
+/* SYS_EVENTFD(initval, flags) / SYS_TIMERFD_CREATE()：返回 fd 或 -errno。
+ * 两者都是 8 字节计数：read 要求 buf 8 字节对齐、len >= 8，计数为 0 时
+ * 阻塞，否则取走计数（EFD_SEMAPHORE 时取 1）返回 8。eventfd 的 write 把
+ * 8 字节的值加到计数上（会超过 EVFD_COUNT_MAX 时 -EAGAIN）。
+ * SYS_TIMERFD_SETTIME(fd, first, period)：tick 为单位，first 后第一次到期，
+ * 之后每 period 到期一次（按截止时间上膛，不漂移；0 = 一次性）；first = 0
+ * 停止。重新设置会清掉未读的到期次数。poll：计数非零时 POLLIN。 */
+#define EFD_SEMAPHORE  (1u << 0)
+#define EVFD_COUNT_MAX 0xfffffffffffffffeull
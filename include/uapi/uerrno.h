@@ -0,0 +1,31 @@
+// uerrno.h （shared by user and kernel）
+//
+// syscall 失败时返回 -Exxx。数值沿用 Linux/POSIX 常见取值，方便对照。
+// 早期 syscall 直接返回 -1/-3 等裸数字，新代码统一用这里的名字。
+
+#pragma once
+
+#define EPERM        1
+#define ENOENT       2
+#define ESRCH        3
+#define EINTR        4
+#define EIO          5
+#define EBADF        9
+#define EAGAIN       11
+#define ENOMEM       12
+#define EFAULT       14
+#define EBUSY        16
+#define EEXIST       17
+#define ENODEV       19
+#define ENOTDIR      20
+#define EISDIR       21
+#define EINVAL       22
+#define ENFILE       23
+#define EMFILE       24
+#define EFBIG        27
+#define ENOSPC       28
+#define ESPIPE       29
+#define EPIPE        32
+#define ENAMETOOLONG 36
+#define ENOSYS       38
+#define ETIMEDOUT    110
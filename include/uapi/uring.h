@@ -0,0 +1,73 @@
+// uring.h （shared by user and kernel）
+//
+// io_uring 风格的批量 syscall ring：每个用户线程一对 SQ/CQ。
+//
+//   - ring 内存由用户态提供（没有 MMU，内核直接访问），SYS_RING_SETUP 注册。
+//   - SQ：用户写 sqes[] 和 sq_tail，内核消费后推进 sq_head。
+//   - CQ：内核写 cqes[] 和 cq_tail，用户处理后推进 cq_head。
+//   - 一次 SYS_RING_ENTER 提交多条 SQE；目前所有操作都同步完成，
+//     返回时对应的 CQE 已经可见。普通文件的 READ/WRITE 要读盘，
+//     和 SLEEP / FUTEX_WAIT 一样做完这条 enter 就返回，剩下的留到下次。
+//   - URING_SETUP_SQPOLL：内核 sqpoll 线程轮询 SQ，用户提交不需要陷入。
+//     sqpoll 空闲睡眠前会置 URING_SQ_NEED_WAKEUP，用户看到后要用
+//     SYS_RING_ENTER(URING_ENTER_SQ_WAKEUP) 叫醒它。
+//
+// 发布顺序：写 SQE → fence w,w → 写 sq_tail；读 cq_tail → fence r,r → 读 CQE。
+
+#pragma once
+#include <stdint.h>
+
+#define URING_MAX_ENTRIES 64  /* SQ 上限；CQ = 2 * entries */
+
+/* opcode */
+enum {
+  URING_OP_NOP           = 0,
+  URING_OP_WRITE         = 1,  /* fd, addr=buf, len；fd 按提交线程的 fd 表解析 */
+  URING_OP_READ          = 2,  /* fd, addr=buf, len；不阻塞，没数据返回 -EAGAIN */
+  URING_OP_CLOCK_GETTIME = 3,  /* fd=clock_id, addr=struct timespec* */
+  URING_OP_SLEEP         = 4,  /* len=ticks；只在非 SQPOLL 的 enter 里生效，之后的 SQE 留到下次 */
+  URING_OP_FUTEX_WAKE    = 5,  /* addr=uint32_t*, len=最多唤醒几个；结果是唤醒的个数 */
+  URING_OP_FUTEX_WAIT    = 6,  /* addr=uint32_t*, len=期望值；同 SLEEP 只在非 SQPOLL 的 enter 里，
+                                * 值不等立刻 -EAGAIN，否则 CQE 先写 0、被 wake 后 enter 才返回 */
+};
+
+/* setup flags */
+#define URING_SETUP_SQPOLL    (1u << 0)
+
+/* enter flags */
+#define URING_ENTER_SQ_WAKEUP (1u << 0)
+
+/* sq_flags（内核写，用户读） */
+#define URING_SQ_NEED_WAKEUP  (1u << 0)
+
+struct uring_sqe {
+  uint8_t  op;
+  uint8_t  flags;
+  uint16_t _pad;
+  int32_t  fd;
+  uint64_t addr;
+  uint64_t len;
+  uint64_t user_data;
+};
+
+struct uring_cqe {
+  uint64_t user_data;
+  int64_t  res;  /* 结果或 -errno */
+};
+
+struct uring {
+  volatile uint32_t sq_head;  /* 内核写 */
+  volatile uint32_t sq_tail;  /* 用户写 */
+  volatile uint32_t cq_head;  /* 用户写 */
+  volatile uint32_t cq_tail;  /* 内核写 */
+
+  uint32_t entries;           /* SQ 大小，2 的幂，<= URING_MAX_ENTRIES */
+  uint32_t setup_flags;
+  volatile uint32_t sq_flags; /* URING_SQ_NEED_WAKEUP */
+  volatile uint32_t cq_overflow;
+  uint32_t sq_local_tail;     /* 只给用户库用：已填写未发布的 tail，内核不看 */
+  uint32_t _reserved;
+
+  struct uring_sqe sqes[URING_MAX_ENTRIES];
+  struct uring_cqe cqes[2 * URING_MAX_ENTRIES];
+};
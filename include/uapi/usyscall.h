@@ -15,7 +15,81 @@ enum {
   SYS_GET_HARTID    = 11,
   SYS_YIELD         = 12,
   SYS_THREAD_DETACH = 13,
-  SYS_RUNQUEUE_SNAPSHOT = 14
+  SYS_RUNQUEUE_SNAPSHOT = 14,
+  SYS_SYSSTAT       = 15,
+  SYS_RING_SETUP    = 16,
+  SYS_RING_ENTER    = 17,
+  SYS_NOP           = 18,  /* 什么都不做：测陷入往返开销 */
+  SYS_LOCKSTAT      = 19,
+  SYS_CPUSTAT       = 20,
+  SYS_IRQ_AFFINITY  = 21,
+  SYS_BLK_IO        = 22,
+  SYS_BLK_STAT      = 23,
+  SYS_BCACHE_IO     = 24,
+  SYS_CACHESTAT     = 25,
+  SYS_OPEN          = 26,
+  SYS_CLOSE         = 27,
+  SYS_LSEEK         = 28,
+  SYS_FSTAT         = 29,
+  SYS_GETDENTS      = 30,
+  SYS_PIPE          = 31,
+  SYS_THREAD_SPAWN  = 32,
+  SYS_PIPESTAT      = 33,
+  SYS_FUTEX         = 34,
+  SYS_POLL          = 35,
+  SYS_EVENTFD       = 36,
+  SYS_TIMERFD_CREATE = 37,
+  SYS_TIMERFD_SETTIME = 38,
+
+  SYS_NR  /* 表长：新 syscall 加在它前面 */
 };
 
+/* 0 不是合法 syscall 号：内核把未知号（-ENOSYS）都记在 0 号统计里 */
+static inline const char *
+syscall_name(unsigned nr)
+{
+  switch (nr) {
+    case 0:                     return "<unknown>";
+    case SYS_SLEEP:             return "sleep";
+    case SYS_THREAD_EXIT:       return "thread_exit";
+    case SYS_THREAD_JOIN:       return "thread_join";
+    case SYS_THREAD_CREATE:     return "thread_create";
+    case SYS_WRITE:             return "write";
+    case SYS_READ:              return "read";
+    case SYS_THREAD_LIST:       return "thread_list";
+    case SYS_THREAD_KILL:       return "thread_kill";
+    case SYS_CLOCK_GETTIME:     return "clock_gettime";
+    case SYS_IRQ_GET_STATS:     return "irq_get_stats";
+    case SYS_GET_HARTID:        return "get_hartid";
+    case SYS_YIELD:             return "yield";
+    case SYS_THREAD_DETACH:     return "thread_detach";
+    case SYS_RUNQUEUE_SNAPSHOT: return "runqueue_snapshot";
+    case SYS_SYSSTAT:           return "sysstat";
+    case SYS_RING_SETUP:        return "ring_setup";
+    case SYS_RING_ENTER:        return "ring_enter";
+    case SYS_NOP:               return "nop";
+    case SYS_LOCKSTAT:          return "lockstat";
+    case SYS_CPUSTAT:           return "cpustat";
+    case SYS_IRQ_AFFINITY:      return "irq_affinity";
+    case SYS_BLK_IO:            return "blk_io";
+    case SYS_BLK_STAT:          return "blk_stat";
+    case SYS_BCACHE_IO:         return "bcache_io";
+    case SYS_CACHESTAT:         return "cachestat";
+    case SYS_OPEN:              return "open";
+    case SYS_CLOSE:             return "close";
+    case SYS_LSEEK:             return "lseek";
+    case SYS_FSTAT:             return "fstat";
+    case SYS_GETDENTS:          return "getdents";
+    case SYS_PIPE:              return "pipe";
+    case SYS_THREAD_SPAWN:      return "thread_spawn";
+    case SYS_PIPESTAT:          return "pipestat";
+    case SYS_FUTEX:             return "futex";
+    case SYS_POLL:              return "poll";
+    case SYS_EVENTFD:           return "eventfd";
+    case SYS_TIMERFD_CREATE:    return "timerfd_create";
+    case SYS_TIMERFD_SETTIME:   return "timerfd_settime";
+    default:                    return "?";
+  }
+}
+
 #endif // SYSCALL_NO_H
@@ -0,0 +1,70 @@
+// uvdso.h （shared by user and kernel）
+//
+// 内核维护、用户态直接读取的共享数据页（vDSO 风格）。
+//
+// 当前没有 MMU：整个镜像（包括 U-mode 代码）链接在一起，用户态本来就能读到
+// 内核全局变量，所以“共享页”就是链接脚本里一个 4KiB 对齐的段，
+// 用户态通过链接符号 __vdso_data 只读访问。
+//
+// 时间换算：
+//   ns = base_real_ns + ((ticks - base_ticks) * mult) >> VDSO_MULT_SHIFT
+//   ticks 来自 time CSR（U-mode 可用 rdtime 读，内核已打开 scounteren.TM）
+//
+// 一致性：seq 是 seqlock 计数，奇数表示内核正在更新；
+// 读者读前后两次 seq 相同且为偶数才算拿到一致快照。
+
+#pragma once
+#include <stdint.h>
+
+#define VDSO_PAGE_SIZE  4096
+#define VDSO_MULT_SHIFT 32
+
+/* hwcap：内核探测到、并且已经为用户态打开的 ISA 扩展 */
+#define VDSO_HWCAP_V    (1ull << 0)  /* RVV 1.0，vlenb 有效 */
+#define VDSO_HWCAP_FD   (1ull << 1)  /* F/D（RISCV_FP=YES 构建），惰性保存 */
+
+struct vdso_hart {
+  uint32_t hartid;
+  volatile uint32_t online;
+};
+
+struct vdso_data {
+  volatile uint32_t seq;  /* seqlock：奇数 = 更新中 */
+  volatile uint32_t ready;
+
+  /* 时间基准（seq 保护） */
+  uint64_t timebase_hz;
+  uint64_t mult;          /* ns/tick << VDSO_MULT_SHIFT */
+  uint64_t base_ticks;    /* base_real_ns 对应的 time CSR 值 */
+  uint64_t base_real_ns;  /* CLOCK_REALTIME 基准 */
+  uint64_t boot_real_ns;  /* CLOCK_MONOTONIC = REALTIME - boot_real_ns */
+
+  /* per-hart 信息。
+   * 约定：trap 返回 U-mode 时 tp 仍指向当前 hart 的 cpu_t，
+   * 所以 hartid = (tp - cpu_base) / cpu_stride，不需要陷入内核。
+   */
+  uintptr_t cpu_base;
+  uint32_t  cpu_stride;
+  uint32_t  nr_harts;
+
+  /* 线程栈：线程 tid 的栈是 [stack_base + tid * stack_stride, +stack_stride)。
+   * sp 属于线程自己，抢占、迁移都不变，所以 tid = (sp - stack_base) / stack_stride
+   * 不像经 tp 读 cpu_t.current_tid 那样会读到别的线程。stack_stride == 0 = 未设置。
+   */
+  uintptr_t stack_base;
+  uint32_t  stack_stride;
+  uint32_t  nr_stacks;
+
+  /* 只在启动时写一次 */
+  uint64_t hwcap;  /* VDSO_HWCAP_* */
+  uint32_t vlenb;  /* VDSO_HWCAP_V 时的向量寄存器字节数 */
+  uint32_t _pad;
+
+  struct vdso_hart harts[MAX_HARTS];
+};
+
+_Static_assert(sizeof(struct vdso_data) <= VDSO_PAGE_SIZE,
+               "vdso_data must fit in one page");
+
+/* 链接脚本导出的页起始地址（user 侧只读使用） */
+extern const struct vdso_data __vdso_data;
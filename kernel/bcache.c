@@ -0,0 +1,617 @@
+/* kernel/bcache.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bcache.h"
+#include "blkdev.h"
+#include "lock.h"
+#include "log.h"
+#include "sleeplock.h"
+#include "string.h"
+#include "sysworker.h"
+#include "thread.h"
+#include "trap.h"
+#include "uerrno.h"
+
+#define BCACHE_NODEV    0xffffffffu  /* 还没分配给任何块 */
+#define BCACHE_ALL_DEVS 0xffffffffu
+
+/* 每个设备的顺序读检测 */
+typedef struct {
+  uint32_t last;     /* 上次读的块 */
+  uint32_t ra_next;  /* 预读已经发到哪（不含） */
+  uint32_t seq_valid;
+} bcache_ra_t;
+
+static struct buf s_bufs[BCACHE_NBUF];
+static struct buf *s_hash[BCACHE_HASH];
+static struct buf s_lru;  /* 哨兵：lru_next = 最近用过，lru_prev = 最久没用 */
+static bcache_ra_t s_ra[BLK_MAX_DEVS];
+static kwaitq_t s_free_waiters;  /* 等空闲块 */
+static uint32_t s_ndirty;
+static tid_t s_flush_tid = -1;
+static uint32_t s_flush_kick;
+static uint32_t s_flush_ticks;
+static struct cachestat_user s_stat;  /* 只用计数字段 */
+
+static void
+bflush_kick(void)
+{
+  s_flush_kick = 1;
+  if (s_flush_tid >= 0) thread_wake(s_flush_tid);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Hash / LRU                                                                 */
+/* -------------------------------------------------------------------------- */
+
+static inline uint32_t
+bhash(uint32_t dev, uint32_t blockno)
+{
+  return ((blockno ^ (dev << 24)) * 2654435761u) % BCACHE_HASH;
+}
+
+static struct buf *
+hash_lookup(uint32_t dev, uint32_t blockno)
+{
+  for (struct buf *b = s_hash[bhash(dev, blockno)]; b; b = b->hnext) {
+    if (b->dev == dev && b->blockno == blockno) return b;
+  }
+  return NULL;
+}
+
+static void
+hash_insert(struct buf *b)
+{
+  uint32_t h = bhash(b->dev, b->blockno);
+  b->hnext   = s_hash[h];
+  s_hash[h]  = b;
+}
+
+static void
+hash_remove(struct buf *b)
+{
+  struct buf **pp = &s_hash[bhash(b->dev, b->blockno)];
+  while (*pp != b) pp = &(*pp)->hnext;
+  *pp = b->hnext;
+}
+
+static void
+lru_remove(struct buf *b)
+{
+  b->lru_prev->lru_next = b->lru_next;
+  b->lru_next->lru_prev = b->lru_prev;
+}
+
+static void
+lru_push_front(struct buf *b)
+{
+  b->lru_next              = s_lru.lru_next;
+  b->lru_prev              = &s_lru;
+  s_lru.lru_next->lru_prev = b;
+  s_lru.lru_next           = b;
+}
+
+/* 从 LRU 尾找一个能换出的块；*may_wait = 有脏块 / 在飞的块，等一会儿会空出来 */
+static struct buf *
+bcache_victim(int *may_wait)
+{
+  for (struct buf *b = s_lru.lru_prev; b != &s_lru; b = b->lru_prev) {
+    if (b->refcnt != 0 || b->owner >= 0) continue;
+    if (!(b->flags & (B_DIRTY | B_IO))) return b;
+    if (may_wait) *may_wait = 1;
+  }
+  return NULL;
+}
+
+static void
+bcache_assign(struct buf *b, uint32_t dev, uint32_t blockno)
+{
+  if (b->dev != BCACHE_NODEV) {
+    hash_remove(b);
+    if (b->flags & B_VALID) s_stat.evictions++;
+  }
+  b->dev     = dev;
+  b->blockno = blockno;
+  b->flags   = 0;
+  hash_insert(b);
+  lru_remove(b);
+  lru_push_front(b);
+}
+
+/* 持锁：找到或分配 (dev, blockno) 的 buf，refcnt+1。
+ * 全被引用着（等也等不到）时返回 NULL。 */
+static struct buf *
+bget(uint32_t dev, uint32_t blockno, reg_t *s)
+{
+  for (;;) {
+    struct buf *b = hash_lookup(dev, blockno);
+    if (b) {
+      b->refcnt++;
+      return b;
+    }
+
+    int may_wait = 0;
+    b            = bcache_victim(&may_wait);
+    if (b) {
+      bcache_assign(b, dev, blockno);
+      b->refcnt = 1;
+      return b;
+    }
+    if (!may_wait) return NULL;
+
+    /* 睡醒后重新查：别人可能已经把这个块读进来了 */
+    s_stat.alloc_waits++;
+    bflush_kick();
+    kwait_sleep_locked(&s_free_waiters, s);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Buffer lock / IO                                                           */
+/* -------------------------------------------------------------------------- */
+
+static void
+buf_lock(struct buf *b, reg_t *s)
+{
+  ASSERT(b->owner != thread_current());
+  if (b->owner >= 0) s_stat.lock_waits++;
+  while (b->owner >= 0) kwait_sleep_locked(&b->waiters, s);
+  b->owner = thread_current();
+}
+
+static void
+brelse_locked(struct buf *b)
+{
+  ASSERT(b->refcnt > 0);
+  b->owner = -1;
+  kwait_wake_all(&b->waiters);
+
+  if (--b->refcnt == 0) {
+    lru_remove(b);
+    lru_push_front(b);
+    if (!(b->flags & B_DIRTY)) kwait_wake_all(&s_free_waiters);
+  }
+}
+
+/* 块设备完成回调（持锁） */
+static void
+bcache_io_done(blk_req_t *req)
+{
+  struct buf *b = (struct buf *)req->priv;
+
+  b->io_status = req->status;
+  b->flags &= ~B_IO;
+  if (req->op == BLK_OP_READ) {
+    if (req->status == 0) {
+      b->flags |= B_VALID;
+    } else {
+      b->flags &= ~(B_VALID | B_RA);
+    }
+  }
+  kwait_wake_all(&b->waiters);
+  if (b->refcnt == 0 && !(b->flags & B_DIRTY)) kwait_wake_all(&s_free_waiters);
+}
+
+/* 持锁：给 b 发一个整块请求，不等完成 */
+static void
+bcache_submit(blkdev_t *bd, struct buf *b, uint32_t op)
+{
+  b->flags |= B_IO;
+  b->io_status  = BLK_REQ_PENDING;
+  b->req.op     = op;
+  b->req.nsect  = BCACHE_SECT_PER_BLK;
+  b->req.sector = (uint64_t)b->blockno * BCACHE_SECT_PER_BLK;
+  b->req.buf    = b->data;
+  b->req.done   = bcache_io_done;
+  b->req.priv   = b;
+  (void)blk_submit(bd, &b->req);  /* 块号在入口检查过 */
+}
+
+static void
+bcache_wait_io(struct buf *b, reg_t *s)
+{
+  while (b->flags & B_IO) kwait_sleep_locked(&b->waiters, s);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Read-ahead                                                                 */
+/* -------------------------------------------------------------------------- */
+
+static inline uint32_t
+bcache_nblocks(const blkdev_t *bd)
+{
+  uint64_t n = bd->nsectors / BCACHE_SECT_PER_BLK;
+  return n > 0xffffffffull ? 0xffffffffu : (uint32_t)n;
+}
+
+/* 持锁、设备已 plug：把 [from, to) 里不在缓存的块读进空闲块（不等）。
+ * 没有空闲块就停，预读不值得等写回。 */
+static void
+bcache_readahead(blkdev_t *bd, uint32_t dev, uint32_t from, uint32_t to)
+{
+  uint32_t nblocks = bcache_nblocks(bd);
+  if (to > nblocks) to = nblocks;
+
+  for (uint32_t k = from; k < to; ++k) {
+    if (hash_lookup(dev, k)) continue;
+    struct buf *b = bcache_victim(NULL);
+    if (!b) break;
+    bcache_assign(b, dev, k);
+    b->flags = B_RA;
+    bcache_submit(bd, b, BLK_OP_READ);
+    s_stat.ra_issued++;
+  }
+}
+
+/* 顺序读时让已发出的预读始终领先 BCACHE_RA_WINDOW/2 ~ BCACHE_RA_WINDOW 块 */
+static void
+bcache_ra_update(blkdev_t *bd, uint32_t dev, uint32_t blockno)
+{
+  bcache_ra_t *ra = &s_ra[dev];
+  int seq         = ra->seq_valid && blockno == ra->last + 1u;
+
+  ra->last      = blockno;
+  ra->seq_valid = 1;
+  if (!seq) {
+    ra->ra_next = blockno + 1u;
+    return;
+  }
+  if (ra->ra_next < blockno + 1u) ra->ra_next = blockno + 1u;
+  if (ra->ra_next > blockno + BCACHE_RA_WINDOW / 2u) return;
+
+  uint32_t to = blockno + 1u + BCACHE_RA_WINDOW;
+  bcache_readahead(bd, dev, ra->ra_next, to);
+  ra->ra_next = to;
+}
+
+/* -------------------------------------------------------------------------- */
+/* API                                                                        */
+/* -------------------------------------------------------------------------- */
+
+static struct buf *
+bcache_get(uint32_t dev, uint32_t blockno, int read)
+{
+  blkdev_t *bd = blk_get(dev);
+  if (!bd || blockno >= bcache_nblocks(bd)) return NULL;
+
+  reg_t s       = kernel_lock();
+  struct buf *b = bget(dev, blockno, &s);
+  if (!b) {
+    kernel_unlock(s);
+    return NULL;
+  }
+  buf_lock(b, &s);
+
+  if (read) {
+    /* 自己的读和新发的预读在同一个 plug 里，相邻的会合并成一个设备请求 */
+    blk_plug(bd);
+    if (b->flags & (B_VALID | B_IO)) {
+      s_stat.hits++;  /* 在飞的预读也算命中 */
+      if (b->flags & B_RA) s_stat.ra_hits++;
+    } else {
+      s_stat.misses++;
+      bcache_submit(bd, b, BLK_OP_READ);
+    }
+    bcache_ra_update(bd, dev, blockno);
+    blk_unplug(bd);
+  }
+  b->flags &= ~B_RA;
+
+  bcache_wait_io(b, &s);  /* 不读盘时也要等在飞的预读，免得它盖掉新数据 */
+  if (read && !(b->flags & B_VALID)) {
+    brelse_locked(b);
+    b = NULL;
+  }
+  kernel_unlock(s);
+  return b;
+}
+
+struct buf *
+bread(uint32_t dev, uint32_t blockno)
+{
+  return bcache_get(dev, blockno, 1);
+}
+
+struct buf *
+bgetblk(uint32_t dev, uint32_t blockno)
+{
+  return bcache_get(dev, blockno, 0);
+}
+
+void
+bdirty(struct buf *b)
+{
+  reg_t s = kernel_lock();
+  ASSERT(b->owner == thread_current());
+
+  b->flags |= B_VALID;
+  if (!(b->flags & B_DIRTY)) {
+    b->flags |= B_DIRTY;
+    if (++s_ndirty >= BCACHE_DIRTY_HIWAT) bflush_kick();
+  }
+  kernel_unlock(s);
+}
+
+int
+bwrite(struct buf *b)
+{
+  reg_t s = kernel_lock();
+  ASSERT(b->owner == thread_current());
+
+  b->flags |= B_VALID;
+  bcache_submit(blk_get(b->dev), b, BLK_OP_WRITE);
+  bcache_wait_io(b, &s);
+
+  int rc = b->io_status;
+  if (rc == 0 && (b->flags & B_DIRTY)) {
+    b->flags &= ~B_DIRTY;
+    s_ndirty--;
+  }
+  s_stat.sync_writes++;
+  kernel_unlock(s);
+  return rc;
+}
+
+void
+brelse(struct buf *b)
+{
+  reg_t s = kernel_lock();
+  ASSERT(b->owner == thread_current());
+  brelse_locked(b);
+  kernel_unlock(s);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Write-back                                                                 */
+/* -------------------------------------------------------------------------- */
+
+static inline int
+buf_before(const struct buf *a, const struct buf *b)
+{
+  return a->dev != b->dev ? a->dev < b->dev : a->blockno < b->blockno;
+}
+
+/* 持锁：收集最多 BCACHE_FLUSH_BATCH 个没人持有的脏块（dev 过滤），按
+ * (dev, blockno) 排序，每个设备 plug 住一起下发，等全部完成。
+ * 返回收集到的块数；*err = 第一个失败；*busy = 一个被别人持有的脏块。
+ */
+static uint32_t
+bcache_writeback(uint32_t dev, reg_t *s, struct buf **busy, int *err)
+{
+  struct buf *batch[BCACHE_FLUSH_BATCH];
+  uint32_t n = 0;
+
+  for (uint32_t i = 0; i < BCACHE_NBUF && n < BCACHE_FLUSH_BATCH; ++i) {
+    struct buf *b = &s_bufs[i];
+    if (!(b->flags & B_DIRTY)) continue;
+    if (dev != BCACHE_ALL_DEVS && b->dev != dev) continue;
+    if (b->owner >= 0) {
+      if (busy) *busy = b;
+      continue;
+    }
+
+    b->owner = thread_current();
+    b->refcnt++;
+    uint32_t j = n++;
+    while (j > 0 && buf_before(b, batch[j - 1u])) {
+      batch[j] = batch[j - 1u];
+      --j;
+    }
+    batch[j] = b;
+  }
+  if (n == 0) return 0;
+
+  blkdev_t *plugged = NULL;
+  for (uint32_t i = 0; i < n; ++i) {
+    blkdev_t *bd = blk_get(batch[i]->dev);
+    if (bd != plugged) {
+      if (plugged) blk_unplug(plugged);
+      blk_plug(bd);
+      plugged = bd;
+    }
+    bcache_submit(bd, batch[i], BLK_OP_WRITE);
+  }
+  blk_unplug(plugged);
+  s_stat.flush_batches++;
+
+  for (uint32_t i = 0; i < n; ++i) {
+    struct buf *b = batch[i];
+    bcache_wait_io(b, s);
+    if (b->io_status == 0) {
+      b->flags &= ~B_DIRTY;
+      s_ndirty--;
+      s_stat.writebacks++;
+    } else {
+      if (*err == 0) *err = b->io_status;
+      pr_warn("bcache: writeback dev %u block %u failed (%d)", b->dev,
+              b->blockno, b->io_status);
+    }
+    brelse_locked(b);
+  }
+  return n;
+}
+
+int
+bcache_read_blocks(uint32_t dev, uint32_t blockno, uint32_t n, void *dst)
+{
+  blkdev_t *bd = blk_get(dev);
+  if (!bd) return -ENODEV;
+  uint32_t nblocks = bcache_nblocks(bd);
+  if (n == 0 || blockno >= nblocks || n > nblocks - blockno) return -EINVAL;
+
+  uint8_t *p = (uint8_t *)dst;
+  uint32_t i = 0;
+  while (i < n) {
+    /* 从 i 开始有几块不在缓存里 */
+    reg_t s      = kernel_lock();
+    uint32_t run = 0;
+    while (i + run < n && run < BCACHE_DIRECT_MAX &&
+           !hash_lookup(dev, blockno + i + run)) {
+      run++;
+    }
+    if (run) {
+      s_stat.direct_reqs++;
+      s_stat.direct_blocks += run;
+    }
+    kernel_unlock(s);
+
+    if (run == 0) {
+      struct buf *b = bread(dev, blockno + i);
+      if (!b) return -EIO;
+      memcpy(p + (size_t)i * BCACHE_BLOCK_SIZE, b->data, BCACHE_BLOCK_SIZE);
+      brelse(b);
+      i++;
+      continue;
+    }
+
+    int rc = blk_rw(bd, BLK_OP_READ,
+                    (uint64_t)(blockno + i) * BCACHE_SECT_PER_BLK,
+                    run * BCACHE_SECT_PER_BLK,
+                    p + (size_t)i * BCACHE_BLOCK_SIZE);
+    if (rc < 0) return rc;
+    i += run;
+  }
+  return 0;
+}
+
+int
+bsync(uint32_t dev)
+{
+  blkdev_t *bd = blk_get(dev);
+  if (!bd) return -ENODEV;
+
+  int err = 0;
+  reg_t s = kernel_lock();
+  for (;;) {
+    struct buf *busy = NULL;
+    uint32_t n       = bcache_writeback(dev, &s, &busy, &err);
+    if (err) break;
+    if (n) continue;
+    if (!busy) break;
+    /* 别人正持有（在改，或 bflush 正在写）：等它放手再看 */
+    kwait_sleep_locked(&busy->waiters, &s);
+  }
+  kernel_unlock(s);
+
+  if (err) return err;
+  return blk_rw(bd, BLK_OP_FLUSH, 0, 0, NULL);
+}
+
+static void __attribute__((noreturn))
+bflush_main(void *arg)
+{
+  (void)arg;
+
+  for (;;) {
+    reg_t s = kernel_lock();
+    if (!s_flush_kick) {
+      thread_kern_block_locked();
+      kernel_unlock(s);
+      continue;
+    }
+    s_flush_kick = 0;
+
+    /* 写满一批说明可能还有；失败的块留着脏，下个周期再试 */
+    int err = 0;
+    while (bcache_writeback(BCACHE_ALL_DEVS, &s, NULL, &err) ==
+               BCACHE_FLUSH_BATCH &&
+           err == 0) {
+    }
+    kwait_wake_all(&s_free_waiters);
+    kernel_unlock(s);
+  }
+}
+
+void
+bcache_tick(void)
+{
+  if (++s_flush_ticks < BCACHE_FLUSH_PERIOD_TICKS) return;
+  s_flush_ticks = 0;
+  if (s_ndirty) bflush_kick();
+}
+
+void
+bcache_init(void)
+{
+  s_lru.lru_next = &s_lru;
+  s_lru.lru_prev = &s_lru;
+  for (uint32_t i = 0; i < BCACHE_NBUF; ++i) {
+    struct buf *b = &s_bufs[i];
+    b->dev        = BCACHE_NODEV;
+    b->owner      = -1;
+    lru_push_front(b);
+  }
+
+  s_flush_tid = thread_create_kern(bflush_main, NULL, "bflush");
+  if (s_flush_tid < 0) PANICF("bcache: create bflush failed");
+}
+
+/* -------------------------------------------------------------------------- */
+/* Syscalls                                                                   */
+/* -------------------------------------------------------------------------- */
+
+/* sysworker 线程里跑：可以睡 */
+static long
+bcache_io_worker(uint64_t dev, uint64_t op, uint64_t blockno, uint64_t ubuf)
+{
+  uint8_t *p = (uint8_t *)(uintptr_t)ubuf;
+  struct buf *b;
+
+  switch (op) {
+    case BCACHE_OP_READ:
+      b = bread((uint32_t)dev, (uint32_t)blockno);
+      if (!b) return -EIO;
+      memcpy(p, b->data, BCACHE_BLOCK_SIZE);
+      brelse(b);
+      return BCACHE_BLOCK_SIZE;
+    case BCACHE_OP_WRITE:
+      b = bgetblk((uint32_t)dev, (uint32_t)blockno);
+      if (!b) return -ENOMEM;
+      memcpy(b->data, p, BCACHE_BLOCK_SIZE);
+      bdirty(b);
+      brelse(b);
+      return BCACHE_BLOCK_SIZE;
+    case BCACHE_OP_SYNC:
+      return bsync((uint32_t)dev);
+    default:
+      return -EINVAL;
+  }
+}
+
+void
+sys_bcache_io(struct trapframe *tf)
+{
+  blkdev_t *bd = blk_get((uint32_t)tf->a1);
+  if (!bd) {
+    tf->a0 = (reg_t)-ENODEV;
+    return;
+  }
+  if (tf->a2 > BCACHE_OP_SYNC ||
+      (tf->a2 != BCACHE_OP_SYNC &&
+       (!tf->a4 || tf->a3 >= bcache_nblocks(bd)))) {
+    tf->a0 = (reg_t)-EINVAL;
+    return;
+  }
+  (void)sysworker_call(tf, bcache_io_worker, tf->a1, tf->a2, tf->a3, tf->a4);
+}
+
+long
+sys_cachestat(struct cachestat_user *out, uint32_t flags)
+{
+  if (!out) return -EINVAL;
+
+  struct cachestat_user tmp = s_stat;
+  tmp.nbuf                  = BCACHE_NBUF;
+  tmp.block_size            = BCACHE_BLOCK_SIZE;
+  tmp.ndirty                = s_ndirty;
+  tmp.nvalid                = 0;
+  for (uint32_t i = 0; i < BCACHE_NBUF; ++i) {
+    if (s_bufs[i].flags & B_VALID) tmp.nvalid++;
+  }
+  *out = tmp;
+
+  if (flags & CACHESTAT_F_RESET) memset(&s_stat, 0, sizeof(s_stat));
+  return 0;
+}
@@ -0,0 +1,382 @@
+/* kernel/blk.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "blkdev.h"
+#include "cpu.h"
+#include "lock.h"
+#include "log.h"
+#include "platform.h"
+#include "thread.h"
+#include "trap.h"
+#include "uerrno.h"
+
+static blkdev_t *s_blkdevs[BLK_MAX_DEVS];
+static uint32_t s_nblkdevs;
+
+int
+blk_register(blkdev_t *dev)
+{
+  if (!dev || !dev->ops || !dev->ops->submit) return -EINVAL;
+  if (s_nblkdevs >= BLK_MAX_DEVS) return -ENOSPC;
+
+  if (dev->max_inflight == 0) dev->max_inflight = 1;
+  if (dev->max_segs == 0) dev->max_segs = 1;
+
+  uint32_t devno      = s_nblkdevs++;
+  s_blkdevs[devno]    = dev;
+  pr_info("blk: %s = dev %u, %llu sectors (%llu MiB), qd %u, %u segs/req",
+          dev->name, devno, (unsigned long long)dev->nsectors,
+          (unsigned long long)(dev->nsectors / 2048u), dev->max_inflight,
+          dev->max_segs);
+  return (int)devno;
+}
+
+blkdev_t *
+blk_get(uint32_t devno)
+{
+  return devno < s_nblkdevs ? s_blkdevs[devno] : NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Queue                                                                      */
+/* -------------------------------------------------------------------------- */
+
+static void
+blk_finish_one(blkdev_t *dev, blk_req_t *req, int status, uint64_t now)
+{
+  uint64_t lat = now - req->submit_tick;
+  dev->lat_ticks += lat;
+  if (lat > dev->lat_max) dev->lat_max = lat;
+
+  req->status = status;
+  if (req->done) req->done(req);
+}
+
+/* 能否把 req 接到队尾请求后面 */
+static int
+blk_can_merge(const blkdev_t *dev, const blk_req_t *tail, const blk_req_t *req)
+{
+  return tail && req->op != BLK_OP_FLUSH && tail->op == req->op &&
+         tail->sector + tail->total_nsect == req->sector &&
+         tail->nseg < dev->max_segs;
+}
+
+int
+blk_submit(blkdev_t *dev, blk_req_t *req)
+{
+  if (!dev || !req || req->op >= BLK_OP_NR) return -EINVAL;
+
+  if (req->op != BLK_OP_FLUSH) {
+    if (!req->buf || req->nsect == 0 || req->sector >= dev->nsectors ||
+        req->nsect > dev->nsectors - req->sector) {
+      return -EINVAL;
+    }
+  }
+
+  req->next        = NULL;
+  req->merge_next  = NULL;
+  req->merge_tail  = req;
+  req->nseg        = 1;
+  req->total_nsect = req->nsect;
+  req->status      = BLK_REQ_PENDING;
+  req->submit_tick = platform_time_now();
+
+  dev->reqs[req->op]++;
+  dev->sectors[req->op] += req->nsect;
+
+  if (req->op == BLK_OP_FLUSH && !(dev->flags & BLKDEV_F_FLUSH)) {
+    blk_finish_one(dev, req, 0, req->submit_tick);  /* 没有写缓存，直接成功 */
+    return 0;
+  }
+
+  blk_req_t *tail = dev->pend_tail;
+  if (blk_can_merge(dev, tail, req)) {
+    tail->merge_tail->merge_next = req;
+    tail->merge_tail             = req;
+    tail->nseg++;
+    tail->total_nsect += req->nsect;
+    dev->merges++;
+    return 0;
+  }
+
+  if (tail) {
+    tail->next = req;
+  } else {
+    dev->pend_head = req;
+  }
+  dev->pend_tail = req;
+
+  blk_run_queue(dev);
+  return 0;
+}
+
+void
+blk_plug(blkdev_t *dev)
+{
+  dev->plugged++;
+}
+
+void
+blk_unplug(blkdev_t *dev)
+{
+  if (dev->plugged > 0 && --dev->plugged == 0) blk_run_queue(dev);
+}
+
+void
+blk_run_queue(blkdev_t *dev)
+{
+  if (dev->plugged) return;
+
+  uint32_t sent = 0;
+  while (dev->pend_head && dev->inflight < dev->max_inflight) {
+    blk_req_t *req = dev->pend_head;
+
+    /* FLUSH 只保证已完成的写落盘：等前面的都回来再发 */
+    if (req->op == BLK_OP_FLUSH && dev->inflight > 0) break;
+    if (dev->ops->submit(dev, req) != 0) break;
+
+    dev->pend_head = req->next;
+    if (!dev->pend_head) dev->pend_tail = NULL;
+    req->next = NULL;
+
+    dev->inflight++;
+    if (dev->inflight > dev->inflight_peak) dev->inflight_peak = dev->inflight;
+    dev->hw_reqs++;
+    sent++;
+
+    /* FLUSH 之后的请求也要等它完成 */
+    if (req->op == BLK_OP_FLUSH) break;
+  }
+
+  if (sent) {
+    dev->dispatch_rounds++;
+    if (dev->ops->kick) dev->ops->kick(dev);
+  }
+}
+
+void
+blk_complete(blkdev_t *dev, blk_req_t *req, int status)
+{
+  ASSERT(dev->inflight > 0);
+  dev->inflight--;
+
+  uint64_t now = platform_time_now();
+  while (req) {
+    blk_req_t *next = req->merge_next;  /* done 里可能回收 req */
+    blk_finish_one(dev, req, status, now);
+    req = next;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Kernel-thread synchronous I/O                                              */
+/* -------------------------------------------------------------------------- */
+
+static void
+blk_kern_done(blk_req_t *req)
+{
+  thread_wake((tid_t)(uintptr_t)req->priv);
+}
+
+int
+blk_rw(blkdev_t *dev, uint32_t op, uint64_t sector, uint32_t nsect, void *buf)
+{
+  blk_req_t req = {
+      .op     = op,
+      .nsect  = nsect,
+      .sector = sector,
+      .buf    = buf,
+      .done   = blk_kern_done,
+      .priv   = (void *)(uintptr_t)thread_current(),
+  };
+
+  reg_t s = kernel_lock();
+  int rc  = blk_submit(dev, &req);
+  while (rc == 0 && req.status == BLK_REQ_PENDING) {
+    thread_kern_block_locked();
+    kernel_unlock(s);  /* 在这里切走，完成回调 thread_wake 之后回来 */
+    s = kernel_lock();
+  }
+  kernel_unlock(s);
+
+  return rc ? rc : req.status;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Syscalls                                                                   */
+/* -------------------------------------------------------------------------- */
+
+#define BLK_REQ_POOL (2u * BLK_IO_MAX_BATCH)
+
+/* 一次 SYS_BLK_IO：每个线程同时最多一个 */
+typedef struct {
+  struct blk_io *iov;
+  uint32_t remaining;
+  uint32_t blocked;   /* 已经 thread_block：完成方负责写 a0 并唤醒 */
+  uint32_t slot_seq;  /* 线程被回收重用后不再唤醒它 */
+  int64_t result;
+} blk_wait_t;
+
+static blk_req_t s_req_pool[BLK_REQ_POOL];
+static blk_req_t *s_req_free;
+static uint32_t s_req_nfree;
+static int s_req_pool_ready;
+static blk_wait_t s_waits[THREAD_MAX];
+
+static void
+blk_pool_init(void)
+{
+  for (uint32_t i = 0; i < BLK_REQ_POOL; ++i) {
+    s_req_pool[i].next = s_req_free;
+    s_req_free         = &s_req_pool[i];
+  }
+  s_req_nfree      = BLK_REQ_POOL;
+  s_req_pool_ready = 1;
+}
+
+static void
+blk_sys_done(blk_req_t *req)
+{
+  blk_wait_t *w = (blk_wait_t *)req->priv;
+  tid_t tid     = (tid_t)(w - s_waits);
+  Thread *t     = &g_threads[tid];
+  /* 提交者被 kill / 槽位被回收：iov 和 tf 都不是它的了，只做记账 */
+  int live = t->slot_seq.seq == w->slot_seq && t->state != THREAD_ZOMBIE &&
+             t->state != THREAD_UNUSED;
+
+  if (live) {
+    w->iov[req->tag].result = req->status;
+    if (req->status < 0 && w->result >= 0) w->result = req->status;
+  }
+
+  req->next  = s_req_free;
+  s_req_free = req;
+  s_req_nfree++;
+
+  if (--w->remaining > 0 || !w->blocked || !live) return;
+
+  t->tf.a0 = (reg_t)w->result;
+  thread_wake(tid);
+}
+
+void
+sys_blk_io(struct trapframe *tf, uint32_t devno, struct blk_io *iov,
+           uint32_t n)
+{
+  blkdev_t *dev = blk_get(devno);
+  if (!dev) {
+    tf->a0 = (reg_t)-ENODEV;
+    return;
+  }
+  if (!iov || n == 0 || n > BLK_IO_MAX_BATCH) {
+    tf->a0 = (reg_t)-EINVAL;
+    return;
+  }
+
+  for (uint32_t i = 0; i < n; ++i) {
+    const struct blk_io *io = &iov[i];
+    if (io->op >= BLK_OP_NR) goto inval;
+    if (io->op == BLK_OP_FLUSH) continue;
+    if (!io->buf || io->nsect == 0 || io->nsect > BLK_IO_MAX_SECT ||
+        io->sector >= dev->nsectors || io->nsect > dev->nsectors - io->sector) {
+      goto inval;
+    }
+  }
+
+  if (!s_req_pool_ready) blk_pool_init();
+  if (s_req_nfree < n) {
+    tf->a0 = (reg_t)-EAGAIN;
+    return;
+  }
+
+  tid_t tid     = thread_current();
+  blk_wait_t *w = &s_waits[tid];
+  if (w->remaining > 0) {
+    /* 同一个 tid 的上一个主人被 kill 时还有请求在飞 */
+    tf->a0 = (reg_t)-EBUSY;
+    return;
+  }
+  w->iov        = iov;
+  w->remaining  = n;
+  w->blocked    = 0;
+  w->slot_seq   = g_threads[tid].slot_seq.seq;
+  w->result     = (int64_t)n;
+
+  blk_plug(dev);
+  for (uint32_t i = 0; i < n; ++i) {
+    blk_req_t *req = s_req_free;
+    s_req_free     = req->next;
+    s_req_nfree--;
+
+    req->op     = iov[i].op;
+    req->nsect  = (iov[i].op == BLK_OP_FLUSH) ? 0 : iov[i].nsect;
+    req->sector = (iov[i].op == BLK_OP_FLUSH) ? 0 : iov[i].sector;
+    req->buf    = (void *)(uintptr_t)iov[i].buf;
+    req->tag    = i;
+    req->done   = blk_sys_done;
+    req->priv   = w;
+    iov[i].result = BLK_REQ_PENDING;
+
+    (void)blk_submit(dev, req);  /* 参数上面已经检查过，不会失败 */
+  }
+  blk_unplug(dev);
+
+  if (w->remaining == 0) {
+    tf->a0 = (reg_t)w->result;
+    return;
+  }
+  w->blocked = 1;
+  thread_block(tf);  /* 最后一个完成时 blk_sys_done 写 a0 并唤醒 */
+  return;
+
+inval:
+  tf->a0 = (reg_t)-EINVAL;
+}
+
+long
+sys_blk_stat(uint32_t devno, struct blkstat_user *out, uint32_t flags)
+{
+  blkdev_t *dev = blk_get(devno);
+  if (!dev) return -ENODEV;
+  if (!out) return -EINVAL;
+
+  struct blkstat_user tmp = {0};
+  size_t j                = 0;
+  for (; dev->name && dev->name[j] && j + 1 < sizeof(tmp.name); ++j) {
+    tmp.name[j] = dev->name[j];
+  }
+  tmp.name[j]         = '\0';
+  tmp.nsectors        = dev->nsectors;
+  tmp.max_inflight    = dev->max_inflight;
+  tmp.max_segs        = dev->max_segs;
+  for (uint32_t op = 0; op < BLK_OP_NR; ++op) {
+    tmp.reqs[op]    = dev->reqs[op];
+    tmp.sectors[op] = dev->sectors[op];
+  }
+  tmp.merges          = dev->merges;
+  tmp.hw_reqs         = dev->hw_reqs;
+  tmp.dispatch_rounds = dev->dispatch_rounds;
+  tmp.inflight_peak   = dev->inflight_peak;
+  tmp.lat_ticks       = dev->lat_ticks;
+  tmp.lat_max         = dev->lat_max;
+  if (dev->ops->stats) {
+    dev->ops->stats(dev, &tmp, (flags & BLKSTAT_F_RESET) != 0);
+  }
+  *out = tmp;
+
+  if (flags & BLKSTAT_F_RESET) {
+    for (uint32_t op = 0; op < BLK_OP_NR; ++op) {
+      dev->reqs[op]    = 0;
+      dev->sectors[op] = 0;
+    }
+    dev->merges          = 0;
+    dev->hw_reqs         = 0;
+    dev->dispatch_rounds = 0;
+    dev->inflight_peak   = dev->inflight;
+    dev->lat_ticks       = 0;
+    dev->lat_max         = 0;
+  }
+  return 0;
+}
@@ -1,6 +1,8 @@
 #include "console.h"
 #include "uart_16550.h"
 #include <stdint.h>
+#include "lock.h"
+#include "softirq.h"
 #include "thread.h"
 
 #define CONSOLE_RBUF_SIZE 1024
@@ -12,6 +14,9 @@ static volatile uint32_t g_rx_tail = 0;  /* next read position */
 /* Which thread is waiting for stdin? -1 means none. */
 tid_t g_stdin_waiter               = -1;
 
+/* poll 在 stdin 上的线程 */
+static pollq_t s_rx_pollq;
+
 static inline int rb_is_empty(void) { return g_rx_head == g_rx_tail; }
 
 static inline int rb_is_full(void)
@@ -19,10 +24,13 @@ static inline int rb_is_full(void)
   return ((g_rx_head + 1) % CONSOLE_RBUF_SIZE) == g_rx_tail;
 }
 
+static void console_rx_softirq(void);
+
 void console_init(void)
 {
   g_rx_head = g_rx_tail = 0;
   g_stdin_waiter        = -1;
+  open_softirq(SOFTIRQ_CONSOLE_RX, console_rx_softirq);
 }
 
 /* Output for kernel / sys_write. */
@@ -39,7 +47,40 @@ int console_read_nonblock(char *buf, size_t len)
   return (int)n;
 }
 
-/* IRQ context: push a character into the ring buffer. */
+uint32_t console_poll_locked(pollq_t **q)
+{
+  *q = &s_rx_pollq;
+  return (rb_is_empty() ? 0 : POLLIN) | POLLOUT;
+}
+
+/* Hand buffered input to the blocked stdin reader; caller holds g_kernel_lock. */
+static void console_rx_deliver(void)
+{
+  if (rb_is_empty()) {
+    return;
+  }
+
+  /* wake and let g_stdin_waiter read */
+  if (g_stdin_waiter >= 0) {
+    thread_read_from_stdin(console_read_nonblock);
+    g_stdin_waiter = -1;
+  }
+
+  /* 阻塞的 read 没取完（或根本没人 read）：轮到 poll 的线程 */
+  if (pollq_active(&s_rx_pollq) && !rb_is_empty()) {
+    pollq_wake_locked(&s_rx_pollq);
+  }
+}
+
+/* Bottom half: runs on the kworker with interrupts enabled. */
+static void console_rx_softirq(void)
+{
+  reg_t s = kernel_lock();
+  console_rx_deliver();
+  kernel_unlock(s);
+}
+
+/* IRQ context (top half): push a character into the ring buffer. */
 void console_on_char_from_irq(uint8_t ch)
 {
   /* 1. Push into ring buffer (drop if full). */
@@ -49,11 +90,14 @@ void console_on_char_from_irq(uint8_t ch)
   }
 
   /* 2. If nobody is waiting for stdin, just keep it buffered. */
-  if (g_stdin_waiter < 0) {
+  if (g_stdin_waiter < 0 && !pollq_active(&s_rx_pollq)) {
     return;
   }
 
-  /* 3. wake and let g_stdin_waiter read” */
-  thread_read_from_stdin(console_read_nonblock);
-  g_stdin_waiter = -1;
+  /* 3. Copy-out + wakeup is deferred to the kworker (or done here in BH-inline mode). */
+  if (g_bh_inline) {
+    console_rx_deliver();
+  } else {
+    raise_softirq(SOFTIRQ_CONSOLE_RX);
+  }
 }
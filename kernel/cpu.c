@@ -8,6 +8,7 @@
 #include "sched.h"
 #include "sbi.h"
 #include "thread.h"
+#include "vdso.h"
 
 enum {
   HART_BITS_PER_WORD = (int)(sizeof(unsigned long) * 8u),
@@ -15,12 +16,15 @@ enum {
       (MAX_HARTS + HART_BITS_PER_WORD - 1) / HART_BITS_PER_WORD,
 };
 
-cpu_t g_cpus[MAX_HARTS];
+cpu_t g_cpus[MAX_HARTS] __percpu;
 uint8_t g_kstack[MAX_HARTS][KSTACK_SIZE];
 
 volatile uint32_t g_boot_hartid = NO_BOOT_HART;
 volatile int smp_boot_done      = 0;
 
+_Static_assert(MAX_HARTS <= 64, "smp ready mask is 64 bits");
+static volatile uint64_t s_ready_mask;  /* 做完 per-hart 初始化的 hart */
+
 static inline void
 smp_set_online(uint32_t hartid)
 {
@@ -52,6 +56,10 @@ cpu_init_this_hart(uintptr_t hartid)
   __asm__ volatile("mv tp, %0" ::"r"(c) : "memory");
   csr_write_sscratch((uintptr_t)c);
 
+  /* vdso: U-mode rdtime + per-hart 信息 */
+  arch_enable_user_counters();
+  vdso_hart_online((uint32_t)hartid);
+
   /* online hint: ideally set when entering idle/scheduling;
    * setting it here also works.
    */
@@ -160,6 +168,25 @@ smp_kick_hart(uint32_t hartid)
   }
 }
 
+void
+smp_set_ready(uint32_t hartid)
+{
+  __atomic_fetch_or(&s_ready_mask, 1ull << hartid, __ATOMIC_SEQ_CST);
+}
+
+uint64_t
+smp_wait_harts_ready(uint64_t want, uint64_t timeout_ticks)
+{
+  /* 只读内存，不走 SBI；所有 hart 共用一个截止时间 */
+  uint64_t start = platform_time_now();
+  uint64_t got   = __atomic_load_n(&s_ready_mask, __ATOMIC_ACQUIRE) & want;
+  while (got != want && (platform_time_now() - start) < timeout_ticks) {
+    __asm__ volatile("nop");
+    got = __atomic_load_n(&s_ready_mask, __ATOMIC_ACQUIRE) & want;
+  }
+  return got;
+}
+
 int
 smp_wait_hart_online(uint32_t hartid, uint64_t timeout_ticks)
 {
@@ -0,0 +1,101 @@
+/* kernel/cpustat.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpu.h"
+#include "cpustat.h"
+#include "percpu.h"
+#include "softirq.h"
+#include "uerrno.h"
+
+typedef struct {
+  uint64_t trap_count[CPUSTAT_TRAP_NR];
+  uint64_t trap_ticks[CPUSTAT_TRAP_NR];
+  uint64_t trap_max[CPUSTAT_TRAP_NR];
+  uint64_t softirq_count[CPUSTAT_SOFTIRQ_MAX];
+  uint64_t softirq_ticks;
+  uint64_t work_count;
+  uint64_t work_ticks;
+  uint64_t kworker_wakeups;
+} cpustat_t;
+
+/* trap 计数在 trap 里（关中断）写，softirq/work 计数在本 hart 的 kworker 里写：
+ * 都只写本 hart 那一份。读 / 清零不加锁，统计值允许有一点误差。
+ */
+static DEFINE_PER_CPU(cpustat_t, s_cpustat);
+
+void
+cpustat_trap(uint32_t cls, uint64_t ticks)
+{
+  if (cls >= CPUSTAT_TRAP_NR) cls = CPUSTAT_TRAP_OTHER;
+
+  cpustat_t *st = &this_cpu(s_cpustat);
+  st->trap_count[cls]++;
+  st->trap_ticks[cls] += ticks;
+  if (ticks > st->trap_max[cls]) st->trap_max[cls] = ticks;
+}
+
+void
+cpustat_softirq(uint32_t nr, uint64_t ticks)
+{
+  if (nr >= CPUSTAT_SOFTIRQ_MAX) return;
+
+  cpustat_t *st = &this_cpu(s_cpustat);
+  st->softirq_count[nr]++;
+  st->softirq_ticks += ticks;
+}
+
+void
+cpustat_work(uint64_t ticks)
+{
+  cpustat_t *st = &this_cpu(s_cpustat);
+  st->work_count++;
+  st->work_ticks += ticks;
+}
+
+void
+cpustat_kworker_wakeup(void)
+{
+  this_cpu(s_cpustat).kworker_wakeups++;
+}
+
+long
+sys_cpustat(struct cpustat_user *ubuf, size_t n, uint32_t flags)
+{
+  if (!ubuf) return -EINVAL;
+
+  if (flags & CPUSTAT_F_BH_INLINE) g_bh_inline = 1;
+  if (flags & CPUSTAT_F_BH_DEFER) g_bh_inline = 0;
+
+  size_t out = 0;
+  for (uint32_t h = 0; h < (uint32_t)MAX_HARTS && out < n; ++h) {
+    if (!g_cpus[h].online) continue;
+
+    const cpustat_t *st = &per_cpu(s_cpustat, h);
+    struct cpustat_user tmp;
+    tmp.hart      = h;
+    tmp.bh_inline = g_bh_inline;
+    for (uint32_t i = 0; i < CPUSTAT_TRAP_NR; ++i) {
+      tmp.trap_count[i] = st->trap_count[i];
+      tmp.trap_ticks[i] = st->trap_ticks[i];
+      tmp.trap_max[i]   = st->trap_max[i];
+    }
+    for (uint32_t i = 0; i < CPUSTAT_SOFTIRQ_MAX; ++i) {
+      tmp.softirq_count[i] = st->softirq_count[i];
+    }
+    tmp.softirq_ticks   = st->softirq_ticks;
+    tmp.work_count      = st->work_count;
+    tmp.work_ticks      = st->work_ticks;
+    tmp.kworker_wakeups = st->kworker_wakeups;
+    ubuf[out++]         = tmp;
+  }
+
+  if (flags & CPUSTAT_F_RESET) {
+    for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+      per_cpu(s_cpustat, h) = (cpustat_t){0};
+    }
+  }
+
+  return (long)out;
+}
@@ -0,0 +1,249 @@
+/* kernel/evfd.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "evfd.h"
+#include "string.h"
+#include "thread.h"
+#include "trap.h"
+#include "uapi.h"
+#include "uerrno.h"
+
+/* 一个阻塞在 read 上的线程 */
+typedef struct evfd_wait {
+  struct evfd_wait *next;
+  evfd_t *ev;         /* NULL = 没在等 */
+  uint64_t *buf;
+  uint32_t slot_seq;
+} evfd_wait_t;
+
+struct evfd {
+  uint32_t kind;      /* 0 = 空闲 */
+  uint32_t flags;     /* EFD_* */
+  uint64_t count;
+  uint64_t deadline;  /* 下次到期（s_now 的值）；0 = 没上膛 */
+  uint64_t period;
+  evfd_wait_t *rq;    /* FIFO */
+  pollq_t pq;
+};
+
+static evfd_t s_evfds[EVFD_MAX];
+static evfd_wait_t s_waits[THREAD_MAX];
+static uint64_t s_now;                /* evfd_tick 次数 */
+static uint64_t s_next = UINT64_MAX;  /* 所有定时器里最早的截止时间 */
+
+static void
+evfd_recalc_next(void)
+{
+  s_next = UINT64_MAX;
+  for (uint32_t i = 0; i < EVFD_MAX; ++i) {
+    if (s_evfds[i].deadline && s_evfds[i].deadline < s_next) {
+      s_next = s_evfds[i].deadline;
+    }
+  }
+}
+
+static evfd_wait_t *
+rq_pop(evfd_t *ev)
+{
+  evfd_wait_t *w = ev->rq;
+  if (w) {
+    ev->rq  = w->next;
+    w->next = NULL;
+    w->ev   = NULL;
+  }
+  return w;
+}
+
+/* 出队的等待者还活着吗（被 kill 的跳过） */
+static int
+wait_live(const evfd_wait_t *w)
+{
+  const Thread *t = &g_threads[w - s_waits];
+  return t->slot_seq.seq == w->slot_seq && t->state != THREAD_ZOMBIE &&
+         t->state != THREAD_UNUSED;
+}
+
+static void
+wait_finish(evfd_wait_t *w, int64_t rc)
+{
+  tid_t tid            = (tid_t)(w - s_waits);
+  g_threads[tid].tf.a0 = (reg_t)rc;
+  thread_wake(tid);
+}
+
+/* 取一次：整个计数，或信号量模式下的 1 */
+static uint64_t
+evfd_take(evfd_t *ev)
+{
+  uint64_t v = (ev->flags & EFD_SEMAPHORE) ? 1u : ev->count;
+  ev->count -= v;
+  return v;
+}
+
+/* 计数变了：先喂阻塞的读者，还有剩的再叫 poll */
+static void
+evfd_deliver(evfd_t *ev)
+{
+  evfd_wait_t *w;
+  while (ev->count > 0 && (w = rq_pop(ev)) != NULL) {
+    if (!wait_live(w)) continue;
+    *w->buf = evfd_take(ev);
+    wait_finish(w, (int64_t)sizeof(uint64_t));
+  }
+  if (ev->count > 0 && pollq_active(&ev->pq)) pollq_wake_locked(&ev->pq);
+}
+
+evfd_t *
+evfd_alloc_locked(uint32_t kind, uint64_t initval, uint32_t flags)
+{
+  for (uint32_t i = 0; i < EVFD_MAX; ++i) {
+    evfd_t *ev = &s_evfds[i];
+    if (ev->kind == 0) {
+      memset(ev, 0, sizeof(*ev));
+      ev->kind  = kind;
+      ev->flags = flags;
+      ev->count = initval;
+      return ev;
+    }
+  }
+  return NULL;
+}
+
+void
+evfd_free_locked(evfd_t *ev)
+{
+  evfd_wait_t *w;
+  while ((w = rq_pop(ev)) != NULL) {
+    if (wait_live(w)) wait_finish(w, -EBADF);
+  }
+  pollq_release_locked(&ev->pq);
+  int armed    = (ev->deadline != 0);
+  ev->kind     = 0;
+  ev->deadline = 0;
+  if (armed) evfd_recalc_next();
+}
+
+uint32_t
+evfd_kind(const evfd_t *ev)
+{
+  return ev->kind;
+}
+
+uint64_t
+evfd_count_locked(const evfd_t *ev)
+{
+  return ev->count;
+}
+
+uint32_t
+evfd_poll_locked(evfd_t *ev, pollq_t **q)
+{
+  *q            = &ev->pq;
+  uint32_t mask = ev->count ? POLLIN : 0;
+  if (ev->kind == EVFD_EVENT && ev->count < EVFD_COUNT_MAX) mask |= POLLOUT;
+  return mask;
+}
+
+void
+evfd_settime_locked(evfd_t *ev, uint64_t first, uint64_t period)
+{
+  /* 重新设置时丢掉还没读的到期次数（和 timerfd_settime 一样） */
+  ev->count    = 0;
+  ev->period   = period;
+  ev->deadline = first ? s_now + first : 0;
+  evfd_recalc_next();
+}
+
+void
+evfd_thread_gone_locked(tid_t tid)
+{
+  if (tid < 0 || tid >= THREAD_MAX) return;
+  evfd_wait_t *w = &s_waits[tid];
+  if (!w->ev) return;
+
+  evfd_wait_t **pp = &w->ev->rq;
+  while (*pp && *pp != w) pp = &(*pp)->next;
+  if (*pp) *pp = w->next;
+  w->next = NULL;
+  w->ev   = NULL;
+}
+
+long
+evfd_read_nonblock_locked(evfd_t *ev, void *buf, uint64_t len)
+{
+  if (len < sizeof(uint64_t) || ((uintptr_t)buf & 7u)) return -EINVAL;
+  if (ev->count == 0) return -EAGAIN;
+  *(uint64_t *)buf = evfd_take(ev);
+  return sizeof(uint64_t);
+}
+
+void
+evfd_read(struct trapframe *tf, evfd_t *ev, void *buf, uint64_t len)
+{
+  long rc = evfd_read_nonblock_locked(ev, buf, len);
+  if (rc != -EAGAIN) {
+    tf->a0 = (reg_t)rc;
+    return;
+  }
+
+  tid_t tid      = thread_current();
+  evfd_wait_t *w = &s_waits[tid];
+  w->ev          = ev;
+  w->buf         = (uint64_t *)buf;
+  w->slot_seq    = g_threads[tid].slot_seq.seq;
+  w->next        = NULL;
+
+  evfd_wait_t **pp = &ev->rq;
+  while (*pp) pp = &(*pp)->next;
+  *pp = w;
+
+  thread_block(tf);  /* evfd_deliver 写 a0 并唤醒 */
+}
+
+long
+evfd_write_locked(evfd_t *ev, const void *buf, uint64_t len)
+{
+  if (ev->kind != EVFD_EVENT || len < sizeof(uint64_t) ||
+      ((uintptr_t)buf & 7u)) {
+    return -EINVAL;
+  }
+  uint64_t v = *(const uint64_t *)buf;
+  if (v > EVFD_COUNT_MAX) return -EINVAL;
+  /* 不会真的加满：满了就让写者自己重试，不阻塞 */
+  if (v > EVFD_COUNT_MAX - ev->count) return -EAGAIN;
+  ev->count += v;
+  if (v) evfd_deliver(ev);
+  return sizeof(uint64_t);
+}
+
+void
+evfd_write(struct trapframe *tf, evfd_t *ev, const void *buf, uint64_t len)
+{
+  tf->a0 = (reg_t)evfd_write_locked(ev, buf, len);
+}
+
+void
+evfd_tick(void)
+{
+  ++s_now;
+  if (s_now < s_next) return;
+
+  for (uint32_t i = 0; i < EVFD_MAX; ++i) {
+    evfd_t *ev = &s_evfds[i];
+    if (!ev->deadline || ev->deadline > s_now) continue;
+
+    if (ev->period == 0) {
+      ev->count++;
+      ev->deadline = 0;
+    } else {
+      /* 从上一次的截止时间往后数，错过几个周期就记几次 */
+      uint64_t n = (s_now - ev->deadline) / ev->period + 1u;
+      ev->count += n;
+      ev->deadline += n * ev->period;
+    }
+    evfd_deliver(ev);
+  }
+  evfd_recalc_next();
+}
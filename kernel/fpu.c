@@ -0,0 +1,137 @@
+/* kernel/fpu.c */
+
+#include <stdint.h>
+
+#include "fpu.h"
+
+#ifdef CONFIG_RISCV_FP
+
+#include "arch.h"
+#include "cpu.h"
+#include "log.h"
+#include "percpu.h"
+#include "platform.h"
+#include "riscv_csr.h"
+#include "riscv_insn.h"
+#include "thread.h"
+#include "trap.h"
+#include "vdso.h"
+
+static int s_fpu_ok;
+
+/* 每个 hart 的 FP 寄存器里现在是谁的状态（-1 = 没有/不可信） */
+static DEFINE_PER_CPU(tid_t, s_fowner);
+
+/* sstatus.FS 是 WARL：没有 F 时写不进去 */
+static int
+fpu_probe_fs(void)
+{
+  reg_t old = csr_read(sstatus);
+  csr_set(sstatus, SSTATUS_FS_INITIAL);
+  int ok = (csr_read(sstatus) & SSTATUS_FS_MASK) != 0;
+  csr_write(sstatus, old);
+  return ok;
+}
+
+void
+fpu_init(void)
+{
+  for (uint32_t h = 0; h < MAX_HARTS; ++h) {
+    per_cpu(s_fowner, h) = -1;
+  }
+
+  int dt_fd = platform_isa_has_ext('f') && platform_isa_has_ext('d');
+  int hw_fd = fpu_probe_fs();
+
+  /* 内核自己不用 FP：关掉，误用会直接非法指令 */
+  csr_clear(sstatus, SSTATUS_FS_MASK);
+
+  pr_info("fpu: DT riscv,isa %s 'fd', sstatus.FS %s", dt_fd ? "has" : "lacks",
+          hw_fd ? "writable" : "hardwired off");
+  if (!dt_fd || !hw_fd) {
+    return;
+  }
+
+  s_fpu_ok = 1;
+  vdso_set_hwcap(VDSO_HWCAP_FD, 0);
+  pr_info("fpu: F/D enabled, lazy context switch");
+}
+
+int
+fpu_available(void)
+{
+  return s_fpu_ok;
+}
+
+int
+fpu_first_use(struct trapframe *tf)
+{
+  if (!s_fpu_ok) return 0;
+  if ((tf->sstatus & SSTATUS_FS_MASK) != SSTATUS_FS_OFF) {
+    return 0;  /* FS 已开仍然非法：真正的非法指令（或向量指令） */
+  }
+  if (!riscv_insn_is_fp(riscv_insn_fetch(tf->sepc))) {
+    return 0;  /* 向量指令交给 vector_first_use，其余照常报错 */
+  }
+
+  cpu_t *c  = cpu_this();
+  tid_t tid = c->current_tid;
+  if (tid < 0 || tid >= THREAD_MAX) return 0;
+  Thread *t = &g_threads[tid];
+
+  /* sret 时 sstatus 从 tf 恢复，这里临时打开只为了操作寄存器 */
+  csr_set(sstatus, SSTATUS_FS_INITIAL);
+
+  reg_t fs = SSTATUS_FS_CLEAN;
+  if (!t->fp_valid) {
+    arch_fp_clear();
+    fs = SSTATUS_FS_INITIAL;
+  } else if (per_cpu(s_fowner, c->hartid) != tid) {
+    arch_fp_restore(&t->fp);
+  }
+
+  csr_clear(sstatus, SSTATUS_FS_MASK);
+
+  /* 其它 hart 上残留的同一线程状态从此作废 */
+  for (uint32_t h = 0; h < MAX_HARTS; ++h) {
+    if (per_cpu(s_fowner, h) == tid) per_cpu(s_fowner, h) = -1;
+  }
+  per_cpu(s_fowner, c->hartid) = tid;
+
+  tf->sstatus = (tf->sstatus & ~SSTATUS_FS_MASK) | fs;
+  return 1;
+}
+
+void
+fpu_switch_out(tid_t tid, struct trapframe *tf)
+{
+  if (!s_fpu_ok || tid < 0 || tid >= THREAD_MAX) return;
+
+  reg_t fs = tf->sstatus & SSTATUS_FS_MASK;
+  if (fs == SSTATUS_FS_OFF) return;
+
+  if (fs == SSTATUS_FS_DIRTY) {
+    /* FS 非 Off 说明这个线程正在本 hart 上用 FP，寄存器就是它的 */
+    Thread *t = &g_threads[tid];
+    csr_set(sstatus, SSTATUS_FS_INITIAL);
+    arch_fp_save(&t->fp);
+    csr_clear(sstatus, SSTATUS_FS_MASK);
+    t->fp_valid = 1;
+  }
+  /* Clean/Initial：没写过，Thread.fp（或“全零”）仍然有效 */
+
+  tf->sstatus = (tf->sstatus & ~SSTATUS_FS_MASK) | SSTATUS_FS_OFF;
+}
+
+void
+fpu_thread_reset(tid_t tid)
+{
+  if (tid < 0 || tid >= THREAD_MAX) return;
+
+  g_threads[tid].fp_valid = 0;
+  for (uint32_t h = 0; h < MAX_HARTS; ++h) {
+    if (per_cpu(s_fowner, h) == tid) per_cpu(s_fowner, h) = -1;
+  }
+}
+
+#endif /* CONFIG_RISCV_FP */
@@ -0,0 +1,120 @@
+/* kernel/futex.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "futex.h"
+#include "thread.h"
+#include "trap.h"
+#include "uapi.h"
+#include "uerrno.h"
+
+/* 一个阻塞在某个地址上的线程 */
+typedef struct futex_wait {
+  struct futex_wait *next;
+  uintptr_t addr;     /* 0 = 不在任何桶里 */
+  uint32_t slot_seq;
+} futex_wait_t;
+
+static futex_wait_t *s_buckets[FUTEX_HASH];
+static futex_wait_t s_waits[THREAD_MAX];
+
+static inline futex_wait_t **
+futex_bucket(uintptr_t addr)
+{
+  /* 低 2 位恒为 0；同一 cache line 里的几个字散到不同桶 */
+  return &s_buckets[(addr >> 2) % FUTEX_HASH];
+}
+
+static void
+futex_unlink(futex_wait_t *w)
+{
+  futex_wait_t **pp = futex_bucket(w->addr);
+  while (*pp && *pp != w) pp = &(*pp)->next;
+  if (*pp) *pp = w->next;
+  w->next = NULL;
+  w->addr = 0;
+}
+
+int
+futex_wait_queue_locked(volatile uint32_t *addr, uint32_t val)
+{
+  /* 值已经变了：用户态重新看一遍，不睡 */
+  if (*addr != val) return -EAGAIN;
+
+  tid_t tid       = thread_current();
+  futex_wait_t *w = &s_waits[tid];
+
+  w->addr     = (uintptr_t)addr;
+  w->slot_seq = g_threads[tid].slot_seq.seq;
+  /* 接在桶尾：同一地址上先来先醒 */
+  futex_wait_t **pp = futex_bucket(w->addr);
+  while (*pp) pp = &(*pp)->next;
+  w->next = NULL;
+  *pp     = w;
+  return 0;
+}
+
+uint32_t
+futex_wake_locked(volatile uint32_t *addr, uint32_t n)
+{
+  uintptr_t key     = (uintptr_t)addr;
+  futex_wait_t **pp = futex_bucket(key);
+  uint32_t woken    = 0;
+
+  while (*pp && woken < n) {
+    futex_wait_t *w = *pp;
+    if (w->addr != key) {
+      pp = &w->next;
+      continue;
+    }
+    *pp     = w->next;
+    w->next = NULL;
+    w->addr = 0;
+
+    /* 已经被 kill 的不算 */
+    tid_t tid       = (tid_t)(w - s_waits);
+    const Thread *t = &g_threads[tid];
+    if (t->slot_seq.seq != w->slot_seq || t->state == THREAD_ZOMBIE ||
+        t->state == THREAD_UNUSED) {
+      continue;
+    }
+    thread_wake(tid);
+    woken++;
+  }
+  return woken;
+}
+
+void
+futex_op(struct trapframe *tf, volatile uint32_t *addr, uint32_t op,
+         uint32_t val)
+{
+  if (!addr || ((uintptr_t)addr & 3u)) {
+    tf->a0 = (reg_t)-EINVAL;
+    return;
+  }
+
+  switch (op) {
+    case FUTEX_WAIT:
+      if (futex_wait_queue_locked(addr, val) < 0) {
+        tf->a0 = (reg_t)-EAGAIN;
+        return;
+      }
+      tf->a0 = 0;
+      thread_block(tf);  /* futex_wake 摘链并唤醒 */
+      return;
+    case FUTEX_WAKE:
+      tf->a0 = futex_wake_locked(addr, val);
+      return;
+    default:
+      tf->a0 = (reg_t)-EINVAL;
+      return;
+  }
+}
+
+void
+futex_thread_gone_locked(tid_t tid)
+{
+  if (tid < 0 || tid >= THREAD_MAX) return;
+  if (s_waits[tid].addr) futex_unlink(&s_waits[tid]);
+}
@@ -0,0 +1,77 @@
+/* kernel/include/bcache.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "blkdev.h"
+#include "sleeplock.h"
+#include "types.h"
+#include "uapi.h"
+
+/*
+ * 块缓存（bcache.c）：按 (dev, blockno) 缓存 BCACHE_BLOCK_SIZE 的块。
+ *
+ *  - 哈希查找；空闲块从 LRU 尾部挑（没人引用、不脏、没 IO 的）。
+ *  - 每个 buf 一把睡眠锁（owner tid）：bread/bgetblk 返回时已持有，brelse 释放。
+ *  - 写回：bdirty 只标脏，后台线程 "bflush" 周期性地（或脏块过多、分配
+ *    等不到空闲块时）把脏块按 (dev, blockno) 排好、plug 住一起下发，相邻块在
+ *    块设备层合并成一个请求。bwrite 是同步写，bsync 写回整个设备再 FLUSH。
+ *  - 预读：同一设备连续读时，把后面 BCACHE_RA_WINDOW 个块提前读进来。
+ *
+ * 都只能在内核线程里调用（可能睡眠），不持 g_kernel_lock。
+ * 用户态通过 SYS_BCACHE_IO 使用，实际执行在 sysworker 线程里。
+ */
+
+#define BCACHE_BLOCK_SIZE    1024u
+#define BCACHE_SECT_PER_BLK  (BCACHE_BLOCK_SIZE / BLK_SECTOR_SIZE)
+#define BCACHE_NBUF          128u
+#define BCACHE_HASH          64u
+#define BCACHE_RA_WINDOW     8u    /* 预读窗口（块） */
+#define BCACHE_FLUSH_BATCH   32u   /* 写回线程一批最多几块 */
+#define BCACHE_DIRTY_HIWAT   (BCACHE_NBUF / 2u)  /* 脏块超过它立刻唤醒 bflush */
+#define BCACHE_FLUSH_PERIOD_TICKS 100u
+#define BCACHE_DIRECT_MAX    128u  /* bcache_read_blocks 一个请求最多几块 */
+
+#define B_VALID (1u << 0)  /* data 是盘上内容（或更新的） */
+#define B_DIRTY (1u << 1)  /* 还没写回 */
+#define B_IO    (1u << 2)  /* 有 IO 在飞 */
+#define B_RA    (1u << 3)  /* 预读进来、还没被读过 */
+
+struct buf {
+  uint32_t dev;
+  uint32_t blockno;
+  uint32_t flags;      /* B_* */
+  uint32_t refcnt;     /* >0 时不会被换出 */
+  tid_t owner;         /* 睡眠锁：持有者，-1 = 空闲 */
+  kwaitq_t waiters;    /* 等 owner / 等 IO 的线程 */
+  struct buf *hnext;
+  struct buf *lru_prev; /* 头 = 最近用过 */
+  struct buf *lru_next;
+  blk_req_t req;
+  int io_status;
+  uint8_t data[BCACHE_BLOCK_SIZE] __attribute__((aligned(64)));
+};
+
+void bcache_init(void);
+
+/* 返回持锁、内容有效的 buf；设备/块号不对或读失败返回 NULL */
+struct buf *bread(uint32_t dev, uint32_t blockno);
+/* 返回持锁的 buf，不读盘（整块覆盖写用）：调用方填完 data 再 bdirty/bwrite */
+struct buf *bgetblk(uint32_t dev, uint32_t blockno);
+void bdirty(struct buf *b);  /* 标脏（延迟写回），同时标 B_VALID */
+int  bwrite(struct buf *b);  /* 同步写回；0 或 -errno */
+void brelse(struct buf *b);
+/* 读 n 个连续块到 dst（大块顺序读）：缓存里有的从缓存拷，其余每段连续块
+ * 直接一个设备请求读进 dst，不占缓存。调用方保证这段时间没人改这些块
+ * （efs：持 inode 锁）。0 或 -errno */
+int  bcache_read_blocks(uint32_t dev, uint32_t blockno, uint32_t n, void *dst);
+/* 写回 dev 的所有脏块并 FLUSH 设备；0 或 -errno */
+int  bsync(uint32_t dev);
+
+/* boot hart 的 timer tick（持 g_kernel_lock）：周期性唤醒 bflush */
+void bcache_tick(void);
+
+struct trapframe;
+/* SYS_BCACHE_IO(dev, op, blockno, buf)：交给 sysworker，结果稍后写 a0 */
+void sys_bcache_io(struct trapframe *tf);
+long sys_cachestat(struct cachestat_user *out, uint32_t flags);
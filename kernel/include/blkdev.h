@@ -0,0 +1,109 @@
+/* kernel/include/blkdev.h */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "uapi.h"
+
+/*
+ * 块设备层（blk.c）：驱动只管把一个 blk_req 变成设备请求，
+ * 排队、合并、限流、唤醒等待者都在这里做。
+ *
+ *  - 请求先进 pending 队列；和队尾方向相同、扇区相接的请求直接挂到队尾请求的
+ *    merge 链上（一个设备请求带多段 buf），最多 dev->max_segs 段。
+ *  - blk_run_queue 在 inflight < max_inflight 时把队头交给 ops->submit，
+ *    一批结束后调一次 ops->kick（一批一次门铃）。
+ *  - plug：blk_plug 期间只排队不下发，blk_unplug 时一起下发，方便合并。
+ *  - FLUSH 是屏障：前面的请求全部完成后才下发，之后的请求不会越过它。
+ *  - 驱动完成时对每个设备请求调 blk_complete，收完一批再 blk_run_queue。
+ *
+ * 除 blk_rw 外都要持 g_kernel_lock。
+ */
+
+#define BLK_MAX_DEVS    4u
+#define BLK_REQ_PENDING 1  /* blk_req.status：还没完成 */
+
+typedef struct blk_req blk_req_t;
+typedef struct blkdev blkdev_t;
+typedef void (*blk_done_t)(blk_req_t *req);
+
+struct blk_req {
+  blk_req_t *next;        /* pending 队列 / 空闲链 */
+  blk_req_t *merge_next;  /* 合并进来的后续段 */
+  blk_req_t *merge_tail;  /* 头请求：merge 链最后一段 */
+  uint32_t op;            /* BLK_OP_* */
+  uint32_t nsect;         /* 本段 */
+  uint64_t sector;
+  void *buf;
+  int status;             /* BLK_REQ_PENDING / 0 / -errno */
+  uint32_t nseg;          /* 头请求：段数（含自己） */
+  uint32_t total_nsect;   /* 头请求：所有段的扇区数 */
+  uint32_t tag;           /* 完成回调自用 */
+  uint64_t submit_tick;
+  blk_done_t done;        /* 完成回调（持锁）；NULL = 不通知 */
+  void *priv;
+};
+
+typedef struct {
+  /* 把头请求（连同 merge 链）交给设备；0，或 -EAGAIN（设备队列满，稍后重试） */
+  int  (*submit)(blkdev_t *dev, blk_req_t *req);
+  void (*kick)(blkdev_t *dev);                               /* 可选 */
+  /* 可选：填驱动自己的计数（kicks/irqs），reset 时顺便清零 */
+  void (*stats)(blkdev_t *dev, struct blkstat_user *out, int reset);
+} blkdev_ops_t;
+
+#define BLKDEV_F_FLUSH (1u << 0)  /* 设备支持 FLUSH；否则 FLUSH 直接成功 */
+
+struct blkdev {
+  const char *name;
+  uint64_t nsectors;
+  uint32_t max_inflight;
+  uint32_t max_segs;
+  uint32_t flags;
+  const blkdev_ops_t *ops;
+  void *priv;
+
+  /* 以下由 blk.c 维护 */
+  blk_req_t *pend_head;
+  blk_req_t *pend_tail;
+  uint32_t inflight;
+  uint32_t plugged;
+
+  uint64_t reqs[BLK_OP_NR];
+  uint64_t sectors[BLK_OP_NR];
+  uint64_t merges;
+  uint64_t hw_reqs;
+  uint64_t dispatch_rounds;
+  uint64_t inflight_peak;
+  uint64_t lat_ticks;
+  uint64_t lat_max;
+};
+
+/* 注册设备，返回编号（SYS_BLK_IO 的 dev）或 -ENOSPC */
+int blk_register(blkdev_t *dev);
+blkdev_t *blk_get(uint32_t devno);
+
+/* 排队一个请求（调用方填 op/sector/nsect/buf/done/priv）；0 或 -EINVAL。
+ * 返回 0 之后 done 一定会被调用（可能就在这次调用里，比如不支持的 FLUSH）。
+ */
+int  blk_submit(blkdev_t *dev, blk_req_t *req);
+void blk_plug(blkdev_t *dev);
+void blk_unplug(blkdev_t *dev);
+void blk_run_queue(blkdev_t *dev);
+
+/* 驱动：一个设备请求（头请求）完成，status = 0 / -errno */
+void blk_complete(blkdev_t *dev, blk_req_t *req, int status);
+
+/* 内核线程用的同步读写：不持锁调用，等完成才返回；0 或 -errno */
+int blk_rw(blkdev_t *dev, uint32_t op, uint64_t sector, uint32_t nsect,
+           void *buf);
+
+/* RAM 盘 ram0（ramdisk.c）：返回设备号；没配置 / 地址不对时返回 -errno */
+int ramdisk_init(void);
+
+struct trapframe;
+/* 返回值由完成回调写 tf->a0；有请求在飞时当前线程阻塞 */
+void sys_blk_io(struct trapframe *tf, uint32_t devno, struct blk_io *iov,
+                uint32_t n);
+long sys_blk_stat(uint32_t devno, struct blkstat_user *out, uint32_t flags);
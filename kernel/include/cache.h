@@ -0,0 +1,10 @@
+/* kernel/include/cache.h */
+#pragma once
+
+/* QEMU virt / 常见 RISC-V 核的 L1 行宽；只用来对齐，不影响正确性 */
+#define CACHELINE_SIZE 64
+
+#define __cacheline_aligned __attribute__((aligned(CACHELINE_SIZE)))
+
+/* 放进 .bss.percpu：链接脚本把它们集中、按 cache line 对齐，和普通全局变量分开 */
+#define __percpu __attribute__((section(".bss.percpu")))
@@ -4,12 +4,17 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "poll.h"
+
 /* 内核和 syscall 用的 console API */
 void console_init(void);
 void console_write(const char *buf, size_t len);
 
 int console_read_nonblock(char *buf, size_t len);
 
+/* poll：有输入就 POLLIN，输出总是就绪；*q = 输入到达时唤醒的队列。持锁 */
+uint32_t console_poll_locked(pollq_t **q);
+
 /* UART IRQ 回调入口：在中断上下文里被调用 */
 void console_on_char_from_irq(uint8_t ch);
 
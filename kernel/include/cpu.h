@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 
+#include "cache.h"
 #include "cpu_defs.h"
 #include "types.h"
 
@@ -34,7 +35,13 @@ struct cpu {
   /* 调度相关（时间片/need_resched） */
   uint32_t need_resched;
   uint32_t slice_left;
-};
+
+  /* trap_entry_c 拿锁时的 sstatus，trap_exit_c 放锁时用 */
+  reg_t trap_irq_state;
+  uint32_t trap_locked;  /* 0 = 本次 trap 走免锁 syscall，trap_exit_c 不放锁 */
+  uint32_t trap_class;   /* CPUSTAT_TRAP_*，trap_exit_c 记关中断时长用 */
+  uint64_t trap_t0;      /* 进 trap_entry_c 的时刻 */
+} __cacheline_aligned;  /* 每个 hart 的计数器每 tick 都写：不能和邻居共行 */
 
 typedef struct cpu cpu_t;
 
@@ -75,3 +82,7 @@ void wait_for_smp_boot_done(void);
 void smp_kick_all_others(void);
 void smp_kick_hart(uint32_t hartid);
 int  smp_wait_hart_online(uint32_t hartid, uint64_t timeout_ticks);
+/* secondary 的 per-hart 初始化做完后置位；boot hart 一次等一组 hart。
+ * 返回 want 里在超时前就绪的那些位 */
+void     smp_set_ready(uint32_t hartid);
+uint64_t smp_wait_harts_ready(uint64_t want, uint64_t timeout_ticks);
@@ -0,0 +1,16 @@
+/* kernel/include/cpustat.h */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "uapi.h"
+
+/* per-hart 关中断 / 下半部统计（cpustat.c），每个 hart 只写自己那一份 */
+
+void cpustat_trap(uint32_t cls, uint64_t ticks);  /* cls: CPUSTAT_TRAP_* */
+void cpustat_softirq(uint32_t nr, uint64_t ticks);
+void cpustat_work(uint64_t ticks);
+void cpustat_kworker_wakeup(void);
+
+long sys_cpustat(struct cpustat_user *ubuf, size_t n, uint32_t flags);
@@ -0,0 +1,11 @@
+/* kernel/include/efs.h */
+#pragma once
+
+/*
+ * efs（efs.c）：extent 布局的小文件系统，盘上格式见 efs_format.h，
+ * 镜像由宿主机上的 tools/mkefs 生成（make fsimg）。
+ * 数据和元数据都经 bcache；整块对齐的大读按 extent 整段直接读。
+ */
+
+/* 在第一个有 efs 超级块的块设备上挂载 "/"（vfs_init 的回调，内核线程里调用） */
+int efs_mount_root(void);
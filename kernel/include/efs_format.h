@@ -0,0 +1,74 @@
+/* kernel/include/efs_format.h */
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * efs 的盘上格式（内核 efs.c 和宿主机工具 tools/mkefs 共用，只依赖 stdint）。
+ *
+ *   block 0                      超级块
+ *   [inode_start, +ninode_blocks) inode 表，每块 8 个 128 字节 inode
+ *   [bitmap_start, +nbitmap_blocks) 块位图（1 = 已用，覆盖整个盘）
+ *   [data_start, nblocks)        数据块
+ *
+ * 文件数据用 extent（起始块 + 块数）描述，最多 EFS_NEXTENT 段：分配时尽量
+ * 接在最后一段后面，大文件通常只有一两段，顺序读可以整段一次读出。
+ * 目录是 efs_dirent 数组（ino == 0 的槽位空闲）。小端，块大小 1 KiB。
+ */
+
+#define EFS_MAGIC      0x31534645u  /* "EFS1" */
+#define EFS_VERSION    1u
+#define EFS_BLOCK_SIZE 1024u
+
+#define EFS_INODE_SIZE       128u
+#define EFS_INODES_PER_BLOCK (EFS_BLOCK_SIZE / EFS_INODE_SIZE)
+#define EFS_NEXTENT          13u
+#define EFS_ROOT_INO         1u  /* 0 号不用 */
+
+#define EFS_NAME_MAX         27u
+#define EFS_DIRENT_SIZE      32u
+#define EFS_DIRENTS_PER_BLOCK (EFS_BLOCK_SIZE / EFS_DIRENT_SIZE)
+
+#define EFS_BITS_PER_BLOCK   (EFS_BLOCK_SIZE * 8u)
+
+#define EFS_T_FREE 0u
+#define EFS_T_FILE 1u
+#define EFS_T_DIR  2u
+
+struct efs_super {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t block_size;
+  uint32_t nblocks;
+  uint32_t ninodes;
+  uint32_t inode_start;
+  uint32_t ninode_blocks;
+  uint32_t bitmap_start;
+  uint32_t nbitmap_blocks;
+  uint32_t data_start;
+  uint32_t root_ino;
+  uint32_t _pad;
+};
+
+struct efs_extent {
+  uint32_t start;  /* 盘上块号 */
+  uint32_t len;    /* 块数；0 = 没用 */
+};
+
+struct efs_dinode {
+  uint16_t type;      /* EFS_T_* */
+  uint16_t nlink;
+  uint32_t nextents;
+  uint64_t size;      /* 字节 */
+  uint64_t mtime;     /* 秒（CLOCK_REALTIME），mkefs 填构建时间 */
+  struct efs_extent ext[EFS_NEXTENT];
+};
+
+struct efs_dirent {
+  uint32_t ino;
+  char name[EFS_NAME_MAX + 1];  /* '\0' 结尾 */
+};
+
+_Static_assert(sizeof(struct efs_dinode) == EFS_INODE_SIZE, "efs inode size");
+_Static_assert(sizeof(struct efs_dirent) == EFS_DIRENT_SIZE, "efs dirent size");
+_Static_assert(sizeof(struct efs_super) <= EFS_BLOCK_SIZE, "efs superblock");
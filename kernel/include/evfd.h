@@ -0,0 +1,48 @@
+/* kernel/include/evfd.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "poll.h"
+#include "types.h"
+
+/*
+ * eventfd / timerfd（evfd.c）：都是“一个 64 位计数 + 阻塞的读者”。
+ *
+ *  - eventfd：write 把 8 字节的值加到计数上；read 取走整个计数并清零
+ *    （EFD_SEMAPHORE：每次取 1）。
+ *  - timerfd：到期一次计数加一，read 取走到期次数。周期定时器按上一次
+ *    的截止时间 + 周期重新上膛，不按“现在 + 周期”，所以处理得慢不会
+ *    累积漂移；错过的周期一次性计进计数里。
+ *  - 时间单位是 tick（同 sleep / poll），由 boot hart 的 evfd_tick 推进。
+ *  - 全部在 trap 侧持 g_kernel_lock 完成；计数为 0 时 read thread_block(tf)，
+ *    计数变非零时交给排在最前面的读者，剩下的再唤醒 poll。
+ */
+
+#define EVFD_MAX 16u
+
+#define EVFD_EVENT 1u
+#define EVFD_TIMER 2u
+
+typedef struct evfd evfd_t;
+
+/* 都持 g_kernel_lock */
+evfd_t  *evfd_alloc_locked(uint32_t kind, uint64_t initval, uint32_t flags);
+void     evfd_free_locked(evfd_t *ev);  /* 它的 file 关了；阻塞的读者拿 -EBADF */
+uint32_t evfd_kind(const evfd_t *ev);
+uint64_t evfd_count_locked(const evfd_t *ev);
+uint32_t evfd_poll_locked(evfd_t *ev, pollq_t **q);
+/* first：第一次到期距现在的 tick，0 = 停止；period：0 = 一次性 */
+void     evfd_settime_locked(evfd_t *ev, uint64_t first, uint64_t period);
+void     evfd_thread_gone_locked(tid_t tid);
+
+struct trapframe;
+/* 结果写 tf->a0（read 可能之后由 evfd_tick / 写者写） */
+void evfd_read(struct trapframe *tf, evfd_t *ev, void *buf, uint64_t len);
+void evfd_write(struct trapframe *tf, evfd_t *ev, const void *buf,
+                uint64_t len);
+/* 持锁、不阻塞（uring 用）：8、-EAGAIN 或 -EINVAL */
+long evfd_read_nonblock_locked(evfd_t *ev, void *buf, uint64_t len);
+long evfd_write_locked(evfd_t *ev, const void *buf, uint64_t len);
+
+void evfd_tick(void);  /* boot hart 的 timer 中断里，持锁 */
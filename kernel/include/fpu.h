@@ -0,0 +1,40 @@
+/* kernel/include/fpu.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+
+struct trapframe;
+
+/*
+ * 浮点惰性上下文切换（RISCV_FP=YES 构建才有，策略同 vector.h）：
+ *  - 线程的 tf->sstatus.FS 初始为 Off，第一条 FP 指令陷入非法指令，
+ *    fpu_first_use() 恢复（或清零）f0-f31/fcsr 后把 FS 置为 Clean/Initial。
+ *  - 切走时只有 FS == Dirty 才保存到 Thread.fp；trap 路径本身从不碰 FP。
+ *  - 每个 hart 记住寄存器里是谁的状态，同一线程回到同一 hart 时省掉恢复。
+ * 默认 rv64ima 构建下全部是空函数。
+ */
+
+#ifdef CONFIG_RISCV_FP
+
+void fpu_init(void);  /* boot hart：探测 + 更新 vdso hwcap */
+int  fpu_available(void);
+
+int  fpu_first_use(struct trapframe *tf);  /* 1 = 已处理，重新执行该指令 */
+void fpu_switch_out(tid_t tid, struct trapframe *tf);
+void fpu_thread_reset(tid_t tid);
+
+#else
+
+static inline void fpu_init(void) {}
+static inline int  fpu_available(void) { return 0; }
+static inline int  fpu_first_use(struct trapframe *tf) { (void)tf; return 0; }
+static inline void fpu_switch_out(tid_t tid, struct trapframe *tf)
+{
+  (void)tid;
+  (void)tf;
+}
+static inline void fpu_thread_reset(tid_t tid) { (void)tid; }
+
+#endif /* CONFIG_RISCV_FP */
@@ -0,0 +1,30 @@
+/* kernel/include/futex.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+
+/*
+ * 按地址等待 / 唤醒（futex.c），给用户态的无锁结构做阻塞兜底。
+ *
+ *  - 没有 MMU，键就是用户地址本身；按地址散列到 FUTEX_HASH 个桶。
+ *  - FUTEX_WAIT 在 g_kernel_lock 下比较 *addr == val 再入队，和持同一把锁
+ *    的 FUTEX_WAKE 之间不会丢唤醒：用户态先改值、再 wake 即可。
+ *  - 等待者是每个 tid 一条记录；被 kill / 回收时摘掉（futex_thread_gone_locked）。
+ */
+
+#define FUTEX_HASH 16u
+
+struct trapframe;
+
+/* 结果写 tf->a0：WAIT 0 / -EAGAIN / -EINVAL；WAKE 唤醒的个数 / -EINVAL */
+void futex_op(struct trapframe *tf, volatile uint32_t *addr, uint32_t op,
+              uint32_t val);
+
+/* futex_op 的两半，持 g_kernel_lock（uring 用；addr 由调用方检查过对齐）：
+ * WAIT 把当前线程挂上去，0 = 已入队，调用方接着 thread_block；-EAGAIN = 值变了 */
+int      futex_wait_queue_locked(volatile uint32_t *addr, uint32_t val);
+uint32_t futex_wake_locked(volatile uint32_t *addr, uint32_t n);
+
+void futex_thread_gone_locked(tid_t tid);  /* 持 g_kernel_lock */
@@ -0,0 +1,31 @@
+/* kernel/include/irq.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "platform.h"
+
+/*
+ * 外部中断的内核侧策略（irq.c）：
+ *  - 亲和性：irq_set_affinity() 把 PLIC 使能改到指定 hart 上（过滤掉不在线的）。
+ *  - 均衡：irq_balance() 按两次调用之间各源的触发次数，把源贪心地分给
+ *    负载最小的 hart（每个源只留一个 hart，避免多个 hart 抢 claim）。
+ *    打开 auto 后 boot hart 每 IRQ_BALANCE_PERIOD_TICKS 个 tick 在 kworker 上做一次。
+ *  - 线程化 handler：request_threaded_irq() 的 handler 在内核线程 "irq/N" 里跑，
+ *    开着中断、可被调度。硬中断里只屏蔽该源并唤醒线程，handler 返回后再解除屏蔽
+ *    （PLIC 电平触发，不屏蔽会一直重入）。
+ * 除 irq_is_threaded 外都要持 g_kernel_lock。
+ */
+
+#define IRQ_BALANCE_PERIOD_TICKS 1000u
+
+int  irq_set_affinity(uint32_t irq, uint32_t hart_mask);  /* 新位图或 -errno */
+int  irq_balance(void);                                   /* 迁移的源个数 */
+void irq_balance_tick(void);                              /* boot hart 的 timer tick */
+
+/* handler 在线程上下文、不持锁被调用；0 或 -errno */
+int  request_threaded_irq(uint32_t irq, irq_handler_t handler, void *arg,
+                          const char *name);
+int  irq_is_threaded(uint32_t irq);
+
+long sys_irq_affinity(uint32_t irq, uint32_t hart_mask, uint32_t op);
@@ -0,0 +1,28 @@
+/* kernel/include/ksyscall.h */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "uapi.h"
+
+struct trapframe;
+
+/* 每个 syscall 的内核入口：参数从 tf->a1.. 取，返回值写 tf->a0。
+ * 阻塞型 syscall 内部会 schedule()，返回值由唤醒方写回。
+ */
+typedef void (*syscall_fn_t)(struct trapframe *tf);
+
+/* SYSCALL_F_NOLOCK：只读共享状态（seqcount / 原子读），不阻塞、不 schedule()，
+ * trap_entry_c 不拿 g_kernel_lock 直接分发。
+ */
+#define SYSCALL_F_NOLOCK (1u << 0)
+
+typedef struct {
+  syscall_fn_t fn;
+  uint32_t flags;
+} syscall_desc_t;
+
+void syscall_handler(struct trapframe *tf);
+int  syscall_is_lockless(uintptr_t nr);
+long sys_sysstat(struct sysstat_user *ubuf, size_t n, uint32_t flags);
@@ -0,0 +1,18 @@
+/* kernel/include/kuring.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "uring.h"
+
+struct trapframe;
+
+/* SYS_RING_SETUP：给当前线程注册 ring（用户内存），返回 0 或 -errno */
+long sys_ring_setup(struct uring *ring, uint32_t entries, uint32_t flags);
+
+/* SYS_RING_ENTER：返回值写 tf->a0（本次完成的 SQE 数）；
+ * 遇到 URING_OP_SLEEP / FUTEX_WAIT、普通文件的 READ/WRITE 时做完这条会阻塞，
+ * 返回后剩下的 SQE 留给下一次。
+ */
+void sys_ring_enter(struct trapframe *tf, uint32_t to_submit,
+                    uint32_t min_complete, uint32_t flags);
@@ -1,8 +1,13 @@
 /* kernel/include/kernel_lock.h */
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "spinlock.h"
 
+struct lockstat_user;
+
 extern spinlock_t g_kernel_lock;
 
 static inline reg_t
@@ -19,6 +24,10 @@ kernel_unlock(reg_t sstatus)
 
 extern spinlock_t g_log_lock;
 
+/* 把锁加进 lockstat 列表（g_kernel_lock / g_log_lock 已在里面）；0 或 -ENOSPC */
+int  lock_register(spinlock_t *lk);
+long sys_lockstat(struct lockstat_user *ubuf, size_t n, uint32_t flags);
+
 /* LOG_LOCK and LOG_UNLOCK hooks in log_config.h provided for log in lib */
 /* #define LOG_LOCK()   spin_lock(&g_log_lock) */
 /* #define LOG_UNLOCK() spin_unlock(&g_log_lock) */
@@ -0,0 +1,24 @@
+/* kernel/include/percpu.h */
+#pragma once
+
+#include "cache.h"
+#include "cpu.h"
+
+/*
+ * 每个 hart 一份的变量。
+ *
+ *   static DEFINE_PER_CPU(tid_t, s_owner);
+ *   per_cpu(s_owner, h) = -1;
+ *   this_cpu(s_owner)   = tid;
+ *
+ * 每个槽单独占（至少）一条 cache line，hart 只写自己的槽，
+ * 不会因为邻居 hart 的写把整行来回抢（false sharing）。
+ * 数组类型先 typedef 再用（DEFINE_PER_CPU(row_t, x)）。
+ */
+#define DEFINE_PER_CPU(type, name)                       \
+  struct percpu_##name {                                 \
+    type v;                                              \
+  } __cacheline_aligned name[MAX_HARTS] __percpu
+
+#define per_cpu(name, hart) (name[(hart)].v)
+#define this_cpu(name)      per_cpu(name, cpu_current_hartid())
@@ -0,0 +1,43 @@
+/* kernel/include/pipe.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "poll.h"
+#include "types.h"
+#include "uapi.h"
+
+/*
+ * 管道（pipe.c）：PIPE_BUF_SIZE 的环形缓冲 + 读 / 写两条等待队列。
+ *
+ *  - 全部在 trap 侧持 g_kernel_lock 完成，不走 sysworker。读不到 / 写不进时
+ *    thread_block(tf)，数据到了由对端把结果写进等待者的 tf.a0 再唤醒。
+ *  - 直接交接：读端已经在等、缓冲又是空的时候，写端把数据直接拷进读端的
+ *    buf，不经过环形缓冲（一次拷贝）；读端取数时也会直接从阻塞的写端
+ *    buf 里拿。没有 MMU，所有线程共用地址空间，对方的 buf 就是普通指针。
+ *  - 等待者是每个 tid 一条记录（同一时刻一个线程只会等一个管道）。
+ *    线程被 kill / 回收时从队列里摘掉（pipe_thread_gone_locked）。
+ *  - poll：两端共用一条 pollq，数据、空间或端点数变了才去唤醒。
+ */
+
+#define PIPE_MAX 8u
+
+typedef struct pipe pipe_t;
+
+/* 都持 g_kernel_lock */
+pipe_t  *pipe_alloc_locked(void);  /* 一个读端 + 一个写端；用完返回 NULL */
+void     pipe_release_locked(pipe_t *p, int writer);
+uint32_t pipe_nbytes_locked(const pipe_t *p);
+void     pipe_thread_gone_locked(tid_t tid);
+/* 读端 / 写端的 POLL* 就绪位；*q = 管道的 poll 队列 */
+uint32_t pipe_poll_locked(pipe_t *p, int writer, pollq_t **q);
+
+struct trapframe;
+/* 结果写 tf->a0（可能在之后由对端写） */
+void pipe_read(struct trapframe *tf, pipe_t *p, void *buf, uint64_t len);
+void pipe_write(struct trapframe *tf, pipe_t *p, const void *buf, uint64_t len);
+/* 持锁、不阻塞（uring 用）：字节数（写可能不足 len）、-EAGAIN 或 -EPIPE */
+long pipe_read_nonblock_locked(pipe_t *p, void *buf, uint64_t len);
+long pipe_write_nonblock_locked(pipe_t *p, const void *buf, uint64_t len);
+
+long sys_pipestat(struct pipestat_user *out, uint32_t flags);
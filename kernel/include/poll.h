@@ -0,0 +1,44 @@
+/* kernel/include/poll.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+#include "uapi.h"
+
+/*
+ * poll（poll.c）：一次等多个 fd 的就绪，可带超时。
+ *
+ *  - 每个可等待的对象（控制台输入、每个管道）带一条 pollq_t。对象状态
+ *    变了调 pollq_wake_locked：只重查挂在这条队列上的 poller，其余线程
+ *    不受打扰；队列空时就是一次判空。
+ *  - 重查用 poller 自己的 fd 表和 pollfd 数组（没有 MMU，直接可访问），
+ *    有就绪的就把个数写进它的 a0 并唤醒；没有就继续挂着。
+ *  - 超时复用 sleep：poller 是 THREAD_SLEEPING + wakeup_tick，a0 预置 0；
+ *    threads_tick 到点唤醒前调 poll_cancel_locked 把它从各队列摘掉。
+ *  - 每个 tid 一条记录，线程回收时同样 poll_cancel_locked。
+ *  - 对象释放前必须 pollq_release_locked，否则挂着的 poller 永远等不到。
+ */
+
+typedef struct poll_entry poll_entry_t;
+
+typedef struct {
+  poll_entry_t *head;
+} pollq_t;
+
+/* 都持 g_kernel_lock */
+void pollq_wake_locked(pollq_t *q);
+/* 带 pollq 的对象释放前调用：还挂着的 poller 对应项报 POLLNVAL 并唤醒 */
+void pollq_release_locked(pollq_t *q);
+void poll_cancel_locked(tid_t tid);
+
+static inline int
+pollq_active(const pollq_t *q)
+{
+  return q->head != NULL;
+}
+
+struct trapframe;
+/* timeout：tick；< 0 一直等，0 只查不等。结果写 tf->a0（可能由唤醒方写） */
+void sys_poll(struct trapframe *tf, struct pollfd_user *fds, uint32_t nfds,
+              int64_t timeout);
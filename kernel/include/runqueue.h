@@ -10,6 +10,7 @@
 void rq_init(uint32_t hartid);
 void rq_init_all(void);
 void rq_push_tail(uint32_t hartid, tid_t tid);
+void rq_push_head(uint32_t hartid, tid_t tid);  /* 插队：下一个 schedule() 就选它 */
 tid_t rq_pop_head(uint32_t hartid);
 uint32_t rq_len(uint32_t hartid);
 
@@ -23,5 +24,13 @@ int rq_remove(uint32_t hartid, tid_t tid);
  */
 int rq_remove_any(tid_t tid);
 
-/* Copy runqueue order into dst (up to max entries); returns length or -1. */
+/* Copy runqueue order into dst (up to max entries); returns length or -1.
+ * rq_snapshot 不拿锁（seqcount 读）：队列一直在变、重试 RQ_SNAPSHOT_TRIES 次
+ * 都没读到一致快照时返回 RQ_SNAPSHOT_BUSY，调用方拿 g_kernel_lock 后改用
+ * rq_snapshot_locked。
+ */
+#define RQ_SNAPSHOT_TRIES 8
+#define RQ_SNAPSHOT_BUSY  (-2)
+
 int rq_snapshot(uint32_t hartid, tid_t *dst, size_t max);
+int rq_snapshot_locked(uint32_t hartid, tid_t *dst, size_t max);
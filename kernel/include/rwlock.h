@@ -0,0 +1,114 @@
+/* kernel/include/rwlock.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "riscv_csr.h"
+#include "spinlock.h"
+
+/*
+ * 读写自旋锁：多个读者并发，写者独占。
+ *
+ *  - cnt > 0：读者个数；cnt == RW_WRITER：写者持有；0：空闲。
+ *  - 写者优先：有写者在等（wwait != 0）时新读者先让路，写者不会饿死。
+ *    代价是同一 hart 上不能嵌套 read_lock（中间插进来的写者会死锁）。
+ *  - 和 spinlock 一样提供 irqsave 版本；trap 里已经关中断的路径用普通版本。
+ *
+ * 适合注册表这类“偶尔改、经常查”的数据。只读一两个字段的场景
+ * 用 seqlock.h 更便宜（读者完全不写共享行）。
+ */
+
+#define RW_WRITER (-1)
+
+typedef struct rwlock {
+  volatile int32_t cnt;
+  volatile uint32_t wwait;  /* 等待中的写者数 */
+  const char *name;
+} rwlock_t;
+
+#define RWLOCK_INIT_NAMED(n) {.cnt = 0, .wwait = 0, .name = (n)}
+#define RWLOCK_INIT          RWLOCK_INIT_NAMED(0)
+
+static inline void
+rwlock_init(rwlock_t *rw, const char *name)
+{
+  rw->cnt   = 0;
+  rw->wwait = 0;
+  rw->name  = name;
+}
+
+static inline void
+read_lock(rwlock_t *rw)
+{
+  for (;;) {
+    while (__atomic_load_n(&rw->wwait, __ATOMIC_RELAXED) ||
+           __atomic_load_n(&rw->cnt, __ATOMIC_RELAXED) < 0) {
+      spin_pause();
+    }
+    int32_t c = __atomic_load_n(&rw->cnt, __ATOMIC_RELAXED);
+    if (c >= 0 && __atomic_compare_exchange_n(&rw->cnt, &c, c + 1, 0,
+                                              __ATOMIC_ACQUIRE,
+                                              __ATOMIC_RELAXED)) {
+      return;
+    }
+  }
+}
+
+static inline void
+read_unlock(rwlock_t *rw)
+{
+  __atomic_fetch_sub(&rw->cnt, 1, __ATOMIC_RELEASE);
+}
+
+static inline void
+write_lock(rwlock_t *rw)
+{
+  __atomic_fetch_add(&rw->wwait, 1u, __ATOMIC_RELAXED);
+  for (;;) {
+    int32_t c = 0;
+    if (__atomic_compare_exchange_n(&rw->cnt, &c, RW_WRITER, 0,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      break;
+    }
+    spin_pause();
+  }
+  __atomic_fetch_sub(&rw->wwait, 1u, __ATOMIC_RELAXED);
+}
+
+static inline void
+write_unlock(rwlock_t *rw)
+{
+  __atomic_store_n(&rw->cnt, 0, __ATOMIC_RELEASE);
+}
+
+static inline reg_t
+read_lock_irqsave(rwlock_t *rw)
+{
+  reg_t sstatus = csr_read(sstatus);
+  csr_clear(sstatus, SSTATUS_SIE);
+  read_lock(rw);
+  return sstatus;
+}
+
+static inline void
+read_unlock_irqrestore(rwlock_t *rw, reg_t sstatus)
+{
+  read_unlock(rw);
+  csr_write(sstatus, sstatus);
+}
+
+static inline reg_t
+write_lock_irqsave(rwlock_t *rw)
+{
+  reg_t sstatus = csr_read(sstatus);
+  csr_clear(sstatus, SSTATUS_SIE);
+  write_lock(rw);
+  return sstatus;
+}
+
+static inline void
+write_unlock_irqrestore(rwlock_t *rw, reg_t sstatus)
+{
+  write_unlock(rw);
+  csr_write(sstatus, sstatus);
+}
@@ -0,0 +1,68 @@
+/* kernel/include/seqlock.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "spinlock.h"
+
+/*
+ * seqcount：读多写少的数据，读者不拿锁。
+ *
+ *  - 写者：write_seqcount_begin → 改数据 → write_seqcount_end。
+ *    seqcount 本身不做写者互斥，写者之间由调用方串行
+ *    （g_kernel_lock 或者只有一个写者）。
+ *  - 读者：
+ *      do {
+ *        s = read_seqcount_begin(&sc);
+ *        ...拷贝数据...
+ *      } while (read_seqcount_retry(&sc, s));
+ *    拷贝过程中数据可能被改得不一致，只能拷贝，不能据此解引用/做决定，
+ *    retry 通过之后才能用。
+ *
+ * 和 vdso_data.seq 是同一套协议（那边字段在 uapi 里，单独实现）。
+ */
+
+typedef struct {
+  volatile uint32_t seq;  /* 奇数 = 写者正在改 */
+} seqcount_t;
+
+#define SEQCNT_INIT {.seq = 0}
+
+static inline void
+seqcount_init(seqcount_t *s)
+{
+  s->seq = 0;
+}
+
+static inline void
+write_seqcount_begin(seqcount_t *s)
+{
+  s->seq = s->seq + 1u;
+  __asm__ volatile("fence w,w" ::: "memory");
+}
+
+static inline void
+write_seqcount_end(seqcount_t *s)
+{
+  __asm__ volatile("fence w,w" ::: "memory");
+  s->seq = s->seq + 1u;
+}
+
+static inline uint32_t
+read_seqcount_begin(const seqcount_t *s)
+{
+  uint32_t v;
+  while ((v = s->seq) & 1u) {
+    spin_pause();
+  }
+  __asm__ volatile("fence r,r" ::: "memory");
+  return v;
+}
+
+/* 返回非 0：拷贝期间有写者，需要重读 */
+static inline int
+read_seqcount_retry(const seqcount_t *s, uint32_t start)
+{
+  __asm__ volatile("fence r,r" ::: "memory");
+  return s->seq != start;
+}
@@ -0,0 +1,37 @@
+/* kernel/include/sleeplock.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "spinlock.h"
+#include "types.h"
+
+/*
+ * 内核线程用的等待队列和睡眠锁（sleeplock.c）。
+ *
+ *  - kwaitq：等待者的 tid 位图。kwait_sleep_locked 持 g_kernel_lock 调用，
+ *    睡一次就回来（可能是假唤醒），调用方循环重查条件。
+ *  - sleeplock：持有期间可以睡（做 IO）。
+ *
+ * 只有不会被 kill 的内核线程（sysworker / bflush）在这里睡，位图里的 tid
+ * 不会换人。用户线程的阻塞走 thread_block(tf)。
+ */
+
+typedef struct {
+  uint64_t mask;
+} kwaitq_t;
+
+typedef struct {
+  tid_t owner;  /* -1 = 空闲 */
+  kwaitq_t wq;
+} sleeplock_t;
+
+#define SLEEPLOCK_INIT {.owner = -1, .wq = {0}}
+
+void kwait_sleep_locked(kwaitq_t *q, reg_t *s);
+void kwait_wake_all(kwaitq_t *q);
+
+void sleeplock_init(sleeplock_t *l);
+void sleep_lock(sleeplock_t *l);    /* 不持 g_kernel_lock 调用 */
+void sleep_unlock(sleeplock_t *l);
+int  sleep_lock_held(const sleeplock_t *l);
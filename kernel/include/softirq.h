@@ -0,0 +1,59 @@
+/* kernel/include/softirq.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+#include "uapi.h"
+
+struct trapframe;
+
+/*
+ * 中断下半部 + per-hart 工作队列（softirq.c）。
+ *
+ *  - 上半部（硬中断）：只做必须马上做的（读空设备 FIFO 等），
+ *    然后 raise_softirq(nr)。
+ *  - 硬中断出口（softirq_irq_exit）：本 hart 有 pending 就唤醒本 hart 的
+ *    kworker（插到 rq 头，立即切过去）。
+ *  - kworker：绑定在各自 hart 上的内核线程，开着中断执行 softirq 处理函数和
+ *    queue_work_on() 排进来的 work。处理函数不持锁被调用，需要碰共享状态时
+ *    自己 kernel_lock()/kernel_unlock()。
+ */
+
+enum {
+  SOFTIRQ_CONSOLE_RX = 0,  /* UART 收到字符：唤醒 stdin 读者 */
+
+  SOFTIRQ_NR
+};
+
+_Static_assert(SOFTIRQ_NR <= CPUSTAT_SOFTIRQ_MAX, "raise CPUSTAT_SOFTIRQ_MAX");
+
+typedef void (*softirq_fn_t)(void);
+
+struct work;
+typedef void (*work_fn_t)(struct work *w);
+
+struct work {
+  struct work *next;
+  work_fn_t fn;
+  uint8_t queued;  /* 已在某个 hart 的队列上 */
+};
+
+#define WORK_INIT(f) {.next = 0, .fn = (f), .queued = 0}
+
+/* 1 = 下半部直接在硬中断里做（旧行为，只用来对比 cpustat），见 CPUSTAT_F_BH_INLINE */
+extern volatile uint32_t g_bh_inline;
+
+void softirq_init(void);  /* boot hart，threads_init 之后：建各 hart 的 kworker */
+void open_softirq(uint32_t nr, softirq_fn_t fn);
+
+/* 硬中断里调用：给本 hart 记一位 pending */
+void raise_softirq(uint32_t nr);
+
+/* trap_entry_c 处理完外部中断后调用（持 g_kernel_lock）；可能 schedule(tf) */
+void softirq_irq_exit(struct trapframe *tf);
+
+/* 把 w 排到 hartid 的 kworker 上；持 g_kernel_lock。1 = 新排上，0 = 已在队列 */
+int queue_work_on(uint32_t hartid, struct work *w);
+
+tid_t softirq_kworker(uint32_t hartid);
@@ -6,24 +6,131 @@
 #include <stdint.h>
 #include "riscv_csr.h"
 
-typedef struct {
-  volatile uint32_t locked;  /* 0 = unlocked, 1 = locked */
+/*
+ * 两种自旋锁，按锁选择（SPINLOCK_INIT_NAMED 的 kind）：
+ *
+ *  - SPIN_TICKET（默认）：next/owner 两个计数器，先到先得（FIFO），
+ *    等待者按前面排了几个人做比例退避，不会饿死。
+ *  - SPIN_MCS：队列锁。每个等待者在自己的节点（per-hart，lock.c）上自旋，
+ *    只有交接时才碰别的 hart 的 cache line；适合 g_kernel_lock 这种争用大的锁。
+ *    需要 tp = cpu*（cpu_init_this_hart 之后才能用），且同一 hart 上的
+ *    MCS 锁必须按 LIFO 顺序释放（最多嵌套 SPIN_MCS_NEST_MAX 层）。
+ *
+ * CONFIG_LOCKSTAT（make LOCKSTAT=YES，Debug 默认打开）时每把锁记录
+ * 获取次数、争用次数、自旋时间和最长持有时间（time CSR tick），
+ * 统计字段只在持锁时修改。
+ */
+
+enum {
+  SPIN_TICKET = 0,
+  SPIN_MCS    = 1,
+};
+
+#define SPIN_MCS_NEST_MAX 4
+
+struct mcs_node;
+
+#ifdef CONFIG_LOCKSTAT
+struct lockstat {
+  uint64_t acquisitions;
+  uint64_t contended;   /* 需要等待的获取次数 */
+  uint64_t spin_ticks;  /* 等待总时长 */
+  uint64_t spin_max;
+  uint64_t hold_max;
+  uint64_t hold_start;  /* 当前持有者拿到锁的时刻 */
+};
+#endif
+
+typedef struct spinlock {
+  /* ticket */
+  volatile uint32_t next;   /* 下一个要发的号 */
+  volatile uint32_t owner;  /* 正在服务的号 */
+
+  /* MCS */
+  struct mcs_node *volatile tail;
+  struct mcs_node *holder;  /* 持有者的节点，unlock 用 */
+
+  uint32_t kind;            /* SPIN_TICKET / SPIN_MCS */
+  const char *name;         /* lockstat 显示用；NULL = 匿名 */
+
+#ifdef CONFIG_LOCKSTAT
+  struct lockstat stat;
+#endif
 } spinlock_t;
 
-#define SPINLOCK_INIT {.locked = 0}
+#define SPINLOCK_INIT_NAMED(n, k) {.next = 0, .owner = 0, .tail = 0, .holder = 0, .kind = (k), .name = (n)}
+#define SPINLOCK_INIT             SPINLOCK_INIT_NAMED(0, SPIN_TICKET)
+
+/* lock.c */
+int  mcs_lock(spinlock_t *lk);   /* 返回 1 = 有争用 */
+void mcs_unlock(spinlock_t *lk);
+
+static inline void spinlock_init_named(spinlock_t *lk, const char *name,
+                                       uint32_t kind) {
+  lk->next   = 0;
+  lk->owner  = 0;
+  lk->tail   = 0;
+  lk->holder = 0;
+  lk->kind   = kind;
+  lk->name   = name;
+#ifdef CONFIG_LOCKSTAT
+  lk->stat = (struct lockstat){0};
+#endif
+}
 
 static inline void spinlock_init(spinlock_t *lk) {
-  lk->locked = 0;
+  spinlock_init_named(lk, 0, SPIN_TICKET);
 }
 
-static inline void spin_lock(spinlock_t *lk) {
-  uint32_t tmp;
+/* Zihintpause 的 pause（没有该扩展的核上就是一条无害的 fence 提示） */
+static inline void spin_pause(void) {
+  __asm__ volatile(".4byte 0x0100000f" ::: "memory");
+}
+
+static inline uint64_t spin_now(void) {
+  uint64_t t;
+  __asm__ volatile("rdtime %0" : "=r"(t));
+  return t;
+}
+
+static inline int ticket_lock(spinlock_t *lk) {
+  uint32_t me = __atomic_fetch_add(&lk->next, 1u, __ATOMIC_RELAXED);
+  uint32_t cur = __atomic_load_n(&lk->owner, __ATOMIC_ACQUIRE);
+  if (cur == me) return 0;
+
   do {
-    __asm__ volatile("amoswap.w.aq %0, %2, %1\n"
-                     : "=r"(tmp), "+A"(lk->locked)
-                     : "r"(1)
-                     : "memory");
-  } while (tmp != 0);
+    /* 前面每多一个人就多等一会儿，减少对 owner 那一行的轮询 */
+    for (uint32_t n = (me - cur) * 8u; n; --n) {
+      spin_pause();
+    }
+    cur = __atomic_load_n(&lk->owner, __ATOMIC_ACQUIRE);
+  } while (cur != me);
+  return 1;
+}
+
+static inline void ticket_unlock(spinlock_t *lk) {
+  /* 只有持有者写 owner */
+  __atomic_store_n(&lk->owner, lk->owner + 1u, __ATOMIC_RELEASE);
+}
+
+static inline void spin_lock(spinlock_t *lk) {
+#ifdef CONFIG_LOCKSTAT
+  uint64_t t0 = spin_now();
+#endif
+  int contended = (lk->kind == SPIN_MCS) ? mcs_lock(lk) : ticket_lock(lk);
+#ifdef CONFIG_LOCKSTAT
+  uint64_t t1 = spin_now();
+  lk->stat.acquisitions++;
+  if (contended) {
+    uint64_t spin = t1 - t0;
+    lk->stat.contended++;
+    lk->stat.spin_ticks += spin;
+    if (spin > lk->stat.spin_max) lk->stat.spin_max = spin;
+  }
+  lk->stat.hold_start = t1;
+#else
+  (void)contended;
+#endif
 }
 
 static inline reg_t spin_lock_irqsave(spinlock_t *lk) {
@@ -34,7 +141,15 @@ static inline reg_t spin_lock_irqsave(spinlock_t *lk) {
 }
 
 static inline void spin_unlock(spinlock_t *lk) {
-  __asm__ volatile("amoswap.w.rl x0, x0, %0\n" : "+A"(lk->locked) : : "memory");
+#ifdef CONFIG_LOCKSTAT
+  uint64_t hold = spin_now() - lk->stat.hold_start;
+  if (hold > lk->stat.hold_max) lk->stat.hold_max = hold;
+#endif
+  if (lk->kind == SPIN_MCS) {
+    mcs_unlock(lk);
+  } else {
+    ticket_unlock(lk);
+  }
 }
 
 static inline void spin_unlock_irqrestore(spinlock_t *lk, reg_t sstatus) {
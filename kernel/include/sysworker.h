@@ -0,0 +1,28 @@
+/* kernel/include/sysworker.h */
+#pragma once
+
+#include <stdint.h>
+
+struct trapframe;
+
+/*
+ * 系统调用里要“睡着等”的慢路径（buffer cache 读盘、等 buffer 锁）不能在 trap
+ * 里直接阻塞：syscall 路径只能 thread_block(tf) 之后返回。sysworker 把这类
+ * 函数交给几个内核线程去跑：
+ *
+ *   sysworker_call(tf, fn, a1..a4)
+ *                            持 g_kernel_lock；记下参数，调用者 thread_block
+ *   worker                   不持锁执行 fn(a1..a4)（可以 blk_rw / 睡眠锁）
+ *                            完成后把返回值写进调用者的 tf.a0 并 thread_wake
+ *
+ * 调用者在等待期间被 kill / 回收时（slot_seq 变了）结果直接丢掉。
+ */
+
+typedef long (*sysworker_fn_t)(uint64_t a1, uint64_t a2, uint64_t a3,
+                               uint64_t a4);
+
+void sysworker_init(void);  /* boot hart，threads_init 之后 */
+/* 参数通常就是 tf->a1..a4，也可以是 syscall 里已经查好的内核对象（带引用）。
+ * 0 = 已交给 worker；<0 = 没排上（已写 tf->a0），调用方自己放掉引用。 */
+int sysworker_call(struct trapframe *tf, sysworker_fn_t fn, uint64_t a1,
+                    uint64_t a2, uint64_t a3, uint64_t a4);
@@ -4,6 +4,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "arch.h"
+#include "cache.h"
+#include "seqlock.h"
 #include "trap.h"
 #include "uthread.h"
 
@@ -26,25 +29,31 @@
  *   - RUNNABLE 当且仅当 on_rq == 1。
  *   - RUNNING 表示当前持有 CPU，on_rq == 0。
  *   - idle 线程永不入 rq。
+ *
+ * 布局：调度器每次入队/切换都要碰的字段放在最前面、同一条 cache line；
+ * 288 字节的 trapframe 和其它冷字段放后面。整个结构按 cache line 对齐，
+ * 不同线程的热字段不会共行。
  */
 typedef struct Thread {
+  /* --- hot: scheduler / runqueue --- */
   tid_t        id;
   ThreadState  state;
-  uint64_t wakeup_tick; /* SLEEPING 时的唤醒 tick（绝对时间） */
+  tid_t        rq_next;       /* 单向链表 next */
+  uint8_t      on_rq;         /* 是否在某个 runqueue 上 */
+  ThreadState  pending_state; /* 内核线程自阻塞：下一次 schedule() 时进入的状态（THREAD_UNUSED = 无） */
+  int32_t      running_hart;  /* -1 not running; >=0 running on that hart */
+  int32_t      last_hart;     /* -1 never ran;  >=0 last hart it ran on */
+  uint32_t     migrations;    /* number of migrations */
+  uint64_t     runs;          /* number of times scheduled RUNNING */
+  uint64_t     wakeup_tick;   /* SLEEPING 时的唤醒 tick（绝对时间） */
+
+  /* --- cold --- */
   const char *name;
+  seqcount_t slot_seq;  /* 建/回收线程时 +2：免锁的 thread_list 据此判断身份字段一致 */
   int is_user; /* 0 = S 模式线程; 1 = U 模式线程（可选字段）*/
   int can_be_killed;
   int detached; /* 1 = detached, auto-recycle on exit/kill */
-
-  /* --- SMP debug/metrics --- */
-  int32_t  running_hart;   /* -1 not running; >=0 running on that hart */
-  int32_t  last_hart;      /* -1 never ran;  >=0 last hart it ran on */
-  uint32_t migrations;     /* number of migrations */
-  uint64_t runs;           /* number of times scheduled RUNNING */
-
-  /* runqueue metadata */
-  tid_t    rq_next;    /* 单向链表 next */
-  uint8_t  on_rq;      /* 是否在某个 runqueue 上 */
+  int32_t bound_hart; /* -1 = 可迁移；>=0 只在该 hart 上跑（per-hart kworker） */
 
   struct trapframe tf; /* 保存的寄存器上下文 */
 
@@ -60,7 +69,23 @@ typedef struct Thread {
   uintptr_t pending_read_buf; /* 用户传来的 buf 指针 */
   uint64_t pending_read_len;  /* 用户传来的 len      */
 
-} Thread;
+  /* SYS_RING_SETUP 注册的 SQ/CQ ring（用户内存） */
+  struct uring *ring;
+  uint32_t ring_flags;
+
+  /* fd 表（vfs.c）：同一线程组共用；内核线程为 NULL */
+  struct files *files;
+
+#ifdef CONFIG_RISCV_FP
+  /* 惰性 FP 上下文（fpu.c）：fp_valid = fp 里存着该线程的寄存器 */
+  struct arch_fpstate fp;
+  uint8_t fp_valid;
+#endif
+
+} __cacheline_aligned Thread;
+
+_Static_assert(offsetof(Thread, name) <= CACHELINE_SIZE,
+               "Thread hot fields must fit in one cache line");
 
 /* -------------------------------------------------------------------------- */
 /* Core thread API                                                            */
@@ -76,6 +101,9 @@ void threads_init(thread_entry_t user_main);
 void cpu_enter_idle(uint32_t hartid) __attribute__((noreturn));
 
 tid_t thread_create_kern(thread_entry_t entry, void *arg, const char *name);
+/* 绑定在 hartid 上的内核线程（永不迁移） */
+tid_t thread_create_kern_on(uint32_t hartid, thread_entry_t entry, void *arg,
+                            const char *name);
 
 void threads_tick(void);
 
@@ -83,6 +111,21 @@ struct trapframe *schedule(struct trapframe *tf);
 
 void thread_block(struct trapframe *tf);
 void thread_wake(tid_t tid);
+/* 提前结束 thread_sys_sleep（poll 的超时等待）；不在 SLEEPING 就什么都不做 */
+void thread_wake_sleeping(tid_t tid);
+
+/* 内核线程（S-mode，不能 ecall）的让出/阻塞：
+ *  - 都是给自己发 SSIP，在调用方释放 g_kernel_lock、SIE 恢复后立刻陷入并 schedule()。
+ *  - *_locked 必须持有 g_kernel_lock 调用；在锁释放到陷入之间的 thread_wake()
+ *    会取消这次阻塞，不会丢唤醒。
+ */
+void thread_kern_yield(void);
+void thread_kern_block_locked(void);
+
+/* 中断下半部用：唤醒绑定在本 hart 的内核线程，插到 rq 头并立即 schedule(tf)。
+ * 持 g_kernel_lock，tf 是本次 trap 的 tf。
+ */
+void thread_kern_wake_local(tid_t tid, struct trapframe *tf);
 
 /* -------------------------------------------------------------------------- */
 /* Sleeping / syscalls                                                        */
@@ -115,6 +158,9 @@ void thread_sys_join(struct trapframe *tf, tid_t target_tid,
 
 void thread_sys_create(struct trapframe *tf, thread_entry_t entry, void *arg,
                        const char *name);
+/* 同 thread_sys_create，但新线程用新的 fd 表（0/1/2 见 uapi.h SYS_THREAD_SPAWN） */
+void thread_sys_spawn(struct trapframe *tf, thread_entry_t entry, void *arg,
+                      const char *name, const int *stdio);
 int thread_sys_list(struct u_thread_info *ubuf, int max);
 void thread_sys_kill(struct trapframe *tf, tid_t target_tid);
 /* Mark thread as detached; detached threads auto-recycle, cannot be joined. */
@@ -0,0 +1,23 @@
+/* kernel/include/tmpfs.h */
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * tmpfs（tmpfs.c）：挂在 /tmp 的内存文件系统。
+ *
+ *  - 文件内容放在 4 KiB 页里，页来自 tmpfs 自己的页池：内核镜像
+ *    （__image_end）之后的 CONFIG_TMPFS_SIZE_MB，按需切，不走 bcache。
+ *  - 每个文件一棵基数树（每层 512 路，节点本身也是一页），高度按文件大小
+ *    增长；0 层时根直接就是第 0 页，小文件只占一页。没写过的页读出来是 0。
+ *  - 读写整页整页地拷；只有写不满一页的新页才需要先清零。
+ *  - 目录树和页池持 g_kernel_lock；文件内容由每个节点的 sleeplock 保护，
+ *    拷贝时不持大锁。
+ */
+
+#define TMPFS_PAGE_SIZE  4096u
+#define TMPFS_PAGE_SHIFT 12u
+#define TMPFS_MAX_NODES  64u   /* 文件 + 目录（含根），不回收 */
+
+/* 切页池、建根目录并挂到 /tmp；0 或 -errno（没配置页池时 -ENODEV） */
+int tmpfs_init(void);
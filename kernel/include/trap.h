@@ -53,7 +53,13 @@ _Static_assert(offsetof(struct trapframe, stval) == 272, "tf offset mismatch");
 _Static_assert(sizeof(struct trapframe) == 288, "tf size mismatch");
 
 void trap_init(void);
+/* trap.S 调用：trap_entry_c 返回 next tf 时仍持有 g_kernel_lock，
+ * trap.S 搬完 s0..s11（见 trap.S 惰性保存）后再调 trap_exit_c 放锁。
+ * SYSCALL_F_NOLOCK 的 syscall 整个 trap 都不拿锁（cpu_t.trap_locked = 0）。
+ * 中断和 U-mode ecall 期间 tf->s0..s11 不是最新值，C 代码不要读写当前线程的它们。
+ */
 struct trapframe *trap_entry_c(struct trapframe *tf);
+void trap_exit_c(void);
 
 /* Illegal-instruction probe helpers (used for bring-up diagnostics).
  *
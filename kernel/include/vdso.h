@@ -0,0 +1,15 @@
+/* kernel/include/vdso.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "uvdso.h"
+
+/* 内核侧可写视图；用户态通过 __vdso_data 只读访问同一块内存 */
+extern struct vdso_data g_vdso_data;
+
+void vdso_init(uint32_t timebase_hz, uint64_t base_ticks, uint64_t base_real_ns,
+               uint64_t boot_real_ns);
+void vdso_hart_online(uint32_t hartid);
+void vdso_set_hwcap(uint64_t hwcap, uint32_t vlenb);
+void vdso_set_thread_stacks(uintptr_t base, uint32_t stride, uint32_t n);
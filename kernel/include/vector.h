@@ -0,0 +1,27 @@
+/* kernel/include/vector.h */
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+
+struct trapframe;
+
+/*
+ * RVV 惰性上下文切换：
+ *  - 每个线程的 tf->sstatus.VS 初始为 Off，第一条向量指令陷入非法指令，
+ *    vector_first_use() 恢复（或清零）寄存器后把 VS 置为 Clean/Initial 重新执行。
+ *  - 切走时只有 VS == Dirty 才保存，然后 VS 置回 Off；从不用向量的线程没有任何开销。
+ *  - 每个 hart 记住寄存器里是谁的状态（owner），同一线程回到同一 hart 时省掉恢复。
+ *  - 内核自己不用向量指令。
+ */
+
+#define VECTOR_VLENB_MAX 32u  /* 支持到 VLEN=256；更长的硬件当作没有 V */
+
+void vector_init(void);  /* boot hart：探测 + 更新 vdso hwcap */
+int  vector_available(void);
+uint32_t vector_vlenb(void);
+
+int  vector_first_use(struct trapframe *tf);  /* 1 = 已处理，重新执行该指令 */
+void vector_switch_out(tid_t tid, struct trapframe *tf);
+void vector_thread_reset(tid_t tid);
@@ -0,0 +1,124 @@
+/* kernel/include/vfs.h */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "poll.h"
+#include "types.h"
+#include "uapi.h"
+
+/*
+ * VFS（vfs.c）：挂载表、路径查找、file 对象和 fd 表。
+ *
+ *  - 文件系统提供 vnode + vnode_ops。vnode 的引用计数由 VFS 管（持
+ *    g_kernel_lock），减到 0 时调 ops->release（持锁，不能睡）。
+ *  - lookup/create/read/write/truncate/readdir 可能睡（读盘），只在内核线程里调：
+ *    用户 syscall 经 sysworker 执行。stat 不睡。
+ *  - fd 表按线程组共享：用户线程 thread_create 出来的线程和创建者共用一张，
+ *    最后一个线程回收时关掉所有 fd。
+ *  - 控制台（0/1/2）是 FILE_CONSOLE，读写仍走 sysfile.c 原来的路径。
+ *  - 管道（pipe.c）是 FILE_PIPE，不睡，读写直接在 trap 侧做。
+ *  - eventfd / timerfd 是 FILE_EVFD，和管道一样在 trap 侧读写。
+ *  - poll（poll.c）通过 vfs_poll_locked 问每个 fd 的就绪状态和等待队列。
+ *  - thread_spawn 建新线程组：新表只带 0/1/2（shell 管道线用它接 stdin/stdout）。
+ *  - 根文件系统在第一次路径查找时由 vfs_init 传进来的回调挂载
+ *    （那时已经在内核线程里，可以读盘）。
+ */
+
+#define VFS_MAX_MOUNTS 4u
+#define VFS_FILE_MAX   64u            /* 全局 file 对象 */
+#define VFS_FILES_MAX  16u            /* fd 表（线程组）个数 */
+#define VFS_OFF_APPEND UINT64_MAX     /* write 的 *off：写到文件尾 */
+
+typedef struct vnode vnode_t;
+
+typedef struct {
+  /* 在目录 dir 里找 / 建 name（不含 '/'，len 字节）；*out 带一个引用 */
+  int  (*lookup)(vnode_t *dir, const char *name, size_t len, vnode_t **out);
+  int  (*create)(vnode_t *dir, const char *name, size_t len, vnode_t **out);
+  /* 从 *off 读写，成功后 *off 前进；返回字节数或 -errno */
+  long (*read)(vnode_t *vn, uint64_t *off, void *buf, uint64_t len);
+  long (*write)(vnode_t *vn, uint64_t *off, const void *buf, uint64_t len);
+  int  (*truncate)(vnode_t *vn);  /* 截成 0 */
+  void (*stat)(vnode_t *vn, struct stat_user *st);
+  /* 目录：从游标 *off（文件系统自己定义）起最多填 n 项，*off 前进；项数或 -errno */
+  long (*readdir)(vnode_t *dir, uint64_t *off, struct dirent_user *out,
+                  uint32_t n);
+  void (*release)(vnode_t *vn);   /* 可选 */
+} vnode_ops_t;
+
+struct vnode {
+  const vnode_ops_t *ops;
+  uint32_t refcnt;
+  uint32_t type;  /* STAT_T_FILE / STAT_T_DIR */
+};
+
+enum {
+  FILE_NONE    = 0,
+  FILE_CONSOLE = 1,
+  FILE_VNODE   = 2,
+  FILE_PIPE    = 3,  /* flags 的 O_RDONLY / O_WRONLY 区分读端 / 写端 */
+  FILE_EVFD    = 4,  /* eventfd / timerfd（evfd.c） */
+};
+
+struct pipe;
+struct evfd;
+
+typedef struct file {
+  uint32_t type;    /* FILE_* */
+  uint32_t refcnt;  /* fd 表里的槽位 + 在飞的 syscall */
+  uint32_t flags;   /* O_* */
+  uint64_t off;
+  vnode_t *vn;
+  struct pipe *pipe;
+  struct evfd *ev;
+} file_t;
+
+typedef struct files {
+  uint32_t refcnt;  /* 共用这张表的线程 */
+  file_t *fd[OPEN_MAX];
+} files_t;
+
+void vfs_init(int (*mount_root)(void));
+/* 把 root 挂到 path（"/" 或 "/tmp" 这样的一级目录），接管 root 的一个引用 */
+int  vfs_mount(const char *path, vnode_t *root);
+
+void vnode_get_locked(vnode_t *vn);
+void vnode_put_locked(vnode_t *vn);
+void vnode_put(vnode_t *vn);
+
+/* fd 表；都持 g_kernel_lock 调用 */
+files_t *files_new_console(void);  /* 0/1/2 = 控制台；表用完返回 NULL */
+/* 新线程组的表：0/1/2 = from 里的 stdio[0..2]（-1 / stdio 为 NULL 时用
+ * from 自己的 0/1/2），别的 fd 不继承。-EBADF / -ENFILE */
+int      files_new_stdio(files_t *from, const int *stdio, files_t **out);
+files_t *files_get(files_t *fs);
+void     files_put(files_t *fs);
+/* fs 里 fd 的就绪位（POLL*，含 POLLNVAL）；*q = 状态变化时会唤醒的队列，
+ * 可能为 NULL（普通文件总是就绪） */
+uint32_t vfs_poll_locked(files_t *fs, int fd, pollq_t **q);
+
+/* 持锁、不阻塞的 read/write（uring 用），fd 在 fs 里查。控制台 / 管道 / evfd
+ * 直接做完，返回字节数或 -errno（没数据 / 没空间是 -EAGAIN）；普通文件要读盘：
+ * 返回 0，*slow 带回 file 的一个引用，调用方不持锁再调 vfs_file_rw */
+long vfs_rw_nonblock_locked(files_t *fs, int fd, void *buf, uint64_t len,
+                            int write, file_t **slow);
+/* 不持锁、可能睡：从 f->off 读写普通文件，放掉 f 的一个引用；字节数或 -errno */
+long vfs_file_rw(file_t *f, void *buf, uint64_t len, int write);
+void file_put_locked(file_t *f);
+
+struct trapframe;
+/* read/write：控制台照旧（stdin 可能阻塞），文件交给 sysworker；结果写 tf->a0 */
+void sys_fd_read(struct trapframe *tf, int fd, void *buf, uint64_t len);
+void sys_fd_write(struct trapframe *tf, int fd, const void *buf, uint64_t len);
+void sys_open(struct trapframe *tf, const char *path, uint32_t flags);
+long sys_close(int fd);
+long sys_lseek(int fd, int64_t off, int whence);
+long sys_fstat(int fd, struct stat_user *st);
+void sys_getdents(struct trapframe *tf, int fd, struct dirent_user *ents,
+                  uint32_t n);
+long sys_pipe(int *fds);
+long sys_eventfd(uint64_t initval, uint32_t flags);
+long sys_timerfd_create(void);
+long sys_timerfd_settime(int fd, uint64_t first, uint64_t period);
@@ -0,0 +1,241 @@
+/* kernel/irq.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpu.h"
+#include "irq.h"
+#include "lock.h"
+#include "log.h"
+#include "platform.h"
+#include "softirq.h"
+#include "thread.h"
+#include "uapi.h"
+#include "uerrno.h"
+
+/* -------------------------------------------------------------------------- */
+/* Affinity / balancing                                                       */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t
+irq_online_mask(void)
+{
+  uint32_t mask = 0;
+  for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+    if (g_cpus[h].online) mask |= 1u << h;
+  }
+  return mask;
+}
+
+int
+irq_set_affinity(uint32_t irq, uint32_t hart_mask)
+{
+  if (!platform_irq_registered(irq)) return -EINVAL;
+
+  hart_mask &= irq_online_mask();
+  if (hart_mask == 0) return -EINVAL;
+
+  platform_irq_set_affinity(irq, hart_mask);
+  return (int)hart_mask;
+}
+
+typedef struct {
+  uint32_t irq;
+  uint64_t rate;  /* 上次 balance 以来的触发次数 */
+} irq_load_t;
+
+/* 只在持锁时用；放 static 里省内核栈 */
+static uint64_t s_balance_last[IRQSTAT_MAX_IRQ];
+static irq_load_t s_balance_src[IRQSTAT_MAX_IRQ];
+
+int
+irq_balance(void)
+{
+  const uint32_t online = irq_online_mask();
+  uint32_t nsrc         = 0;
+  uint32_t max_irq      = platform_irq_max();
+  if (max_irq > IRQSTAT_MAX_IRQ) max_irq = IRQSTAT_MAX_IRQ;
+
+  for (uint32_t irq = 1; irq < max_irq; ++irq) {
+    if (!platform_irq_registered(irq)) continue;
+
+    platform_irq_stat_t st;
+    platform_irq_get_stat(irq, &st);
+
+    /* 插入排序（源很少），按 rate 从大到小 */
+    irq_load_t cur = {.irq = irq, .rate = st.count - s_balance_last[irq]};
+    s_balance_last[irq] = st.count;
+
+    uint32_t i = nsrc++;
+    while (i > 0 && s_balance_src[i - 1].rate < cur.rate) {
+      s_balance_src[i] = s_balance_src[i - 1];
+      --i;
+    }
+    s_balance_src[i] = cur;
+  }
+
+  /* LPT：最忙的源先挑，每次给当前负载最小的 hart；
+   * 负载一样时留在原 hart 上，避免没有必要的搬迁。
+   */
+  uint64_t load[MAX_HARTS] = {0};
+  int moved                = 0;
+
+  for (uint32_t i = 0; i < nsrc; ++i) {
+    const irq_load_t *src = &s_balance_src[i];
+    uint32_t old_mask     = platform_irq_get_affinity(src->irq);
+    int best              = -1;
+
+    for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+      if (!(online & (1u << h))) continue;
+      if (best < 0 || load[h] < load[best] ||
+          (load[h] == load[best] && (old_mask & (1u << h)))) {
+        best = (int)h;
+      }
+    }
+    if (best < 0) break;
+
+    load[best] += src->rate + 1u;  /* +1：空闲的源也摊开 */
+    uint32_t new_mask = 1u << best;
+    if (new_mask != old_mask) {
+      platform_irq_set_affinity(src->irq, new_mask);
+      moved++;
+    }
+  }
+
+  return moved;
+}
+
+static volatile uint32_t s_balance_auto;
+static uint32_t s_balance_ticks;
+
+static void
+irq_balance_work_fn(struct work *w)
+{
+  (void)w;
+  reg_t s   = kernel_lock();
+  int moved = irq_balance();
+  kernel_unlock(s);
+  if (moved > 0) {
+    pr_debug("irq_balance: moved %d source(s)", moved);
+  }
+}
+
+static struct work s_balance_work = WORK_INIT(irq_balance_work_fn);
+
+void
+irq_balance_tick(void)
+{
+  if (!s_balance_auto) return;
+  if (++s_balance_ticks < IRQ_BALANCE_PERIOD_TICKS) return;
+
+  s_balance_ticks = 0;
+  queue_work_on(cpu_current_hartid(), &s_balance_work);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Threaded handlers                                                          */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  irq_handler_t handler;
+  void *arg;
+  tid_t tid;
+  volatile uint32_t pending;
+  char tname[16];  /* "irq/N" */
+} irq_thread_t;
+
+static irq_thread_t s_irq_threads[IRQSTAT_MAX_IRQ];
+
+int
+irq_is_threaded(uint32_t irq)
+{
+  return irq < IRQSTAT_MAX_IRQ && s_irq_threads[irq].handler != NULL;
+}
+
+/* 硬中断：屏蔽源，交给线程 */
+static void
+irq_thread_top(uint32_t irq, void *arg)
+{
+  irq_thread_t *d = (irq_thread_t *)arg;
+  platform_irq_mask(irq);
+  d->pending = 1;
+  thread_wake(d->tid);
+}
+
+static void __attribute__((noreturn))
+irq_thread_main(void *arg)
+{
+  const uint32_t irq = (uint32_t)(uintptr_t)arg;
+  irq_thread_t *d    = &s_irq_threads[irq];
+
+  for (;;) {
+    reg_t s = kernel_lock();
+    if (!d->pending) {
+      thread_kern_block_locked();
+      kernel_unlock(s);
+      continue;
+    }
+    d->pending = 0;
+    kernel_unlock(s);
+
+    d->handler(irq, d->arg);  /* 开中断、不持锁 */
+
+    s = kernel_lock();
+    platform_irq_unmask(irq);
+    kernel_unlock(s);
+  }
+}
+
+int
+request_threaded_irq(uint32_t irq, irq_handler_t handler, void *arg,
+                     const char *name)
+{
+  if (irq == 0 || irq >= IRQSTAT_MAX_IRQ || !handler) return -EINVAL;
+
+  irq_thread_t *d = &s_irq_threads[irq];
+  if (d->handler) return -EBUSY;
+
+  /* "irq/N" */
+  const char *prefix = "irq/";
+  int n              = 0;
+  while (prefix[n]) {
+    d->tname[n] = prefix[n];
+    ++n;
+  }
+  if (irq >= 10) d->tname[n++] = (char)('0' + irq / 10u);
+  d->tname[n++] = (char)('0' + irq % 10u);
+  d->tname[n]   = '\0';
+
+  d->tid = thread_create_kern(irq_thread_main, (void *)(uintptr_t)irq, d->tname);
+  if (d->tid < 0) return -ENOMEM;
+
+  d->handler = handler;
+  d->arg     = arg;
+  d->pending = 0;
+  platform_register_irq_handler(irq, irq_thread_top, d, name);
+  return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Syscall                                                                    */
+/* -------------------------------------------------------------------------- */
+
+long
+sys_irq_affinity(uint32_t irq, uint32_t hart_mask, uint32_t op)
+{
+  switch (op) {
+    case IRQ_AFF_SET:
+      return irq_set_affinity(irq, hart_mask);
+    case IRQ_AFF_BALANCE:
+      return irq_balance();
+    case IRQ_AFF_AUTO_ON:
+      s_balance_auto  = 1;
+      s_balance_ticks = 0;
+      return 0;
+    case IRQ_AFF_AUTO_OFF:
+      s_balance_auto = 0;
+      return 0;
+    default:
+      return -EINVAL;
+  }
+}
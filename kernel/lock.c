@@ -1,7 +1,187 @@
 /* lock.c */
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cache.h"
+#include "lock.h"
+#include "log.h"
+#include "percpu.h"
+#include "rwlock.h"
 #include "spinlock.h"
+#include "uapi.h"
+#include "uerrno.h"
 
 /* Global log lock: protects log output and its ring buffer only. */
-spinlock_t g_log_lock    = SPINLOCK_INIT;
-spinlock_t g_kernel_lock = SPINLOCK_INIT;
+spinlock_t g_log_lock __cacheline_aligned =
+    SPINLOCK_INIT_NAMED("log", SPIN_TICKET);
+
+/* 大锁：所有 hart 的 trap 都要抢，用 MCS 让等待者各自在本地节点上自旋 */
+spinlock_t g_kernel_lock __cacheline_aligned =
+    SPINLOCK_INIT_NAMED("kernel", SPIN_MCS);
+
+/* -------------------------------------------------------------------------- */
+/* MCS queue lock                                                             */
+/* -------------------------------------------------------------------------- */
+
+struct mcs_node {
+  struct mcs_node *volatile next;
+  volatile uint32_t locked;  /* 1 = 还在排队；前驱交接时写 0 */
+} __cacheline_aligned;
+
+typedef struct {
+  struct mcs_node nodes[SPIN_MCS_NEST_MAX];
+  uint32_t depth;
+} mcs_hart_t;
+
+/* 每个 hart 一组节点，按嵌套深度取用 */
+static DEFINE_PER_CPU(mcs_hart_t, s_mcs);
+
+int
+mcs_lock(spinlock_t *lk)
+{
+  mcs_hart_t *h = &this_cpu(s_mcs);
+  if (h->depth >= SPIN_MCS_NEST_MAX) {
+    PANICF("mcs: nesting > %d on lock %s", SPIN_MCS_NEST_MAX,
+           lk->name ? lk->name : "?");
+  }
+
+  struct mcs_node *me = &h->nodes[h->depth++];
+  me->next   = NULL;
+  me->locked = 1;
+
+  struct mcs_node *prev = __atomic_exchange_n(&lk->tail, me, __ATOMIC_ACQ_REL);
+  int contended         = 0;
+  if (prev) {
+    contended = 1;
+    __atomic_store_n(&prev->next, me, __ATOMIC_RELEASE);
+    while (__atomic_load_n(&me->locked, __ATOMIC_ACQUIRE)) {
+      spin_pause();  /* 只读自己的节点 */
+    }
+  }
+
+  lk->holder = me;
+  return contended;
+}
+
+void
+mcs_unlock(spinlock_t *lk)
+{
+  mcs_hart_t *h       = &this_cpu(s_mcs);
+  struct mcs_node *me = lk->holder;
+
+  struct mcs_node *next = __atomic_load_n(&me->next, __ATOMIC_ACQUIRE);
+  if (!next) {
+    struct mcs_node *expected = me;
+    if (__atomic_compare_exchange_n(&lk->tail, &expected, NULL, 0,
+                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+      goto out;  /* 没人排队 */
+    }
+    /* 有人刚 swap 了 tail，还没来得及链到我后面 */
+    while (!(next = __atomic_load_n(&me->next, __ATOMIC_ACQUIRE))) {
+      spin_pause();
+    }
+  }
+  __atomic_store_n(&next->locked, 0u, __ATOMIC_RELEASE);
+
+out:
+  h->depth--;
+  if (me != &h->nodes[h->depth]) {
+    PANICF("mcs: non-LIFO unlock of %s", lk->name ? lk->name : "?");
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* lockstat                                                                   */
+/* -------------------------------------------------------------------------- */
+
+/* 注册表读多写少：驱动初始化时 register，lockstat 读 */
+static rwlock_t s_locks_rw = RWLOCK_INIT_NAMED("lockstat");
+static spinlock_t *s_locks[LOCKSTAT_MAX_LOCKS] = {&g_kernel_lock, &g_log_lock};
+static uint32_t s_nlocks = 2;
+
+int
+lock_register(spinlock_t *lk)
+{
+  if (!lk) return -ENOSPC;
+
+  int ret = -ENOSPC;
+  reg_t s = write_lock_irqsave(&s_locks_rw);
+  if (s_nlocks < LOCKSTAT_MAX_LOCKS) {
+    s_locks[s_nlocks++] = lk;
+    ret                 = 0;
+  }
+  write_unlock_irqrestore(&s_locks_rw, s);
+  return ret;
+}
+
+#ifdef CONFIG_LOCKSTAT
+/*
+ * 计数是持有者在临界区里改的：读 / 清零也要持那把锁，否则快照会撕裂、
+ * 清零会和持有者的 ++ 交错。g_kernel_lock 由 syscall 入口持着，不再拿。
+ */
+static void
+lockstat_snapshot(spinlock_t *lk, struct lockstat_user *out, int reset)
+{
+  const int take = (lk != &g_kernel_lock);
+  if (take) spin_lock(lk);
+
+  struct lockstat *st = &lk->stat;
+  if (out) {
+    out->acquisitions = st->acquisitions;
+    out->contended    = st->contended;
+    out->spin_ticks   = st->spin_ticks;
+    out->spin_max     = st->spin_max;
+    out->hold_max     = st->hold_max;
+  }
+  if (reset) {
+    uint64_t hold_start = st->hold_start;  /* 持有者（可能就是自己）unlock 时还要用 */
+    *st                 = (struct lockstat){0};
+    st->hold_start      = hold_start;
+  }
+
+  if (take) spin_unlock(lk);
+}
+#endif
+
+long
+sys_lockstat(struct lockstat_user *ubuf, size_t n, uint32_t flags)
+{
+#ifdef CONFIG_LOCKSTAT
+  if (!ubuf) return -EINVAL;
+
+  const int reset = (flags & LOCKSTAT_F_RESET) != 0;
+  size_t out      = 0;
+  reg_t s         = read_lock_irqsave(&s_locks_rw);
+  for (uint32_t i = 0; i < s_nlocks; ++i) {
+    spinlock_t *lk = s_locks[i];
+    if (out >= n) {
+      if (!reset) break;
+      lockstat_snapshot(lk, NULL, 1);
+      continue;
+    }
+
+    struct lockstat_user tmp;
+    const char *name = lk->name ? lk->name : "?";
+    size_t k         = 0;
+    for (; k + 1 < sizeof(tmp.name) && name[k]; ++k) {
+      tmp.name[k] = name[k];
+    }
+    for (; k < sizeof(tmp.name); ++k) {
+      tmp.name[k] = '\0';
+    }
+    tmp.kind = lk->kind;
+    tmp._pad = 0;
+    lockstat_snapshot(lk, &tmp, reset);
+    ubuf[out++] = tmp;
+  }
+  read_unlock_irqrestore(&s_locks_rw, s);
+
+  return (long)out;
+#else
+  (void)ubuf;
+  (void)n;
+  (void)flags;
+  return -ENOSYS;
+#endif
+}
@@ -2,16 +2,26 @@
 #include <stdint.h>
 
 #include "arch.h"
+#include "bcache.h"
+#include "blkdev.h"
 #include "console.h"
 #include "cpu.h"
+#include "dt.h"
+#include "efs.h"
 #include "kernel.h"
 #include "log.h"
 #include "platform.h"
 #include "probe_illegal.h"
 #include "sbi.h"
+#include "softirq.h"
+#include "sysworker.h"
 #include "thread.h"
 #include "time.h"
+#include "tmpfs.h"
 #include "trap.h"
+#include "vfs.h"
+#include "fpu.h"
+#include "vector.h"
 
 /* OpenSBI will jump here for secondary harts: a0=hartid, a1=opaque(dtb_pa) */
 extern void secondary_entry(uintptr_t hartid, uintptr_t opaque);
@@ -72,12 +82,63 @@ sbi_early_banner(long hartid, long dtb_pa) {
   sbi_console_puts("\n");
 }
 
+/*
+ * Boot timeline: time CSR value at the end of each boot phase, printed once at
+ * the end of primary_main. Only the boot hart appends phases; secondaries only
+ * write their own ready slot.
+ */
+#define BOOT_PHASE_MAX 16
+
+static struct {
+  const char *name;
+  uint64_t t;
+} s_boot_phases[BOOT_PHASE_MAX];
+static uint32_t s_boot_nphases;
+static uint64_t s_boot_t0;
+static uint64_t s_hart_ready_at[MAX_HARTS];
+
+static void
+boot_phase(const char *name) {
+  if (s_boot_nphases < BOOT_PHASE_MAX) {
+    s_boot_phases[s_boot_nphases].name = name;
+    s_boot_phases[s_boot_nphases].t    = platform_time_now();
+    s_boot_nphases++;
+  }
+}
+
+static uint64_t
+boot_ticks_to_us(uint64_t ticks) {
+  uint64_t hz = platform_timebase_hz();
+  return hz ? ticks * 1000000u / hz : 0;
+}
+
+static void
+boot_timeline_print(uint64_t ready_mask) {
+  uint64_t prev = s_boot_t0;
+  for (uint32_t i = 0; i < s_boot_nphases; ++i) {
+    uint64_t t = s_boot_phases[i].t;
+    pr_info("boot: %-10s %8llu us  (+%llu us)",
+            s_boot_phases[i].name,
+            (unsigned long long) boot_ticks_to_us(t - s_boot_t0),
+            (unsigned long long) boot_ticks_to_us(t - prev));
+    prev = t;
+  }
+  for (uint32_t h = 0; h < MAX_HARTS; ++h) {
+    if (ready_mask & (1ull << h)) {
+      pr_info("boot: hart%u ready %8llu us",
+              h,
+              (unsigned long long) boot_ticks_to_us(s_hart_ready_at[h] - s_boot_t0));
+    }
+  }
+}
+
 /*
  * S-mode entry: OpenSBI jumps to _start, start.S clears BSS + builds the stack,
  * then tail-calls main(hartid, dtb).
  */
 void
 kernel_main(long hartid, long dtb_pa) {
+  uint64_t t0 = platform_time_now();
   sbi_early_banner(hartid, dtb_pa);
 
   uint32_t my_hartid = (uint32_t) hartid;
@@ -87,6 +148,7 @@ kernel_main(long hartid, long dtb_pa) {
 
   /* First hart to set g_boot_hartid becomes the logical boot hart */
   if (__sync_bool_compare_and_swap(&g_boot_hartid, expected, my_hartid)) {
+    s_boot_t0 = t0;
     primary_main(hartid, dtb_pa);
   } else {
     wait_for_smp_boot_done();
@@ -94,76 +156,51 @@ kernel_main(long hartid, long dtb_pa) {
   }
 }
 
-/* OpenSBI keeps other harts parked in M-mode; need to start them explicitly */
-static void
+/*
+ * OpenSBI keeps other harts parked in M-mode; need to start them explicitly.
+ * Issue every sbi_hart_start first, then wait once on the ready mask with a
+ * single overall timeout, so secondaries run their per-hart init concurrently
+ * and boot time no longer grows by one full wait per hart. HSM status is only
+ * queried for harts that failed to come up. Returns the mask of ready harts.
+ */
+static uint64_t
 start_other_harts(long dtb_pa) {
   ASSERT(g_boot_hartid != NO_BOOT_HART);
 
   const uint64_t start_timeout = platform_sched_delta_ticks() * 100u; /* ~100ms */
+  uint64_t want = 0;
 
   for (uint32_t h = 0; h < MAX_HARTS; ++h) {
     if (h == (uint32_t) g_boot_hartid)
       continue;
 
-    struct sbiret st_before = sbi_hart_status(h);
-    if (st_before.error == 0) {
-      pr_info("hart%u status before start: %s (%ld)",
-              h,
-              hsm_status_str(st_before.value),
-              st_before.value);
-    } else {
-      pr_warn("hart%u status query failed: err=%ld", h, st_before.error);
-    }
-
     pr_debug(
         "sbi_hart_start args: hart=%ld start=%p opaque=%p", h, secondary_entry, (void *) dtb_pa);
     struct sbiret ret
         = sbi_hart_start(h, (uintptr_t) secondary_entry, (uintptr_t) dtb_pa /* opaque -> a1 */);
     if (ret.error != 0) {
       pr_warn("sbi_hart_start(hart=%u) failed: err=%ld\n", h, ret.error);
+      continue;
     }
+    want |= 1ull << h;
+  }
+  boot_phase("hart_start");
 
-    /* Wait a fixed timeout (~100ms) derived from the 1ms scheduler slice. */
-    uint64_t start = platform_time_now();
-    long last_status = -1;
-    long first_started = -1;
-    int online = 0;
-    while ((platform_time_now() - start) < start_timeout) {
-      struct sbiret st = sbi_hart_status(h);
-      if (st.error == 0) {
-        last_status = st.value;
-        if (st.value == SBI_HSM_STATUS_STARTED && first_started == -1) {
-          first_started = st.value;
-        }
-      }
-      if (*(volatile uint32_t *) &g_cpus[h].online) {
-        long st_val = (first_started != -1) ? first_started : last_status;
-        pr_info("hart%u online (HSM=%s/%ld, last=%s/%ld)",
-                h,
-                hsm_status_str(st_val),
-                st_val,
-                hsm_status_str(last_status),
-                last_status);
-        online = 1;
-        break;
-      }
-      /* Some platforms may report START_PENDING/STARTED before S-mode sees online flag. */
-      if (st.error == 0
-          && (st.value == SBI_HSM_STATUS_STARTED || st.value == SBI_HSM_STATUS_START_PENDING)) {
-        static uint32_t logged_mask = 0;
-        if ((logged_mask & (1u << h)) == 0) {
-          pr_debug("hart%u HSM status=%s, waiting for S-mode online", h, hsm_status_str(st.value));
-          logged_mask |= (1u << h);
-        }
-      }
-    }
-    if (!online) {
-      pr_warn("hart%u did not come online; last status=%s/%ld",
+  uint64_t ready = smp_wait_harts_ready(want, start_timeout);
+  for (uint32_t h = 0; h < MAX_HARTS; ++h) {
+    if (!(want & (1ull << h)) || (ready & (1ull << h)))
+      continue;
+    struct sbiret st = sbi_hart_status(h);
+    if (st.error == 0) {
+      pr_warn("hart%u did not come online; HSM status=%s/%ld",
               h,
-              hsm_status_str(last_status),
-              last_status);
+              hsm_status_str(st.value),
+              st.value);
+    } else {
+      pr_warn("hart%u did not come online; status query failed: err=%ld", h, st.error);
     }
   }
+  return ready;
 }
 
 void
@@ -179,6 +216,7 @@ primary_main(long hartid, long dtb_pa) {
    */
   platform_init((uintptr_t) hartid, (uintptr_t) dtb_pa);
   platform_boot_hart_init((uintptr_t) hartid);
+  boot_phase("platform");
 
   /* platform_puts can be used after platform_init (uart) */
   platform_puts("Booting...\n");
@@ -188,19 +226,39 @@ primary_main(long hartid, long dtb_pa) {
   console_init(); /* console layer on uart */
 
   log_init_baremetal();
+  boot_phase("trap+log");
+  dt_log_stats();
 
   probe_privileged_isa();
+  vector_init();
+  fpu_init();
 
   time_init();
+  boot_phase("isa+time");
 
   threads_init(user_main);
+  softirq_init();
+  boot_phase("threads");
+  platform_devices_init();
+  boot_phase("devices");
+  (void) ramdisk_init();
+  sysworker_init();
+  bcache_init();
+  vfs_init(efs_mount_root);  /* 第一次路径查找时挂载 */
+  (void) tmpfs_init();
+  boot_phase("storage");
 
   set_smp_boot_done();
-  start_other_harts(dtb_pa);
+  uint64_t ready = start_other_harts(dtb_pa);
+  boot_phase("smp");
 
   pr_info(
       "Kernel built as %s, CPUS=%d, Boot Hart=%ld", KERNEL_BUILD_TYPE, MAX_HARTS, (long) hartid);
-  pr_info("Boot Hart: system init done.");
+  boot_timeline_print(ready);
+  pr_info("Boot Hart: system init done, %u/%u harts online in %llu us.",
+          (unsigned) __builtin_popcountll(ready) + 1u,
+          (unsigned) MAX_HARTS,
+          (unsigned long long) boot_ticks_to_us(platform_time_now() - s_boot_t0));
 
   cpu_enter_idle(hartid);
 }
@@ -213,6 +271,8 @@ secondary_main(long hartid, long dtb_pa) {
   platform_secondary_hart_init(hartid);
   trap_init();
 
+  s_hart_ready_at[hartid] = platform_time_now();
+  smp_set_ready((uint32_t) hartid);
   pr_info("hart %ld online (secondary)", cpu_current_hartid());
   cpu_enter_idle((uint32_t) hartid);
 }
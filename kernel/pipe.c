@@ -0,0 +1,401 @@
+/* kernel/pipe.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lock.h"
+#include "log.h"
+#include "pipe.h"
+#include "string.h"
+#include "thread.h"
+#include "trap.h"
+#include "uerrno.h"
+
+_Static_assert((PIPE_BUF_SIZE & (PIPE_BUF_SIZE - 1u)) == 0,
+               "ring index uses a mask");
+
+/* 一个阻塞在管道上的线程 */
+typedef struct pipe_wait {
+  struct pipe_wait *next;
+  pipe_t *pipe;      /* NULL = 不在任何队列上 */
+  uint8_t *buf;      /* 读端：目的；写端：源 */
+  uint64_t len;
+  uint64_t done;
+  uint32_t slot_seq;
+  uint32_t writer;
+} pipe_wait_t;
+
+typedef struct {
+  pipe_wait_t *head;
+  pipe_wait_t *tail;
+} pipe_waitq_t;
+
+struct pipe {
+  uint32_t readers;  /* 打开的读端 / 写端（file 对象个数） */
+  uint32_t writers;
+  uint32_t head;     /* 自由增长的读 / 写计数，用时 & mask */
+  uint32_t tail;
+  pipe_waitq_t rq;
+  pipe_waitq_t wq;
+  pollq_t pq;        /* 两端的 poller 共用；唤醒后各自重查 */
+  uint8_t buf[PIPE_BUF_SIZE];
+};
+
+static pipe_t s_pipes[PIPE_MAX];
+static pipe_wait_t s_waits[THREAD_MAX];
+static struct pipestat_user s_stat;
+
+/* -------------------------------------------------------------------------- */
+/* Wait queues                                                                */
+/* -------------------------------------------------------------------------- */
+
+static void
+waitq_push(pipe_waitq_t *q, pipe_wait_t *w)
+{
+  w->next = NULL;
+  if (q->tail) {
+    q->tail->next = w;
+  } else {
+    q->head = w;
+  }
+  q->tail = w;
+}
+
+static void
+waitq_remove(pipe_waitq_t *q, pipe_wait_t *w)
+{
+  pipe_wait_t **pp = &q->head;
+  pipe_wait_t *prev = NULL;
+  while (*pp && *pp != w) {
+    prev = *pp;
+    pp   = &(*pp)->next;
+  }
+  if (!*pp) return;
+  *pp = w->next;
+  if (q->tail == w) q->tail = prev;
+  w->next = NULL;
+}
+
+static tid_t
+wait_tid(const pipe_wait_t *w)
+{
+  return (tid_t)(w - s_waits);
+}
+
+/* 队头等待者；已经被 kill 的顺手摘掉 */
+static pipe_wait_t *
+waitq_first(pipe_waitq_t *q)
+{
+  while (q->head) {
+    pipe_wait_t *w  = q->head;
+    const Thread *t = &g_threads[wait_tid(w)];
+    if (t->slot_seq.seq == w->slot_seq && t->state != THREAD_ZOMBIE &&
+        t->state != THREAD_UNUSED) {
+      return w;
+    }
+    waitq_remove(q, w);
+    w->pipe = NULL;
+  }
+  return NULL;
+}
+
+/* 出队并让 syscall 返回 rc */
+static void
+wait_finish(pipe_waitq_t *q, pipe_wait_t *w, int64_t rc)
+{
+  tid_t tid = wait_tid(w);
+  waitq_remove(q, w);
+  w->pipe = NULL;
+
+  Thread *t = &g_threads[tid];
+  if (t->slot_seq.seq != w->slot_seq) return;
+  t->tf.a0 = (reg_t)rc;
+  thread_wake(tid);
+}
+
+static void
+wait_block(struct trapframe *tf, pipe_t *p, pipe_waitq_t *q, uint8_t *buf,
+           uint64_t len, uint64_t done, int writer)
+{
+  tid_t tid      = thread_current();
+  pipe_wait_t *w = &s_waits[tid];
+
+  w->pipe     = p;
+  w->buf      = buf;
+  w->len      = len;
+  w->done     = done;
+  w->slot_seq = g_threads[tid].slot_seq.seq;
+  w->writer   = (uint32_t)writer;
+  waitq_push(q, w);
+
+  if (writer) {
+    s_stat.write_blocks++;
+  } else {
+    s_stat.read_blocks++;
+  }
+  thread_block(tf);  /* 对端 wait_finish 写 a0 并唤醒 */
+}
+
+/* -------------------------------------------------------------------------- */
+/* Ring                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static inline uint32_t
+ring_used(const pipe_t *p)
+{
+  return p->tail - p->head;
+}
+
+static uint64_t
+ring_put(pipe_t *p, const uint8_t *src, uint64_t len)
+{
+  uint32_t room = PIPE_BUF_SIZE - ring_used(p);
+  uint32_t n    = (len < room) ? (uint32_t)len : room;
+  uint32_t off  = p->tail & (PIPE_BUF_SIZE - 1u);
+  uint32_t n1   = (n < PIPE_BUF_SIZE - off) ? n : PIPE_BUF_SIZE - off;
+
+  memcpy(p->buf + off, src, n1);
+  memcpy(p->buf, src + n1, n - n1);
+  p->tail += n;
+  return n;
+}
+
+static uint64_t
+ring_get(pipe_t *p, uint8_t *dst, uint64_t len)
+{
+  uint32_t used = ring_used(p);
+  uint32_t n    = (len < used) ? (uint32_t)len : used;
+  uint32_t off  = p->head & (PIPE_BUF_SIZE - 1u);
+  uint32_t n1   = (n < PIPE_BUF_SIZE - off) ? n : PIPE_BUF_SIZE - off;
+
+  memcpy(dst, p->buf + off, n1);
+  memcpy(dst + n1, p->buf, n - n1);
+  p->head += n;
+  s_stat.bytes_ring += n;
+  return n;
+}
+
+/* 阻塞的写端：把剩下的数据尽量搬进环形缓冲，写完的唤醒 */
+static void
+pipe_refill(pipe_t *p)
+{
+  pipe_wait_t *w;
+  while ((w = waitq_first(&p->wq)) != NULL) {
+    w->done += ring_put(p, w->buf + w->done, w->len - w->done);
+    if (w->done < w->len) break;
+    wait_finish(&p->wq, w, (int64_t)w->done);
+  }
+}
+
+/* 数据 / 空间 / 端点数变了：有 poller 才去重查 */
+static inline void
+pipe_notify(pipe_t *p)
+{
+  if (pollq_active(&p->pq)) pollq_wake_locked(&p->pq);
+}
+
+/* -------------------------------------------------------------------------- */
+/* API                                                                        */
+/* -------------------------------------------------------------------------- */
+
+pipe_t *
+pipe_alloc_locked(void)
+{
+  for (uint32_t i = 0; i < PIPE_MAX; ++i) {
+    pipe_t *p = &s_pipes[i];
+    if (p->readers == 0 && p->writers == 0) {
+      p->readers = 1;
+      p->writers = 1;
+      p->head    = 0;
+      p->tail    = 0;
+      p->rq      = (pipe_waitq_t){0};
+      p->wq      = (pipe_waitq_t){0};
+      p->pq      = (pollq_t){0};
+      s_stat.npipes++;
+      s_stat.created++;
+      return p;
+    }
+  }
+  return NULL;
+}
+
+void
+pipe_release_locked(pipe_t *p, int writer)
+{
+  pipe_wait_t *w;
+  if (writer) {
+    ASSERT(p->writers > 0);
+    if (--p->writers == 0) {
+      /* 读端拿到已经读到的部分；一点没有就是 EOF */
+      while ((w = waitq_first(&p->rq)) != NULL) {
+        wait_finish(&p->rq, w, (int64_t)w->done);
+      }
+    }
+  } else {
+    ASSERT(p->readers > 0);
+    if (--p->readers == 0) {
+      while ((w = waitq_first(&p->wq)) != NULL) {
+        wait_finish(&p->wq, w, w->done ? (int64_t)w->done : -EPIPE);
+      }
+    }
+  }
+  if (p->readers == 0 && p->writers == 0) {
+    pollq_release_locked(&p->pq);
+    s_stat.npipes--;
+  } else {
+    pipe_notify(p);
+  }
+}
+
+uint32_t
+pipe_nbytes_locked(const pipe_t *p)
+{
+  return ring_used(p);
+}
+
+uint32_t
+pipe_poll_locked(pipe_t *p, int writer, pollq_t **q)
+{
+  *q = &p->pq;
+  if (writer) {
+    if (p->readers == 0) return POLLERR;
+    /* 有写端在排队说明缓冲满着 */
+    return (ring_used(p) < PIPE_BUF_SIZE && !waitq_first(&p->wq)) ? POLLOUT : 0;
+  }
+  /* 阻塞写端手里的数据也能直接读到 */
+  uint32_t mask = (ring_used(p) > 0 || waitq_first(&p->wq)) ? POLLIN : 0;
+  if (p->writers == 0) mask |= POLLHUP;
+  return mask;
+}
+
+void
+pipe_thread_gone_locked(tid_t tid)
+{
+  if (tid < 0 || tid >= THREAD_MAX) return;
+  pipe_wait_t *w = &s_waits[tid];
+  if (!w->pipe) return;
+  waitq_remove(w->writer ? &w->pipe->wq : &w->pipe->rq, w);
+  w->pipe = NULL;
+}
+
+/* 不阻塞地读：先取缓冲里的（更早写入的），再直接从阻塞的写端拿 */
+static uint64_t
+pipe_read_some(pipe_t *p, uint8_t *dst, uint64_t len)
+{
+  uint64_t n = ring_get(p, dst, len);
+  pipe_wait_t *w;
+  while (n < len && (w = waitq_first(&p->wq)) != NULL) {
+    uint64_t k = w->len - w->done;
+    if (k > len - n) k = len - n;
+    memcpy(dst + n, w->buf + w->done, k);
+    s_stat.bytes_direct += k;
+    w->done += k;
+    n += k;
+    if (w->done == w->len) wait_finish(&p->wq, w, (int64_t)w->done);
+  }
+  pipe_refill(p);
+
+  if (n > 0) pipe_notify(p);  /* 腾出了空间 */
+  return n;
+}
+
+/* 不阻塞地写，返回写进去的字节数（可能不足 len） */
+static uint64_t
+pipe_write_some(pipe_t *p, const uint8_t *src, uint64_t len)
+{
+  uint64_t done = 0;
+  /* 前面有写端在排队：缓冲是满的，按顺序排到它们后面 */
+  if (!waitq_first(&p->wq)) {
+    /* 缓冲空、读端在等：直接交给读端 */
+    pipe_wait_t *w;
+    while (done < len && ring_used(p) == 0 &&
+           (w = waitq_first(&p->rq)) != NULL) {
+      uint64_t k = w->len - w->done;
+      if (k > len - done) k = len - done;
+      memcpy(w->buf + w->done, src + done, k);
+      s_stat.bytes_direct += k;
+      w->done += k;
+      done += k;
+      wait_finish(&p->rq, w, (int64_t)w->done);
+    }
+    done += ring_put(p, src + done, len - done);
+
+    /* 还有读端在等（上面没轮到的）：从缓冲里各分一份 */
+    while (ring_used(p) > 0 && (w = waitq_first(&p->rq)) != NULL) {
+      uint64_t k = ring_get(p, w->buf, w->len);
+      wait_finish(&p->rq, w, (int64_t)k);
+    }
+  }
+
+  if (done > 0) pipe_notify(p);
+  return done;
+}
+
+void
+pipe_read(struct trapframe *tf, pipe_t *p, void *buf, uint64_t len)
+{
+  uint8_t *dst = (uint8_t *)buf;
+  if (len == 0) {
+    tf->a0 = 0;
+    return;
+  }
+
+  uint64_t n = pipe_read_some(p, dst, len);
+  if (n > 0 || p->writers == 0) {
+    tf->a0 = (reg_t)n;
+    return;
+  }
+  wait_block(tf, p, &p->rq, dst, len, 0, 0);
+}
+
+void
+pipe_write(struct trapframe *tf, pipe_t *p, const void *buf, uint64_t len)
+{
+  const uint8_t *src = (const uint8_t *)buf;
+  if (p->readers == 0) {
+    tf->a0 = (reg_t)-EPIPE;
+    return;
+  }
+  if (len == 0) {
+    tf->a0 = 0;
+    return;
+  }
+
+  uint64_t done = pipe_write_some(p, src, len);
+  if (done == len) {
+    tf->a0 = (reg_t)len;
+    return;
+  }
+  wait_block(tf, p, &p->wq, (uint8_t *)(uintptr_t)src, len, done, 1);
+}
+
+long
+pipe_read_nonblock_locked(pipe_t *p, void *buf, uint64_t len)
+{
+  if (len == 0) return 0;
+  uint64_t n = pipe_read_some(p, (uint8_t *)buf, len);
+  if (n > 0 || p->writers == 0) return (long)n;
+  return -EAGAIN;
+}
+
+long
+pipe_write_nonblock_locked(pipe_t *p, const void *buf, uint64_t len)
+{
+  if (p->readers == 0) return -EPIPE;
+  if (len == 0) return 0;
+  uint64_t done = pipe_write_some(p, (const uint8_t *)buf, len);
+  return done > 0 ? (long)done : -EAGAIN;
+}
+
+long
+sys_pipestat(struct pipestat_user *out, uint32_t flags)
+{
+  if (!out) return -EINVAL;
+  *out = s_stat;
+  if (flags & PIPESTAT_F_RESET) {
+    uint32_t npipes = s_stat.npipes;
+    s_stat          = (struct pipestat_user){0};
+    s_stat.npipes   = npipes;
+  }
+  return 0;
+}
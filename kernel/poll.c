@@ -0,0 +1,181 @@
+/* kernel/poll.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "poll.h"
+#include "thread.h"
+#include "trap.h"
+#include "uerrno.h"
+#include "vfs.h"
+
+/* 一个 poller 在一个对象队列上的挂点 */
+struct poll_entry {
+  poll_entry_t *next;
+  pollq_t *q;  /* NULL = 没挂 */
+};
+
+typedef struct {
+  poll_entry_t ent[POLL_MAX_FDS];
+  struct pollfd_user *fds;  /* 非 NULL = 正在等 */
+  uint32_t nfds;
+  uint32_t slot_seq;
+} poller_t;
+
+static poller_t s_pollers[THREAD_MAX];
+
+static tid_t
+entry_tid(const poll_entry_t *e)
+{
+  return (tid_t)(((uintptr_t)e - (uintptr_t)s_pollers) / sizeof(poller_t));
+}
+
+/* 查一遍 fds，写 revents，返回就绪的个数；qs 非 NULL 时顺带收集要挂的队列 */
+static uint32_t
+poll_scan(files_t *fs, struct pollfd_user *fds, uint32_t nfds, pollq_t **qs)
+{
+  uint32_t ready = 0;
+  for (uint32_t i = 0; i < nfds; ++i) {
+    pollq_t *q = NULL;
+    uint32_t mask;
+    if (fds[i].fd < 0) {
+      mask = 0;  /* 和 Linux 一样：负 fd 忽略 */
+    } else {
+      mask = vfs_poll_locked(fs, fds[i].fd, &q);
+      /* 出错类的总是报告，不用订阅 */
+      mask &= (uint32_t)fds[i].events | POLLERR | POLLHUP | POLLNVAL;
+    }
+    fds[i].revents = (uint16_t)mask;
+    if (mask) ready++;
+    if (qs) qs[i] = q;
+  }
+  return ready;
+}
+
+void
+poll_cancel_locked(tid_t tid)
+{
+  if (tid < 0 || tid >= THREAD_MAX) return;
+  poller_t *p = &s_pollers[tid];
+  if (!p->fds) return;
+
+  for (uint32_t i = 0; i < POLL_MAX_FDS; ++i) {
+    poll_entry_t *e = &p->ent[i];
+    if (!e->q) continue;
+    poll_entry_t **pp = &e->q->head;
+    while (*pp && *pp != e) pp = &(*pp)->next;
+    if (*pp) *pp = e->next;
+    e->next = NULL;
+    e->q    = NULL;
+  }
+  p->fds  = NULL;
+  p->nfds = 0;
+}
+
+/* poller 还是挂上去时的那个线程吗（被 kill / 回收的不算） */
+static int
+poller_live(tid_t tid)
+{
+  const Thread *t = &g_threads[tid];
+  return t->slot_seq.seq == s_pollers[tid].slot_seq &&
+         t->state != THREAD_ZOMBIE && t->state != THREAD_UNUSED;
+}
+
+/* 从所有队列摘下并带着就绪个数 n 唤醒 */
+static void
+poller_finish(tid_t tid, uint32_t n)
+{
+  Thread *t = &g_threads[tid];
+  poll_cancel_locked(tid);
+  t->tf.a0 = n;
+  if (t->state == THREAD_SLEEPING) {
+    thread_wake_sleeping(tid);
+  } else {
+    thread_wake(tid);
+  }
+}
+
+void
+pollq_wake_locked(pollq_t *q)
+{
+  poll_entry_t *e = q->head;
+  while (e) {
+    /* poll_cancel_locked 只会摘掉 e 本身（同一 poller 在一条队列上只挂一次） */
+    poll_entry_t *next = e->next;
+    tid_t tid          = entry_tid(e);
+    poller_t *p        = &s_pollers[tid];
+
+    if (!poller_live(tid)) {
+      poll_cancel_locked(tid);  /* 被 kill 了 */
+    } else {
+      uint32_t n = poll_scan(g_threads[tid].files, p->fds, p->nfds, NULL);
+      if (n > 0) poller_finish(tid, n);
+    }
+    e = next;
+  }
+}
+
+void
+pollq_release_locked(pollq_t *q)
+{
+  /* 对象已经不能再查了（没有 fd 指着它），不重扫：挂在它上面的那一项直接报 POLLNVAL */
+  while (q->head) {
+    poll_entry_t *e = q->head;
+    tid_t tid       = entry_tid(e);
+    poller_t *p     = &s_pollers[tid];
+
+    if (!poller_live(tid)) {
+      poll_cancel_locked(tid);
+      continue;
+    }
+    p->fds[e - p->ent].revents = POLLNVAL;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < p->nfds; ++i) {
+      if (p->fds[i].revents) n++;
+    }
+    poller_finish(tid, n);  /* 把 e 也从 q 上摘掉 */
+  }
+}
+
+void
+sys_poll(struct trapframe *tf, struct pollfd_user *fds, uint32_t nfds,
+         int64_t timeout)
+{
+  if (nfds > POLL_MAX_FDS || (nfds && !fds)) {
+    tf->a0 = (reg_t)-EINVAL;
+    return;
+  }
+
+  tid_t tid = thread_current();
+  Thread *t = &g_threads[tid];
+  pollq_t *qs[POLL_MAX_FDS];
+  uint32_t n = poll_scan(t->files, fds, nfds, qs);
+  if (n > 0 || timeout == 0) {
+    tf->a0 = n;
+    return;
+  }
+
+  /* 挂到每个不同的队列上（同一个管道的两端、重复的 fd 只挂一次） */
+  poller_t *p = &s_pollers[tid];
+  for (uint32_t i = 0; i < nfds; ++i) {
+    if (!qs[i]) continue;
+    int dup = 0;
+    for (uint32_t j = 0; j < i && !dup; ++j) dup = (qs[j] == qs[i]);
+    if (dup) continue;
+    poll_entry_t *e = &p->ent[i];
+    e->q            = qs[i];
+    e->next         = qs[i]->head;
+    qs[i]->head     = e;
+  }
+  p->fds      = fds;
+  p->nfds     = nfds;
+  p->slot_seq = t->slot_seq.seq;
+
+  /* 超时返回 0；就绪时唤醒方改写 a0 */
+  tf->a0 = 0;
+  if (timeout < 0) {
+    thread_block(tf);
+  } else {
+    thread_sys_sleep(tf, (uint64_t)timeout);
+  }
+}
@@ -0,0 +1,114 @@
+/* kernel/ramdisk.c */
+
+/*
+ * RAM 盘：一段固定的物理内存当块设备用（ram0）。
+ * 内容由 QEMU `-device loader,file=...,addr=CONFIG_RAMDISK_BASE` 预先装好
+ * （make RAMDISK_IMG=xxx），不装就是一块全零的盘。
+ * 位置 / 大小来自 mk/config.mk 的 RAMDISK_ADDR / RAMDISK_SIZE_MB，0 MiB = 不要。
+ *
+ * submit 里直接 memcpy，完成留到 kick 里统一上报：blk_run_queue 的下发循环
+ * 里不能重入 blk_complete。
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "blkdev.h"
+#include "log.h"
+#include "string.h"
+#include "uerrno.h"
+
+#ifndef CONFIG_RAMDISK_SIZE_MB
+#define CONFIG_RAMDISK_SIZE_MB 0
+#endif
+#ifndef CONFIG_RAMDISK_BASE
+#define CONFIG_RAMDISK_BASE 0x8c000000ul
+#endif
+
+#define RAMDISK_MAX_INFLIGHT 64u
+#define RAMDISK_MAX_SEGS     16u
+
+extern char __bss_end[];
+
+typedef struct {
+  uint8_t *base;
+  blk_req_t *done_head;  /* 已拷贝、等 kick 上报的请求 */
+  blk_req_t *done_tail;
+  blkdev_t blk;
+} ramdisk_t;
+
+static ramdisk_t s_ram;
+
+static int
+ramdisk_submit(blkdev_t *bd, blk_req_t *req)
+{
+  ramdisk_t *rd = (ramdisk_t *)bd->priv;
+
+  if (req->op != BLK_OP_FLUSH) {
+    uint8_t *p = rd->base + req->sector * BLK_SECTOR_SIZE;
+    for (blk_req_t *seg = req; seg; seg = seg->merge_next) {
+      size_t len = (size_t)seg->nsect * BLK_SECTOR_SIZE;
+      if (req->op == BLK_OP_READ) {
+        memcpy(seg->buf, p, len);
+      } else {
+        memcpy(p, seg->buf, len);
+      }
+      p += len;
+    }
+  }
+
+  req->next = NULL;
+  if (rd->done_tail) {
+    rd->done_tail->next = req;
+  } else {
+    rd->done_head = req;
+  }
+  rd->done_tail = req;
+  return 0;
+}
+
+static void
+ramdisk_kick(blkdev_t *bd)
+{
+  ramdisk_t *rd = (ramdisk_t *)bd->priv;
+
+  blk_req_t *req = rd->done_head;
+  rd->done_head  = NULL;
+  rd->done_tail  = NULL;
+  while (req) {
+    blk_req_t *next = req->next;
+    blk_complete(bd, req, 0);
+    req = next;
+  }
+
+  /* 超过 max_inflight 没发出去的，接着发（每轮最多 64 个，深度有限） */
+  if (bd->pend_head) blk_run_queue(bd);
+}
+
+static const blkdev_ops_t s_ramdisk_ops = {
+    .submit = ramdisk_submit,
+    .kick   = ramdisk_kick,
+};
+
+int
+ramdisk_init(void)
+{
+  const uintptr_t base = (uintptr_t)CONFIG_RAMDISK_BASE;
+  const uint64_t size  = (uint64_t)CONFIG_RAMDISK_SIZE_MB << 20;
+
+  if (size == 0) return -ENODEV;
+  if (base < (uintptr_t)__bss_end) {
+    pr_warn("ramdisk: base 0x%lx overlaps the kernel image (end 0x%lx)",
+            (unsigned long)base, (unsigned long)(uintptr_t)__bss_end);
+    return -EINVAL;
+  }
+
+  s_ram.base             = (uint8_t *)base;
+  s_ram.blk.name         = "ram0";
+  s_ram.blk.nsectors     = size / BLK_SECTOR_SIZE;
+  s_ram.blk.max_inflight = RAMDISK_MAX_INFLIGHT;
+  s_ram.blk.max_segs     = RAMDISK_MAX_SEGS;
+  s_ram.blk.ops          = &s_ramdisk_ops;
+  s_ram.blk.priv         = &s_ram;
+  return blk_register(&s_ram.blk);
+}
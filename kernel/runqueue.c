@@ -1,7 +1,9 @@
 /* runqueue.c */
 
 #include "log.h"
+#include "percpu.h"
 #include "runqueue.h"
+#include "seqlock.h"
 #include "thread.h"
 #include "types.h"
 
@@ -9,15 +11,19 @@ typedef struct {
   tid_t head;
   tid_t tail;
   uint32_t len;
+  seqcount_t seq;  /* 改链表时 +1/+1；写者都持 g_kernel_lock */
 } runqueue_t;
 
-static runqueue_t g_runqueues[MAX_HARTS];
+/* 远端唤醒会写别的 hart 的队列，但相邻 hart 的队列至少不再共行 */
+static DEFINE_PER_CPU(runqueue_t, g_runqueues);
 
 void rq_init(uint32_t hartid) {
   if (hartid >= (uint32_t)MAX_HARTS) return;
-  g_runqueues[hartid].head = -1;
-  g_runqueues[hartid].tail = -1;
-  g_runqueues[hartid].len  = 0;
+  runqueue_t *r = &per_cpu(g_runqueues, hartid);
+  r->head       = -1;
+  r->tail       = -1;
+  r->len        = 0;
+  seqcount_init(&r->seq);
 }
 
 void rq_init_all(void) {
@@ -29,7 +35,7 @@ void rq_init_all(void) {
 static inline runqueue_t *
 rq(uint32_t hartid)
 {
-  return &g_runqueues[hartid];
+  return &per_cpu(g_runqueues, hartid);
 }
 
 void
@@ -46,6 +52,7 @@ rq_push_tail(uint32_t hartid, tid_t tid)
     PANICF("rq_push_tail: tid=%d already on rq", (int)tid);
   }
 
+  write_seqcount_begin(&r->seq);
   t->rq_next = -1;
   if (r->tail == -1) {
     r->head = r->tail = tid;
@@ -55,6 +62,32 @@ rq_push_tail(uint32_t hartid, tid_t tid)
   }
   t->on_rq = 1;
   r->len++;
+  write_seqcount_end(&r->seq);
+}
+
+void
+rq_push_head(uint32_t hartid, tid_t tid)
+{
+  if (hartid >= (uint32_t)MAX_HARTS) return;
+  if (tid < 0 || tid >= THREAD_MAX) return;
+  if (tid < (tid_t)MAX_HARTS) return;  /* Do not put idle threads into rq */
+
+  runqueue_t* r = rq(hartid);
+  Thread* t     = &g_threads[tid];
+
+  if (t->on_rq) {
+    PANICF("rq_push_head: tid=%d already on rq", (int)tid);
+  }
+
+  write_seqcount_begin(&r->seq);
+  t->rq_next = r->head;
+  r->head    = tid;
+  if (r->tail == -1) {
+    r->tail = tid;
+  }
+  t->on_rq = 1;
+  r->len++;
+  write_seqcount_end(&r->seq);
 }
 
 tid_t
@@ -68,6 +101,7 @@ rq_pop_head(uint32_t hartid)
   Thread* t = &g_threads[tid];
   tid_t nxt = t->rq_next;
 
+  write_seqcount_begin(&r->seq);
   r->head = nxt;
   if (nxt < 0) {
     r->tail = -1;
@@ -75,6 +109,7 @@ rq_pop_head(uint32_t hartid)
   t->rq_next = -1;
   t->on_rq   = 0;
   if (r->len > 0) r->len--;
+  write_seqcount_end(&r->seq);
   return tid;
 }
 
@@ -100,6 +135,7 @@ rq_remove(uint32_t hartid, tid_t tid)
       Thread* t = &g_threads[cur];
       tid_t nxt = t->rq_next;
 
+      write_seqcount_begin(&r->seq);
       if (prev < 0) {
         r->head = nxt;
       } else {
@@ -112,6 +148,7 @@ rq_remove(uint32_t hartid, tid_t tid)
       t->rq_next = -1;
       t->on_rq   = 0;
       if (r->len > 0) r->len--;
+      write_seqcount_end(&r->seq);
       return 0;
     }
     prev = cur;
@@ -132,17 +169,14 @@ rq_remove_any(tid_t tid)
   return -1;
 }
 
-int
-rq_snapshot(uint32_t hartid, tid_t *dst, size_t max)
+/* 拷贝链表；并发修改时可能读到乱序/截断的链，由调用方的 retry 兜底 */
+static int
+rq_copy(const runqueue_t *r, tid_t *dst, size_t max)
 {
-  if (hartid >= (uint32_t)MAX_HARTS) return -1;
-  if (!dst || max == 0) return -1;
-
-  runqueue_t* r = rq(hartid);
-  tid_t cur     = r->head;
-  size_t n      = 0;
+  tid_t cur = r->head;
+  size_t n  = 0;
 
-  while (cur >= 0 && n < max) {
+  while (cur >= 0 && cur < THREAD_MAX && n < max) {
     dst[n++] = cur;
     cur      = g_threads[cur].rq_next;
   }
@@ -151,3 +185,26 @@ rq_snapshot(uint32_t hartid, tid_t *dst, size_t max)
   }
   return (int)n;
 }
+
+int
+rq_snapshot(uint32_t hartid, tid_t *dst, size_t max)
+{
+  if (hartid >= (uint32_t)MAX_HARTS) return -1;
+  if (!dst || max == 0) return -1;
+
+  const runqueue_t *r = rq(hartid);
+  for (int tries = 0; tries < RQ_SNAPSHOT_TRIES; ++tries) {
+    uint32_t seq = read_seqcount_begin(&r->seq);
+    int n        = rq_copy(r, dst, max);
+    if (!read_seqcount_retry(&r->seq, seq)) return n;
+  }
+  return RQ_SNAPSHOT_BUSY;
+}
+
+int
+rq_snapshot_locked(uint32_t hartid, tid_t *dst, size_t max)
+{
+  if (hartid >= (uint32_t)MAX_HARTS) return -1;
+  if (!dst || max == 0) return -1;
+  return rq_copy(rq(hartid), dst, max);
+}
@@ -1,6 +1,9 @@
 /* sched.c */
 
+#include "bcache.h"
 #include "cpu.h"
+#include "evfd.h"
+#include "irq.h"
 #include "platform.h"
 #include "riscv_csr.h"
 #include "runqueue.h"
@@ -41,6 +44,9 @@ sched_on_timer_irq(struct trapframe *tf)
   /* 只有 boot hart 负责推进全局时间 / 唤醒睡眠线程。 */
   if (c->hartid == g_boot_hartid) {
     threads_tick();
+    evfd_tick();
+    irq_balance_tick();
+    bcache_tick();
   }
 
   /* 时间片计数：到零才触发 schedule，避免过于频繁的切换。 */
@@ -68,7 +74,10 @@ sched_on_ipi_irq(struct trapframe *tf)
 uint32_t
 sched_pick_target_hart(tid_t tid, uint32_t waker_hart)
 {
-  (void)tid;
+  if (tid >= 0 && tid < THREAD_MAX && g_threads[tid].bound_hart >= 0) {
+    return (uint32_t)g_threads[tid].bound_hart;
+  }
+
   uint32_t best_hart   = waker_hart;
   uint32_t best_len    = rq_len(waker_hart);
   uint32_t best_online = g_cpus[waker_hart].online;
@@ -0,0 +1,64 @@
+/* kernel/sleeplock.c */
+
+#include <stdint.h>
+
+#include "lock.h"
+#include "log.h"
+#include "sleeplock.h"
+#include "thread.h"
+
+_Static_assert(THREAD_MAX <= 64, "kwaitq_t is a 64-bit tid mask");
+
+void
+kwait_sleep_locked(kwaitq_t *q, reg_t *s)
+{
+  q->mask |= 1ull << thread_current();
+  thread_kern_block_locked();
+  kernel_unlock(*s);  /* 在这里切走；期间的 wake 会取消这次阻塞 */
+  *s = kernel_lock();
+}
+
+void
+kwait_wake_all(kwaitq_t *q)
+{
+  uint64_t m = q->mask;
+  q->mask    = 0;
+  while (m) {
+    tid_t tid = (tid_t)__builtin_ctzll(m);
+    m &= m - 1u;
+    thread_wake(tid);
+  }
+}
+
+void
+sleeplock_init(sleeplock_t *l)
+{
+  l->owner   = -1;
+  l->wq.mask = 0;
+}
+
+void
+sleep_lock(sleeplock_t *l)
+{
+  reg_t s = kernel_lock();
+  ASSERT(l->owner != thread_current());
+  while (l->owner >= 0) kwait_sleep_locked(&l->wq, &s);
+  l->owner = thread_current();
+  kernel_unlock(s);
+}
+
+void
+sleep_unlock(sleeplock_t *l)
+{
+  reg_t s = kernel_lock();
+  ASSERT(l->owner == thread_current());
+  l->owner = -1;
+  kwait_wake_all(&l->wq);
+  kernel_unlock(s);
+}
+
+int
+sleep_lock_held(const sleeplock_t *l)
+{
+  return l->owner == thread_current();
+}
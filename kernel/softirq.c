@@ -0,0 +1,165 @@
+/* kernel/softirq.c */
+
+/*
+ * 中断下半部与 per-hart kworker（接口见 include/softirq.h）。
+ *
+ * 本内核的 trap 不能嵌套：trap.S 总是切回本 hart 的 kstack_top、把现场存进
+ * cur_tf。所以“开着中断跑下半部”不能像 Linux 那样放在 irq_exit 里，
+ * 只能放到线程上下文：每个 hart 一个绑定的 kworker 内核线程。
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpu.h"
+#include "cpustat.h"
+#include "lock.h"
+#include "log.h"
+#include "percpu.h"
+#include "platform.h"
+#include "softirq.h"
+#include "thread.h"
+
+typedef struct {
+  volatile uint32_t pending;  /* SOFTIRQ_* 位图；只有本 hart 置位 */
+  tid_t kworker;
+  struct work *head;          /* work 队列（g_kernel_lock 保护） */
+  struct work *tail;
+} softirq_cpu_t;
+
+static DEFINE_PER_CPU(softirq_cpu_t, s_softirq);
+static softirq_fn_t s_softirq_vec[SOFTIRQ_NR];
+static char s_kworker_names[MAX_HARTS][12];
+
+volatile uint32_t g_bh_inline = 0;
+
+void
+open_softirq(uint32_t nr, softirq_fn_t fn)
+{
+  if (nr >= SOFTIRQ_NR) return;
+  s_softirq_vec[nr] = fn;
+}
+
+void
+raise_softirq(uint32_t nr)
+{
+  if (nr >= SOFTIRQ_NR) return;
+  __atomic_fetch_or(&this_cpu(s_softirq).pending, 1u << nr, __ATOMIC_RELAXED);
+}
+
+void
+softirq_irq_exit(struct trapframe *tf)
+{
+  softirq_cpu_t *sc = &this_cpu(s_softirq);
+  if (!sc->pending || sc->kworker < 0) return;
+
+  cpustat_kworker_wakeup();
+  thread_kern_wake_local(sc->kworker, tf);
+}
+
+int
+queue_work_on(uint32_t hartid, struct work *w)
+{
+  if (hartid >= (uint32_t)MAX_HARTS || !w || !w->fn) return 0;
+  if (w->queued) return 0;
+
+  softirq_cpu_t *sc = &per_cpu(s_softirq, hartid);
+  w->next           = NULL;
+  w->queued         = 1;
+  if (sc->tail) {
+    sc->tail->next = w;
+  } else {
+    sc->head = w;
+  }
+  sc->tail = w;
+
+  thread_wake(sc->kworker);
+  return 1;
+}
+
+tid_t
+softirq_kworker(uint32_t hartid)
+{
+  if (hartid >= (uint32_t)MAX_HARTS) return -1;
+  return per_cpu(s_softirq, hartid).kworker;
+}
+
+static void
+softirq_run(uint32_t pending)
+{
+  for (uint32_t nr = 0; nr < SOFTIRQ_NR; ++nr) {
+    if (!(pending & (1u << nr)) || !s_softirq_vec[nr]) continue;
+
+    uint64_t t0 = platform_time_now();
+    s_softirq_vec[nr]();
+    cpustat_softirq(nr, platform_time_now() - t0);
+  }
+}
+
+static void __attribute__((noreturn))
+kworker_main(void *arg)
+{
+  const uint32_t hartid = (uint32_t)(uintptr_t)arg;
+  softirq_cpu_t *sc     = &per_cpu(s_softirq, hartid);
+
+  for (;;) {
+    reg_t s = kernel_lock();
+
+    uint32_t pending =
+        __atomic_exchange_n(&sc->pending, 0u, __ATOMIC_ACQ_REL);
+
+    /* 一次取一个 work：fn 运行期间别人可以把它重新排上 */
+    struct work *w = sc->head;
+    if (w) {
+      sc->head = w->next;
+      if (!sc->head) sc->tail = NULL;
+      w->next   = NULL;
+      w->queued = 0;
+    }
+
+    if (!pending && !w) {
+      /* 放锁后、切走前的 raise/queue 会经 thread_wake 取消这次阻塞 */
+      thread_kern_block_locked();
+      kernel_unlock(s);
+      continue;
+    }
+    kernel_unlock(s);
+
+    /* 这里开着中断 */
+    if (pending) softirq_run(pending);
+    if (w) {
+      uint64_t t0 = platform_time_now();
+      w->fn(w);
+      cpustat_work(platform_time_now() - t0);
+    }
+  }
+}
+
+void
+softirq_init(void)
+{
+  for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+    softirq_cpu_t *sc = &per_cpu(s_softirq, h);
+    sc->pending       = 0;
+    sc->head          = NULL;
+    sc->tail          = NULL;
+
+    char *name = s_kworker_names[h];
+    int n      = 0;
+    const char *prefix = "kworker/";
+    while (prefix[n]) {
+      name[n] = prefix[n];
+      ++n;
+    }
+    if (h >= 10) name[n++] = (char)('0' + h / 10u);
+    name[n++] = (char)('0' + h % 10u);
+    name[n]   = '\0';
+
+    sc->kworker = thread_create_kern_on(h, kworker_main, (void *)(uintptr_t)h,
+                                        name);
+    if (sc->kworker < 0) {
+      PANICF("softirq_init: cannot create %s", name);
+    }
+  }
+  pr_info("softirq: %d kworkers", MAX_HARTS);
+}
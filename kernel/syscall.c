@@ -0,0 +1,412 @@
+/* kernel/syscall.c */
+
+#include <stdint.h>
+
+#include "bcache.h"
+#include "blkdev.h"
+#include "cpu.h"
+#include "cpustat.h"
+#include "irq.h"
+#include "futex.h"
+#include "ksyscall.h"
+#include "kuring.h"
+#include "lock.h"
+#include "log.h"
+#include "percpu.h"
+#include "pipe.h"
+#include "poll.h"
+#include "platform.h"
+#include "sysfile.h"
+#include "thread.h"
+#include "trap.h"
+#include "uerrno.h"
+#include "usyscall.h"
+#include "vfs.h"
+
+_Static_assert(SYS_NR <= SYSSTAT_MAX_NR, "raise SYSSTAT_MAX_NR");
+
+/* -------------------------------------------------------------------------- */
+/* Per-hart statistics                                                        */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  uint64_t count;
+  uint64_t total_ticks;
+  uint64_t max_ticks;
+} syscall_stat_t;
+
+typedef syscall_stat_t syscall_stat_row_t[SYS_NR];
+
+/* 每个 hart 只写自己那一行，不需要额外的锁；行按 cache line 对齐 */
+static DEFINE_PER_CPU(syscall_stat_row_t, s_sysstat);
+
+static inline void
+syscall_account(uint32_t hartid, uintptr_t nr, uint64_t ticks)
+{
+  syscall_stat_t *st = &per_cpu(s_sysstat, hartid)[nr];
+  st->count++;
+  st->total_ticks += ticks;
+  if (ticks > st->max_ticks) {
+    st->max_ticks = ticks;
+  }
+}
+
+long
+sys_sysstat(struct sysstat_user *ubuf, size_t n, uint32_t flags)
+{
+  if (!ubuf) return -EINVAL;
+
+  size_t out = 0;
+  for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+    for (uint32_t nr = 0; nr < (uint32_t)SYS_NR && out < n; ++nr) {
+      const syscall_stat_t *st = &per_cpu(s_sysstat, h)[nr];
+      if (st->count == 0) continue;
+
+      struct sysstat_user tmp;
+      tmp.nr          = nr;
+      tmp.hart        = h;
+      tmp.count       = st->count;
+      tmp.total_ticks = st->total_ticks;
+      tmp.max_ticks   = st->max_ticks;
+      ubuf[out++]     = tmp;
+    }
+  }
+
+  if (flags & SYSSTAT_F_RESET) {
+    for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+      for (uint32_t nr = 0; nr < (uint32_t)SYS_NR; ++nr) {
+        per_cpu(s_sysstat, h)[nr] = (syscall_stat_t){0};
+      }
+    }
+  }
+
+  return (long)out;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Syscall entries                                                            */
+/* -------------------------------------------------------------------------- */
+
+static void
+syscall_sleep(struct trapframe *tf)
+{
+  thread_sys_sleep(tf, tf->a1);  /* 里面可能 schedule() */
+}
+
+static void
+syscall_thread_exit(struct trapframe *tf)
+{
+  thread_sys_exit(tf, (int)tf->a1);  /* 通常不会“回到这个线程” */
+}
+
+static void
+syscall_thread_join(struct trapframe *tf)
+{
+  /* 阻塞情况下，thread_sys_join 内部会调用 schedule() */
+  thread_sys_join(tf, (tid_t)tf->a1, tf->a2);
+}
+
+static void
+syscall_thread_create(struct trapframe *tf)
+{
+  thread_sys_create(tf, (thread_entry_t)tf->a1, (void *)tf->a2,
+                    (const char *)tf->a3);
+}
+
+static void
+syscall_thread_spawn(struct trapframe *tf)
+{
+  thread_sys_spawn(tf, (thread_entry_t)tf->a1, (void *)tf->a2,
+                   (const char *)tf->a3, (const int *)tf->a4);
+}
+
+static void
+syscall_write(struct trapframe *tf)
+{
+  /* 控制台直接写；文件在 sysworker 里写，管道写不下时阻塞，之后再写回 a0 */
+  sys_fd_write(tf, (int)tf->a1, (const void *)tf->a2, (uint64_t)tf->a3);
+}
+
+static void
+syscall_read(struct trapframe *tf)
+{
+  /* 阻塞 read（stdin / 文件 / 管道）：唤醒方会写回 t->tf.a0 */
+  sys_fd_read(tf, (int)tf->a1, (void *)tf->a2, (uint64_t)tf->a3);
+}
+
+static void
+syscall_thread_list(struct trapframe *tf)
+{
+  tf->a0 = (reg_t)thread_sys_list((struct u_thread_info *)tf->a1, (int)tf->a2);
+}
+
+static void
+syscall_thread_kill(struct trapframe *tf)
+{
+  thread_sys_kill(tf, (tid_t)tf->a1);  /* 返回值在 thread_sys_kill 里写入 */
+}
+
+static void
+syscall_clock_gettime(struct trapframe *tf)
+{
+  tf->a0 = sys_clock_gettime((int)tf->a1, (struct timespec *)tf->a2);
+}
+
+static void
+syscall_irq_get_stats(struct trapframe *tf)
+{
+  tf->a0 = sys_irq_get_stats((struct irqstat_user *)tf->a1, (size_t)tf->a2);
+}
+
+static void
+syscall_get_hartid(struct trapframe *tf)
+{
+  tf->a0 = (reg_t)cpu_current_hartid();
+}
+
+static void
+syscall_yield(struct trapframe *tf)
+{
+  thread_sys_yield(tf);
+}
+
+static void
+syscall_thread_detach(struct trapframe *tf)
+{
+  thread_sys_detach(tf, (tid_t)tf->a1);
+}
+
+static void
+syscall_runqueue_snapshot(struct trapframe *tf)
+{
+  tf->a0 = sys_runqueue_snapshot((struct rq_state *)tf->a1, (size_t)tf->a2);
+}
+
+static void
+syscall_sysstat(struct trapframe *tf)
+{
+  tf->a0 = sys_sysstat((struct sysstat_user *)tf->a1, (size_t)tf->a2,
+                       (uint32_t)tf->a3);
+}
+
+static void
+syscall_ring_setup(struct trapframe *tf)
+{
+  tf->a0 = sys_ring_setup((struct uring *)tf->a1, (uint32_t)tf->a2,
+                          (uint32_t)tf->a3);
+}
+
+static void
+syscall_ring_enter(struct trapframe *tf)
+{
+  /* SLEEP 操作会 schedule()，返回值已提前写入 tf->a0 */
+  sys_ring_enter(tf, (uint32_t)tf->a1, (uint32_t)tf->a2, (uint32_t)tf->a3);
+}
+
+static void
+syscall_nop(struct trapframe *tf)
+{
+  tf->a0 = 0;
+}
+
+static void
+syscall_lockstat(struct trapframe *tf)
+{
+  tf->a0 = sys_lockstat((struct lockstat_user *)tf->a1, (size_t)tf->a2,
+                        (uint32_t)tf->a3);
+}
+
+static void
+syscall_cpustat(struct trapframe *tf)
+{
+  tf->a0 = sys_cpustat((struct cpustat_user *)tf->a1, (size_t)tf->a2,
+                       (uint32_t)tf->a3);
+}
+
+static void
+syscall_irq_affinity(struct trapframe *tf)
+{
+  tf->a0 = sys_irq_affinity((uint32_t)tf->a1, (uint32_t)tf->a2,
+                            (uint32_t)tf->a3);
+}
+
+static void
+syscall_blk_io(struct trapframe *tf)
+{
+  /* 有请求在飞时阻塞，返回值由完成回调写入 */
+  sys_blk_io(tf, (uint32_t)tf->a1, (struct blk_io *)tf->a2, (uint32_t)tf->a3);
+}
+
+static void
+syscall_blk_stat(struct trapframe *tf)
+{
+  tf->a0 = sys_blk_stat((uint32_t)tf->a1, (struct blkstat_user *)tf->a2,
+                        (uint32_t)tf->a3);
+}
+
+static void
+syscall_bcache_io(struct trapframe *tf)
+{
+  /* 在 sysworker 线程里执行，返回值由它写入 */
+  sys_bcache_io(tf);
+}
+
+static void
+syscall_cachestat(struct trapframe *tf)
+{
+  tf->a0 = sys_cachestat((struct cachestat_user *)tf->a1, (uint32_t)tf->a2);
+}
+
+static void
+syscall_open(struct trapframe *tf)
+{
+  /* 路径查找在 sysworker 线程里做，返回值由它写入 */
+  sys_open(tf, (const char *)tf->a1, (uint32_t)tf->a2);
+}
+
+static void
+syscall_close(struct trapframe *tf)
+{
+  tf->a0 = (reg_t)sys_close((int)tf->a1);
+}
+
+static void
+syscall_lseek(struct trapframe *tf)
+{
+  tf->a0 = (reg_t)sys_lseek((int)tf->a1, (int64_t)tf->a2, (int)tf->a3);
+}
+
+static void
+syscall_fstat(struct trapframe *tf)
+{
+  tf->a0 = (reg_t)sys_fstat((int)tf->a1, (struct stat_user *)tf->a2);
+}
+
+static void
+syscall_getdents(struct trapframe *tf)
+{
+  /* readdir 可能读盘：在 sysworker 线程里执行 */
+  sys_getdents(tf, (int)tf->a1, (struct dirent_user *)tf->a2, (uint32_t)tf->a3);
+}
+
+static void
+syscall_pipe(struct trapframe *tf)
+{
+  tf->a0 = (reg_t)sys_pipe((int *)tf->a1);
+}
+
+static void
+syscall_pipestat(struct trapframe *tf)
+{
+  tf->a0 = (reg_t)sys_pipestat((struct pipestat_user *)tf->a1, (uint32_t)tf->a2);
+}
+
+static void
+syscall_futex(struct trapframe *tf)
+{
+  /* WAIT 可能阻塞：结果由 futex_op 写 a0 */
+  futex_op(tf, (volatile uint32_t *)tf->a1, (uint32_t)tf->a2, (uint32_t)tf->a3);
+}
+
+static void
+syscall_poll(struct trapframe *tf)
+{
+  /* 没就绪时阻塞（或带超时睡）：结果由 sys_poll / 唤醒方写 a0 */
+  sys_poll(tf, (struct pollfd_user *)tf->a1, (uint32_t)tf->a2, (int64_t)tf->a3);
+}
+
+static void
+syscall_eventfd(struct trapframe *tf)
+{
+  tf->a0 = (reg_t)sys_eventfd((uint64_t)tf->a1, (uint32_t)tf->a2);
+}
+
+static void
+syscall_timerfd_create(struct trapframe *tf)
+{
+  tf->a0 = (reg_t)sys_timerfd_create();
+}
+
+static void
+syscall_timerfd_settime(struct trapframe *tf)
+{
+  tf->a0 = (reg_t)sys_timerfd_settime((int)tf->a1, (uint64_t)tf->a2,
+                                      (uint64_t)tf->a3);
+}
+
+/* NOLOCK 的条目不能写调度器状态，也不能阻塞 */
+static const syscall_desc_t s_syscall_table[SYS_NR] = {
+    [SYS_SLEEP]             = {syscall_sleep},
+    [SYS_THREAD_EXIT]       = {syscall_thread_exit},
+    [SYS_THREAD_JOIN]       = {syscall_thread_join},
+    [SYS_THREAD_CREATE]     = {syscall_thread_create},
+    [SYS_WRITE]             = {syscall_write},
+    [SYS_READ]              = {syscall_read},
+    [SYS_THREAD_LIST]       = {syscall_thread_list,       SYSCALL_F_NOLOCK},
+    [SYS_THREAD_KILL]       = {syscall_thread_kill},
+    [SYS_CLOCK_GETTIME]     = {syscall_clock_gettime,     SYSCALL_F_NOLOCK},
+    [SYS_IRQ_GET_STATS]     = {syscall_irq_get_stats,     SYSCALL_F_NOLOCK},
+    [SYS_GET_HARTID]        = {syscall_get_hartid,        SYSCALL_F_NOLOCK},
+    [SYS_YIELD]             = {syscall_yield},
+    [SYS_THREAD_DETACH]     = {syscall_thread_detach},
+    [SYS_RUNQUEUE_SNAPSHOT] = {syscall_runqueue_snapshot, SYSCALL_F_NOLOCK},
+    [SYS_SYSSTAT]           = {syscall_sysstat},
+    [SYS_RING_SETUP]        = {syscall_ring_setup},
+    [SYS_RING_ENTER]        = {syscall_ring_enter},
+    [SYS_NOP]               = {syscall_nop,               SYSCALL_F_NOLOCK},
+    [SYS_LOCKSTAT]          = {syscall_lockstat},
+    [SYS_CPUSTAT]           = {syscall_cpustat},
+    [SYS_IRQ_AFFINITY]      = {syscall_irq_affinity},
+    [SYS_BLK_IO]            = {syscall_blk_io},
+    [SYS_BLK_STAT]          = {syscall_blk_stat},
+    [SYS_BCACHE_IO]         = {syscall_bcache_io},
+    [SYS_CACHESTAT]         = {syscall_cachestat},
+    [SYS_OPEN]              = {syscall_open},
+    [SYS_CLOSE]             = {syscall_close},
+    [SYS_LSEEK]             = {syscall_lseek},
+    [SYS_FSTAT]             = {syscall_fstat},
+    [SYS_GETDENTS]          = {syscall_getdents},
+    [SYS_PIPE]              = {syscall_pipe},
+    [SYS_THREAD_SPAWN]      = {syscall_thread_spawn},
+    [SYS_PIPESTAT]          = {syscall_pipestat},
+    [SYS_FUTEX]             = {syscall_futex},
+    [SYS_POLL]              = {syscall_poll},
+    [SYS_EVENTFD]           = {syscall_eventfd},
+    [SYS_TIMERFD_CREATE]    = {syscall_timerfd_create},
+    [SYS_TIMERFD_SETTIME]   = {syscall_timerfd_settime},
+};
+
+/* -------------------------------------------------------------------------- */
+/* Dispatch                                                                   */
+/* -------------------------------------------------------------------------- */
+
+int
+syscall_is_lockless(uintptr_t nr)
+{
+  return nr < (uintptr_t)SYS_NR &&
+         (s_syscall_table[nr].flags & SYSCALL_F_NOLOCK) != 0;
+}
+
+void
+syscall_handler(struct trapframe *tf)
+{
+  const uintptr_t sys_id = tf->a0;
+  const uint32_t hartid  = cpu_current_hartid();
+  const uint64_t start   = platform_time_now();
+
+  tf->sepc += 4;
+
+  syscall_fn_t fn =
+      (sys_id < (uintptr_t)SYS_NR) ? s_syscall_table[sys_id].fn : 0;
+  if (!fn) {
+    pr_debug("syscall: unknown nr=%lu tid=%d", (unsigned long)sys_id,
+             thread_current());
+    tf->a0 = (reg_t)-ENOSYS;
+    syscall_account(hartid, 0, platform_time_now() - start);
+    return;
+  }
+
+  fn(tf);
+
+  syscall_account(hartid, sys_id, platform_time_now() - start);
+}
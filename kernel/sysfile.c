@@ -2,6 +2,7 @@
 
 #include <console.h>
 
+#include "irq.h"
 #include "platform.h"
 #include "sysfile.h"
 #include "thread.h"
@@ -91,21 +92,32 @@ sys_irq_get_stats(struct irqstat_user* ubuf, size_t n)
   if (n > IRQSTAT_MAX_IRQ) {
     n = IRQSTAT_MAX_IRQ;
   }
+  if (n > platform_irq_max()) {
+    n = platform_irq_max();
+  }
 
-  platform_irq_stat_t kstats[IRQSTAT_MAX_IRQ];
-  size_t k_n = platform_irq_get_stats(kstats, n);
+  for (size_t i = 0; i < n; ++i) {
+    platform_irq_stat_t ks;
+    platform_irq_get_stat((uint32_t)i, &ks);
 
-  for (size_t i = 0; i < k_n; ++i) {
     struct irqstat_user tmp;
-    tmp.irq          = kstats[i].irq;
-    tmp.count        = kstats[i].count;
-    tmp.first_tick   = kstats[i].first_tick;
-    tmp.last_tick    = kstats[i].last_tick;
-    tmp.max_delta    = kstats[i].max_delta;
+    tmp.irq        = ks.irq;
+    tmp.affinity   = ks.affinity;
+    tmp.count      = ks.count;
+    tmp.first_tick = ks.first_tick;
+    tmp.last_tick  = ks.last_tick;
+    tmp.max_delta  = ks.max_delta;
+    tmp.flags      = 0;
+    tmp._pad       = 0;
+    if (platform_irq_registered((uint32_t)i)) tmp.flags |= IRQSTAT_F_REGISTERED;
+    if (irq_is_threaded((uint32_t)i)) tmp.flags |= IRQSTAT_F_THREADED;
+    for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+      tmp.hart_count[h] = ks.hart_count[h];
+    }
 
     /* 拷贝名字，截断 */
     size_t j         = 0;
-    const char* name = kstats[i].name;
+    const char* name = ks.name;
     if (name) {
       for (; j + 1 < IRQSTAT_MAX_NAME && name[j]; ++j) {
         tmp.name[j] = name[j];
@@ -118,5 +130,5 @@ sys_irq_get_stats(struct irqstat_user* ubuf, size_t n)
     ubuf[i]     = tmp;
   }
 
-  return (long)k_n;
+  return (long)n;
 }
@@ -0,0 +1,117 @@
+/* kernel/sysworker.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lock.h"
+#include "log.h"
+#include "sysworker.h"
+#include "thread.h"
+#include "trap.h"
+#include "uerrno.h"
+
+#define SYSWORKER_NR 2u
+
+typedef struct {
+  sysworker_fn_t fn;
+  uint64_t args[4];
+  uint32_t slot_seq;
+  uint32_t busy;  /* 排队中或正在执行 */
+  tid_t next;     /* FIFO，-1 结尾 */
+} sysworker_req_t;
+
+static sysworker_req_t s_reqs[THREAD_MAX];  /* 按调用者 tid 索引：每线程最多一个 */
+static tid_t s_head = -1;
+static tid_t s_tail = -1;
+static tid_t s_workers[SYSWORKER_NR];
+static uint32_t s_idle_mask;  /* 在等活的 worker */
+
+static void __attribute__((noreturn))
+sysworker_main(void *arg)
+{
+  const uint32_t me = (uint32_t)(uintptr_t)arg;
+
+  for (;;) {
+    reg_t s = kernel_lock();
+    if (s_head < 0) {
+      s_idle_mask |= 1u << me;
+      thread_kern_block_locked();
+      kernel_unlock(s);
+      continue;
+    }
+    s_idle_mask &= ~(1u << me);
+
+    tid_t tid          = s_head;
+    sysworker_req_t *r = &s_reqs[tid];
+    s_head             = r->next;
+    if (s_head < 0) s_tail = -1;
+    kernel_unlock(s);
+
+    long rc = r->fn(r->args[0], r->args[1], r->args[2], r->args[3]);
+
+    s         = kernel_lock();
+    Thread *t = &g_threads[tid];
+    r->busy   = 0;
+    if (t->slot_seq.seq == r->slot_seq) {
+      t->tf.a0 = (reg_t)rc;
+      thread_wake(tid);
+    }
+    kernel_unlock(s);
+  }
+}
+
+int
+sysworker_call(struct trapframe *tf, sysworker_fn_t fn, uint64_t a1,
+               uint64_t a2, uint64_t a3, uint64_t a4)
+{
+  if (s_workers[0] <= 0) {
+    tf->a0 = (reg_t)-ENOSYS;
+    return -ENOSYS;
+  }
+
+  tid_t tid          = thread_current();
+  sysworker_req_t *r = &s_reqs[tid];
+  if (r->busy) {
+    /* 同一个 tid 的上一个主人被 kill 时请求还没做完 */
+    tf->a0 = (reg_t)-EBUSY;
+    return -EBUSY;
+  }
+  r->busy            = 1;
+  r->fn              = fn;
+  r->args[0]         = a1;
+  r->args[1]         = a2;
+  r->args[2]         = a3;
+  r->args[3]         = a4;
+  r->slot_seq        = g_threads[tid].slot_seq.seq;
+  r->next            = -1;
+
+  if (s_tail >= 0) {
+    s_reqs[s_tail].next = tid;
+  } else {
+    s_head = tid;
+  }
+  s_tail = tid;
+
+  for (uint32_t i = 0; i < SYSWORKER_NR; ++i) {
+    if (s_idle_mask & (1u << i)) {
+      s_idle_mask &= ~(1u << i);
+      thread_wake(s_workers[i]);
+      break;
+    }
+  }
+
+  thread_block(tf);  /* worker 写 a0 并唤醒 */
+  return 0;
+}
+
+void
+sysworker_init(void)
+{
+  static const char *const names[SYSWORKER_NR] = {"sysworker/0",
+                                                  "sysworker/1"};
+  for (uint32_t i = 0; i < SYSWORKER_NR; ++i) {
+    s_workers[i] = thread_create_kern(sysworker_main, (void *)(uintptr_t)i,
+                                      names[i]);
+    if (s_workers[i] < 0) PANICF("sysworker: create %u failed", i);
+  }
+}
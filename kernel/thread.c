@@ -7,11 +7,21 @@
 #include "platform.h"
 #include "riscv_csr.h"
 #include "cpu.h"
+#include "evfd.h"
+#include "futex.h"
+#include "lock.h"
+#include "pipe.h"
+#include "poll.h"
 #include "runqueue.h"
 #include "sched.h"
+#include "fpu.h"
+#include "vdso.h"
+#include "vector.h"
+#include "vfs.h"
 
 extern tid_t g_stdin_waiter;
 void *memset(void *s, int c, size_t n); /* string.h */
+void *memcpy(void *dest, const void *src, size_t n); /* string.h */
 void arch_first_switch(struct trapframe *tf);
 
 /* -------------------------------------------------------------------------- */
@@ -122,6 +132,8 @@ static void init_thread_context_s(Thread *t, thread_entry_t entry, void *arg) {
 
   reg_t s  = csr_read(sstatus);
   s &= ~(SSTATUS_SPP | SSTATUS_SIE);  /* Clear mode/interrupt bits first. */
+  s &= ~SSTATUS_VS_MASK;              /* Kernel threads never use vectors. */
+  s &= ~SSTATUS_FS_MASK;              /* ...nor floating point. */
   s |= SSTATUS_SPP;                   /* SPP=1 so sret returns to S-mode. */
   s |= SSTATUS_SPIE;                  /* Re-enable S-mode interrupts after sret. */
   tf->sstatus = s;
@@ -140,6 +152,8 @@ static void init_thread_context_u(Thread *t, thread_entry_t entry, void *arg) {
 
   reg_t s  = csr_read(sstatus);
   s &= ~(SSTATUS_SPP | SSTATUS_SIE);
+  s &= ~SSTATUS_VS_MASK;  /* VS=Off: first vector insn traps (lazy enable). */
+  s &= ~SSTATUS_FS_MASK;  /* FS=Off: same for the first FP insn. */
   /* SPP=0 so sret returns to U-mode; set SPIE so U-mode can be interrupted. */
   s |= SSTATUS_SPIE;
   tf->sstatus = s;
@@ -154,23 +168,46 @@ static void idle_main(void *arg) {
   }
 }
 
-/* Recycle a thread that has been joined (return slot to UNUSED). */
-static void recycle_thread(tid_t tid) {
+/*
+ * Release what a dying thread holds, at the moment it becomes ZOMBIE (exit or
+ * kill), not when its slot is recycled: a thread nobody joins would otherwise
+ * keep its fd table -- and the pipe ends in it -- open forever.
+ */
+static void release_thread_resources(tid_t tid) {
   if (tid <= 0 || tid >= THREAD_MAX) {
-    return; /* Leave idle/main slots untouched. */
+    return;
   }
 
   if (g_stdin_waiter == tid) {
     g_stdin_waiter = -1;
   }
+  pipe_thread_gone_locked(tid);
+  futex_thread_gone_locked(tid);
+  poll_cancel_locked(tid);
+  evfd_thread_gone_locked(tid);
+
+  Thread *t = &g_threads[tid];
+  if (t->files) {
+    files_put(t->files);
+    t->files = NULL;
+  }
+}
+
+/* Recycle a thread that has been joined (return slot to UNUSED). */
+static void recycle_thread(tid_t tid) {
+  if (tid <= 0 || tid >= THREAD_MAX) {
+    return; /* Leave idle/main slots untouched. */
+  }
 
   Thread *t          = &g_threads[tid];
+  write_seqcount_begin(&t->slot_seq);
   t->state           = THREAD_UNUSED;
   t->wakeup_tick     = 0;
   t->name            = "unused";
   t->is_user         = 0;
   t->can_be_killed   = 0;
   t->detached        = 0;
+  t->bound_hart      = -1;
   t->exit_code       = 0;
   t->join_waiter     = -1;
   t->waiting_for     = -1;
@@ -183,6 +220,13 @@ static void recycle_thread(tid_t tid) {
   t->runs         = 0;
   t->rq_next      = -1;
   t->on_rq        = 0;
+
+  t->pending_state = THREAD_UNUSED;
+  t->ring          = NULL;
+  t->ring_flags    = 0;
+  vector_thread_reset(tid);
+  fpu_thread_reset(tid);
+  write_seqcount_end(&t->slot_seq);
   /* The stack array g_thread_stacks[tid] stays allocated for reuse. */
 }
 
@@ -214,10 +258,12 @@ static const char *idle_name_for_hart(uint32_t hartid) {
 }
 
 static tid_t thread_create_user(thread_entry_t entry, void *arg,
-                                const char *name);
+                                const char *name, struct files *files);
 
 static tid_t thread_create_user_main(thread_entry_t user_main, void *arg) {
-  tid_t tid = thread_create_user(user_main, arg, "user_main");
+  /* 第一个线程组：fd 0/1/2 = 控制台 */
+  tid_t tid = thread_create_user(user_main, arg, "user_main",
+                                 files_new_console());
   if (tid < 0) {
     pr_err("no slot for user_main\n");
   }
@@ -241,6 +287,7 @@ void threads_init(thread_entry_t user_main) {
     g_threads[i].stack_base       = NULL;
     g_threads[i].can_be_killed    = 0;
     g_threads[i].detached         = 0;
+    g_threads[i].bound_hart       = -1;
     g_threads[i].exit_code        = 0;
     g_threads[i].join_waiter      = -1;
     g_threads[i].waiting_for      = -1;
@@ -254,10 +301,17 @@ void threads_init(thread_entry_t user_main) {
     g_threads[i].runs             = 0;
     g_threads[i].rq_next          = -1;
     g_threads[i].on_rq            = 0;
+    g_threads[i].pending_state    = THREAD_UNUSED;
+    g_threads[i].ring             = NULL;
+    g_threads[i].ring_flags       = 0;
+    g_threads[i].files            = NULL;
+    seqcount_init(&g_threads[i].slot_seq);
     tf_clear(&g_threads[i].tf);
   }
 
   rq_init_all();
+  vdso_set_thread_stacks((uintptr_t)g_thread_stacks, THREAD_STACK_SIZE,
+                         THREAD_MAX);
 
   /* prepare idle thread (idle tid = hartid) */
   for (uint32_t hid = 0; hid < (uint32_t)MAX_HARTS; ++hid) {
@@ -277,7 +331,8 @@ void threads_init(thread_entry_t user_main) {
 }
 
 /* Create a new thread: return tid or -1 on failure. */
-tid_t thread_create_kern(thread_entry_t entry, void *arg, const char *name) {
+static tid_t thread_create_kern_bound(int32_t bound_hart, thread_entry_t entry,
+                                      void *arg, const char *name) {
   if (!entry) {
     pr_info("thread_create: entry is NULL\n");
     return -1;
@@ -291,6 +346,7 @@ tid_t thread_create_kern(thread_entry_t entry, void *arg, const char *name) {
 
   Thread *t          = &g_threads[tid];
 
+  write_seqcount_begin(&t->slot_seq);
   t->state           = THREAD_RUNNABLE;
   t->wakeup_tick     = 0;
   t->name            = name ? name : "thread";
@@ -301,6 +357,9 @@ tid_t thread_create_kern(thread_entry_t entry, void *arg, const char *name) {
   t->waiting_for     = -1;
   t->join_status_ptr = 0;
   t->is_user         = KERN_THREAD;
+  t->pending_state   = THREAD_UNUSED;
+  t->bound_hart      = bound_hart;
+  write_seqcount_end(&t->slot_seq);
 
   init_thread_context_s(t, entry, arg);
   thread_make_runnable(tid, cpu_current_hartid());
@@ -308,15 +367,28 @@ tid_t thread_create_kern(thread_entry_t entry, void *arg, const char *name) {
   return tid;
 }
 
+tid_t thread_create_kern(thread_entry_t entry, void *arg, const char *name) {
+  return thread_create_kern_bound(-1, entry, arg, name);
+}
+
+tid_t thread_create_kern_on(uint32_t hartid, thread_entry_t entry, void *arg,
+                            const char *name) {
+  if (hartid >= (uint32_t)MAX_HARTS) return -1;
+  return thread_create_kern_bound((int32_t)hartid, entry, arg, name);
+}
+
+/* files：新线程的 fd 表，调用方已经持有一个引用（失败时在这里放掉） */
 static tid_t thread_create_user(thread_entry_t entry, void *arg,
-                                const char *name) {
+                                const char *name, struct files *files) {
   tid_t tid = alloc_thread_slot();
 
   if (tid < 0) {
+    if (files) files_put(files);
     return -1;
   }
 
   Thread *t        = &g_threads[tid];
+  write_seqcount_begin(&t->slot_seq);
   t->state         = THREAD_RUNNABLE;
   t->wakeup_tick   = 0;
   t->name          = name ? name : "uthread";
@@ -324,6 +396,8 @@ static tid_t thread_create_user(thread_entry_t entry, void *arg,
   t->is_user       = USER_THREAD;
   t->can_be_killed = 1;
   t->detached      = 0;
+  t->files         = files;
+  write_seqcount_end(&t->slot_seq);
 
   init_thread_context_u(t, entry, arg);
   thread_make_runnable(tid, cpu_current_hartid());
@@ -339,6 +413,7 @@ void threads_tick(void) {
     Thread *t = &g_threads[i];
     if (t->state == THREAD_SLEEPING && t->wakeup_tick <= g_ticks) {
       t->wakeup_tick = 0;
+      poll_cancel_locked((tid_t)i);  /* poll 超时：从各对象队列上摘掉 */
       thread_make_runnable((tid_t)i, g_boot_hartid);
     }
   }
@@ -353,6 +428,14 @@ struct trapframe *schedule(struct trapframe *tf) {
 
   const int cur_is_idle = (cur_tid == c->idle_tid);
 
+  /* 内核线程自阻塞在这里真正生效（见 thread_kern_block_locked）。 */
+  if (cur->pending_state != THREAD_UNUSED) {
+    if (cur->state == THREAD_RUNNING) {
+      cur->state = cur->pending_state;
+    }
+    cur->pending_state = THREAD_UNUSED;
+  }
+
   /* 当前运行线程如果仍可运行且非 idle，则放回本地 runqueue 尾部。 */
   if (!cur_is_idle && cur->state == THREAD_RUNNING) {
     cur->state = THREAD_RUNNABLE;
@@ -384,6 +467,12 @@ struct trapframe *schedule(struct trapframe *tf) {
     }
   }
 
+  /* 切走的线程：向量/FP 状态脏了才保存，并把 VS/FS 关掉等下次惰性恢复 */
+  if (next_tid != cur_tid && cur->state != THREAD_UNUSED) {
+    vector_switch_out(cur_tid, &cur->tf);
+    fpu_switch_out(cur_tid, &cur->tf);
+  }
+
   c->current_tid = next_tid;
   Thread *next   = &g_threads[next_tid];
   next->state    = THREAD_RUNNING;
@@ -419,9 +508,51 @@ void thread_wake(tid_t tid) {
   Thread *t = &g_threads[tid];
   if (t->state == THREAD_BLOCKED) {
     thread_make_runnable(tid, cpu_current_hartid());
+  } else if (t->pending_state != THREAD_UNUSED) {
+    /* 还没来得及切走：取消这次自阻塞 */
+    t->pending_state = THREAD_UNUSED;
   }
 }
 
+void thread_wake_sleeping(tid_t tid) {
+  if (tid < 0 || tid >= THREAD_MAX) return;
+  Thread *t = &g_threads[tid];
+  if (t->state != THREAD_SLEEPING) return;
+  t->wakeup_tick = 0;
+  thread_make_runnable(tid, cpu_current_hartid());
+}
+
+void thread_kern_yield(void) {
+  csr_set(sip, SIP_SSIP);
+}
+
+void thread_kern_block_locked(void) {
+  Thread *cur = &g_threads[current_tid_get()];
+  ASSERT(!cur->is_user);
+
+  cur->pending_state = THREAD_BLOCKED;
+  thread_kern_yield();
+}
+
+void thread_kern_wake_local(tid_t tid, struct trapframe *tf) {
+  if (tid < (tid_t)MAX_HARTS || tid >= THREAD_MAX) return;
+
+  cpu_t *c  = cpu_this();
+  Thread *t = &g_threads[tid];
+  ASSERT(t->bound_hart == (int32_t)c->hartid);
+
+  if (t->state != THREAD_BLOCKED) {
+    /* 正在跑 / 已在 rq / 还没切走（pending_state）：普通唤醒就够了 */
+    thread_wake(tid);
+    return;
+  }
+
+  t->state       = THREAD_RUNNABLE;
+  t->wakeup_tick = 0;
+  rq_push_head(c->hartid, tid);
+  schedule(tf);
+}
+
 /* -------------------------------------------------------------------------- */
 /* Sleep / syscalls (kernel side)                                             */
 /* -------------------------------------------------------------------------- */
@@ -450,10 +581,26 @@ void thread_sys_yield(struct trapframe *tf) {
 
 void thread_sys_create(struct trapframe *tf, thread_entry_t entry, void *arg,
                        const char *name) {
-  tid_t tid = thread_create_user(entry, arg, name);
+  /* 同一线程组：和创建者共用 fd 表 */
+  struct files *files = g_threads[current_tid_get()].files;
+  tid_t tid = thread_create_user(entry, arg, name,
+                                 files ? files_get(files) : NULL);
   tf->a0    = (uintptr_t)tid;  /* Return tid to user mode. */
 }
 
+void thread_sys_spawn(struct trapframe *tf, thread_entry_t entry, void *arg,
+                      const char *name, const int *stdio) {
+  /* 新线程组：新 fd 表只带 0/1/2 */
+  struct files *files = NULL;
+  int rc = files_new_stdio(g_threads[current_tid_get()].files, stdio, &files);
+  if (rc < 0) {
+    tf->a0 = (reg_t)rc;
+    return;
+  }
+  tid_t tid = thread_create_user(entry, arg, name, files);
+  tf->a0    = (uintptr_t)tid;
+}
+
 void thread_sys_exit(struct trapframe *tf, int exit_code) {
   tid_t cur_tid  = current_tid_get();
   Thread *cur    = &g_threads[cur_tid];
@@ -466,6 +613,7 @@ void thread_sys_exit(struct trapframe *tf, int exit_code) {
   cur->state     = THREAD_ZOMBIE;
   cur->on_rq     = 0;
   cur->rq_next   = -1;
+  release_thread_resources(self_tid);
 
   if (joiner >= 0 && joiner < THREAD_MAX) {
     Thread *w = &g_threads[joiner];
@@ -566,35 +714,58 @@ void thread_sys_join(struct trapframe *tf, tid_t target_tid,
   schedule(tf);
 }
 
+/* 免锁读（SYSCALL_F_NOLOCK）：槽位是静态数组，指针永远有效；
+ * slot_seq 保证 tid/name/is_user 不会拼出“半个旧线程 + 半个新线程”。
+ * state/runs 这类计数各自读一次，允许相对彼此略旧。
+ */
+static int thread_info_read(const Thread *t, struct u_thread_info *dst) {
+  uint32_t seq;
+  int live;
+  /* 名字先拷进定长的本地缓冲（有界，不依赖 '\0'），序号对上了才交出去 */
+  char name_buf[sizeof(dst->name)];
+
+  do {
+    seq  = read_seqcount_begin(&t->slot_seq);
+    live = (t->state != THREAD_UNUSED);
+    if (live) {
+      dst->tid        = t->id;
+      dst->state      = (int)t->state;
+      dst->is_user    = t->is_user ? 1 : 0;
+      dst->exit_code  = t->exit_code;
+      dst->cpu        = t->running_hart;
+      dst->last_hart  = t->last_hart;
+      dst->migrations = t->migrations;
+      dst->runs       = t->runs;
+
+      size_t j         = 0;
+      const char *name = t->name;
+      if (name) {
+        for (; j + 1 < sizeof(name_buf) && name[j]; ++j) {
+          name_buf[j] = name[j];
+        }
+      }
+      for (; j < sizeof(name_buf); ++j) {
+        name_buf[j] = '\0';
+      }
+    }
+  } while (read_seqcount_retry(&t->slot_seq, seq));
+
+  if (live) {
+    memcpy(dst->name, name_buf, sizeof(dst->name));
+  }
+  return live;
+}
+
 int thread_sys_list(struct u_thread_info *ubuf, int max) {
   if (!ubuf || max <= 0) {
     return -1;  /* EINVAL */
   }
   int count = 0;
   for (int i = 0; i < THREAD_MAX && count < max; ++i) {
-    Thread *t = &g_threads[i];
-    if (t->state == THREAD_UNUSED) {
-      continue;
+    struct u_thread_info tmp;
+    if (thread_info_read(&g_threads[i], &tmp)) {
+      ubuf[count++] = tmp;
     }
-    struct u_thread_info *dst = &ubuf[count];
-    dst->tid                  = t->id;
-    dst->state                = (int)t->state;
-    dst->is_user              = t->is_user ? 1 : 0;
-    dst->exit_code            = t->exit_code;
-    dst->cpu                  = t->running_hart;
-    dst->last_hart            = t->last_hart;
-    dst->migrations           = t->migrations;
-    dst->runs                 = t->runs;
-
-    int j = 0;
-    if (t->name) {
-      while (t->name[j] && j < (int)sizeof(dst->name) - 1) {
-        dst->name[j] = t->name[j];
-        ++j;
-      }
-    }
-    dst->name[j] = '\0';
-    ++count;
   }
   return count;
 }
@@ -641,6 +812,7 @@ void thread_sys_kill(struct trapframe *tf, tid_t target_tid) {
   t->exit_code = THREAD_EXITCODE_SIGKILL;  /* Usually -9. */
   t->state     = THREAD_ZOMBIE;
   t->wakeup_tick = 0;
+  release_thread_resources(target_tid);
 
   /* Ensure it can't be scheduled again from any runqueue. */
   if (t->on_rq) {
@@ -733,7 +905,9 @@ void thread_sys_detach(struct trapframe *tf, tid_t target_tid) {
   tf->a0 = 0;
 }
 
-/* Runqueue snapshot: write up to n online harts into ubuf; returns count. */
+/* Runqueue snapshot: write up to n online harts into ubuf; returns count.
+ * SYSCALL_F_NOLOCK：进来时不持 g_kernel_lock。
+ */
 long sys_runqueue_snapshot(struct rq_state *ubuf, size_t n) {
   if (!ubuf || n == 0) {
     return -1;
@@ -751,6 +925,12 @@ long sys_runqueue_snapshot(struct rq_state *ubuf, size_t n) {
     }
 
     int len = rq_snapshot(h, tmp.tids, RQ_MAX_TIDS);
+    if (len == RQ_SNAPSHOT_BUSY) {
+      /* 免锁读一直被打断：退回大锁（只在这一个 hart 上排一次队） */
+      reg_t s = kernel_lock();
+      len     = rq_snapshot_locked(h, tmp.tids, RQ_MAX_TIDS);
+      kernel_unlock(s);
+    }
     if (len < 0) len = 0;
     tmp.len = (uint32_t)len;
 
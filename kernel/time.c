@@ -1,23 +1,65 @@
 /* kernel/time.c */
 /* kernel/time.c */
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "platform.h"
 #include "log.h"
+#include "seqlock.h"
+#include "vdso.h"
 
-/* Real nanoseconds at boot; used to derive since-boot time */
-static uint64_t boot_real_ns;
+/*
+ * 时间基准：real_ns = base_real_ns + ticks_to_ns(now - base_ticks)。
+ * 和 vdso_data 同一套换算；clock_gettime 是免锁 syscall，基准由 seqcount
+ * 保护。目前写者只有 time_init，以后加 settime 时也在写区间里改。
+ */
+static struct {
+  seqcount_t seq;
+  uint32_t hz;
+  uint64_t base_ticks;
+  uint64_t base_real_ns;
+  uint64_t boot_real_ns;  /* Real nanoseconds at boot; used to derive since-boot time */
+} s_tb = {.seq = SEQCNT_INIT};
 
 struct k_timespec {
   uint64_t tv_sec;
   uint32_t tv_nsec;
 };
 
+/* 与 platform_rtc_read_ns() 同一换算，避免 vdso 基准和 syscall 路径不一致 */
+static uint64_t
+ticks_to_ns(uint64_t ticks, uint32_t hz)
+{
+  uint64_t sec = ticks / (uint64_t)hz;
+  uint64_t rem = ticks - sec * (uint64_t)hz;
+  return sec * 1000000000ull + (rem * 1000000000ull) / (uint64_t)hz;
+}
+
+/* 一次一致地读出 real 和 boot 两个值 */
+static void
+ktime_read(uint64_t *real_ns, uint64_t *boot_ns)
+{
+  uint32_t seq;
+  uint64_t real, boot;
+
+  do {
+    seq = read_seqcount_begin(&s_tb.seq);
+    uint64_t now = platform_time_now();
+    real = s_tb.base_real_ns + ticks_to_ns(now - s_tb.base_ticks, s_tb.hz);
+    boot = s_tb.boot_real_ns;
+  } while (read_seqcount_retry(&s_tb.seq, seq));
+
+  *real_ns = real;
+  if (boot_ns) *boot_ns = boot;
+}
+
 uint64_t
 ktime_get_real_ns(void)
 {
-  return platform_rtc_read_ns();
+  uint64_t real;
+  ktime_read(&real, NULL);
+  return real;
 }
 
 void
@@ -31,8 +73,9 @@ ktime_get_real_ts(struct k_timespec *ts)
 uint64_t
 ktime_get_monotonic_ns(void)
 {
-  uint64_t now = platform_rtc_read_ns();
-  return now - boot_real_ns;
+  uint64_t real, boot;
+  ktime_read(&real, &boot);
+  return real - boot;
 }
 
 void
@@ -46,6 +89,18 @@ ktime_get_monotonic_ts(struct k_timespec *ts)
 void
 time_init(void)
 {
-  boot_real_ns = platform_rtc_read_ns();
-  pr_info("time_init: boot_real_ns=%llu", (unsigned long long)boot_real_ns);
+  uint32_t hz        = platform_timebase_hz();
+  uint64_t now_ticks = platform_time_now();
+  uint64_t now_ns    = ticks_to_ns(now_ticks, hz);
+
+  write_seqcount_begin(&s_tb.seq);
+  s_tb.hz           = hz;
+  s_tb.base_ticks   = now_ticks;
+  s_tb.base_real_ns = now_ns;
+  s_tb.boot_real_ns = now_ns;
+  write_seqcount_end(&s_tb.seq);
+  pr_info("time_init: boot_real_ns=%llu", (unsigned long long)now_ns);
+
+  /* 用户态 clock_gettime 从这里开始走 vdso 快速路径 */
+  vdso_init(hz, now_ticks, now_ns, now_ns);
 }
@@ -0,0 +1,442 @@
+/* kernel/tmpfs.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lock.h"
+#include "log.h"
+#include "sleeplock.h"
+#include "string.h"
+#include "time.h"
+#include "tmpfs.h"
+#include "uerrno.h"
+#include "vfs.h"
+
+#ifndef CONFIG_TMPFS_SIZE_MB
+#define CONFIG_TMPFS_SIZE_MB 0
+#endif
+#ifndef CONFIG_RAMDISK_SIZE_MB
+#define CONFIG_RAMDISK_SIZE_MB 0
+#endif
+#ifndef CONFIG_RAMDISK_BASE
+#define CONFIG_RAMDISK_BASE 0x8c000000ul
+#endif
+
+#define TMPFS_RADIX_SHIFT  9u
+#define TMPFS_RADIX_SLOTS  (1u << TMPFS_RADIX_SHIFT)  /* 一页放 512 个指针 */
+#define TMPFS_RADIX_MASK   (TMPFS_RADIX_SLOTS - 1u)
+#define TMPFS_RADIX_HEIGHT 3u  /* 512^3 页，远大于页池 */
+
+_Static_assert(TMPFS_RADIX_SLOTS * sizeof(void *) == TMPFS_PAGE_SIZE,
+               "radix node = one page");
+
+extern char __image_end[];
+extern char __stack_bottom[];
+
+/* -------------------------------------------------------------------------- */
+/* Page pool                                                                  */
+/* -------------------------------------------------------------------------- */
+
+/* 没用过的页从 brk 往上切；释放的页串在 free 链上（第一个字是 next） */
+typedef struct {
+  uintptr_t brk;
+  uintptr_t end;
+  void *free;
+  uint32_t npages;
+  uint32_t used;
+} tmpfs_pool_t;
+
+static tmpfs_pool_t s_pool;
+
+/* 持 g_kernel_lock */
+static void *
+tmpfs_page_alloc_locked(void)
+{
+  void *pg = s_pool.free;
+  if (pg) {
+    s_pool.free = *(void **)pg;
+  } else if (s_pool.brk < s_pool.end) {
+    pg = (void *)s_pool.brk;
+    s_pool.brk += TMPFS_PAGE_SIZE;
+  } else {
+    return NULL;
+  }
+  s_pool.used++;
+  return pg;
+}
+
+static void
+tmpfs_page_free_locked(void *pg)
+{
+  *(void **)pg = s_pool.free;
+  s_pool.free  = pg;
+  s_pool.used--;
+}
+
+static void *
+tmpfs_page_alloc(int zero)
+{
+  reg_t s  = kernel_lock();
+  void *pg = tmpfs_page_alloc_locked();
+  kernel_unlock(s);
+  if (pg && zero) memset(pg, 0, TMPFS_PAGE_SIZE);
+  return pg;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Nodes                                                                      */
+/* -------------------------------------------------------------------------- */
+
+typedef struct tmpfs_node {
+  vnode_t vn;  /* 必须在最前 */
+  uint32_t ino;
+  char name[DIRENT_NAME_MAX + 1u];
+  struct tmpfs_node *parent;
+  struct tmpfs_node *child;  /* 目录：第一个子项 */
+  struct tmpfs_node *next;   /* 同一目录里的下一个 */
+  uint32_t nchild;
+
+  sleeplock_t lock;  /* 下面这些 */
+  uint64_t size;
+  uint64_t mtime;
+  void *root;        /* 基数树 */
+  uint32_t height;   /* 0：root 就是第 0 页 */
+  uint32_t npages;   /* 数据页 + 树节点 */
+} tmpfs_node_t;
+
+static tmpfs_node_t s_nodes[TMPFS_MAX_NODES];
+static uint32_t s_nnodes;
+static const vnode_ops_t s_tmpfs_ops;
+
+static inline tmpfs_node_t *
+tmpfs_vi(vnode_t *vn)
+{
+  return (tmpfs_node_t *)vn;
+}
+
+static uint64_t
+tmpfs_now(void)
+{
+  struct k_timespec ts;
+  ktime_get_real_ts(&ts);
+  return ts.tv_sec;
+}
+
+/* 持 g_kernel_lock；节点不回收（没有 unlink） */
+static tmpfs_node_t *
+tmpfs_node_alloc_locked(tmpfs_node_t *dir, const char *name, size_t len,
+                        uint32_t type)
+{
+  if (s_nnodes >= TMPFS_MAX_NODES) return NULL;
+
+  tmpfs_node_t *n = &s_nodes[s_nnodes];
+  memset(n, 0, sizeof(*n));
+  n->ino     = ++s_nnodes;
+  n->vn.ops  = &s_tmpfs_ops;
+  n->vn.type = type;
+  n->mtime   = tmpfs_now();
+  sleeplock_init(&n->lock);
+  memcpy(n->name, name, len);
+  n->name[len] = '\0';
+
+  if (dir) {
+    n->parent  = dir;
+    n->next    = dir->child;
+    dir->child = n;
+    dir->nchild++;
+    dir->mtime = n->mtime;
+  }
+  return n;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Radix tree (node locked)                                                   */
+/* -------------------------------------------------------------------------- */
+
+static inline uint64_t
+tmpfs_radix_cap(uint32_t height)
+{
+  return 1ull << (height * TMPFS_RADIX_SHIFT);
+}
+
+/* 第 idx 页；没有返回 NULL */
+static void *
+tmpfs_radix_lookup(const tmpfs_node_t *n, uint64_t idx)
+{
+  if (idx >= tmpfs_radix_cap(n->height)) return NULL;
+
+  void *p = n->root;
+  for (uint32_t h = n->height; h > 0 && p; --h) {
+    p = ((void **)p)[(idx >> ((h - 1u) * TMPFS_RADIX_SHIFT)) & TMPFS_RADIX_MASK];
+  }
+  return p;
+}
+
+/* 第 idx 页的槽位，沿途缺的中间节点补上；-ENOSPC / -EFBIG 时返回 NULL */
+static void **
+tmpfs_radix_slot(tmpfs_node_t *n, uint64_t idx, int *err)
+{
+  while (idx >= tmpfs_radix_cap(n->height)) {
+    if (n->height == TMPFS_RADIX_HEIGHT) {
+      *err = -EFBIG;
+      return NULL;
+    }
+    if (n->root) {
+      void **top = tmpfs_page_alloc(1);
+      if (!top) goto nospc;
+      top[0]  = n->root;
+      n->root = top;
+      n->npages++;
+    }
+    n->height++;
+  }
+
+  void **slot = &n->root;
+  for (uint32_t h = n->height; h > 0; --h) {
+    if (!*slot) {
+      *slot = tmpfs_page_alloc(1);
+      if (!*slot) goto nospc;
+      n->npages++;
+    }
+    slot = &((void **)*slot)[(idx >> ((h - 1u) * TMPFS_RADIX_SHIFT)) &
+                             TMPFS_RADIX_MASK];
+  }
+  return slot;
+
+nospc:
+  *err = -ENOSPC;
+  return NULL;
+}
+
+static void
+tmpfs_radix_free_locked(void *p, uint32_t height)
+{
+  if (height > 0) {
+    void **slots = (void **)p;
+    for (uint32_t i = 0; i < TMPFS_RADIX_SLOTS; ++i) {
+      if (slots[i]) tmpfs_radix_free_locked(slots[i], height - 1u);
+    }
+  }
+  tmpfs_page_free_locked(p);
+}
+
+/* -------------------------------------------------------------------------- */
+/* vnode ops                                                                  */
+/* -------------------------------------------------------------------------- */
+
+static tmpfs_node_t *
+tmpfs_find_locked(tmpfs_node_t *dir, const char *name, size_t len)
+{
+  for (tmpfs_node_t *c = dir->child; c; c = c->next) {
+    if (strnlen(c->name, len + 1u) == len && memcmp(c->name, name, len) == 0) {
+      return c;
+    }
+  }
+  return NULL;
+}
+
+static int
+tmpfs_lookup(vnode_t *dir, const char *name, size_t len, vnode_t **out)
+{
+  if (len > DIRENT_NAME_MAX) return -ENAMETOOLONG;
+
+  reg_t s         = kernel_lock();
+  tmpfs_node_t *c = tmpfs_find_locked(tmpfs_vi(dir), name, len);
+  if (c) vnode_get_locked(&c->vn);
+  kernel_unlock(s);
+
+  if (!c) return -ENOENT;
+  *out = &c->vn;
+  return 0;
+}
+
+static int
+tmpfs_create(vnode_t *dir, const char *name, size_t len, vnode_t **out)
+{
+  if (len == 0) return -EINVAL;
+  if (len > DIRENT_NAME_MAX) return -ENAMETOOLONG;
+
+  reg_t s         = kernel_lock();
+  tmpfs_node_t *c = tmpfs_find_locked(tmpfs_vi(dir), name, len);
+  if (!c) c = tmpfs_node_alloc_locked(tmpfs_vi(dir), name, len, STAT_T_FILE);
+  if (c) vnode_get_locked(&c->vn);
+  kernel_unlock(s);
+
+  if (!c) return -ENOSPC;
+  *out = &c->vn;
+  return 0;
+}
+
+static long
+tmpfs_read(vnode_t *vn, uint64_t *off, void *buf, uint64_t len)
+{
+  tmpfs_node_t *n = tmpfs_vi(vn);
+  uint8_t *dst    = (uint8_t *)buf;
+
+  sleep_lock(&n->lock);
+  const uint64_t pos0 = *off;
+  if (pos0 >= n->size) len = 0;
+  if (len > n->size - pos0) len = n->size - pos0;
+
+  uint64_t done = 0;
+  while (done < len) {
+    uint64_t pos = pos0 + done;
+    uint64_t po  = pos & (TMPFS_PAGE_SIZE - 1u);
+    uint64_t cnt = TMPFS_PAGE_SIZE - po;
+    if (cnt > len - done) cnt = len - done;
+
+    const uint8_t *pg = tmpfs_radix_lookup(n, pos >> TMPFS_PAGE_SHIFT);
+    if (pg) {
+      memcpy(dst + done, pg + po, cnt);
+    } else {
+      memset(dst + done, 0, cnt);  /* 洞 */
+    }
+    done += cnt;
+  }
+  sleep_unlock(&n->lock);
+
+  *off = pos0 + done;
+  return (long)done;
+}
+
+static long
+tmpfs_write(vnode_t *vn, uint64_t *off, const void *buf, uint64_t len)
+{
+  tmpfs_node_t *n    = tmpfs_vi(vn);
+  const uint8_t *src = (const uint8_t *)buf;
+  int err            = 0;
+
+  sleep_lock(&n->lock);
+  const uint64_t pos0 = (*off == VFS_OFF_APPEND) ? n->size : *off;
+  if (pos0 + len < pos0) len = 0;
+
+  uint64_t done = 0;
+  while (done < len) {
+    uint64_t pos = pos0 + done;
+    uint64_t po  = pos & (TMPFS_PAGE_SIZE - 1u);
+    uint64_t cnt = TMPFS_PAGE_SIZE - po;
+    if (cnt > len - done) cnt = len - done;
+
+    void **slot = tmpfs_radix_slot(n, pos >> TMPFS_PAGE_SHIFT, &err);
+    if (!slot) break;
+    if (!*slot) {
+      /* 整页覆盖就不用先清零 */
+      *slot = tmpfs_page_alloc(cnt != TMPFS_PAGE_SIZE);
+      if (!*slot) {
+        err = -ENOSPC;
+        break;
+      }
+      n->npages++;
+    }
+    memcpy((uint8_t *)*slot + po, src + done, cnt);
+    done += cnt;
+  }
+  if (done && pos0 + done > n->size) n->size = pos0 + done;
+  if (done) n->mtime = tmpfs_now();
+  sleep_unlock(&n->lock);
+
+  if (done == 0 && err < 0) return err;
+  *off = pos0 + done;
+  return (long)done;
+}
+
+static int
+tmpfs_truncate(vnode_t *vn)
+{
+  tmpfs_node_t *n = tmpfs_vi(vn);
+
+  sleep_lock(&n->lock);
+  if (n->root) {
+    reg_t s = kernel_lock();
+    tmpfs_radix_free_locked(n->root, n->height);
+    kernel_unlock(s);
+  }
+  n->root   = NULL;
+  n->height = 0;
+  n->npages = 0;
+  n->size   = 0;
+  n->mtime  = tmpfs_now();
+  sleep_unlock(&n->lock);
+  return 0;
+}
+
+static void
+tmpfs_stat(vnode_t *vn, struct stat_user *st)
+{
+  tmpfs_node_t *n = tmpfs_vi(vn);
+  st->type        = vn->type;
+  st->dev         = STAT_DEV_NONE;
+  st->ino         = n->ino;
+  st->size        = (vn->type == STAT_T_DIR) ? n->nchild : n->size;
+  st->blocks      = (uint64_t)n->npages * (TMPFS_PAGE_SIZE / 1024u);
+  st->mtime       = n->mtime;
+}
+
+/* *off = 已经跳过的子项个数（新建的插在链表头，列表中途可能重复一项） */
+static long
+tmpfs_readdir(vnode_t *dir, uint64_t *off, struct dirent_user *out, uint32_t n)
+{
+  uint32_t cnt = 0;
+  uint64_t idx = 0;
+
+  reg_t s = kernel_lock();
+  for (tmpfs_node_t *c = tmpfs_vi(dir)->child; c && cnt < n; c = c->next) {
+    if (idx++ < *off) continue;
+    out[cnt].ino  = c->ino;
+    out[cnt].type = c->vn.type;
+    memcpy(out[cnt].name, c->name, sizeof(out[cnt].name));
+    cnt++;
+  }
+  kernel_unlock(s);
+
+  *off += cnt;
+  return cnt;
+}
+
+static const vnode_ops_t s_tmpfs_ops = {
+    .lookup   = tmpfs_lookup,
+    .create   = tmpfs_create,
+    .read     = tmpfs_read,
+    .write    = tmpfs_write,
+    .truncate = tmpfs_truncate,
+    .stat     = tmpfs_stat,
+    .readdir  = tmpfs_readdir,
+};
+
+/* -------------------------------------------------------------------------- */
+/* Init                                                                       */
+/* -------------------------------------------------------------------------- */
+
+int
+tmpfs_init(void)
+{
+  const uint64_t size = (uint64_t)CONFIG_TMPFS_SIZE_MB << 20;
+  if (size == 0) return -ENODEV;
+
+  const uintptr_t base = ((uintptr_t)__image_end + TMPFS_PAGE_SIZE - 1u) &
+                         ~(uintptr_t)(TMPFS_PAGE_SIZE - 1u);
+  const uintptr_t end  = base + size;
+  const uintptr_t rd   = (uintptr_t)CONFIG_RAMDISK_BASE;
+  const uintptr_t rd_end = rd + ((uint64_t)CONFIG_RAMDISK_SIZE_MB << 20);
+  if (end > (uintptr_t)__stack_bottom || (rd < end && base < rd_end)) {
+    pr_warn("tmpfs: page pool 0x%lx-0x%lx overlaps the boot stack or ram0",
+            (unsigned long)base, (unsigned long)end);
+    return -EINVAL;
+  }
+
+  s_pool.brk    = base;
+  s_pool.end    = end;
+  s_pool.npages = (uint32_t)(size / TMPFS_PAGE_SIZE);
+
+  reg_t s            = kernel_lock();
+  tmpfs_node_t *root = tmpfs_node_alloc_locked(NULL, "", 0, STAT_T_DIR);
+  root->vn.refcnt    = 1;  /* 挂载表的引用 */
+  kernel_unlock(s);
+
+  int rc = vfs_mount("/tmp", &root->vn);
+  if (rc < 0) return rc;
+
+  pr_info("tmpfs: /tmp, %u pages (%llu KiB) at 0x%lx", s_pool.npages,
+          (unsigned long long)(size >> 10), (unsigned long)base);
+  return 0;
+}
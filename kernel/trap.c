@@ -4,16 +4,19 @@
 #include <time.h>
 
 #include "cpu.h"
+#include "cpustat.h"
+#include "ksyscall.h"
 #include "lock.h"
 #include "log.h"
 #include "panic.h"
 #include "platform.h"
 #include "riscv_csr.h"
 #include "sched.h"
-#include "sysfile.h"
+#include "softirq.h"
 #include "thread.h"
 #include "trap.h"
-#include "usyscall.h"
+#include "fpu.h"
+#include "vector.h"
 
 #ifndef NDEBUG
 extern void print_thread_prefix(void);
@@ -91,6 +94,14 @@ trap_init(void)
   csr_write(stvec, val);
 }
 
+/* 陷入指令长度：RVC 构建里 ebreak 可能是 2 字节的 c.ebreak（没有 MMU，直接读） */
+static inline uintptr_t
+trap_insn_len(uintptr_t pc)
+{
+  uint16_t lo = *(const volatile uint16_t *)pc;
+  return ((lo & 3u) == 3u) ? 4u : 2u;
+}
+
 static void
 breakpoint_handler(struct trapframe *tf)
 {
@@ -117,7 +128,7 @@ breakpoint_handler(struct trapframe *tf)
     /* 用户态 ebreak：类似 SIGTRAP
      * 策略：跳过 ebreak，然后把当前线程干掉，避免用户态死循环。
      */
-    tf->sepc = sepc + 4;
+    tf->sepc = sepc + trap_insn_len(sepc);
     thread_sys_exit(tf, -1);  /* 不一定会返回（内部可能 schedule） */
     return;
   }
@@ -125,7 +136,7 @@ breakpoint_handler(struct trapframe *tf)
   /* 内核态 ebreak：大多数就是你写的 BREAK_IF()
    * Debug 下默认策略：打印一堆信息，然后跳过 ebreak 继续执行。
    */
-  tf->sepc = sepc + 4;
+  tf->sepc = sepc + trap_insn_len(sepc);
   return;
 
 #else /* NDEBUG */
@@ -138,99 +149,36 @@ breakpoint_handler(struct trapframe *tf)
 #endif /* NDEBUG */
 }
 
-static void
-syscall_handler(struct trapframe *tf)
+static inline uint32_t
+trap_stat_class(reg_t scause)
 {
-  const uintptr_t sys_id = tf->a0;
-
-  uint64_t nwrite, nread;
-
-  tf->sepc += 4;
-
-  switch (sys_id) {
-    case SYS_SLEEP:
-      thread_sys_sleep(tf, tf->a1);
-      /* 里面可能 schedule() */
-      break;
-    case SYS_THREAD_EXIT:
-      thread_sys_exit(tf, (int)tf->a1);
-      /* 通常不会“回到这个线程”的 trap_return */
-      break;
-    case SYS_THREAD_JOIN:
-      thread_sys_join(tf, (tid_t)tf->a1, tf->a2);
-      /* 阻塞情况下，thread_sys_join 内部会调用 schedule() */
-      break;
-    case SYS_THREAD_CREATE:
-      thread_sys_create(tf, (thread_entry_t)tf->a1, (void *)tf->a2,
-                        (const char *)tf->a3);
-      break;
-    case SYS_THREAD_KILL: {
-      tid_t tid = (tid_t)tf->a1;
-      thread_sys_kill(tf, tid);
-      /* 返回值已经在 thread_sys_kill 里写入 tf->a0 了 */
-      break;
-    }
-    case SYS_THREAD_LIST: {
-      struct u_thread_info *ubuf = (struct u_thread_info *)tf->a1;
-      int max                    = (int)tf->a2;
-      int n                      = thread_sys_list(ubuf, max);
-      tf->a0                     = (reg_t)n;
-      break;
-    }
-    case SYS_WRITE:
-      nwrite = sys_write((int)tf->a1, (const char *)tf->a2, (uint64_t)tf->a3);
-      tf->a0 = nwrite;
-      break;
-    case SYS_READ: {
-      int is_non_block_read = 0;
-      nread = sys_read((int)tf->a1, (char *)tf->a2, (uint64_t)tf->a3, tf,
-                       &is_non_block_read);
-      if (is_non_block_read) {
-        tf->a0 = nread;
-      } else {
-        /* 阻塞 read：
-         * - sys_read 应该已经把当前线程挂到等待队列并 schedule()
-         * - 被唤醒时，唤醒方会写回 t->tf.a0（你在 thread.c 里已经这么做了）
-         */
-      }
-      break;
+  const reg_t code = scause_code(scause);
+  if (scause_is_interrupt(scause)) {
+    switch (code) {
+      case IRQ_EXT_S:   return CPUSTAT_TRAP_EXT;
+      case IRQ_TIMER_S: return CPUSTAT_TRAP_TIMER;
+      case IRQ_SOFT_S:  return CPUSTAT_TRAP_IPI;
+      default:          return CPUSTAT_TRAP_OTHER;
     }
-    case SYS_CLOCK_GETTIME:
-      tf->a0 = sys_clock_gettime((int)tf->a1, (struct timespec *)tf->a2);
-      break;
-    case SYS_IRQ_GET_STATS:
-      tf->a0 = sys_irq_get_stats((struct irqstat_user *)tf->a1, (size_t)tf->a2);
-      break;
-    case SYS_GET_HARTID:
-      tf->a0 = (reg_t)cpu_current_hartid();
-      break;
-    case SYS_YIELD:
-      thread_sys_yield(tf);
-      break;
-    case SYS_THREAD_DETACH:
-      thread_sys_detach(tf, (tid_t)tf->a1);
-      break;
-    case SYS_RUNQUEUE_SNAPSHOT:
-      tf->a0 = sys_runqueue_snapshot((struct rq_state *)tf->a1,
-                                     (size_t)tf->a2);
-      break;
-    default:
-      dump_trap(tf);
-      panic("unknown syscall");
-      break;
   }
+  return (code == EXC_ENV_CALL_U) ? CPUSTAT_TRAP_SYSCALL : CPUSTAT_TRAP_OTHER;
 }
 
 struct trapframe *
 trap_entry_c(struct trapframe *tf)
 {
-  reg_t irq_state = kernel_lock();
-  struct trapframe *ret;
-
+  const uint64_t t0       = platform_time_now();
   const reg_t scause      = tf->scause;
   const uintptr_t sstatus = tf->sstatus;
   const reg_t code        = scause_code(scause);
 
+  /* 只读的 introspection syscall 不抢大锁：mon 轮询不会挡住别的 hart 调度。
+   * trap 里 SIE 已被硬件清掉，免锁路径不需要再关中断。
+   */
+  const int locked = scause_is_interrupt(scause) || code != EXC_ENV_CALL_U ||
+                     !syscall_is_lockless(tf->a0);
+  reg_t irq_state = locked ? kernel_lock() : 0;
+
 #ifndef NDEBUG
   /* Debug helpers:
    * const unsigned long old_sepc   = tf->sepc;
@@ -263,6 +211,7 @@ trap_entry_c(struct trapframe *tf)
         goto handled;
       case IRQ_EXT_S:
         platform_handle_s_external(tf);
+        softirq_irq_exit(tf);  /* 上半部留下的活交给本 hart 的 kworker */
         goto handled;
       default:
         break;  /* 落到下面的“未处理 trap” */
@@ -276,9 +225,15 @@ trap_entry_c(struct trapframe *tf)
         breakpoint_handler(tf);
         goto handled;
       case EXC_ILLEGAL_INSTR:
+        /* 用户线程第一次用向量/FP 指令：按操作码惰性打开 VS/FS 后重新执行。
+         * 向量浮点两样都要，会先后陷入两次；别的非法指令两边都不认 */
+        if ((sstatus & SSTATUS_SPP) == 0 &&
+            (fpu_first_use(tf) || vector_first_use(tf))) {
+          goto handled;
+        }
         if ((sstatus & SSTATUS_SPP) != 0 && g_illegal_probe_enabled) {
           g_illegal_probe_hit = 1;
-          tf->sepc += 4;
+          tf->sepc += trap_insn_len(tf->sepc);
           goto handled;
         }
         platform_puts("Illegal instruction\n");
@@ -305,9 +260,23 @@ handled:
    */
 #endif
 
-  ret = cpu_this()->cur_tf;
-  kernel_unlock(irq_state);
-  return ret;
+  /* 锁留给 trap_exit_c：trap.S 要先把 prev 的 s0..s11 落盘 */
+  cpu_t *c          = cpu_this();
+  c->trap_irq_state = irq_state;
+  c->trap_locked    = (uint32_t)locked;
+  c->trap_class     = trap_stat_class(scause);
+  c->trap_t0        = t0;
+  return c->cur_tf;
+}
+
+void
+trap_exit_c(void)
+{
+  cpu_t *c = cpu_this();
+  cpustat_trap(c->trap_class, platform_time_now() - c->trap_t0);
+  if (c->trap_locked) {
+    kernel_unlock(c->trap_irq_state);
+  }
 }
 
 /* ---------- 调试用：打印完整 trap 信息 ---------- */
@@ -0,0 +1,418 @@
+/* kernel/uring.c */
+
+/*
+ * 批量 syscall ring（见 include/uapi/uring.h）。
+ *
+ *  - SYS_RING_ENTER：在一次陷入里把 SQ 里的请求依次做完，CQE 同步写回。
+ *  - SQPOLL：一个内核线程 "uring-sqpoll" 轮询所有 SQPOLL ring，用户只写内存，
+ *    不陷入。空闲约 URING_SQPOLL_IDLE_US 后置 URING_SQ_NEED_WAKEUP 并阻塞，
+ *    由 SYS_RING_ENTER(URING_ENTER_SQ_WAKEUP) 叫醒。
+ *
+ *  - READ/WRITE 的 fd 按 ring 主人的 fd 表解析：控制台、管道、evfd 持锁不阻塞
+ *    地做；普通文件要读盘，不持锁做（enter 交给 sysworker，SQPOLL 线程自己放锁做），
+ *    做完这条再补 CQE。
+ *
+ * ring 只在 g_kernel_lock 下访问（SQPOLL 线程的扫描也是），注销 / 回收线程也持
+ * 同一把锁，所以注销返回后内核不会再碰那块内存。唯一的例外是不持锁做普通文件
+ * 读写的那段：只用拷出来的 SQE，补 CQE 前重新确认主人和 ring 都没变；这期间
+ * 重新注册这块 ring 返回 -EBUSY。
+ */
+
+#include <stdint.h>
+
+#include "cpu.h"
+#include "futex.h"
+#include "kuring.h"
+#include "lock.h"
+#include "log.h"
+#include "platform.h"
+#include "runqueue.h"
+#include "sysfile.h"
+#include "sysworker.h"
+#include "thread.h"
+#include "trap.h"
+#include "uerrno.h"
+#include "utime.h"
+#include "vfs.h"
+
+#define URING_SQPOLL_IDLE_US 1000u
+
+static tid_t s_sqpoll_tid = -1;
+static struct uring *s_sqpoll_inflight;  /* SQPOLL 线程正不持锁做着它的一条 SQE */
+
+static void uring_sqpoll_main(void *arg) __attribute__((noreturn));
+
+static inline void
+uring_fence_rw(void)
+{
+  __asm__ volatile("fence rw,rw" ::: "memory");
+}
+
+static inline uint32_t
+uring_cq_entries(const struct uring *r)
+{
+  return 2u * r->entries;
+}
+
+static inline int
+uring_sq_pending(const struct uring *r)
+{
+  return r->sq_tail != r->sq_head;
+}
+
+static inline int
+uring_cq_full(const struct uring *r)
+{
+  return (uint32_t)(r->cq_tail - r->cq_head) >= uring_cq_entries(r);
+}
+
+static void
+uring_post_cqe(struct uring *r, uint64_t user_data, int64_t res)
+{
+  struct uring_cqe *cqe = &r->cqes[r->cq_tail & (uring_cq_entries(r) - 1u)];
+  cqe->user_data        = user_data;
+  cqe->res              = res;
+  __asm__ volatile("fence w,w" ::: "memory");
+  r->cq_tail++;
+}
+
+/* 主人线程 + 它当时的 slot_seq：不持锁的那段之后用来确认 ring 还是那一个 */
+static inline uint64_t
+uring_owner_key(tid_t tid)
+{
+  return ((uint64_t)g_threads[tid].slot_seq.seq << 32) | (uint32_t)tid;
+}
+
+static int
+uring_owner_live(uint64_t key, const struct uring *r)
+{
+  const Thread *t = &g_threads[(tid_t)(uint32_t)key];
+  return t->slot_seq.seq == (uint32_t)(key >> 32) && t->ring == r &&
+         t->state != THREAD_UNUSED && t->state != THREAD_ZOMBIE;
+}
+
+/* 持锁、不阻塞地执行一条 SQE，返回结果或 -errno。
+ * 普通文件的读写要读盘：*slow 带回 file 的一个引用，结果无意义，调用方不持锁
+ * 做完（uring_finish_slow）再补 CQE。 */
+static int64_t
+uring_do_sqe(Thread *owner, const struct uring_sqe *sqe, file_t **slow)
+{
+  *slow = NULL;
+  switch (sqe->op) {
+    case URING_OP_NOP:
+      return 0;
+
+    case URING_OP_WRITE:
+    case URING_OP_READ:
+      return vfs_rw_nonblock_locked(owner->files, sqe->fd,
+                                    (void *)(uintptr_t)sqe->addr, sqe->len,
+                                    sqe->op == URING_OP_WRITE, slow);
+
+    case URING_OP_CLOCK_GETTIME:
+      if (sys_clock_gettime(sqe->fd,
+                            (struct timespec *)(uintptr_t)sqe->addr) != 0) {
+        return -EINVAL;
+      }
+      return 0;
+
+    case URING_OP_FUTEX_WAKE: {
+      volatile uint32_t *addr = (volatile uint32_t *)(uintptr_t)sqe->addr;
+      if (!addr || ((uintptr_t)addr & 3u)) return -EINVAL;
+      return futex_wake_locked(addr, (uint32_t)sqe->len);
+    }
+
+    case URING_OP_SLEEP:
+    case URING_OP_FUTEX_WAIT:
+      /* 会阻塞的只在非 SQPOLL 的 enter 里做；SQPOLL 线程不能替用户睡 */
+      return -EINVAL;
+
+    default:
+      return -EINVAL;
+  }
+}
+
+/* 不持锁：做完队头那条普通文件 SQE（已拷到 sqe），放掉 f 的引用；主人和 ring
+ * 都没变才补 CQE、推进 sq_head */
+static void
+uring_finish_slow(file_t *f, const struct uring_sqe *sqe, struct uring *r,
+                  uint64_t owner)
+{
+  long res = vfs_file_rw(f, (void *)(uintptr_t)sqe->addr, sqe->len,
+                         sqe->op == URING_OP_WRITE);
+
+  reg_t s = kernel_lock();
+  if (uring_owner_live(owner, r)) {
+    uring_post_cqe(r, sqe->user_data, res);
+    r->sq_head++;
+  }
+  kernel_unlock(s);
+}
+
+/* sysworker：enter 遇到普通文件时，主人阻塞着，这条做完再把 ret 交回 a0 */
+static long
+uring_slow_worker(uint64_t fp, uint64_t rp, uint64_t owner, uint64_t ret)
+{
+  file_t *f       = (file_t *)(uintptr_t)fp;
+  struct uring *r = (struct uring *)(uintptr_t)rp;
+  struct uring_sqe sqe;
+
+  reg_t s  = kernel_lock();
+  int live = uring_owner_live(owner, r);
+  if (live) {
+    sqe = r->sqes[r->sq_head & (r->entries - 1u)];
+  } else {
+    file_put_locked(f);
+  }
+  kernel_unlock(s);
+
+  if (live) uring_finish_slow(f, &sqe, r, owner);
+  return (long)ret;
+}
+
+/* 持锁消费最多 max 条 SQE（CQ 满了就停），返回处理条数。
+ * 遇到普通文件的读写就停在它上面（不消费），*slow 带回 file 的引用。 */
+static uint32_t
+uring_drain(Thread *owner, struct uring *r, uint32_t max, file_t **slow)
+{
+  uint32_t done = 0;
+
+  *slow = NULL;
+  while (done < max && uring_sq_pending(r) && !uring_cq_full(r)) {
+    __asm__ volatile("fence r,r" ::: "memory");  /* sq_tail -> sqe */
+
+    const struct uring_sqe *sqe = &r->sqes[r->sq_head & (r->entries - 1u)];
+    int64_t res                 = uring_do_sqe(owner, sqe, slow);
+    if (*slow) break;
+    uring_post_cqe(r, sqe->user_data, res);
+    r->sq_head++;
+    done++;
+  }
+
+  return done;
+}
+
+/* -------------------------------------------------------------------------- */
+/* SQPOLL thread                                                              */
+/* -------------------------------------------------------------------------- */
+
+/* 持锁：t 注册了 SQPOLL ring 且还活着时返回它 */
+static struct uring *
+uring_sqpoll_ring(const Thread *t)
+{
+  if (!(t->ring_flags & URING_SETUP_SQPOLL) || t->state == THREAD_UNUSED ||
+      t->state == THREAD_ZOMBIE) {
+    return NULL;
+  }
+  return t->ring;
+}
+
+static int
+uring_sqpoll_has_work_locked(void)
+{
+  for (int i = 0; i < THREAD_MAX; ++i) {
+    const struct uring *r = uring_sqpoll_ring(&g_threads[i]);
+    if (r && uring_sq_pending(r)) return 1;
+  }
+  return 0;
+}
+
+static void
+uring_sqpoll_set_need_wakeup_locked(int on)
+{
+  for (int i = 0; i < THREAD_MAX; ++i) {
+    struct uring *r = uring_sqpoll_ring(&g_threads[i]);
+    if (!r) continue;
+    if (on) {
+      r->sq_flags |= URING_SQ_NEED_WAKEUP;
+    } else {
+      r->sq_flags &= ~URING_SQ_NEED_WAKEUP;
+    }
+  }
+}
+
+/* 持锁进来、持锁出去（中间放过锁，返回新的 sstatus）：扫一遍所有 SQPOLL ring，
+ * *done 累加处理的条数 */
+static reg_t
+uring_sqpoll_scan(reg_t s, uint32_t *done)
+{
+  for (int i = 0; i < THREAD_MAX; ++i) {
+    Thread *t       = &g_threads[i];
+    struct uring *r = uring_sqpoll_ring(t);
+    if (!r) continue;
+
+    file_t *slow = NULL;
+    *done += uring_drain(t, r, r->entries, &slow);
+    if (!slow) continue;
+
+    /* 普通文件：拷出 SQE，放锁去读写；期间这块 ring 不许重新注册 */
+    struct uring_sqe sqe = r->sqes[r->sq_head & (r->entries - 1u)];
+    uint64_t owner       = uring_owner_key((tid_t)i);
+    s_sqpoll_inflight    = r;
+    kernel_unlock(s);
+
+    uring_finish_slow(slow, &sqe, r, owner);
+
+    s                 = kernel_lock();
+    s_sqpoll_inflight = NULL;
+    (*done)++;
+  }
+  return s;
+}
+
+static void
+uring_sqpoll_main(void *arg)
+{
+  (void)arg;
+  const uint64_t idle_ticks =
+      (uint64_t)platform_timebase_hz() * URING_SQPOLL_IDLE_US / 1000000u;
+  uint64_t last_work = platform_time_now();
+
+  for (;;) {
+    uint32_t done = 0;
+    reg_t s       = kernel_lock();
+    s             = uring_sqpoll_scan(s, &done);
+
+    if (done || platform_time_now() - last_work < idle_ticks) {
+      kernel_unlock(s);
+      if (done) last_work = platform_time_now();
+      if (rq_len(cpu_current_hartid()) > 0) thread_kern_yield();
+      continue;
+    }
+
+    /* 空闲：先告诉用户要叫醒我们，再复查一次，避免丢提交 */
+    uring_sqpoll_set_need_wakeup_locked(1);
+    uring_fence_rw();
+    if (!uring_sqpoll_has_work_locked()) {
+      thread_kern_block_locked();
+    }
+    kernel_unlock(s);  /* 阻塞的话在这里陷入，被唤醒后从这里继续 */
+
+    s = kernel_lock();
+    uring_sqpoll_set_need_wakeup_locked(0);
+    kernel_unlock(s);
+    last_work = platform_time_now();
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Syscalls                                                                   */
+/* -------------------------------------------------------------------------- */
+
+long
+sys_ring_setup(struct uring *ring, uint32_t entries, uint32_t flags)
+{
+  Thread *cur = &g_threads[thread_current()];
+
+  if (!cur->is_user) return -EPERM;
+  if (flags & ~URING_SETUP_SQPOLL) return -EINVAL;
+
+  /* SQPOLL 线程正不持锁做着这块 ring 上的一条：等它补完 CQE 再换 */
+  if (cur->ring && cur->ring == s_sqpoll_inflight) return -EBUSY;
+
+  if (!ring) {
+    /* 注销 */
+    cur->ring       = NULL;
+    cur->ring_flags = 0;
+    return 0;
+  }
+
+  if (entries == 0 || entries > URING_MAX_ENTRIES ||
+      (entries & (entries - 1u)) != 0) {
+    return -EINVAL;
+  }
+
+  if ((flags & URING_SETUP_SQPOLL) && s_sqpoll_tid < 0) {
+    s_sqpoll_tid = thread_create_kern(uring_sqpoll_main, NULL, "uring-sqpoll");
+    if (s_sqpoll_tid < 0) return -ENOMEM;
+    pr_info("uring: sqpoll thread tid=%d", s_sqpoll_tid);
+  }
+
+  ring->sq_head       = 0;
+  ring->sq_tail       = 0;
+  ring->cq_head       = 0;
+  ring->cq_tail       = 0;
+  ring->entries       = entries;
+  ring->setup_flags   = flags;
+  ring->sq_flags      = 0;
+  ring->cq_overflow   = 0;
+  ring->sq_local_tail = 0;
+  uring_fence_rw();
+
+  cur->ring       = ring;
+  cur->ring_flags = flags;
+
+  if (flags & URING_SETUP_SQPOLL) thread_wake(s_sqpoll_tid);
+  return 0;
+}
+
+void
+sys_ring_enter(struct trapframe *tf, uint32_t to_submit, uint32_t min_complete,
+               uint32_t flags)
+{
+  (void)min_complete;  /* 目前全部同步完成，返回时 CQE 已就绪 */
+
+  Thread *cur     = &g_threads[thread_current()];
+  struct uring *r = cur->ring;
+
+  if (!r) {
+    tf->a0 = (reg_t)-EINVAL;
+    return;
+  }
+
+  if (cur->ring_flags & URING_SETUP_SQPOLL) {
+    if ((flags & URING_ENTER_SQ_WAKEUP) && s_sqpoll_tid >= 0) {
+      thread_wake(s_sqpoll_tid);
+    }
+    tf->a0 = 0;
+    return;
+  }
+
+  uint32_t done = 0;
+  while (done < to_submit && uring_sq_pending(r) && !uring_cq_full(r)) {
+    __asm__ volatile("fence r,r" ::: "memory");
+
+    const struct uring_sqe *sqe = &r->sqes[r->sq_head & (r->entries - 1u)];
+    if (sqe->op == URING_OP_SLEEP) {
+      /* 睡眠结束才返回；剩下的 SQE 留给下一次 enter */
+      uint64_t ticks = sqe->len;
+      uring_post_cqe(r, sqe->user_data, 0);
+      r->sq_head++;
+      tf->a0 = (reg_t)(done + 1u);
+      thread_sys_sleep(tf, ticks);
+      return;
+    }
+
+    if (sqe->op == URING_OP_FUTEX_WAIT) {
+      volatile uint32_t *addr = (volatile uint32_t *)(uintptr_t)sqe->addr;
+      int rc = (!addr || ((uintptr_t)addr & 3u))
+                   ? -EINVAL
+                   : futex_wait_queue_locked(addr, (uint32_t)sqe->len);
+      uring_post_cqe(r, sqe->user_data, rc);
+      r->sq_head++;
+      done++;
+      if (rc < 0) continue;
+      /* 已入队：被 wake 才返回，剩下的 SQE 留给下一次 enter */
+      tf->a0 = (reg_t)done;
+      thread_block(tf);
+      return;
+    }
+
+    file_t *slow = NULL;
+    done += uring_drain(cur, r, 1, &slow);
+    if (slow) {
+      /* 普通文件要读盘：交给 sysworker，做完这条才返回，剩下的留给下一次 enter */
+      if (sysworker_call(tf, uring_slow_worker, (uint64_t)(uintptr_t)slow,
+                         (uint64_t)(uintptr_t)r,
+                         uring_owner_key(thread_current()), done + 1u) < 0) {
+        file_put_locked(slow);
+        uring_post_cqe(r, sqe->user_data, (int64_t)tf->a0);
+        r->sq_head++;
+        done++;
+        continue;
+      }
+      return;
+    }
+  }
+
+  tf->a0 = (reg_t)done;
+}
@@ -0,0 +1,90 @@
+/* kernel/vdso.c */
+
+#include <stdint.h>
+
+#include "cpu.h"
+#include "log.h"
+#include "vdso.h"
+
+/*
+ * 放在 .bss.vdso：链接脚本把它单独对齐到一页，并导出 __vdso_data。
+ * 只有内核写；写者之间由调用方保证串行（boot 阶段 / g_kernel_lock）。
+ */
+struct vdso_data g_vdso_data
+    __attribute__((section(".bss.vdso"), aligned(VDSO_PAGE_SIZE)));
+
+static inline void
+vdso_write_begin(struct vdso_data *vd)
+{
+  vd->seq++;
+  __asm__ volatile("fence w,w" ::: "memory");
+}
+
+static inline void
+vdso_write_end(struct vdso_data *vd)
+{
+  __asm__ volatile("fence w,w" ::: "memory");
+  vd->seq++;
+}
+
+void
+vdso_set_hwcap(uint64_t hwcap, uint32_t vlenb)
+{
+  struct vdso_data *vd = &g_vdso_data;
+
+  vd->hwcap |= hwcap;
+  if (hwcap & VDSO_HWCAP_V) {
+    vd->vlenb = vlenb;
+  }
+  __asm__ volatile("fence w,w" ::: "memory");
+}
+
+/* threads_init 里写一次：用户态按 sp 算自己的 tid */
+void
+vdso_set_thread_stacks(uintptr_t base, uint32_t stride, uint32_t n)
+{
+  struct vdso_data *vd = &g_vdso_data;
+
+  vd->stack_base = base;
+  vd->nr_stacks  = n;
+  __asm__ volatile("fence w,w" ::: "memory");
+  vd->stack_stride = stride;  /* 最后写：用户态见到非 0 才用 */
+}
+
+void
+vdso_hart_online(uint32_t hartid)
+{
+  if (hartid >= MAX_HARTS) return;
+
+  g_vdso_data.harts[hartid].hartid = hartid;
+  g_vdso_data.harts[hartid].online = 1;
+}
+
+void
+vdso_init(uint32_t timebase_hz, uint64_t base_ticks, uint64_t base_real_ns,
+          uint64_t boot_real_ns)
+{
+  struct vdso_data *vd = &g_vdso_data;
+
+  if (timebase_hz == 0) {
+    PANICF("vdso_init: timebase_hz == 0");
+  }
+
+  vdso_write_begin(vd);
+  vd->timebase_hz  = timebase_hz;
+  vd->mult         = (1000000000ull << VDSO_MULT_SHIFT) / timebase_hz;
+  vd->base_ticks   = base_ticks;
+  vd->base_real_ns = base_real_ns;
+  vd->boot_real_ns = boot_real_ns;
+  vd->cpu_base     = (uintptr_t)&g_cpus[0];
+  vd->cpu_stride   = (uint32_t)sizeof(cpu_t);
+  vd->nr_harts     = MAX_HARTS;
+  vdso_write_end(vd);
+
+  /* ready 之后用户态才会走快速路径，否则回落到 syscall */
+  __asm__ volatile("fence w,w" ::: "memory");
+  vd->ready = 1;
+
+  pr_info("vdso: data=%p hz=%u mult=0x%llx", (void *)vd, timebase_hz,
+          (unsigned long long)vd->mult);
+}
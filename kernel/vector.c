@@ -0,0 +1,151 @@
+/* kernel/vector.c */
+
+#include <stdint.h>
+
+#include "arch.h"
+#include "cpu.h"
+#include "log.h"
+#include "percpu.h"
+#include "platform.h"
+#include "riscv_csr.h"
+#include "riscv_insn.h"
+#include "thread.h"
+#include "trap.h"
+#include "vdso.h"
+#include "vector.h"
+
+#define VSTATE_SIZE (ARCH_VSTATE_HDR + 32u * VECTOR_VLENB_MAX)
+
+static int s_vector_ok;
+static uint32_t s_vlenb;
+
+/* 每线程保存区；s_vstate_valid[tid] = 保存区里有该线程的状态 */
+static uint8_t s_vstate[THREAD_MAX][VSTATE_SIZE] __attribute__((aligned(16)));
+static uint8_t s_vstate_valid[THREAD_MAX];
+
+/* 每个 hart 的向量寄存器里现在是谁的状态（-1 = 没有/不可信） */
+static DEFINE_PER_CPU(tid_t, s_vowner);
+
+/* sstatus.VS 是 WARL：没有 V 时写不进去 */
+static int
+vector_probe_vs(void)
+{
+  reg_t old = csr_read(sstatus);
+  csr_set(sstatus, SSTATUS_VS_INITIAL);
+  int ok = (csr_read(sstatus) & SSTATUS_VS_MASK) != 0;
+  csr_write(sstatus, old);
+  return ok;
+}
+
+void
+vector_init(void)
+{
+  for (uint32_t h = 0; h < MAX_HARTS; ++h) {
+    per_cpu(s_vowner, h) = -1;
+  }
+
+  /* misa 只有 M-mode 能读；S-mode 看 DT + VS 字段能否写入 */
+  int dt_v = platform_isa_has_ext('v');
+  int hw_v = vector_probe_vs();
+
+  pr_info("vector: DT riscv,isa %s 'v', sstatus.VS %s", dt_v ? "has" : "lacks",
+          hw_v ? "writable" : "hardwired off");
+  if (!dt_v || !hw_v) {
+    return;
+  }
+
+  reg_t old = csr_read(sstatus);
+  csr_set(sstatus, SSTATUS_VS_INITIAL);
+  s_vlenb = (uint32_t)arch_vector_vlenb();
+  csr_write(sstatus, old);
+
+  if (s_vlenb == 0 || s_vlenb > VECTOR_VLENB_MAX) {
+    pr_warn("vector: VLEN=%u unsupported (max %u), disabled",
+            (unsigned)(s_vlenb * 8u), (unsigned)(VECTOR_VLENB_MAX * 8u));
+    s_vlenb = 0;
+    return;
+  }
+
+  s_vector_ok = 1;
+  vdso_set_hwcap(VDSO_HWCAP_V, s_vlenb);
+  pr_info("vector: RVV enabled, VLEN=%u, lazy context switch",
+          (unsigned)(s_vlenb * 8u));
+}
+
+int
+vector_available(void)
+{
+  return s_vector_ok;
+}
+
+uint32_t
+vector_vlenb(void)
+{
+  return s_vlenb;
+}
+
+int
+vector_first_use(struct trapframe *tf)
+{
+  if (!s_vector_ok) return 0;
+  if ((tf->sstatus & SSTATUS_VS_MASK) != SSTATUS_VS_OFF) {
+    return 0;  /* VS 已开仍然非法：真正的非法指令 */
+  }
+  if (!riscv_insn_is_vector(riscv_insn_fetch(tf->sepc))) {
+    return 0;  /* 不是向量指令：FP 的交给 fpu_first_use，其余照常报错 */
+  }
+
+  cpu_t *c  = cpu_this();
+  tid_t tid = c->current_tid;
+  if (tid < 0 || tid >= THREAD_MAX) return 0;
+
+  /* 内核这边操作向量寄存器也要 VS != Off；sret 时 sstatus 从 tf 恢复 */
+  csr_set(sstatus, SSTATUS_VS_INITIAL);
+
+  reg_t vs = SSTATUS_VS_CLEAN;
+  if (!s_vstate_valid[tid]) {
+    arch_vector_clear();
+    vs = SSTATUS_VS_INITIAL;
+  } else if (per_cpu(s_vowner, c->hartid) != tid) {
+    arch_vector_restore(s_vstate[tid]);
+  }
+
+  /* 其它 hart 上残留的同一线程状态从此作废 */
+  for (uint32_t h = 0; h < MAX_HARTS; ++h) {
+    if (per_cpu(s_vowner, h) == tid) per_cpu(s_vowner, h) = -1;
+  }
+  per_cpu(s_vowner, c->hartid) = tid;
+
+  tf->sstatus = (tf->sstatus & ~SSTATUS_VS_MASK) | vs;
+  return 1;
+}
+
+void
+vector_switch_out(tid_t tid, struct trapframe *tf)
+{
+  if (!s_vector_ok || tid < 0 || tid >= THREAD_MAX) return;
+
+  reg_t vs = tf->sstatus & SSTATUS_VS_MASK;
+  if (vs == SSTATUS_VS_OFF) return;
+
+  if (vs == SSTATUS_VS_DIRTY) {
+    /* 只有这个线程在本 hart 上跑时 VS 才可能非 Off，寄存器就是它的 */
+    csr_set(sstatus, SSTATUS_VS_INITIAL);
+    arch_vector_save(s_vstate[tid]);
+    s_vstate_valid[tid] = 1;
+  }
+  /* Clean/Initial：没写过，保存区（或“全零”）仍然有效 */
+
+  tf->sstatus = (tf->sstatus & ~SSTATUS_VS_MASK) | SSTATUS_VS_OFF;
+}
+
+void
+vector_thread_reset(tid_t tid)
+{
+  if (tid < 0 || tid >= THREAD_MAX) return;
+
+  s_vstate_valid[tid] = 0;
+  for (uint32_t h = 0; h < MAX_HARTS; ++h) {
+    if (per_cpu(s_vowner, h) == tid) per_cpu(s_vowner, h) = -1;
+  }
+}
@@ -0,0 +1,733 @@
+/* kernel/vfs.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "console.h"
+#include "evfd.h"
+#include "lock.h"
+#include "log.h"
+#include "pipe.h"
+#include "sleeplock.h"
+#include "string.h"
+#include "sysfile.h"
+#include "sysworker.h"
+#include "thread.h"
+#include "trap.h"
+#include "uerrno.h"
+#include "vfs.h"
+
+typedef struct {
+  char path[16];  /* "/" 或 "/tmp" */
+  size_t len;
+  vnode_t *root;
+} vfs_mount_t;
+
+static vfs_mount_t s_mounts[VFS_MAX_MOUNTS];
+static uint32_t s_nmounts;
+static int (*s_mount_root)(void);
+static volatile uint32_t s_root_tried;
+static sleeplock_t s_root_lock = SLEEPLOCK_INIT;
+
+static file_t s_file_pool[VFS_FILE_MAX];
+static files_t s_files_pool[VFS_FILES_MAX];
+/* 控制台：所有 fd 表共用这两个对象，不回收 */
+static file_t s_console_in  = {.type = FILE_CONSOLE, .refcnt = 1, .flags = O_RDONLY};
+static file_t s_console_out = {.type = FILE_CONSOLE, .refcnt = 1, .flags = O_WRONLY};
+
+void
+vfs_init(int (*mount_root)(void))
+{
+  s_mount_root = mount_root;
+}
+
+int
+vfs_mount(const char *path, vnode_t *root)
+{
+  size_t len = strlen(path);
+  if (!root || path[0] != '/' || len >= sizeof(s_mounts[0].path)) {
+    return -EINVAL;
+  }
+
+  reg_t s = kernel_lock();
+  if (s_nmounts >= VFS_MAX_MOUNTS) {
+    kernel_unlock(s);
+    return -ENOSPC;
+  }
+  vfs_mount_t *m = &s_mounts[s_nmounts];
+  memcpy(m->path, path, len + 1u);
+  m->len  = len;
+  m->root = root;
+  s_nmounts++;
+  kernel_unlock(s);
+  return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* vnode / file refcounts                                                     */
+/* -------------------------------------------------------------------------- */
+
+void
+vnode_get_locked(vnode_t *vn)
+{
+  vn->refcnt++;
+}
+
+void
+vnode_put_locked(vnode_t *vn)
+{
+  ASSERT(vn->refcnt > 0);
+  if (--vn->refcnt == 0 && vn->ops->release) vn->ops->release(vn);
+}
+
+void
+vnode_put(vnode_t *vn)
+{
+  reg_t s = kernel_lock();
+  vnode_put_locked(vn);
+  kernel_unlock(s);
+}
+
+static file_t *
+file_alloc_locked(void)
+{
+  for (uint32_t i = 0; i < VFS_FILE_MAX; ++i) {
+    file_t *f = &s_file_pool[i];
+    if (f->refcnt == 0) {
+      memset(f, 0, sizeof(*f));
+      f->refcnt = 1;
+      return f;
+    }
+  }
+  return NULL;
+}
+
+void
+file_put_locked(file_t *f)
+{
+  ASSERT(f->refcnt > 0);
+  if (--f->refcnt > 0) return;
+
+  ASSERT(f != &s_console_in && f != &s_console_out);
+  if (f->vn) vnode_put_locked(f->vn);
+  if (f->pipe) pipe_release_locked(f->pipe, (f->flags & O_ACCMODE) == O_WRONLY);
+  if (f->ev) evfd_free_locked(f->ev);
+  f->type = FILE_NONE;
+  f->vn   = NULL;
+  f->pipe = NULL;
+  f->ev   = NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* fd tables                                                                  */
+/* -------------------------------------------------------------------------- */
+
+files_t *
+files_new_console(void)
+{
+  for (uint32_t i = 0; i < VFS_FILES_MAX; ++i) {
+    files_t *fs = &s_files_pool[i];
+    if (fs->refcnt != 0) continue;
+
+    memset(fs, 0, sizeof(*fs));
+    fs->refcnt = 1;
+    fs->fd[FD_STDIN]  = &s_console_in;
+    fs->fd[FD_STDOUT] = &s_console_out;
+    fs->fd[FD_STDERR] = &s_console_out;
+    s_console_in.refcnt++;
+    s_console_out.refcnt += 2u;
+    return fs;
+  }
+  return NULL;
+}
+
+int
+files_new_stdio(files_t *from, const int *stdio, files_t **out)
+{
+  file_t *std[3];
+  for (int i = 0; i < 3; ++i) {
+    int src = (stdio && stdio[i] >= 0) ? stdio[i] : i;
+    if (!from || src >= (int)OPEN_MAX || !from->fd[src]) return -EBADF;
+    std[i] = from->fd[src];
+  }
+
+  for (uint32_t i = 0; i < VFS_FILES_MAX; ++i) {
+    files_t *fs = &s_files_pool[i];
+    if (fs->refcnt != 0) continue;
+
+    memset(fs, 0, sizeof(*fs));
+    fs->refcnt = 1;
+    for (int j = 0; j < 3; ++j) {
+      fs->fd[j] = std[j];
+      std[j]->refcnt++;
+    }
+    *out = fs;
+    return 0;
+  }
+  return -ENFILE;
+}
+
+files_t *
+files_get(files_t *fs)
+{
+  fs->refcnt++;
+  return fs;
+}
+
+void
+files_put(files_t *fs)
+{
+  ASSERT(fs->refcnt > 0);
+  if (--fs->refcnt > 0) return;
+
+  for (uint32_t i = 0; i < OPEN_MAX; ++i) {
+    if (fs->fd[i]) {
+      file_put_locked(fs->fd[i]);
+      fs->fd[i] = NULL;
+    }
+  }
+}
+
+uint32_t
+vfs_poll_locked(files_t *fs, int fd, pollq_t **q)
+{
+  *q = NULL;
+  if (!fs || fd < 0 || fd >= (int)OPEN_MAX || !fs->fd[fd]) return POLLNVAL;
+
+  file_t *f = fs->fd[fd];
+  switch (f->type) {
+    case FILE_CONSOLE:
+      return console_poll_locked(q);
+    case FILE_PIPE:
+      return pipe_poll_locked(f->pipe, (f->flags & O_ACCMODE) == O_WRONLY, q);
+    case FILE_EVFD:
+      return evfd_poll_locked(f->ev, q);
+    default:
+      return POLLIN | POLLOUT;
+  }
+}
+
+static files_t *
+files_current(void)
+{
+  return g_threads[thread_current()].files;
+}
+
+/* 持锁：当前线程组的 fd -> file（不加引用） */
+static file_t *
+fd_lookup(int fd)
+{
+  files_t *fs = files_current();
+  if (!fs || fd < 0 || fd >= (int)OPEN_MAX) return NULL;
+  return fs->fd[fd];
+}
+
+static int
+fd_install(files_t *fs, file_t *f)
+{
+  for (int i = 0; i < (int)OPEN_MAX; ++i) {
+    if (!fs->fd[i]) {
+      fs->fd[i] = f;
+      return i;
+    }
+  }
+  return -EMFILE;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Path lookup (kernel threads only)                                          */
+/* -------------------------------------------------------------------------- */
+
+static void
+vfs_mount_root_once(void)
+{
+  if (s_root_tried) return;
+  sleep_lock(&s_root_lock);
+  if (!s_root_tried) {
+    if (s_mount_root) (void)s_mount_root();
+    s_root_tried = 1;
+  }
+  sleep_unlock(&s_root_lock);
+}
+
+/* 最长前缀匹配的挂载点；*rest 指向挂载点之后的部分。返回带引用的根 */
+static vnode_t *
+vfs_find_mount(const char *path, const char **rest)
+{
+  vfs_mount_t *best = NULL;
+
+  reg_t s = kernel_lock();
+  for (uint32_t i = 0; i < s_nmounts; ++i) {
+    vfs_mount_t *m = &s_mounts[i];
+    if (m->len == 1u) {
+      if (!best) best = m;  /* "/" */
+      continue;
+    }
+    if (strnlen(path, m->len) < m->len) continue;
+    if (memcmp(path, m->path, m->len) != 0) continue;
+    if (path[m->len] != '\0' && path[m->len] != '/') continue;
+    if (!best || m->len > best->len) best = m;
+  }
+  vnode_t *root = NULL;
+  if (best) {
+    root  = best->root;
+    *rest = path + (best->len == 1u ? 0u : best->len);
+    vnode_get_locked(root);
+  }
+  kernel_unlock(s);
+  return root;
+}
+
+/* 解析绝对路径；O_CREAT 时最后一段不存在就建普通文件。*out 带一个引用 */
+static int
+vfs_lookup(const char *path, uint32_t flags, vnode_t **out)
+{
+  if (path[0] != '/') return -ENOENT;
+
+  vfs_mount_root_once();
+  const char *p = NULL;
+  vnode_t *vn   = vfs_find_mount(path, &p);
+  if (!vn) return -ENOENT;
+
+  for (;;) {
+    while (*p == '/') p++;
+    if (*p == '\0') break;
+
+    const char *name = p;
+    while (*p && *p != '/') p++;
+    size_t len = (size_t)(p - name);
+    while (*p == '/') p++;
+    int last = (*p == '\0');
+
+    if (vn->type != STAT_T_DIR) {
+      vnode_put(vn);
+      return -ENOTDIR;
+    }
+
+    vnode_t *next = NULL;
+    int rc        = vn->ops->lookup(vn, name, len, &next);
+    if (rc == -ENOENT && last && (flags & O_CREAT)) {
+      rc = vn->ops->create ? vn->ops->create(vn, name, len, &next) : -EPERM;
+    }
+    vnode_put(vn);
+    if (rc < 0) return rc;
+    vn = next;
+  }
+
+  *out = vn;
+  return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* sysworker side                                                             */
+/* -------------------------------------------------------------------------- */
+
+static long
+vfs_open_worker(uint64_t upath, uint64_t flags, uint64_t files_p, uint64_t a4)
+{
+  (void)a4;
+  files_t *fs = (files_t *)(uintptr_t)files_p;
+  const char *src = (const char *)(uintptr_t)upath;
+  char path[PATH_MAX];
+  vnode_t *vn = NULL;
+  reg_t s;
+  long rc;
+
+  size_t len = strnlen(src, PATH_MAX);
+  if (len == PATH_MAX) {
+    rc = -ENAMETOOLONG;
+    goto out;
+  }
+  memcpy(path, src, len + 1u);
+
+  rc = vfs_lookup(path, (uint32_t)flags, &vn);
+  if (rc < 0) goto out;
+
+  const uint32_t acc = (uint32_t)flags & O_ACCMODE;
+  if (vn->type == STAT_T_DIR && acc != O_RDONLY) {
+    rc = -EISDIR;
+  } else if ((flags & O_TRUNC) && acc != O_RDONLY) {
+    rc = vn->ops->truncate ? vn->ops->truncate(vn) : -EPERM;
+  }
+  if (rc < 0) {
+    vnode_put(vn);
+    goto out;
+  }
+
+  s         = kernel_lock();
+  file_t *f = file_alloc_locked();
+  if (!f) {
+    vnode_put_locked(vn);
+    rc = -ENFILE;
+  } else {
+    f->type  = FILE_VNODE;
+    f->flags = (uint32_t)flags & (O_ACCMODE | O_APPEND);
+    f->vn    = vn;
+    rc       = fd_install(fs, f);
+    if (rc < 0) file_put_locked(f);
+  }
+  files_put(fs);
+  kernel_unlock(s);
+  return rc;
+
+out:
+  s = kernel_lock();
+  files_put(fs);
+  kernel_unlock(s);
+  return rc;
+}
+
+static long
+vfs_read_worker(uint64_t fp, uint64_t buf, uint64_t len, uint64_t a4)
+{
+  (void)a4;
+  file_t *f    = (file_t *)(uintptr_t)fp;
+  uint64_t off = f->off;
+
+  long rc = f->vn->ops->read(f->vn, &off, (void *)(uintptr_t)buf, len);
+
+  reg_t s = kernel_lock();
+  if (rc >= 0) f->off = off;
+  file_put_locked(f);
+  kernel_unlock(s);
+  return rc;
+}
+
+static long
+vfs_write_worker(uint64_t fp, uint64_t buf, uint64_t len, uint64_t a4)
+{
+  (void)a4;
+  file_t *f    = (file_t *)(uintptr_t)fp;
+  uint64_t off = (f->flags & O_APPEND) ? VFS_OFF_APPEND : f->off;
+
+  long rc = f->vn->ops->write(f->vn, &off, (const void *)(uintptr_t)buf, len);
+
+  reg_t s = kernel_lock();
+  if (rc >= 0) f->off = off;
+  file_put_locked(f);
+  kernel_unlock(s);
+  return rc;
+}
+
+long
+vfs_file_rw(file_t *f, void *buf, uint64_t len, int write)
+{
+  return write ? vfs_write_worker((uint64_t)(uintptr_t)f,
+                                  (uint64_t)(uintptr_t)buf, len, 0)
+               : vfs_read_worker((uint64_t)(uintptr_t)f,
+                                 (uint64_t)(uintptr_t)buf, len, 0);
+}
+
+static long
+vfs_readdir_worker(uint64_t fp, uint64_t ents, uint64_t n, uint64_t a4)
+{
+  (void)a4;
+  file_t *f    = (file_t *)(uintptr_t)fp;
+  uint64_t off = f->off;
+
+  long rc = f->vn->ops->readdir(f->vn, &off,
+                                (struct dirent_user *)(uintptr_t)ents,
+                                (uint32_t)n);
+
+  reg_t s = kernel_lock();
+  if (rc >= 0) f->off = off;
+  file_put_locked(f);
+  kernel_unlock(s);
+  return rc;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Syscalls (trap side, g_kernel_lock held)                                   */
+/* -------------------------------------------------------------------------- */
+
+void
+sys_fd_read(struct trapframe *tf, int fd, void *buf, uint64_t len)
+{
+  file_t *f = fd_lookup(fd);
+  if (!f || (f->flags & O_ACCMODE) == O_WRONLY) {
+    tf->a0 = (reg_t)-EBADF;
+    return;
+  }
+
+  if (f->type == FILE_CONSOLE) {
+    int is_non_block_read = 0;
+    uint64_t n = sys_read(FD_STDIN, (char *)buf, len, tf, &is_non_block_read);
+    if (is_non_block_read) tf->a0 = n;
+    /* 阻塞 read：唤醒方会写回 t->tf.a0 */
+    return;
+  }
+  if (f->type == FILE_PIPE) {
+    pipe_read(tf, f->pipe, buf, len);
+    return;
+  }
+  if (f->type == FILE_EVFD) {
+    evfd_read(tf, f->ev, buf, len);
+    return;
+  }
+  if (f->vn->type == STAT_T_DIR) {
+    tf->a0 = (reg_t)-EISDIR;
+    return;
+  }
+
+  f->refcnt++;
+  if (sysworker_call(tf, vfs_read_worker, (uint64_t)(uintptr_t)f,
+                     (uint64_t)(uintptr_t)buf, len, 0) < 0) {
+    file_put_locked(f);
+  }
+}
+
+void
+sys_fd_write(struct trapframe *tf, int fd, const void *buf, uint64_t len)
+{
+  file_t *f = fd_lookup(fd);
+  if (!f || (f->flags & O_ACCMODE) == O_RDONLY) {
+    tf->a0 = (reg_t)-EBADF;
+    return;
+  }
+
+  if (f->type == FILE_CONSOLE) {
+    tf->a0 = sys_write(FD_STDOUT, (const char *)buf, len);
+    return;
+  }
+  if (f->type == FILE_PIPE) {
+    pipe_write(tf, f->pipe, buf, len);
+    return;
+  }
+  if (f->type == FILE_EVFD) {
+    evfd_write(tf, f->ev, buf, len);
+    return;
+  }
+
+  f->refcnt++;
+  if (sysworker_call(tf, vfs_write_worker, (uint64_t)(uintptr_t)f,
+                     (uint64_t)(uintptr_t)buf, len, 0) < 0) {
+    file_put_locked(f);
+  }
+}
+
+long
+vfs_rw_nonblock_locked(files_t *fs, int fd, void *buf, uint64_t len, int write,
+                       file_t **slow)
+{
+  *slow     = NULL;
+  file_t *f = (fs && fd >= 0 && fd < (int)OPEN_MAX) ? fs->fd[fd] : NULL;
+  if (!f || (f->flags & O_ACCMODE) == (write ? O_RDONLY : O_WRONLY)) {
+    return -EBADF;
+  }
+
+  switch (f->type) {
+    case FILE_CONSOLE: {
+      if (write) return (long)sys_write(FD_STDOUT, (const char *)buf, len);
+      if (len == 0) return 0;
+      int n = console_read_nonblock((char *)buf, (size_t)len);
+      return (n > 0) ? n : -EAGAIN;
+    }
+    case FILE_PIPE:
+      return write ? pipe_write_nonblock_locked(f->pipe, buf, len)
+                   : pipe_read_nonblock_locked(f->pipe, buf, len);
+    case FILE_EVFD:
+      return write ? evfd_write_locked(f->ev, buf, len)
+                   : evfd_read_nonblock_locked(f->ev, buf, len);
+    default:
+      break;
+  }
+  if (!write && f->vn->type == STAT_T_DIR) return -EISDIR;
+
+  f->refcnt++;
+  *slow = f;
+  return 0;
+}
+
+void
+sys_open(struct trapframe *tf, const char *path, uint32_t flags)
+{
+  files_t *fs = files_current();
+  if (!fs) {
+    tf->a0 = (reg_t)-EBADF;
+    return;
+  }
+  if (!path) {
+    tf->a0 = (reg_t)-EFAULT;
+    return;
+  }
+
+  /* fd 最后在 worker 里装进这张表；表的引用由 worker 放掉 */
+  files_get(fs);
+  if (sysworker_call(tf, vfs_open_worker, (uint64_t)(uintptr_t)path, flags,
+                     (uint64_t)(uintptr_t)fs, 0) < 0) {
+    files_put(fs);
+  }
+}
+
+long
+sys_close(int fd)
+{
+  files_t *fs = files_current();
+  file_t *f   = fd_lookup(fd);
+  if (!f) return -EBADF;
+
+  fs->fd[fd] = NULL;
+  file_put_locked(f);
+  return 0;
+}
+
+long
+sys_lseek(int fd, int64_t off, int whence)
+{
+  file_t *f = fd_lookup(fd);
+  if (!f) return -EBADF;
+  if (f->type != FILE_VNODE) return -ESPIPE;
+
+  int64_t base;
+  switch (whence) {
+    case SEEK_SET:
+      base = 0;
+      break;
+    case SEEK_CUR:
+      base = (int64_t)f->off;
+      break;
+    case SEEK_END: {
+      struct stat_user st;
+      f->vn->ops->stat(f->vn, &st);
+      base = (int64_t)st.size;
+      break;
+    }
+    default:
+      return -EINVAL;
+  }
+  int64_t pos;
+  if (__builtin_add_overflow(base, off, &pos)) return -EINVAL;  /* 溢出 int64 */
+  if (pos < 0) return -EINVAL;
+
+  f->off = (uint64_t)pos;
+  return (long)f->off;
+}
+
+long
+sys_fstat(int fd, struct stat_user *st)
+{
+  file_t *f = fd_lookup(fd);
+  if (!f) return -EBADF;
+  if (!st) return -EFAULT;
+
+  struct stat_user tmp = {0};
+  if (f->type == FILE_CONSOLE) {
+    tmp.type = STAT_T_CHR;
+  } else if (f->type == FILE_PIPE) {
+    tmp.type = STAT_T_FIFO;
+    tmp.dev  = STAT_DEV_NONE;
+    tmp.size = pipe_nbytes_locked(f->pipe);
+  } else if (f->type == FILE_EVFD) {
+    tmp.type = STAT_T_ANON;
+    tmp.dev  = STAT_DEV_NONE;
+    tmp.size = evfd_count_locked(f->ev);
+  } else {
+    f->vn->ops->stat(f->vn, &tmp);
+  }
+  *st = tmp;
+  return 0;
+}
+
+void
+sys_getdents(struct trapframe *tf, int fd, struct dirent_user *ents, uint32_t n)
+{
+  file_t *f = fd_lookup(fd);
+  if (!f) {
+    tf->a0 = (reg_t)-EBADF;
+    return;
+  }
+  if (f->type != FILE_VNODE || f->vn->type != STAT_T_DIR ||
+      !f->vn->ops->readdir) {
+    tf->a0 = (reg_t)-ENOTDIR;
+    return;
+  }
+  if (!ents || n == 0) {
+    tf->a0 = (reg_t)-EINVAL;
+    return;
+  }
+
+  f->refcnt++;
+  if (sysworker_call(tf, vfs_readdir_worker, (uint64_t)(uintptr_t)f,
+                     (uint64_t)(uintptr_t)ents, n, 0) < 0) {
+    file_put_locked(f);
+  }
+}
+
+long
+sys_pipe(int *fds)
+{
+  files_t *fs = files_current();
+  if (!fs) return -EBADF;
+  if (!fds) return -EFAULT;
+
+  file_t *r = file_alloc_locked();
+  file_t *w = r ? file_alloc_locked() : NULL;
+  pipe_t *p = w ? pipe_alloc_locked() : NULL;
+  if (!p) {
+    if (r) r->refcnt = 0;
+    if (w) w->refcnt = 0;
+    return -ENFILE;
+  }
+  r->type  = FILE_PIPE;
+  r->flags = O_RDONLY;
+  r->pipe  = p;
+  w->type  = FILE_PIPE;
+  w->flags = O_WRONLY;
+  w->pipe  = p;
+
+  int rfd = fd_install(fs, r);
+  int wfd = (rfd >= 0) ? fd_install(fs, w) : -EMFILE;
+  if (wfd < 0) {
+    if (rfd >= 0) fs->fd[rfd] = NULL;
+    file_put_locked(r);
+    file_put_locked(w);
+    return -EMFILE;
+  }
+  fds[0] = rfd;
+  fds[1] = wfd;
+  return 0;
+}
+
+static long
+evfd_open_locked(uint32_t kind, uint64_t initval, uint32_t flags)
+{
+  files_t *fs = files_current();
+  if (!fs) return -EBADF;
+
+  file_t *f  = file_alloc_locked();
+  evfd_t *ev  = f ? evfd_alloc_locked(kind, initval, flags) : NULL;
+  if (!ev) {
+    if (f) f->refcnt = 0;
+    return -ENFILE;
+  }
+  f->type  = FILE_EVFD;
+  f->flags = (kind == EVFD_EVENT) ? O_RDWR : O_RDONLY;
+  f->ev    = ev;
+
+  int fd = fd_install(fs, f);
+  if (fd < 0) file_put_locked(f);
+  return fd;
+}
+
+long
+sys_eventfd(uint64_t initval, uint32_t flags)
+{
+  if ((flags & ~EFD_SEMAPHORE) || initval > EVFD_COUNT_MAX) return -EINVAL;
+  return evfd_open_locked(EVFD_EVENT, initval, flags);
+}
+
+long
+sys_timerfd_create(void)
+{
+  return evfd_open_locked(EVFD_TIMER, 0, 0);
+}
+
+long
+sys_timerfd_settime(int fd, uint64_t first, uint64_t period)
+{
+  file_t *f = fd_lookup(fd);
+  if (!f) return -EBADF;
+  if (f->type != FILE_EVFD || evfd_kind(f->ev) != EVFD_TIMER) return -EINVAL;
+  evfd_settime_locked(f->ev, first, period);
+  return 0;
+}
@@ -0,0 +1,238 @@
+/* string_word.h */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 按 8 字节字处理的 mem/str 系列，内核（lib/string.c）和用户库
+ * （user/ulib_string.c 的标量路径）共用这一份，bench string 的语料
+ * 测的就是内核跑的代码。
+ *  - 没有 Zicclsm 保证，非对齐的字访问可能陷入 SBI 模拟，所以先按字节对齐 dst，
+ *    src 与 dst 同余时直接拷字，不同余时 memcpy 用移位拼接，其它函数退回字节循环。
+ *  - 对齐的字读不会跨越页/设备边界，所以越过结尾读半个字是安全的。
+ *  - 需要 -fno-tree-loop-distribute-patterns，否则 GCC 会把循环改回 memcpy/memset 调用。
+ */
+
+typedef unsigned long __attribute__((may_alias)) strw_word_t;
+
+#define STRW_WSIZE      sizeof(strw_word_t)
+#define STRW_WMASK      (STRW_WSIZE - 1)
+#define STRW_ONES       ((strw_word_t)0x0101010101010101UL)
+#define STRW_HIGHS      ((strw_word_t)0x8080808080808080UL)
+#define STRW_HASZERO(x) (((x) - STRW_ONES) & ~(x) & STRW_HIGHS)
+#define STRW_ALIGNED(p) (((uintptr_t)(p) & STRW_WMASK) == 0)
+
+/* 前向拷贝；d <= s 的重叠也安全（写永远落后于读） */
+static inline void
+strw_copy_fwd(unsigned char *d, const unsigned char *s, size_t n)
+{
+  if (n >= 2 * STRW_WSIZE) {
+    while (!STRW_ALIGNED(d)) {
+      *d++ = *s++;
+      n--;
+    }
+
+    strw_word_t *dw = (strw_word_t *)d;
+
+    if (STRW_ALIGNED(s)) {
+      const strw_word_t *sw = (const strw_word_t *)s;
+      for (; n >= 8 * STRW_WSIZE; n -= 8 * STRW_WSIZE, dw += 8, sw += 8) {
+        dw[0] = sw[0];
+        dw[1] = sw[1];
+        dw[2] = sw[2];
+        dw[3] = sw[3];
+        dw[4] = sw[4];
+        dw[5] = sw[5];
+        dw[6] = sw[6];
+        dw[7] = sw[7];
+      }
+      for (; n >= STRW_WSIZE; n -= STRW_WSIZE) {
+        *dw++ = *sw++;
+      }
+      s = (const unsigned char *)sw;
+    } else {
+      /* src 不同余：按对齐字读，移位拼出 dst 的每个字（小端） */
+      size_t off            = (uintptr_t)s & STRW_WMASK;
+      unsigned shr          = (unsigned)(off * 8);
+      unsigned shl          = (unsigned)(STRW_WSIZE * 8) - shr;
+      const strw_word_t *sw = (const strw_word_t *)(s - off);
+      strw_word_t prev      = *sw++;
+
+      for (; n >= STRW_WSIZE; n -= STRW_WSIZE) {
+        strw_word_t next = *sw++;
+        *dw++            = (prev >> shr) | (next << shl);
+        prev             = next;
+      }
+      s = (const unsigned char *)(sw - 1) + off;
+    }
+    d = (unsigned char *)dw;
+  }
+
+  while (n--) {
+    *d++ = *s++;
+  }
+}
+
+static inline void *
+strw_memmove(void *dest, const void *src, size_t n)
+{
+  unsigned char *d       = (unsigned char *)dest;
+  const unsigned char *s = (const unsigned char *)src;
+
+  if (d == s || n == 0) {
+    return dest;
+  }
+
+  if (d < s || d >= s + n) {
+    strw_copy_fwd(d, s, n);
+    return dest;
+  }
+
+  /* 有重叠且 d 在后：从尾往前拷 */
+  d += n;
+  s += n;
+  if (n >= 2 * STRW_WSIZE &&
+      (((uintptr_t)d ^ (uintptr_t)s) & STRW_WMASK) == 0) {
+    while (!STRW_ALIGNED(d)) {
+      *--d = *--s;
+      n--;
+    }
+    for (; n >= STRW_WSIZE; n -= STRW_WSIZE) {
+      d -= STRW_WSIZE;
+      s -= STRW_WSIZE;
+      *(strw_word_t *)d = *(const strw_word_t *)s;
+    }
+  }
+  while (n--) {
+    *--d = *--s;
+  }
+
+  return dest;
+}
+
+static inline void *
+strw_memchr(const void *s, int c, size_t n)
+{
+  const unsigned char *p = (const unsigned char *)s;
+  unsigned char uc       = (unsigned char)c;
+
+  for (; n > 0 && !STRW_ALIGNED(p); n--, p++) {
+    if (*p == uc) return (void *)p;
+  }
+
+  const strw_word_t pat = STRW_ONES * uc;
+  for (; n >= STRW_WSIZE; n -= STRW_WSIZE, p += STRW_WSIZE) {
+    strw_word_t w = *(const strw_word_t *)p ^ pat;
+    if (STRW_HASZERO(w)) break;
+  }
+
+  for (; n > 0; n--, p++) {
+    if (*p == uc) return (void *)p;
+  }
+  return NULL;
+}
+
+static inline void *
+strw_memset(void *s, int c, size_t n)
+{
+  unsigned char *p    = (unsigned char *)s;
+  unsigned char value = (unsigned char)c;
+
+  if (n >= 2 * STRW_WSIZE) {
+    while (!STRW_ALIGNED(p)) {
+      *p++ = value;
+      n--;
+    }
+
+    const strw_word_t w = STRW_ONES * value;
+    strw_word_t *pw     = (strw_word_t *)p;
+    for (; n >= 8 * STRW_WSIZE; n -= 8 * STRW_WSIZE, pw += 8) {
+      pw[0] = w;
+      pw[1] = w;
+      pw[2] = w;
+      pw[3] = w;
+      pw[4] = w;
+      pw[5] = w;
+      pw[6] = w;
+      pw[7] = w;
+    }
+    for (; n >= STRW_WSIZE; n -= STRW_WSIZE) {
+      *pw++ = w;
+    }
+    p = (unsigned char *)pw;
+  }
+
+  while (n--) {
+    *p++ = value;
+  }
+
+  return s;
+}
+
+static inline int
+strw_memcmp(const void *s1, const void *s2, size_t n)
+{
+  const unsigned char *p1 = (const unsigned char *)s1;
+  const unsigned char *p2 = (const unsigned char *)s2;
+
+  if (n >= 2 * STRW_WSIZE &&
+      (((uintptr_t)p1 ^ (uintptr_t)p2) & STRW_WMASK) == 0) {
+    for (; !STRW_ALIGNED(p1); n--, p1++, p2++) {
+      if (*p1 != *p2) return (int)*p1 - (int)*p2;
+    }
+    /* 相等的字整块跳过；不等的那个字交给下面的字节循环定位 */
+    for (; n >= STRW_WSIZE;
+         n -= STRW_WSIZE, p1 += STRW_WSIZE, p2 += STRW_WSIZE) {
+      if (*(const strw_word_t *)p1 != *(const strw_word_t *)p2) break;
+    }
+  }
+
+  for (; n > 0; n--, p1++, p2++) {
+    if (*p1 != *p2) {
+      return (int)*p1 - (int)*p2;
+    }
+  }
+
+  return 0;
+}
+
+static inline size_t
+strw_strlen(const char *s)
+{
+  const char *p = s;
+
+  for (; !STRW_ALIGNED(p); p++) {
+    if (*p == '\0') return (size_t)(p - s);
+  }
+  for (;; p += STRW_WSIZE) {
+    strw_word_t w = *(const strw_word_t *)p;
+    if (STRW_HASZERO(w)) break;
+  }
+  while (*p) {
+    p++;
+  }
+  return (size_t)(p - s);
+}
+
+static inline char *
+strw_strchr(const char *s, int c)
+{
+  char ch = (char)c;
+
+  for (; !STRW_ALIGNED(s); s++) {
+    if (*s == ch) return (char *)s;
+    if (*s == '\0') return NULL;
+  }
+
+  const strw_word_t pat = STRW_ONES * (unsigned char)ch;
+  for (;; s += STRW_WSIZE) {
+    strw_word_t w = *(const strw_word_t *)s;
+    if (STRW_HASZERO(w) || STRW_HASZERO(w ^ pat)) break;
+  }
+
+  for (; *s; s++) {
+    if (*s == ch) return (char *)s;
+  }
+  return (ch == '\0') ? (char *)s : NULL;
+}
@@ -1,97 +1,48 @@
 #include "string.h"
 
-void *memmove(void *dest, const void *src, size_t n)
-{
-  unsigned char *d       = (unsigned char *)dest;
-  const unsigned char *s = (const unsigned char *)src;
+#include <stdint.h>
 
-  if (d == s || n == 0) {
-    return dest;
-  }
+#include "string_word.h"
 
-  if (d < s) {
-    // Forward copy
-    for (size_t i = 0; i < n; i++) {
-      d[i] = s[i];
-    }
-  } else {
-    // Backward copy (for overlapping regions)
-    for (size_t i = n; i > 0; i--) {
-      d[i - 1] = s[i - 1];
-    }
-  }
+/*
+ * 实现在 string_word.h（和用户库的标量路径共用一份，bench string 的语料
+ * 覆盖它）；这里只是导出成标准名字。
+ */
 
-  return dest;
+void *memmove(void *dest, const void *src, size_t n)
+{
+  return strw_memmove(dest, src, n);
 }
 
 void *memchr(const void *s, int c, size_t n)
 {
-  const unsigned char *p = (const unsigned char *)s;
-  unsigned char uc       = (unsigned char)c;
-
-  for (size_t i = 0; i < n; i++) {
-    if (p[i] == uc) {
-      return (void *)(p + i);
-    }
-  }
-  return NULL;
+  return strw_memchr(s, c, n);
 }
 
 void *memset(void *s, int c, size_t n)
 {
-  unsigned char *p    = (unsigned char *)s;
-  unsigned char value = (unsigned char)c;
-
-  for (size_t i = 0; i < n; ++i) {
-    p[i] = value;
-  }
-
-  return s;
+  return strw_memset(s, c, n);
 }
 
 void *memcpy(void *dest, const void *src, size_t n)
 {
-  unsigned char *d       = (unsigned char *)dest;
-  const unsigned char *s = (const unsigned char *)src;
-
-  for (size_t i = 0; i < n; ++i) {
-    d[i] = s[i];
-  }
-
+  strw_copy_fwd((unsigned char *)dest, (const unsigned char *)src, n);
   return dest;
 }
 
 int memcmp(const void *s1, const void *s2, size_t n)
 {
-  const unsigned char *p1 = (const unsigned char *)s1;
-  const unsigned char *p2 = (const unsigned char *)s2;
-
-  for (size_t i = 0; i < n; ++i) {
-    if (p1[i] != p2[i]) {
-      // cast to int to avoid unsigned wrap confusion
-      return (int)p1[i] - (int)p2[i];
-    }
-  }
-
-  return 0;
+  return strw_memcmp(s1, s2, n);
 }
 
 size_t strlen(const char *s)
 {
-  size_t n = 0;
-  while (s[n] != '\0') {
-    n++;
-  }
-  return n;
+  return strw_strlen(s);
 }
 
 char *strchr(const char *s, int c)
 {
-  char ch = (char)c;
-  for (; *s; s++) {
-    if (*s == ch) return (char *)s;
-  }
-  return (ch == '\0') ? (char *)s : NULL;
+  return strw_strchr(s, c);
 }
 
 char *strrchr(const char *s, int c)
@@ -112,9 +63,6 @@ char *strrchr(const char *s, int c)
 
 size_t strnlen(const char *s, size_t maxlen)
 {
-  size_t i = 0;
-  for (; i < maxlen && s[i] != '\0'; i++) {
-    /* nothing */
-  }
-  return i;
+  const char *p = memchr(s, '\0', maxlen);
+  return p ? (size_t)(p - s) : maxlen;
 }
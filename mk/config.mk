@@ -15,8 +15,23 @@ PLATFORM := qemu-virt-sbi
 QEMU_MACHINE        ?= virt
 QEMU_MACHINE_EXTRAS ?=
 QEMU_MEM            ?= 256M
-QEMU_COMMON_OPTS    ?= -nographic -m $(QEMU_MEM)
+# virtio-mmio 默认是 legacy 布局；驱动两种都支持，默认用 modern
+QEMU_VIRTIO_OPTS    ?= -global virtio-mmio.force-legacy=false
+QEMU_COMMON_OPTS    ?= -nographic -m $(QEMU_MEM) $(QEMU_VIRTIO_OPTS)
 QEMU_SMP_OPTS       ?= -smp $(CPUS)
+# CPU 模型：打开 RVV（vector.c 支持到 VLEN=256）
+QEMU_CPU            ?= rv64,v=true,vlen=128
+QEMU_CPU_OPTS       ?= -cpu $(QEMU_CPU)
+
+# RAM 盘 ram0（kernel/ramdisk.c）：内核镜像之后、QEMU_MEM 以内的一段固定内存。
+# RAMDISK_IMG 非空时由 QEMU -device loader 预先装进去；RAMDISK_SIZE_MB=0 关掉。
+# 默认装 fsimg.mk 从 fsroot/ 生成的 efs 镜像；RAMDISK_IMG= 给一块空盘
+RAMDISK_ADDR    ?= 0x8c000000
+RAMDISK_SIZE_MB ?= 16
+RAMDISK_IMG     ?= $(FS_IMG)
+
+# /tmp（kernel/tmpfs.c）的页池：紧接内核镜像之后；0 = 不挂 /tmp
+TMPFS_SIZE_MB   ?= 8
 
 QEMU          ?= qemu-system-riscv64
 QEMU_GDB_PORT ?= 1234
@@ -1,7 +1,19 @@
 # Compile / link flags.
 
-RISCV_ARCH ?= rv64ima_zicsr_zifencei
-RISCV_ABI  ?= lp64
+# make RISCV_FP=YES：加上 F/D + lp64d，用户态可以用浮点（内核惰性保存 FP 上下文）
+# make RISCV_RVC=YES：C 代码用压缩指令（.S 里仍是 .option norvc）；FP 构建默认打开，即 rv64gc
+RISCV_FP  ?= NO
+RISCV_RVC ?= $(RISCV_FP)
+
+ifeq ($(RISCV_FP),YES)
+  RISCV_ISA_BASE := rv64imafd
+  RISCV_ABI      ?= lp64d
+else
+  RISCV_ISA_BASE := rv64ima
+  RISCV_ABI      ?= lp64
+endif
+
+RISCV_ARCH ?= $(RISCV_ISA_BASE)$(if $(filter YES,$(RISCV_RVC)),c)_zicsr_zifencei
 RISCV_TUNE ?= sifive-7-series
 
 INCLUDE_DIRS := \
@@ -16,6 +28,7 @@ INCLUDE_DIRS := \
 CFLAGS := \
   -march=$(RISCV_ARCH) -mabi=$(RISCV_ABI) -mtune=$(RISCV_TUNE) \
   -ffreestanding -fno-builtin \
+  -fno-tree-loop-distribute-patterns \
   -Wall -Wextra \
   -mcmodel=medany \
   -ffunction-sections -fdata-sections \
@@ -31,6 +44,29 @@ ASFLAGS += -MMD -MP
 # smp
 CFLAGS += -DMAX_HARTS=$(CPUS)
 
+# RAM 盘位置 / 大小（mk/config.mk）
+CFLAGS += -DCONFIG_RAMDISK_BASE=$(RAMDISK_ADDR)ul \
+          -DCONFIG_RAMDISK_SIZE_MB=$(RAMDISK_SIZE_MB)
+
+# tmpfs 页池大小（mk/config.mk）
+CFLAGS += -DCONFIG_TMPFS_SIZE_MB=$(TMPFS_SIZE_MB)
+
+ifeq ($(RISCV_FP),YES)
+  CFLAGS += -DCONFIG_RISCV_FP=1
+endif
+
+# 锁统计（shell: lockstat）：Debug 默认开，Release 默认关；make LOCKSTAT=NO/YES
+LOCKSTAT ?= $(if $(filter YES,$(RELEASE)),NO,YES)
+ifeq ($(LOCKSTAT),YES)
+  CFLAGS += -DCONFIG_LOCKSTAT=1
+endif
+
+# 启动时对比 DT 哈希查找和 libfdt 线性查找的单次耗时（每次开机多扫 64 遍 blob）：make DT_BENCH=YES
+DT_BENCH ?= NO
+ifeq ($(DT_BENCH),YES)
+  CFLAGS += -DCONFIG_DT_BENCH=1
+endif
+
 ifeq ($(RELEASE),YES)
   CFLAGS += -O2 -DNDEBUG -flto -DKERNEL_BUILD_TYPE=\"release\"
 else
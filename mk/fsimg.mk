@@ -0,0 +1,25 @@
+# efs 根文件系统镜像：宿主机 mkefs 把 FS_ROOT 打包成 RAM 盘大小的镜像，
+# QEMU 用 -device loader 装到 RAMDISK_ADDR（见 config.mk / qemu.mk）。
+
+.PHONY: fsimg
+
+HOSTCC     ?= cc
+HOSTCFLAGS ?= -std=c11 -D_DEFAULT_SOURCE -O2 -Wall -Wextra
+
+MKEFS     := $(OUT_DIR)/mkefs
+MKEFS_SRC := tools/mkefs/mkefs.c
+FS_ROOT   ?= fsroot
+FS_IMG    := $(OUT_DIR)/fs.img
+
+# -iquote：efs_format.h 在 kernel/include，但 <time.h> 要用宿主机的
+$(MKEFS): $(MKEFS_SRC) $(KERNEL_DIR)/include/efs_format.h
+	@mkdir -p $(OUT_DIR)
+	@echo "  HOSTCC $@"
+	$(HOSTCC) $(HOSTCFLAGS) -iquote $(KERNEL_DIR)/include -o $@ $<
+
+# FS_ROOT 下任何文件变了都重做镜像
+$(FS_IMG): $(MKEFS) $(shell find $(FS_ROOT) 2>/dev/null)
+	@echo "  MKEFS $@ ($(FS_ROOT), $(RAMDISK_SIZE_MB) MiB)"
+	$(MKEFS) $@ $(RAMDISK_SIZE_MB) $(FS_ROOT)
+
+fsimg: $(FS_IMG)
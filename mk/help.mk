@@ -5,9 +5,11 @@
 help:
 	@echo "ccos Makefile targets:"
 	@echo "  build         Build kernel (ELF/bin) + disasm/symbols/objdumps/size"
+	@echo "  size-rvc      Build with RISCV_RVC=NO and YES, print both sizes"
 	@echo "  qemu          Run QEMU (fw_jump + kernel.bin + dtb)"
 	@echo "  qemu-dbg      Run QEMU paused with GDB stub"
 	@echo "  gdb           Attach GDB to qemu-dbg (port $(QEMU_GDB_PORT))"
+	@echo "  fsimg         Build the efs image ($(FS_IMG)) from FS_ROOT"
 	@echo "  clean         Remove kernel build artifacts"
 	@echo "  distclean     Clean kernel artifacts"
 	@echo "  print-config  Print resolved vars"
@@ -18,4 +20,6 @@ help:
 	@echo "  RELEASE=YES   Enable release flags"
 	@echo "  BUILD=DEBUG|RELEASE (default DEBUG; RELEASE=YES also works)"
 	@echo "  QEMU_MEM=256M QEMU memory size"
+	@echo "  FS_ROOT=<dir>  Directory packed into the efs RAM-disk image (default: $(FS_ROOT))"
+	@echo "  RAMDISK_IMG=<img>  RAM-disk contents (default: efs image; empty = zeroed disk)"
 	@echo "  CROSS_COMPILE=<prefix>        Kernel toolchain prefix"
@@ -1,4 +1,4 @@
-.PHONY: all build disasm-all objdump-objs symbols size debug-sources
+.PHONY: all build disasm-all objdump-objs symbols size size-rvc debug-sources
 
 all: build
 
@@ -52,8 +52,16 @@ symbols: $(TARGET)
 	$(NM) -n $(TARGET) > $(TARGET_SYMS)
 
 size: $(TARGET)
-	@echo "  SIZE    $<"
+	@echo "  SIZE    $<  (RISCV_ARCH=$(RISCV_ARCH))"
 	$(SIZE) $<
+	@$(NM) -S $< | grep -E ' (trap_entry|arch_first_switch|trap_entry_c)$$' || true
+
+# 同一配置分别以 RISCV_RVC=NO / YES 构建到 $(OUT)-norvc / $(OUT)-rvc，对比两份 size
+size-rvc:
+	@for v in NO YES; do \
+	  d=$(OUT)-$$( [ $$v = YES ] && echo rvc || echo norvc ); \
+	  $(MAKE) --no-print-directory OUT=$$d RISCV_RVC=$$v size || exit 1; \
+	done
 
 objdump-objs: $(OBJ_DUMPS)
 
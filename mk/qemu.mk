@@ -9,23 +9,35 @@ OPENSBI_FW_JUMP_BIN ?= $(OPENSBI_OUT)/platform/$(OPENSBI_PLATFORM)/firmware/fw_j
 OPENSBI_FW_JUMP_ADDR ?= 0x80200000
 
 QEMU_OPTS = -machine $(QEMU_MACHINE)$(QEMU_MACHINE_EXTRAS) \
-            $(QEMU_SMP_OPTS) $(QEMU_COMMON_OPTS)
+            $(QEMU_CPU_OPTS) $(QEMU_SMP_OPTS) $(QEMU_COMMON_OPTS)
+
+# virtio-blk 磁盘镜像（bench blk 用）；不存在时建一个全零的
+DISK_IMG     ?= $(OUT_DIR)/disk.img
+DISK_SIZE_MB ?= 64
+QEMU_DISK_OPTS ?= -drive file=$(DISK_IMG),if=none,format=raw,id=hd0 \
+                  -device virtio-blk-device,drive=hd0 \
+                  $(QEMU_RAMDISK_OPTS)
+
+# RAM 盘内容（默认 $(FS_IMG)）：make qemu RAMDISK_IMG=other.img
+ifneq ($(RAMDISK_IMG),)
+QEMU_RAMDISK_OPTS ?= -device loader,file=$(RAMDISK_IMG),addr=$(RAMDISK_ADDR),force-raw=on
+endif
 
 DTB := $(OUT_DIR)/virt.dtb
 DTS := $(OUT_DIR)/virt.dts
 
-qemu: $(TARGET_BIN) $(DTB) $(DTS) $(OPENSBI_FW_JUMP_BIN)
+qemu: $(TARGET_BIN) $(DTB) $(DTS) $(OPENSBI_FW_JUMP_BIN) $(DISK_IMG) $(RAMDISK_IMG)
 	@echo "  QEMU  $(TARGET) (OpenSBI: $(OPENSBI_FW_JUMP_BIN))"
-	$(QEMU) $(QEMU_OPTS) \
+	$(QEMU) $(QEMU_OPTS) $(QEMU_DISK_OPTS) \
 		-bios $(OPENSBI_FW_JUMP_BIN) \
 		-dtb $(DTB) \
 		-device loader,file=$(TARGET_BIN),addr=$(OPENSBI_FW_JUMP_ADDR)
 
 debug: qemu-dbg
 
-qemu-dbg: $(TARGET_BIN) $(DTB) $(OPENSBI_FW_JUMP_BIN) disasm-all
+qemu-dbg: $(TARGET_BIN) $(DTB) $(OPENSBI_FW_JUMP_BIN) $(DISK_IMG) $(RAMDISK_IMG) disasm-all
 	@echo "  QEMU-DBG  $(TARGET) (gdb on port $(QEMU_GDB_PORT))"
-	$(QEMU) $(QEMU_OPTS) \
+	$(QEMU) $(QEMU_OPTS) $(QEMU_DISK_OPTS) \
 		-bios $(OPENSBI_FW_JUMP_BIN) \
 		-dtb $(DTB) \
 		-S -gdb tcp::$(QEMU_GDB_PORT) \
@@ -35,6 +47,10 @@ gdb: $(TARGET)
 	@echo "  GDB   $(TARGET) (target remote :$(QEMU_GDB_PORT))"
 	$(GDB) $(TARGET) -ex "target remote :$(QEMU_GDB_PORT)"
 
+$(DISK_IMG):
+	@mkdir -p $(OUT_DIR)
+	dd if=/dev/zero of=$@ bs=1M count=$(DISK_SIZE_MB) 2>/dev/null
+
 $(DTS): $(DTB)
 	dtc -I dtb -O dts $< > $@
 
@@ -42,7 +58,7 @@ $(DTB):
 	@mkdir -p $(OUT_DIR)
 	$(QEMU) \
 		-machine $(QEMU_MACHINE)$(QEMU_MACHINE_EXTRAS),dumpdtb=$@ \
-		$(QEMU_SMP_OPTS) $(QEMU_COMMON_OPTS) -S
+		$(QEMU_CPU_OPTS) $(QEMU_SMP_OPTS) $(QEMU_COMMON_OPTS) -S
 
 $(OPENSBI_FW_JUMP_BIN):
 	$(MAKE) -f $(REPO_ROOT)/firmware/opensbi/integration/opensbi.mk opensbi \
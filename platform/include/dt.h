@@ -0,0 +1,49 @@
+/* dt.h */
+#pragma once
+#include <stdint.h>
+
+/*
+ * 展开的设备树（dt.c）：platform_set_dtb 时把 DTB 走一遍，建成内存里的
+ * 节点树，再按 compatible / 路径 / phandle 各建一张哈希索引。之后驱动的
+ * 查找都是一次哈希，不再线性扫整个 blob。
+ *
+ *  - reg 按父节点的 #address-cells / #size-cells 解码（缺省 2 / 1），
+ *    interrupts 按 interrupt-parent（沿祖先继承）的 #interrupt-cells 切分，
+ *    每个说明符取第一个 cell 作 IRQ 号。
+ *  - 只在 boot hart 上、别的 hart 起来之前构建，之后只读，查找不用加锁。
+ *  - 容量固定（DT_NODE_MAX 等）；放不下的节点丢掉并计数，dt_log_stats 报告。
+ *  - 其它属性仍从 blob 里取（dt_prop），节点上记着它的 fdt 偏移。
+ */
+
+#define DT_NODE_MAX 192
+#define DT_REG_MAX  4
+#define DT_IRQ_MAX  4
+
+typedef struct dt_node dt_node_t;
+
+int dt_init(const void *fdt);  /* 0 或 -1（blob 坏了） */
+int dt_ready(void);
+
+/* prev = NULL 从头找；否则找 DT 顺序里 prev 之后的下一个 */
+const dt_node_t *dt_find_compatible(const dt_node_t *prev, const char *compat);
+const dt_node_t *dt_find_path(const char *path);  /* "/cpus"、"/soc/plic@c000000" */
+const dt_node_t *dt_find_phandle(uint32_t phandle);
+
+const char      *dt_name(const dt_node_t *n);
+const dt_node_t *dt_first_child(const dt_node_t *n);
+const dt_node_t *dt_next_sibling(const dt_node_t *n);
+
+/* 原始属性（指向 blob，大端）；dt_prop_u32 取第一个 cell。0 或 -1 */
+const void *dt_prop(const dt_node_t *n, const char *name, int *len);
+int         dt_prop_u32(const dt_node_t *n, const char *name, uint32_t *out);
+
+/* 第 idx 个 reg / interrupts；0 或 -1 */
+int dt_reg(const dt_node_t *n, uint32_t idx, uint64_t *base, uint64_t *size);
+int dt_irq(const dt_node_t *n, uint32_t idx, uint32_t *irq);
+
+/* 第一个匹配 compatible 的节点的第一个 reg / interrupts */
+int dt_find_reg_by_compat(const char *compat, uint64_t *base, uint64_t *size);
+int dt_find_irq_by_compat(const char *compat, uint32_t *irq);
+
+/* 展开耗时、表的占用；CONFIG_DT_BENCH 时再加哈希查找和 libfdt 线性查找的单次耗时对比 */
+void dt_log_stats(void);
@@ -13,18 +13,23 @@ typedef void (*irq_handler_t)(uint32_t irq, void *arg);
 
 typedef struct {
   uint32_t irq;
+  uint32_t affinity;                 /* 使能的 hart 位图 */
   uint64_t count;
   platform_time_t first_tick;
   platform_time_t last_tick;
   platform_time_t max_delta;
   const char *name;
+  uint64_t hart_count[MAX_HARTS];    /* 各 hart claim 到的次数 */
 } platform_irq_stat_t;
 
-size_t platform_irq_get_stats(platform_irq_stat_t* out, size_t max);
+uint32_t platform_irq_max(void);
+/* 一个源的统计快照（免锁，seqcount 读）；0 或 -1（irq 越界） */
+int platform_irq_get_stat(uint32_t irq, platform_irq_stat_t *out);
 
 const void *platform_get_dtb(void);
 void platform_set_dtb(uintptr_t dtb_pa);
 uint32_t platform_timebase_hz(void);
+int platform_isa_has_ext(char ext);  /* DT riscv,isa 是否含单字母扩展 */
 
 /* 输出字符串（当前实现：直接用 QEMU virt 的 UART0 MMIO） */
 void platform_uart_init();
@@ -55,9 +60,25 @@ void platform_plic_init(void);
 void platform_init(uintptr_t hartid, uintptr_t dtb_pa);
 void platform_boot_hart_init(uintptr_t hartid);
 void platform_secondary_hart_init(uintptr_t hartid);
+/* 外设（virtio 等）：要用到线程 / softirq，threads_init 之后由 boot hart 调用 */
+void platform_devices_init(void);
 
+/* 注册后只在注册者所在 hart 上使能，之后用 platform_irq_set_affinity 调整 */
 void platform_register_irq_handler(uint32_t irq, irq_handler_t handler,
                                    void *arg, const char *name);
+int platform_irq_registered(uint32_t irq);
+
+/* IRQ 亲和性：mask 里的 hart 都打开 PLIC 使能，其余关掉。
+ * 调用方保证 mask 非空、只含 online hart，并持 g_kernel_lock。
+ */
+void platform_irq_set_affinity(uint32_t irq, uint32_t hart_mask);
+uint32_t platform_irq_get_affinity(uint32_t irq);
+/* secondary hart PLIC 初始化会清掉本 hart 的使能，之后按亲和性补回来 */
+void platform_irq_apply_affinity_this_hart(void);
+
+/* 源级屏蔽（priority = 0），所有 hart 一起生效；线程化 handler 用 */
+void platform_irq_mask(uint32_t irq);
+void platform_irq_unmask(uint32_t irq);
 void platform_handle_s_external(struct trapframe *tf);
 
 #endif /* PLATFORM_H */
@@ -24,8 +24,10 @@
 
 void plic_init_s_mode(void);
 void plic_set_priority(uint32_t irq, uint32_t prio);
-void plic_enable_irq(uint32_t irq);
+void plic_enable_irq(uint32_t irq);   /* 当前 hart */
 void plic_disable_irq(uint32_t irq);
+void plic_enable_irq_hart(uint32_t irq, uint32_t hartid);
+void plic_disable_irq_hart(uint32_t irq, uint32_t hartid);
 uint32_t plic_claim(void);
 void plic_complete(uint32_t irq);
 
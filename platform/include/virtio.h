@@ -0,0 +1,231 @@
+/* virtio.h */
+#ifndef VIRTIO_H
+#define VIRTIO_H
+
+#include <stdint.h>
+
+/*
+ * virtio-mmio 传输层 + split virtqueue（platform/qemu-virt-sbi/virtio_mmio.c）。
+ *
+ * QEMU virt 在 DTB 里给出 8 个 "virtio,mmio" 槽位，没插设备的槽 DeviceID = 0。
+ * 支持 legacy（Version 1，QueuePFN）和 modern（Version 2）两种寄存器布局；
+ * 两者都用同一块“legacy 排布”的 ring 内存（desc | avail | pad | used）。
+ *
+ * 驱动的典型流程：
+ *   dev = virtio_find_device(VIRTIO_ID_BLOCK, 0);
+ *   virtio_dev_negotiate(dev, 驱动想要的特性);
+ *   vq  = virtq_alloc(dev, 0, 完成回调);
+ *   virtio_dev_ready(dev);                 // 注册 IRQ、DRIVER_OK
+ *   virtq_add(vq, bufs, n_out, n_in, token); virtq_kick(vq);
+ *   回调里：while ((tok = virtq_get_buf(vq, &len))) ...
+ *
+ * 减少门铃（QueueNotify 的 MMIO 写，在 QEMU 里每次都是一次 VM exit）：
+ *   - VIRTIO_F_EVENT_IDX：按设备写的 avail_event 决定要不要 notify，
+ *     中断侧用 used_event 控制（不更新 used_event = 关中断）。
+ *   - VIRTIO_F_INDIRECT_DESC：多段请求只占一个 ring 描述符。
+ *   - virtq_add 只推进影子 avail_idx，virtq_kick 一次发布一批。
+ *
+ * 所有 virtq_* / virtio_dev_* 调用都要持 g_kernel_lock（IRQ 回调本身就在锁内）。
+ */
+
+/* ---- MMIO 寄存器 ---- */
+#define VIRTIO_MMIO_MAGIC_VALUE         0x000u  /* "virt" */
+#define VIRTIO_MMIO_VERSION             0x004u
+#define VIRTIO_MMIO_DEVICE_ID           0x008u
+#define VIRTIO_MMIO_VENDOR_ID           0x00cu
+#define VIRTIO_MMIO_DEVICE_FEATURES     0x010u
+#define VIRTIO_MMIO_DEVICE_FEATURES_SEL 0x014u
+#define VIRTIO_MMIO_DRIVER_FEATURES     0x020u
+#define VIRTIO_MMIO_DRIVER_FEATURES_SEL 0x024u
+#define VIRTIO_MMIO_GUEST_PAGE_SIZE     0x028u  /* legacy */
+#define VIRTIO_MMIO_QUEUE_SEL           0x030u
+#define VIRTIO_MMIO_QUEUE_NUM_MAX       0x034u
+#define VIRTIO_MMIO_QUEUE_NUM           0x038u
+#define VIRTIO_MMIO_QUEUE_ALIGN         0x03cu  /* legacy */
+#define VIRTIO_MMIO_QUEUE_PFN           0x040u  /* legacy */
+#define VIRTIO_MMIO_QUEUE_READY         0x044u
+#define VIRTIO_MMIO_QUEUE_NOTIFY        0x050u
+#define VIRTIO_MMIO_INTERRUPT_STATUS    0x060u
+#define VIRTIO_MMIO_INTERRUPT_ACK       0x064u
+#define VIRTIO_MMIO_STATUS              0x070u
+#define VIRTIO_MMIO_QUEUE_DESC_LOW      0x080u
+#define VIRTIO_MMIO_QUEUE_DESC_HIGH     0x084u
+#define VIRTIO_MMIO_QUEUE_DRIVER_LOW    0x090u
+#define VIRTIO_MMIO_QUEUE_DRIVER_HIGH   0x094u
+#define VIRTIO_MMIO_QUEUE_DEVICE_LOW    0x0a0u
+#define VIRTIO_MMIO_QUEUE_DEVICE_HIGH   0x0a4u
+#define VIRTIO_MMIO_CONFIG_GENERATION   0x0fcu
+#define VIRTIO_MMIO_CONFIG              0x100u
+
+#define VIRTIO_MMIO_MAGIC               0x74726976u
+
+/* InterruptStatus */
+#define VIRTIO_MMIO_INT_VRING           (1u << 0)
+#define VIRTIO_MMIO_INT_CONFIG          (1u << 1)
+
+/* Status */
+#define VIRTIO_STATUS_ACKNOWLEDGE       1u
+#define VIRTIO_STATUS_DRIVER            2u
+#define VIRTIO_STATUS_DRIVER_OK         4u
+#define VIRTIO_STATUS_FEATURES_OK       8u
+#define VIRTIO_STATUS_NEEDS_RESET       64u
+#define VIRTIO_STATUS_FAILED            128u
+
+/* 传输层特性位（设备相关的位由各驱动定义） */
+#define VIRTIO_F_INDIRECT_DESC          28
+#define VIRTIO_F_EVENT_IDX              29
+#define VIRTIO_F_VERSION_1              32
+
+#define VIRTIO_FEATURE(bit)             (1ull << (bit))
+
+/* Device ID */
+#define VIRTIO_ID_NET                   1u
+#define VIRTIO_ID_BLOCK                 2u
+#define VIRTIO_ID_CONSOLE               3u
+#define VIRTIO_ID_RNG                   4u
+
+/* ---- split virtqueue 布局 ---- */
+#define VIRTQ_DESC_F_NEXT               1u
+#define VIRTQ_DESC_F_WRITE              2u
+#define VIRTQ_DESC_F_INDIRECT           4u
+
+#define VIRTQ_AVAIL_F_NO_INTERRUPT      1u
+#define VIRTQ_USED_F_NO_NOTIFY          1u
+
+#define VIRTQ_SIZE         64u  /* 每个队列最多用这么多描述符（2 的幂） */
+#define VIRTQ_INDIRECT_MAX 8u   /* 一个间接表最多几段 */
+#define VIRTQ_ALIGN        4096u
+#define VIRTIO_MAX_DEVS    8u
+#define VIRTIO_MAX_VQS     4u   /* 全部设备加起来的队列数（静态池） */
+#define VIRTIO_DEV_MAX_VQS 2u   /* 单个设备 */
+
+struct virtq_desc {
+  uint64_t addr;
+  uint32_t len;
+  uint16_t flags;
+  uint16_t next;
+};
+
+struct virtq_avail {
+  uint16_t flags;
+  uint16_t idx;
+  uint16_t ring[];  /* [num]，之后是 used_event */
+};
+
+struct virtq_used_elem {
+  uint32_t id;
+  uint32_t len;
+};
+
+struct virtq_used {
+  uint16_t flags;
+  uint16_t idx;
+  struct virtq_used_elem ring[];  /* [num]，之后是 avail_event */
+};
+
+/* virtq_add 的一段：out（设备读）在前，in（设备写）在后 */
+typedef struct {
+  void *addr;
+  uint32_t len;
+} virtq_buf_t;
+
+struct virtio_dev;
+struct virtq;
+typedef void (*virtq_callback_t)(struct virtq *vq);
+
+typedef struct virtq {
+  struct virtio_dev *dev;
+  uint32_t index;
+  uint32_t num;
+
+  volatile struct virtq_desc *desc;
+  volatile struct virtq_avail *avail;
+  volatile struct virtq_used *used;
+  volatile uint16_t *used_event;   /* 驱动写：希望在 used idx 越过它时来中断 */
+  volatile uint16_t *avail_event;  /* 设备写：希望在 avail idx 越过它时被 notify */
+  struct virtq_desc (*indirect)[VIRTQ_INDIRECT_MAX];  /* 每个头描述符一张 */
+
+  uint16_t free_head;
+  uint16_t num_free;
+  uint16_t avail_idx;   /* 影子 idx，virtq_kick 时发布 */
+  uint16_t kicked_idx;  /* 上次 kick 时发布的 idx */
+  uint16_t last_used;
+  uint16_t _pad;
+  uint32_t cb_enabled;
+
+  virtq_callback_t callback;
+  void *priv;
+  void *token[VIRTQ_SIZE];
+
+  /* 统计 */
+  uint64_t kicks;             /* 真正写了 QueueNotify */
+  uint64_t kicks_suppressed;  /* 设备说不用通知 */
+  uint64_t irqs;
+  uint64_t indirect_adds;
+} virtq_t;
+
+typedef struct virtio_dev {
+  uintptr_t base;
+  uint32_t irq;
+  uint32_t version;    /* 1 = legacy, 2 = modern */
+  uint32_t device_id;
+  uint32_t vendor_id;
+  uint64_t features;   /* 协商结果 */
+  int claimed;
+  int ready;
+  int irq_registered;  /* 驱动自己注册了 IRQ（如线程化），ready 时不再注册 */
+  char name[16];       /* "virtioN"，N = DT 里的槽位序号 */
+  virtq_t *vqs[VIRTIO_DEV_MAX_VQS];
+  void (*config_changed)(struct virtio_dev *dev);
+  void *priv;
+} virtio_dev_t;
+
+/* 扫描 DT 里所有 virtio,mmio 节点；只记录，不复位设备。返回找到的设备数 */
+int virtio_mmio_probe(void);
+
+/* 第 nth 个 device_id 设备（未被 claim 的），并标记 claimed；没有返回 NULL */
+virtio_dev_t *virtio_find_device(uint32_t device_id, uint32_t nth);
+
+/* 复位 + ACK/DRIVER + 特性协商：dev 提供的位 & wanted（modern 设备自动加
+ * VERSION_1）。INDIRECT_DESC / EVENT_IDX 由驱动自己放进 wanted，方便对比。
+ * 0 或 -errno；结果在 dev->features。
+ */
+int virtio_dev_negotiate(virtio_dev_t *dev, uint64_t wanted);
+
+static inline int
+virtio_has_feature(const virtio_dev_t *dev, uint32_t bit)
+{
+  return (dev->features & VIRTIO_FEATURE(bit)) != 0;
+}
+
+/* 注册 IRQ handler（除非 irq_registered）并置 DRIVER_OK */
+void virtio_dev_ready(virtio_dev_t *dev);
+
+/* 设备配置空间（带 generation 重读） */
+uint32_t virtio_config_read32(virtio_dev_t *dev, uint32_t off);
+uint64_t virtio_config_read64(virtio_dev_t *dev, uint32_t off);
+
+/* 在 negotiate 之后、ready 之前调用；NULL = 队列不存在或池用完 */
+virtq_t *virtq_alloc(virtio_dev_t *dev, uint32_t index, virtq_callback_t cb);
+
+/* 挂一个请求；0 或 -ENOSPC（描述符不够）/ -EINVAL */
+int virtq_add(virtq_t *vq, const virtq_buf_t *bufs, uint32_t n_out,
+              uint32_t n_in, void *token);
+/* 发布之前 add 的请求，需要时写 QueueNotify */
+void virtq_kick(virtq_t *vq);
+/* 取一个完成的请求（token），len 是设备写入的字节数；没有返回 NULL */
+void *virtq_get_buf(virtq_t *vq, uint32_t *len);
+
+/* 中断抑制：enable 返回 1 表示打开之前已经有完成没收（调用方要再收一次） */
+void virtq_disable_cb(virtq_t *vq);
+int  virtq_enable_cb(virtq_t *vq);
+
+/* 默认的 IRQ handler；想把完成放到线程里跑的驱动可以自己注册它 */
+void virtio_mmio_irq(uint32_t irq, void *arg);
+
+/* ---- 驱动 ---- */
+
+/* 认领所有 virtio-blk，注册成块设备 vda/vdb；返回成功的个数 */
+int virtio_blk_init(void);
+
+#endif /* VIRTIO_H */
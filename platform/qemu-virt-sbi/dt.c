@@ -0,0 +1,372 @@
+/* dt.c */
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dt.h"
+#include "libfdt.h"
+#include "log.h"
+#include "platform.h"
+#include "string.h"
+
+#define DT_COMPAT_MAX  384
+#define DT_PATH_POOL   8192
+#define DT_DEPTH_MAX   16
+#define DT_HASH_SIZE   64u  /* 2 的幂 */
+
+#define DT_ADDR_CELLS_DEFAULT 2u
+#define DT_SIZE_CELLS_DEFAULT 1u
+
+#ifdef CONFIG_DT_BENCH
+#define DT_BENCH_ITERS 64u
+#endif
+
+struct dt_node {
+  const char *name;  /* 指向 blob */
+  const char *path;  /* s_path_pool */
+  int off;
+  uint32_t phandle;
+  uint32_t ipar;        /* 生效的 interrupt-parent（自己的或继承的）；0 = 没有 */
+  uint32_t addr_cells;  /* 本节点声明的，给子节点的 reg 用 */
+  uint32_t size_cells;
+  uint32_t nreg;
+  uint32_t nirq;
+  dt_node_t *parent;
+  dt_node_t *child;
+  dt_node_t *last_child;
+  dt_node_t *sibling;
+  dt_node_t *path_next;  /* 哈希链 */
+  dt_node_t *ph_next;
+  uint64_t reg_base[DT_REG_MAX];
+  uint64_t reg_size[DT_REG_MAX];
+  uint32_t irq[DT_IRQ_MAX];
+};
+
+/* 一个节点的一个 compatible 字符串；同一个桶里保持 DT 顺序 */
+typedef struct dt_compat {
+  const char *str;  /* 指向 blob */
+  dt_node_t *node;
+  struct dt_compat *next;
+} dt_compat_t;
+
+static const void *s_fdt;
+static dt_node_t s_nodes[DT_NODE_MAX];
+static uint32_t s_nnodes;
+static uint32_t s_ndropped;
+static dt_compat_t s_compats[DT_COMPAT_MAX];
+static uint32_t s_ncompats;
+static uint32_t s_compat_dropped;
+static char s_path_pool[DT_PATH_POOL];
+static uint32_t s_path_used;
+static dt_compat_t *s_compat_hash[DT_HASH_SIZE];
+static dt_node_t *s_path_hash[DT_HASH_SIZE];
+static dt_node_t *s_ph_hash[DT_HASH_SIZE];
+static uint64_t s_parse_ticks;
+
+/* ========== helpers ========== */
+
+/* FNV-1a */
+static uint32_t dt_hash_str(const char *s) {
+  uint32_t h = 2166136261u;
+  while (*s) {
+    h ^= (uint8_t)*s++;
+    h *= 16777619u;
+  }
+  return h & (DT_HASH_SIZE - 1u);
+}
+
+static uint32_t dt_hash_ph(uint32_t ph) {
+  return (ph * 2654435761u) >> 26;  /* 高 6 位 */
+}
+
+static int dt_streq(const char *a, const char *b) {
+  while (*a && *a == *b) {
+    ++a;
+    ++b;
+  }
+  return *a == *b;
+}
+
+static uint32_t fdt_prop_u32_or(const void *fdt, int off, const char *name,
+                                uint32_t dflt) {
+  int len = 0;
+  const fdt32_t *p = (const fdt32_t *)fdt_getprop(fdt, off, name, &len);
+  if (!p || len < (int)sizeof(fdt32_t)) return dflt;
+  return fdt32_to_cpu(p[0]);
+}
+
+/* 大端 cells 拼成一个数；超过 2 个 cell 时只留低 64 位 */
+static uint64_t dt_read_cells(const fdt32_t *p, uint32_t cells) {
+  uint64_t v = 0;
+  for (uint32_t i = 0; i < cells; ++i) {
+    v = (v << 32) | fdt32_to_cpu(p[i]);
+  }
+  return v;
+}
+
+/* ========== 展开 ========== */
+
+static void dt_decode_reg(const void *fdt, dt_node_t *n) {
+  if (!n->parent) return;
+
+  int len = 0;
+  const fdt32_t *p = (const fdt32_t *)fdt_getprop(fdt, n->off, "reg", &len);
+  uint32_t ac      = n->parent->addr_cells;
+  uint32_t sc      = n->parent->size_cells;
+  if (!p || ac == 0) return;
+
+  uint32_t stride = ac + sc;
+  uint32_t count  = (uint32_t)len / (uint32_t)sizeof(fdt32_t) / stride;
+  for (uint32_t i = 0; i < count && i < DT_REG_MAX; ++i) {
+    n->reg_base[i] = dt_read_cells(p + i * stride, ac);
+    n->reg_size[i] = dt_read_cells(p + i * stride + ac, sc);
+  }
+  n->nreg = (count < DT_REG_MAX) ? count : DT_REG_MAX;
+}
+
+static void dt_index_compat(const void *fdt, dt_node_t *n) {
+  int len = 0;
+  const char *s = (const char *)fdt_getprop(fdt, n->off, "compatible", &len);
+  if (!s) return;
+
+  const char *end = s + len;
+  while (s < end) {
+    size_t l = strnlen(s, (size_t)(end - s));
+    if (l == 0 || s + l >= end) break;  /* 空串 / 没有结尾 NUL */
+    if (s_ncompats >= DT_COMPAT_MAX) {
+      s_compat_dropped++;
+    } else {
+      dt_compat_t *c = &s_compats[s_ncompats++];
+      c->str         = s;
+      c->node        = n;
+      c->next        = NULL;
+      dt_compat_t **pp = &s_compat_hash[dt_hash_str(s)];
+      while (*pp) pp = &(*pp)->next;
+      *pp = c;
+    }
+    s += l + 1;
+  }
+}
+
+static dt_node_t *dt_node_add(const void *fdt, int off, dt_node_t *parent) {
+  int nlen         = 0;
+  const char *name = fdt_get_name(fdt, off, &nlen);
+  if (!name || s_nnodes >= DT_NODE_MAX) return NULL;
+
+  /* 路径 = 父路径 + "/" + 名字；根是 "/" */
+  size_t plen = parent ? strlen(parent->path) : 0;
+  size_t need = parent ? plen + (plen > 1) + (size_t)nlen + 1 : 2;
+  if (s_path_used + need > DT_PATH_POOL) return NULL;
+
+  char *path = &s_path_pool[s_path_used];
+  if (!parent) {
+    path[0] = '/';
+    path[1] = '\0';
+  } else {
+    memcpy(path, parent->path, plen);
+    if (plen > 1) path[plen++] = '/';
+    memcpy(path + plen, name, (size_t)nlen);
+    path[plen + (size_t)nlen] = '\0';
+  }
+  s_path_used += (uint32_t)need;
+
+  dt_node_t *n  = &s_nodes[s_nnodes++];
+  n->name       = name;
+  n->path       = path;
+  n->off        = off;
+  n->parent     = parent;
+  n->phandle    = fdt_get_phandle(fdt, off);
+  n->addr_cells = fdt_prop_u32_or(fdt, off, "#address-cells", DT_ADDR_CELLS_DEFAULT);
+  n->size_cells = fdt_prop_u32_or(fdt, off, "#size-cells", DT_SIZE_CELLS_DEFAULT);
+  n->ipar = fdt_prop_u32_or(fdt, off, "interrupt-parent", parent ? parent->ipar : 0);
+
+  if (parent) {
+    if (parent->last_child) {
+      parent->last_child->sibling = n;
+    } else {
+      parent->child = n;
+    }
+    parent->last_child = n;
+  }
+
+  uint32_t h     = dt_hash_str(path);
+  n->path_next   = s_path_hash[h];
+  s_path_hash[h] = n;
+  if (n->phandle) {
+    h            = dt_hash_ph(n->phandle);
+    n->ph_next   = s_ph_hash[h];
+    s_ph_hash[h] = n;
+  }
+
+  dt_decode_reg(fdt, n);
+  dt_index_compat(fdt, n);
+  return n;
+}
+
+/* interrupts 要等所有 phandle 都进了索引才能按控制器的 #interrupt-cells 切 */
+static void dt_decode_irqs(const void *fdt) {
+  for (uint32_t i = 0; i < s_nnodes; ++i) {
+    dt_node_t *n = &s_nodes[i];
+    int len      = 0;
+    const fdt32_t *p = (const fdt32_t *)fdt_getprop(fdt, n->off, "interrupts", &len);
+    if (!p || len < (int)sizeof(fdt32_t)) continue;
+
+    const dt_node_t *ic = n->ipar ? dt_find_phandle(n->ipar) : NULL;
+    uint32_t cells      = ic ? fdt_prop_u32_or(fdt, ic->off, "#interrupt-cells", 1u) : 1u;
+    if (cells == 0) cells = 1u;
+
+    uint32_t count = (uint32_t)len / (uint32_t)sizeof(fdt32_t) / cells;
+    for (uint32_t k = 0; k < count && k < DT_IRQ_MAX; ++k) {
+      n->irq[k] = fdt32_to_cpu(p[k * cells]);
+    }
+    n->nirq = (count < DT_IRQ_MAX) ? count : DT_IRQ_MAX;
+  }
+}
+
+int dt_init(const void *fdt) {
+  if (s_fdt) return 0;
+  if (!fdt || fdt_check_header(fdt) != 0) return -1;
+
+  uint64_t t0 = platform_time_now();
+
+  dt_node_t *stack[DT_DEPTH_MAX];
+  int depth = 0;
+  for (int off = 0; off >= 0 && depth >= 0; off = fdt_next_node(fdt, off, &depth)) {
+    /* 父节点被丢了（或太深没记下），整棵子树一起丢 */
+    dt_node_t *parent = (depth && depth <= DT_DEPTH_MAX) ? stack[depth - 1] : NULL;
+    dt_node_t *n      = NULL;
+    if (depth < DT_DEPTH_MAX && (depth == 0 || parent)) {
+      n = dt_node_add(fdt, off, parent);
+    }
+    if (!n) s_ndropped++;
+    if (depth < DT_DEPTH_MAX) stack[depth] = n;
+  }
+  dt_decode_irqs(fdt);
+
+  s_parse_ticks = platform_time_now() - t0;
+  s_fdt         = fdt;
+  return 0;
+}
+
+int dt_ready(void) {
+  return s_fdt != NULL;
+}
+
+/* ========== 查找 ========== */
+
+const dt_node_t *dt_find_compatible(const dt_node_t *prev, const char *compat) {
+  if (!compat) return NULL;
+
+  int seen = (prev == NULL);
+  for (const dt_compat_t *c = s_compat_hash[dt_hash_str(compat)]; c; c = c->next) {
+    if (!dt_streq(c->str, compat)) continue;
+    if (seen) return c->node;
+    if (c->node == prev) seen = 1;
+  }
+  return NULL;
+}
+
+const dt_node_t *dt_find_path(const char *path) {
+  if (!path) return NULL;
+  for (const dt_node_t *n = s_path_hash[dt_hash_str(path)]; n; n = n->path_next) {
+    if (dt_streq(n->path, path)) return n;
+  }
+  return NULL;
+}
+
+const dt_node_t *dt_find_phandle(uint32_t phandle) {
+  if (!phandle) return NULL;
+  for (const dt_node_t *n = s_ph_hash[dt_hash_ph(phandle)]; n; n = n->ph_next) {
+    if (n->phandle == phandle) return n;
+  }
+  return NULL;
+}
+
+const char *dt_name(const dt_node_t *n) {
+  return n->name;
+}
+
+const dt_node_t *dt_first_child(const dt_node_t *n) {
+  return n->child;
+}
+
+const dt_node_t *dt_next_sibling(const dt_node_t *n) {
+  return n->sibling;
+}
+
+const void *dt_prop(const dt_node_t *n, const char *name, int *len) {
+  if (!n || !s_fdt) return NULL;
+  return fdt_getprop(s_fdt, n->off, name, len);
+}
+
+int dt_prop_u32(const dt_node_t *n, const char *name, uint32_t *out) {
+  int len = 0;
+  const fdt32_t *p = (const fdt32_t *)dt_prop(n, name, &len);
+  if (!p || len < (int)sizeof(fdt32_t)) return -1;
+  *out = fdt32_to_cpu(p[0]);
+  return 0;
+}
+
+int dt_reg(const dt_node_t *n, uint32_t idx, uint64_t *base, uint64_t *size) {
+  if (!n || idx >= n->nreg) return -1;
+  *base = n->reg_base[idx];
+  *size = n->reg_size[idx];
+  return 0;
+}
+
+int dt_irq(const dt_node_t *n, uint32_t idx, uint32_t *irq) {
+  if (!n || idx >= n->nirq) return -1;
+  *irq = n->irq[idx];
+  return 0;
+}
+
+int dt_find_reg_by_compat(const char *compat, uint64_t *base, uint64_t *size) {
+  return dt_reg(dt_find_compatible(NULL, compat), 0, base, size);
+}
+
+int dt_find_irq_by_compat(const char *compat, uint32_t *irq) {
+  return dt_irq(dt_find_compatible(NULL, compat), 0, irq);
+}
+
+/* ========== 统计 ========== */
+
+static uint64_t dt_ticks_to_ns(uint64_t ticks) {
+  uint64_t hz = platform_timebase_hz();
+  return hz ? ticks * 1000000000ull / hz : 0;
+}
+
+void dt_log_stats(void) {
+  if (!s_fdt) {
+    pr_warn("dt: no device tree");
+    return;
+  }
+
+  pr_info("dt: %u nodes, %u compatible, %u B paths, unflattened in %llu us",
+          s_nnodes, s_ncompats, s_path_used,
+          (unsigned long long)(dt_ticks_to_ns(s_parse_ticks) / 1000u));
+  if (s_ndropped || s_compat_dropped) {
+    pr_warn("dt: tables full, dropped %u nodes / %u compatible", s_ndropped,
+            s_compat_dropped);
+  }
+
+#ifdef CONFIG_DT_BENCH
+  /* DT 顺序里最后一个 compatible：libfdt 要从头扫到它 */
+  if (s_ncompats == 0) return;
+  const char *compat = s_compats[s_ncompats - 1u].str;
+  volatile uintptr_t sink = 0;
+
+  uint64_t t0 = platform_time_now();
+  for (uint32_t i = 0; i < DT_BENCH_ITERS; ++i) {
+    sink += (uintptr_t)dt_find_compatible(NULL, compat);
+  }
+  uint64_t t1 = platform_time_now();
+  for (uint32_t i = 0; i < DT_BENCH_ITERS; ++i) {
+    sink += (uintptr_t)fdt_node_offset_by_compatible(s_fdt, -1, compat);
+  }
+  uint64_t t2 = platform_time_now();
+  (void)sink;
+
+  pr_info("dt: lookup \"%s\": hash %llu ns, fdt walk %llu ns", compat,
+          (unsigned long long)(dt_ticks_to_ns(t1 - t0) / DT_BENCH_ITERS),
+          (unsigned long long)(dt_ticks_to_ns(t2 - t1) / DT_BENCH_ITERS));
+#endif
+}
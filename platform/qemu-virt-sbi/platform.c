@@ -2,13 +2,18 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "cpu.h"
+#include "dt.h"
 #include "log.h"
 #include "riscv_csr.h"
+#include "sbi.h"
 #include "uart_16550.h"
 #include "platform.h"
 #include "plic.h"
 #include "timer.h"
+#include "virtio.h"
 #include "panic.h"
+#include "seqlock.h"
 #include "libfdt.h"
 
 static const void* g_dtb;  /* Cached DTB pointer */
@@ -27,6 +32,10 @@ void platform_set_dtb(uintptr_t dtb_pa) {
 
   if (g_dtb == NULL) {
     g_dtb = new_dtb;
+    /* 一次展开；之后驱动都查 dt.c 的索引 */
+    if (dt_init(g_dtb) < 0) {
+      sbi_console_puts("platform_set_dtb: bad dtb header\n");  /* uart 还没初始化 */
+    }
     return;
   }
 
@@ -39,17 +48,8 @@ uint32_t platform_timebase_hz(void) {
   if (g_timebase_hz) return g_timebase_hz;
 
   uint32_t hz = 0;
-  if (g_dtb) {
-    int off = fdt_path_offset(g_dtb, "/cpus");
-    if (off >= 0) {
-      int len = 0;
-      const fdt32_t* p = (const fdt32_t*)fdt_getprop(g_dtb, off,
-                                                     "timebase-frequency",
-                                                     &len);
-      if (p && len >= (int)sizeof(fdt32_t)) {
-        hz = fdt32_to_cpu(p[0]);
-      }
-    }
+  if (dt_prop_u32(dt_find_path("/cpus"), "timebase-frequency", &hz) < 0) {
+    hz = 0;
   }
   if (hz == 0) {
     hz = 10000000u; /* Typical default: 10MHz (QEMU virt uses this) */
@@ -58,6 +58,44 @@ uint32_t platform_timebase_hz(void) {
   return hz;
 }
 
+/*
+ * DT 里 cpu 节点的 ISA 是否带单字母扩展 ext（'v'、'f'、'd' ...）。
+ * 先看新的 riscv,isa-extensions 字符串列表，再解析 riscv,isa
+ * （"rv64imafdcv_zicsr..."：rv64 之后、第一个 '_' 之前的字母）。
+ * 只看第一个 cpu 节点：QEMU virt 各 hart 配置相同。
+ */
+int platform_isa_has_ext(char ext) {
+  const dt_node_t* cpus = dt_find_path("/cpus");
+  if (!cpus) return 0;
+
+  for (const dt_node_t* n = dt_first_child(cpus); n; n = dt_next_sibling(n)) {
+    int len = 0;
+    const char* type = (const char*)dt_prop(n, "device_type", &len);
+    if (!type || !fdt_stringlist_contains(type, len, "cpu")) continue;
+
+    const char name[2] = {ext, '\0'};
+    const char* exts = (const char*)dt_prop(n, "riscv,isa-extensions", &len);
+    if (exts) {
+      return fdt_stringlist_contains(exts, len, name);
+    }
+
+    const char* isa = (const char*)dt_prop(n, "riscv,isa", &len);
+    if (!isa || len < 5) return 0;
+
+    for (const char* p = isa + 4; *p && *p != '_'; ++p) {
+      if (*p == ext) return 1;
+      /* g = imafd + zicsr + zifencei */
+      if (*p == 'g' && (ext == 'i' || ext == 'm' || ext == 'a' || ext == 'f' ||
+                        ext == 'd')) {
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  return 0;
+}
+
 /* ========== Console output helpers ========== */
 
 void platform_uart_init() {
@@ -218,11 +256,15 @@ typedef struct {
   platform_time_t last_tick;   /* 上次触发的 tick */
   platform_time_t first_tick;  /* 第一次触发 */
   platform_time_t max_delta;   /* 相邻两次最大间隔（可选） */
+  uint64_t hart_count[MAX_HARTS];
 } irq_stat_t;
 
 static irq_entry_t s_irq_table[MAX_IRQ];
 static irq_stat_t s_irq_stats[MAX_IRQ];
+/* 写者：platform_handle_s_external（持 g_kernel_lock）；读者：irqstat，不拿锁 */
+static seqcount_t s_irq_stats_seq = SEQCNT_INIT;
 static const char* s_irq_name[MAX_IRQ];
+static uint32_t s_irq_affinity[MAX_IRQ];  /* hart 位图；0 = 未注册 */
 
 static void platform_irq_table_init(void) {
   for (int i = 0; i < MAX_IRQ; ++i) {
@@ -240,11 +282,50 @@ void platform_register_irq_handler(uint32_t irq, irq_handler_t handler,
   s_irq_table[irq].handler = handler;
   s_irq_table[irq].arg     = arg;
   s_irq_name[irq]          = name;
+  s_irq_affinity[irq]      = 1u << cpu_current_hartid();
 
   plic_set_priority(irq, 1);
   plic_enable_irq(irq);
 }
 
+int platform_irq_registered(uint32_t irq) {
+  return irq < MAX_IRQ && s_irq_table[irq].handler != NULL;
+}
+
+void platform_irq_set_affinity(uint32_t irq, uint32_t hart_mask) {
+  if (irq >= MAX_IRQ || hart_mask == 0) return;
+
+  /* 先开新的再关旧的，切换过程中不会有“谁都没开”的窗口 */
+  for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+    if (hart_mask & (1u << h)) plic_enable_irq_hart(irq, h);
+  }
+  for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+    if (!(hart_mask & (1u << h))) plic_disable_irq_hart(irq, h);
+  }
+  s_irq_affinity[irq] = hart_mask;
+}
+
+uint32_t platform_irq_get_affinity(uint32_t irq) {
+  return (irq < MAX_IRQ) ? s_irq_affinity[irq] : 0;
+}
+
+void platform_irq_apply_affinity_this_hart(void) {
+  uint32_t me = cpu_current_hartid();
+  for (uint32_t irq = 1; irq < MAX_IRQ; ++irq) {
+    if (s_irq_table[irq].handler && (s_irq_affinity[irq] & (1u << me))) {
+      plic_enable_irq_hart(irq, me);
+    }
+  }
+}
+
+void platform_irq_mask(uint32_t irq) {
+  plic_set_priority(irq, 0);
+}
+
+void platform_irq_unmask(uint32_t irq) {
+  plic_set_priority(irq, 1);
+}
+
 void platform_handle_s_external(struct trapframe* tf) {
   (void)tf;
   for (;;) {
@@ -255,6 +336,7 @@ void platform_handle_s_external(struct trapframe* tf) {
 
     if (irq < MAX_IRQ) {
       irq_stat_t* st = &s_irq_stats[irq];
+      write_seqcount_begin(&s_irq_stats_seq);
       if (st->count == 0) {
         st->first_tick = now;
       } else {
@@ -263,6 +345,8 @@ void platform_handle_s_external(struct trapframe* tf) {
       }
       st->last_tick = now;
       st->count++;
+      st->hart_count[cpu_current_hartid()]++;
+      write_seqcount_end(&s_irq_stats_seq);
     }
 
     irq_handler_t handler = NULL;
@@ -308,6 +392,11 @@ void platform_boot_hart_init(uintptr_t hartid) {
   platform_register_irq_handler(uart_irq, uart16550_irq_handler, NULL, "uart0");
 }
 
+void platform_devices_init(void) {
+  virtio_mmio_probe();
+  virtio_blk_init();
+}
+
 void platform_secondary_hart_init(uintptr_t hartid) {
   (void)hartid;
   ASSERT(g_dtb != NULL);
@@ -338,30 +427,35 @@ void platform_secondary_hart_init(uintptr_t hartid) {
   /* */
   platform_plic_init();
 
-  /* 4. 如果将来希望 secondary hart 也直接处理某些外设中断 */
-  /*    （比如本地 virtio queue、per-CPU timer），你可以在这里： */
-  /*      - 调用 plic_enable_irq(XXX); 打开该 hart 上的使能； */
-  /*      - 或者新增一个类似 platform_plic_enable_irq_for_this_hart() 的封装。 */
-  /* */
-  /*    现在你的 UART 中断只需要送到 boot hart 跑 shell 就够了， */
-  /*    secondary hart 主要先用于实验 SMP/IPI，所以这里可以先什么都不额外开。 */
+  /* 4. 亲和性里包含本 hart 的源（irqaffinity 设过的）在这里补开使能 */
+  platform_irq_apply_affinity_this_hart();
 }
 
 /* ========== MISC ========== */
 
-size_t platform_irq_get_stats(platform_irq_stat_t* out, size_t max) {
-  if (!out) return 0;
-
-  size_t n = (max < MAX_IRQ) ? max : MAX_IRQ;
-  for (size_t i = 0; i < n; ++i) {
-    out[i].irq        = (uint32_t)i;
-    out[i].count      = s_irq_stats[i].count;
-    out[i].first_tick = s_irq_stats[i].first_tick;
-    out[i].last_tick  = s_irq_stats[i].last_tick;
-    out[i].max_delta  = s_irq_stats[i].max_delta;
-    out[i].name       = s_irq_name[i];
-  }
-  return n;
+uint32_t platform_irq_max(void) {
+  return MAX_IRQ;
+}
+
+int platform_irq_get_stat(uint32_t irq, platform_irq_stat_t* out) {
+  if (!out || irq >= MAX_IRQ) return -1;
+
+  const irq_stat_t* st = &s_irq_stats[irq];
+  uint32_t seq;
+  do {
+    seq             = read_seqcount_begin(&s_irq_stats_seq);
+    out->irq        = irq;
+    out->affinity   = s_irq_affinity[irq];
+    out->count      = st->count;
+    out->first_tick = st->first_tick;
+    out->last_tick  = st->last_tick;
+    out->max_delta  = st->max_delta;
+    out->name       = s_irq_name[irq];
+    for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+      out->hart_count[h] = st->hart_count[h];
+    }
+  } while (read_seqcount_retry(&s_irq_stats_seq, seq));
+  return 0;
 }
 
 void platform_idle(void) {
@@ -1,11 +1,11 @@
 #include "plic.h"
-#include "platform.h"    /* platform_get_dtb() */
-#include "fdt_helper.h"  /* fdt_find_reg_by_compat() */
-#include "libfdt.h"      /* fdt_node_offset_by_compatible, fdt32_t */
+#include <stddef.h>
+#include "dt.h"          /* dt_find_compatible() */
 #include "cpu.h"         /* cpu_current_hartid() */
 
 static uintptr_t plic_base;       /* runtime PLIC MMIO base */
 static uint32_t plic_num_sources; /* number of interrupt sources (from FDT) */
+static int plic_probed;           /* 查过 DT 了（没有 PLIC 也不再查） */
 
 static inline void w32(uint32_t off, uint32_t v) {
   *(volatile uint32_t *)(plic_base + off) = v;
@@ -55,50 +55,33 @@ static inline uint32_t plic_sclaim_offset_for_hart(uint32_t hartid) {
 }
 
 /*
- * 确保 plic_base 已经从 FDT 初始化。
- * 会在第一次被调用时从 device tree 里解析 PLIC 的 reg。
+ * 确保 plic_base 已经从 DT 初始化。
+ * 第一次调用时查一次展开的 device tree；之后（包括没找到 PLIC）只看一个标志。
  */
 static void plic_ensure_base(void) {
-  if (plic_base != 0) {
+  if (plic_base != 0 || plic_probed) {
     return;
   }
-
-  const void *fdt = platform_get_dtb();
-  if (!fdt) {
+  if (!dt_ready()) {
     /* 理论上 kernel_main 一开始就已经 set 过 dtb */
     return;
   }
-
-  uint64_t base, size;
+  plic_probed = 1;
 
   /* QEMU virt 的 PLIC compatible 可能是 "riscv,plic0" 或 "sifive,plic-1.0.0" */
-  int plic_off = fdt_node_offset_by_compatible(fdt, -1, "riscv,plic0");
-  int compat_fallback = 0;
-  if (plic_off < 0) {
-    plic_off        = fdt_node_offset_by_compatible(fdt, -1, "sifive,plic-1.0.0");
-    compat_fallback = 1;
+  const dt_node_t *plic = dt_find_compatible(NULL, "riscv,plic0");
+  if (!plic) {
+    plic = dt_find_compatible(NULL, "sifive,plic-1.0.0");
   }
 
-  if (plic_off < 0) {
+  uint64_t base, size;
+  if (dt_reg(plic, 0, &base, &size) < 0) {
     return;  /* no PLIC node */
   }
 
-  if (compat_fallback) {
-    if (fdt_find_reg_by_compat(fdt, "sifive,plic-1.0.0", &base, &size) < 0) return;
-  } else {
-    if (fdt_find_reg_by_compat(fdt, "riscv,plic0", &base, &size) < 0) return;
-  }
-
   /* Optional: riscv,ndev tells us how many sources exist. Default to 32. */
-  plic_num_sources = 32;
-  int len               = 0;
-  const fdt32_t *ndev_p = (const fdt32_t *)fdt_getprop(fdt, plic_off, "riscv,ndev", &len);
-  if (ndev_p && len >= (int)sizeof(fdt32_t)) {
-    uint32_t n = fdt32_to_cpu(ndev_p[0]);
-    if (n > 0) {
-      plic_num_sources = n;
-    }
-  }
+  uint32_t n = 0;
+  plic_num_sources = (dt_prop_u32(plic, "riscv,ndev", &n) == 0 && n > 0) ? n : 32;
 
   plic_base = (uintptr_t)base;
 }
@@ -136,41 +119,44 @@ void plic_set_priority(uint32_t irq, uint32_t prio) {
 }
 
 /*
- * 为“当前 hart”的 S-mode context 打开 / 关闭某个 IRQ。
+ * 打开 / 关闭某个 hart 的 S-mode context 上的某个 IRQ。
+ * 同一个源可以同时在多个 context 打开：谁先 claim 谁处理，其它 hart claim 到 0。
  */
 
-void plic_enable_irq(uint32_t irq) {
+static void plic_set_enable(uint32_t irq, uint32_t hartid, int on) {
   if (irq == 0) return;
   plic_ensure_base();
   if (plic_base == 0) return;
   if (plic_num_sources && irq > plic_num_sources) return;
 
-  uint32_t hartid = cpu_current_hartid();
   uint32_t en_off = plic_senable_offset_for_hart(hartid);
 
   uint32_t word_off = en_off + 4u * (irq / 32u);
   uint32_t bit      = irq % 32u;
 
   uint32_t en = r32(word_off);
-  en |= (1u << bit);
+  if (on) {
+    en |= (1u << bit);
+  } else {
+    en &= ~(1u << bit);
+  }
   w32(word_off, en);
 }
 
-void plic_disable_irq(uint32_t irq) {
-  if (irq == 0) return;
-  plic_ensure_base();
-  if (plic_base == 0) return;
-  if (plic_num_sources && irq > plic_num_sources) return;
+void plic_enable_irq_hart(uint32_t irq, uint32_t hartid) {
+  plic_set_enable(irq, hartid, 1);
+}
 
-  uint32_t hartid = cpu_current_hartid();
-  uint32_t en_off = plic_senable_offset_for_hart(hartid);
+void plic_disable_irq_hart(uint32_t irq, uint32_t hartid) {
+  plic_set_enable(irq, hartid, 0);
+}
 
-  uint32_t word_off = en_off + 4u * (irq / 32u);
-  uint32_t bit      = irq % 32u;
+void plic_enable_irq(uint32_t irq) {
+  plic_enable_irq_hart(irq, cpu_current_hartid());
+}
 
-  uint32_t en = r32(word_off);
-  en &= ~(1u << bit);
-  w32(word_off, en);
+void plic_disable_irq(uint32_t irq) {
+  plic_disable_irq_hart(irq, cpu_current_hartid());
 }
 
 /*
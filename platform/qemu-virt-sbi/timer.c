@@ -1,5 +1,5 @@
 #include "timer.h"
-#include "fdt_helper.h"
+#include "dt.h"
 #include "riscv_csr.h"
 #include "sbi.h"
 #include "platform.h"
@@ -34,8 +34,7 @@ void timer_init(uintptr_t hartid)
 {
   (void)hartid;
 
-  const void *fdt = platform_get_dtb();
-  if (!fdt) {
+  if (!dt_ready()) {
     platform_puts("timer: no FDT, fallback to SBI\n");
     /* timer_backend = TIMER_BACKEND_SBI; */
     return;
@@ -45,15 +44,15 @@ void timer_init(uintptr_t hartid)
   int found = 0;
 
   /* 1. 优先尝试 ACLINT MTIMER */
-  if (fdt_find_reg_by_compat(fdt, "riscv,aclint-mtimer", &base, &size) == 0) {
+  if (dt_find_reg_by_compat("riscv,aclint-mtimer", &base, &size) == 0) {
     platform_puts("timer: found riscv,aclint-mtimer\n");
     found = 1;
   }
 
   /* 2. 不行就退回老的 CLINT 兼容串 */
   if (!found &&
-      fdt_find_reg_by_compat(fdt, "sifive,clint0", &base, &size) != 0 &&
-      fdt_find_reg_by_compat(fdt, "riscv,clint0", &base, &size) != 0) {
+      dt_find_reg_by_compat("sifive,clint0", &base, &size) != 0 &&
+      dt_find_reg_by_compat("riscv,clint0", &base, &size) != 0) {
     platform_puts("timer: no CLINT/ACLINT in FDT, use SBI\n");
     /* timer_backend = TIMER_BACKEND_SBI; */
     return;
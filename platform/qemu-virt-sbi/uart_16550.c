@@ -2,8 +2,7 @@
 #include "uart_16550.h"
 #include "platform.h"
 #include <stdint.h>
-#include "fdt_helper.h"
-#include "libfdt.h"
+#include "dt.h"
 
 #include "log.h"
 #include "cpu.h"
@@ -107,51 +106,42 @@ uint32_t uart16550_get_irq(void) {
   return uart_irq;
 }
 
-static void uart16550_parse_dt_params(const void *fdt) {
-  if (!fdt) return;
+static void uart16550_parse_dt_params(const dt_node_t *node) {
+  uint32_t v;
 
-  int off = fdt_node_offset_by_compatible(fdt, -1, "ns16550a");
-  if (off < 0) return;
-
-  int len = 0;
-
-  const fdt32_t *p = (const fdt32_t *)fdt_getprop(fdt, off, "reg-shift", &len);
-  if (p && len >= (int)sizeof(fdt32_t)) {
-    uart_reg_shift = fdt32_to_cpu(p[0]);
+  if (dt_prop_u32(node, "reg-shift", &v) == 0) {
+    uart_reg_shift = v;
   }
 
-  p = (const fdt32_t *)fdt_getprop(fdt, off, "reg-io-width", &len);
-  if (p && len >= (int)sizeof(fdt32_t)) {
-    uint32_t w = fdt32_to_cpu(p[0]);
-    if (w == 1 || w == 2 || w == 4) {
-      uart_reg_io_width = w;
+  if (dt_prop_u32(node, "reg-io-width", &v) == 0) {
+    if (v == 1 || v == 2 || v == 4) {
+      uart_reg_io_width = v;
     }
   }
 
-  p = (const fdt32_t *)fdt_getprop(fdt, off, "reg-offset", &len);
-  if (p && len >= (int)sizeof(fdt32_t)) {
-    uart_reg_offset = fdt32_to_cpu(p[0]);
+  if (dt_prop_u32(node, "reg-offset", &v) == 0) {
+    uart_reg_offset = v;
   }
 }
 
 void uart16550_init(void) {
-  const void *fdt = platform_get_dtb();
+  const dt_node_t *node = dt_find_compatible(NULL, "ns16550a");
   uint64_t base, size;
   uint32_t irq;
 
-  if (fdt_find_reg_by_compat(fdt, "ns16550a", &base, &size) < 0) {
+  if (dt_reg(node, 0, &base, &size) < 0) {
     platform_puts("uart16550_init: no ns16550a reg in fdt\n");
     return;
   }
 
-  if (fdt_find_irq_by_compat(fdt, "ns16550a", &irq) < 0) {
+  if (dt_irq(node, 0, &irq) < 0) {
     platform_puts("uart16550_init: no ns16550a interrupts in fdt\n");
     return;
   }
 
   uart_base = (uintptr_t)base;
   uart_irq  = irq;
-  uart16550_parse_dt_params(fdt);
+  uart16550_parse_dt_params(node);
 
   /* baud rate setting or others */
   uart_ier_write(UART_IER_ERBFI);
@@ -0,0 +1,237 @@
+/* platform/qemu-virt-sbi/virtio_blk.c */
+
+/*
+ * virtio-blk 驱动：把块设备层（kernel/blk.c）的请求翻译成
+ *   outhdr(设备读) | 数据段 x nseg（读：设备写） | status(设备写)
+ * 合并过的请求一次带多段 buf；有 INDIRECT_DESC 时整个请求只占一个 ring 描述符。
+ * 完成在 virtio IRQ 回调里收，收完一批再让块设备层补发（一批一次门铃）。
+ * IRQ 是线程化的（irq/N）：硬中断只屏蔽源，收完成、唤醒提交者都在线程里做。
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "blkdev.h"
+#include "irq.h"
+#include "lock.h"
+#include "log.h"
+#include "uerrno.h"
+#include "virtio.h"
+
+#define VIRTIO_BLK_F_SIZE_MAX 1
+#define VIRTIO_BLK_F_SEG_MAX  2
+#define VIRTIO_BLK_F_RO       5
+#define VIRTIO_BLK_F_BLK_SIZE 6
+#define VIRTIO_BLK_F_FLUSH    9
+
+#define VIRTIO_BLK_T_IN    0u
+#define VIRTIO_BLK_T_OUT   1u
+#define VIRTIO_BLK_T_FLUSH 4u
+
+#define VIRTIO_BLK_S_OK    0u
+
+/* config space */
+#define VIRTIO_BLK_CFG_CAPACITY 0u   /* u64，512 字节扇区 */
+#define VIRTIO_BLK_CFG_SEG_MAX  12u  /* u32 */
+
+#define VBLK_MAX_DEVS 2u
+#define VBLK_MAX_SEGS (VIRTQ_INDIRECT_MAX - 2u)  /* 头和 status 各占一段 */
+
+struct virtio_blk_outhdr {
+  uint32_t type;
+  uint32_t reserved;
+  uint64_t sector;
+};
+
+/* 一个在飞的设备请求；hdr/status 给设备 DMA */
+typedef struct {
+  struct virtio_blk_outhdr hdr;
+  volatile uint8_t status;
+  blk_req_t *req;
+} vblk_slot_t;
+
+typedef struct {
+  virtio_dev_t *vdev;
+  virtq_t *vq;
+  blkdev_t blk;
+  char name[4];  /* "vda" */
+  uint16_t free_slots[VIRTQ_SIZE];
+  uint32_t nfree;
+  vblk_slot_t slots[VIRTQ_SIZE];
+} vblk_t;
+
+static vblk_t s_vblk[VBLK_MAX_DEVS];
+
+static int
+vblk_submit(blkdev_t *bd, blk_req_t *req)
+{
+  vblk_t *vb = (vblk_t *)bd->priv;
+  if (vb->nfree == 0) return -EAGAIN;
+
+  uint16_t si       = vb->free_slots[vb->nfree - 1u];
+  vblk_slot_t *slot = &vb->slots[si];
+
+  slot->hdr.type     = (req->op == BLK_OP_READ)    ? VIRTIO_BLK_T_IN
+                       : (req->op == BLK_OP_WRITE) ? VIRTIO_BLK_T_OUT
+                                                   : VIRTIO_BLK_T_FLUSH;
+  slot->hdr.reserved = 0;
+  slot->hdr.sector   = (req->op == BLK_OP_FLUSH) ? 0 : req->sector;
+  slot->status       = 0xffu;
+  slot->req          = req;
+
+  virtq_buf_t bufs[VBLK_MAX_SEGS + 2u];
+  uint32_t n   = 0;
+  bufs[n++]    = (virtq_buf_t){&slot->hdr, (uint32_t)sizeof(slot->hdr)};
+  for (blk_req_t *seg = req; seg && req->op != BLK_OP_FLUSH;
+       seg = seg->merge_next) {
+    bufs[n++] = (virtq_buf_t){seg->buf, seg->nsect * BLK_SECTOR_SIZE};
+  }
+  uint32_t n_out = (req->op == BLK_OP_WRITE) ? n : 1u;
+  bufs[n++]      = (virtq_buf_t){(void *)&slot->status, 1u};
+
+  if (virtq_add(vb->vq, bufs, n_out, n - n_out, slot) != 0) {
+    return -EAGAIN;  /* 描述符不够（没有 INDIRECT 时） */
+  }
+  vb->nfree--;
+  return 0;
+}
+
+static void
+vblk_kick(blkdev_t *bd)
+{
+  vblk_t *vb = (vblk_t *)bd->priv;
+  virtq_kick(vb->vq);
+}
+
+static void
+vblk_stats(blkdev_t *bd, struct blkstat_user *out, int reset)
+{
+  vblk_t *vb = (vblk_t *)bd->priv;
+  virtq_t *vq = vb->vq;
+
+  out->kicks            = vq->kicks;
+  out->kicks_suppressed = vq->kicks_suppressed;
+  out->irqs             = vq->irqs;
+  if (reset) {
+    vq->kicks            = 0;
+    vq->kicks_suppressed = 0;
+    vq->irqs             = 0;
+  }
+}
+
+static const blkdev_ops_t s_vblk_ops = {
+    .submit = vblk_submit,
+    .kick   = vblk_kick,
+    .stats  = vblk_stats,
+};
+
+/* IRQ 回调（持 g_kernel_lock）：收完所有完成，再补发 pending */
+static void
+vblk_vq_done(virtq_t *vq)
+{
+  vblk_t *vb = (vblk_t *)vq->priv;
+
+  do {
+    virtq_disable_cb(vq);
+
+    vblk_slot_t *slot;
+    uint32_t len;
+    while ((slot = (vblk_slot_t *)virtq_get_buf(vq, &len)) != NULL) {
+      blk_req_t *req = slot->req;
+      int status     = (slot->status == VIRTIO_BLK_S_OK) ? 0 : -EIO;
+
+      slot->req                      = NULL;
+      vb->free_slots[vb->nfree++]    = (uint16_t)(slot - vb->slots);
+      blk_complete(&vb->blk, req, status);
+    }
+  } while (virtq_enable_cb(vq));
+
+  blk_run_queue(&vb->blk);
+}
+
+/* irq/N 线程里、不持锁被调：拿锁后走通用的 virtio handler（回调要持锁） */
+static void
+vblk_irq_thread(uint32_t irq, void *arg)
+{
+  reg_t s = kernel_lock();
+  virtio_mmio_irq(irq, arg);
+  kernel_unlock(s);
+}
+
+static int
+vblk_init_one(vblk_t *vb, virtio_dev_t *vdev, uint32_t idx)
+{
+  const uint64_t wanted = VIRTIO_FEATURE(VIRTIO_BLK_F_SEG_MAX) |
+                          VIRTIO_FEATURE(VIRTIO_BLK_F_FLUSH) |
+                          VIRTIO_FEATURE(VIRTIO_F_INDIRECT_DESC) |
+                          VIRTIO_FEATURE(VIRTIO_F_EVENT_IDX);
+  int rc = virtio_dev_negotiate(vdev, wanted);
+  if (rc < 0) return rc;
+
+  virtq_t *vq = virtq_alloc(vdev, 0, vblk_vq_done);
+  if (!vq) return -ENOMEM;
+  vq->priv = vb;
+
+  vb->vdev    = vdev;
+  vb->vq      = vq;
+  vb->name[0] = 'v';
+  vb->name[1] = 'd';
+  vb->name[2] = (char)('a' + idx);
+  vb->name[3] = '\0';
+
+  vb->nfree = 0;
+  for (uint32_t i = 0; i < VIRTQ_SIZE; ++i) {
+    vb->free_slots[vb->nfree++] = (uint16_t)(VIRTQ_SIZE - 1u - i);
+  }
+
+  const int indirect = virtio_has_feature(vdev, VIRTIO_F_INDIRECT_DESC);
+  uint32_t segs      = VBLK_MAX_SEGS;
+  if (virtio_has_feature(vdev, VIRTIO_BLK_F_SEG_MAX)) {
+    uint32_t seg_max = virtio_config_read32(vdev, VIRTIO_BLK_CFG_SEG_MAX);
+    if (seg_max && seg_max < segs) segs = seg_max;
+  }
+  /* 没有 INDIRECT 时一个请求最多占 segs + 2 个描述符：段数不能超过队列放得下的 */
+  if (!indirect) {
+    if (vq->num < 3u) return -ENOSPC;  /* 连 头 + 1 段 + 状态 都放不下 */
+    if (segs > vq->num - 2u) segs = vq->num - 2u;
+  }
+
+  blkdev_t *bd     = &vb->blk;
+  bd->name         = vb->name;
+  bd->nsectors     = virtio_config_read64(vdev, VIRTIO_BLK_CFG_CAPACITY);
+  bd->max_segs     = segs;
+  bd->max_inflight = indirect ? vq->num : vq->num / (segs + 2u);
+  bd->flags        = virtio_has_feature(vdev, VIRTIO_BLK_F_FLUSH)
+                         ? BLKDEV_F_FLUSH
+                         : 0u;
+  bd->ops          = &s_vblk_ops;
+  bd->priv         = vb;
+
+  if (request_threaded_irq(vdev->irq, vblk_irq_thread, vdev, vdev->name) == 0) {
+    vdev->irq_registered = 1;  /* 失败就退回 virtio_dev_ready 注册的硬中断 */
+  }
+  virtio_dev_ready(vdev);
+
+  pr_info("virtio-blk: %s on %s, features 0x%llx%s%s", vb->name, vdev->name,
+          (unsigned long long)vdev->features, indirect ? " indirect" : "",
+          virtio_has_feature(vdev, VIRTIO_F_EVENT_IDX) ? " event-idx" : "");
+  return blk_register(bd);
+}
+
+int
+virtio_blk_init(void)
+{
+  int found = 0;
+  for (uint32_t i = 0; i < VBLK_MAX_DEVS; ++i) {
+    virtio_dev_t *vdev = virtio_find_device(VIRTIO_ID_BLOCK, 0);
+    if (!vdev) break;
+
+    int rc = vblk_init_one(&s_vblk[i], vdev, i);
+    if (rc < 0) {
+      pr_warn("virtio-blk: %s init failed (%d)", vdev->name, rc);
+      continue;
+    }
+    found++;
+  }
+  return found;
+}
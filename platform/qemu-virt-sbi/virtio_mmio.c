@@ -0,0 +1,416 @@
+/* platform/qemu-virt-sbi/virtio_mmio.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dt.h"
+#include "log.h"
+#include "platform.h"
+#include "string.h"
+#include "uerrno.h"
+#include "virtio.h"
+
+/* ring 内存：desc[num] | avail（含 used_event） | 对齐到 VIRTQ_ALIGN | used（含 avail_event） */
+#define VIRTQ_DESC_BYTES(n)  (16u * (n))
+#define VIRTQ_AVAIL_BYTES(n) (6u + 2u * (n))
+#define VIRTQ_USED_BYTES(n)  (6u + 8u * (n))
+#define VIRTQ_ALIGN_UP(x)    (((x) + VIRTQ_ALIGN - 1u) & ~(VIRTQ_ALIGN - 1u))
+#define VIRTQ_USED_OFF(n)    VIRTQ_ALIGN_UP(VIRTQ_DESC_BYTES(n) + VIRTQ_AVAIL_BYTES(n))
+#define VIRTQ_MEM_BYTES      (2u * VIRTQ_ALIGN)
+
+_Static_assert(VIRTQ_USED_OFF(VIRTQ_SIZE) + VIRTQ_USED_BYTES(VIRTQ_SIZE) <=
+                   VIRTQ_MEM_BYTES,
+               "raise VIRTQ_MEM_BYTES");
+_Static_assert((VIRTQ_SIZE & (VIRTQ_SIZE - 1u)) == 0, "VIRTQ_SIZE must be 2^n");
+
+static virtio_dev_t s_devs[VIRTIO_MAX_DEVS];
+static uint32_t s_ndevs;
+
+static virtq_t s_vqs[VIRTIO_MAX_VQS];
+static uint32_t s_nvqs;
+static uint8_t s_vq_mem[VIRTIO_MAX_VQS][VIRTQ_MEM_BYTES]
+    __attribute__((aligned(VIRTQ_ALIGN)));
+static struct virtq_desc s_vq_indirect[VIRTIO_MAX_VQS][VIRTQ_SIZE]
+                                      [VIRTQ_INDIRECT_MAX]
+    __attribute__((aligned(16)));
+
+static inline uint32_t vio_r32(const virtio_dev_t* dev, uint32_t off) {
+  return *(volatile uint32_t*)(dev->base + off);
+}
+
+static inline void vio_w32(const virtio_dev_t* dev, uint32_t off, uint32_t v) {
+  *(volatile uint32_t*)(dev->base + off) = v;
+}
+
+static inline void vio_mb(void) {
+  __asm__ volatile("fence iorw,iorw" ::: "memory");
+}
+
+static const char* virtio_id_name(uint32_t id) {
+  switch (id) {
+    case VIRTIO_ID_NET:     return "net";
+    case VIRTIO_ID_BLOCK:   return "block";
+    case VIRTIO_ID_CONSOLE: return "console";
+    case VIRTIO_ID_RNG:     return "rng";
+    default:                return "?";
+  }
+}
+
+/* ========== 发现 ========== */
+
+int virtio_mmio_probe(void) {
+  if (!dt_ready() || s_ndevs) return (int)s_ndevs;
+
+  uint32_t slot         = 0;
+  const dt_node_t* node = NULL;
+  while ((node = dt_find_compatible(node, "virtio,mmio")) != NULL) {
+    uint64_t base, size;
+    uint32_t irq;
+    uint32_t this_slot = slot++;
+
+    if (dt_reg(node, 0, &base, &size) < 0) continue;
+    if (dt_irq(node, 0, &irq) < 0) continue;
+    if (s_ndevs >= VIRTIO_MAX_DEVS) break;
+
+    virtio_dev_t* dev = &s_devs[s_ndevs];
+    dev->base         = (uintptr_t)base;
+
+    if (vio_r32(dev, VIRTIO_MMIO_MAGIC_VALUE) != VIRTIO_MMIO_MAGIC) continue;
+    uint32_t version = vio_r32(dev, VIRTIO_MMIO_VERSION);
+    uint32_t id      = vio_r32(dev, VIRTIO_MMIO_DEVICE_ID);
+    if (id == 0) continue;  /* 空槽 */
+    if (version != 1 && version != 2) {
+      pr_warn("virtio: slot %u @0x%lx unsupported version %u", this_slot,
+              (unsigned long)base, version);
+      continue;
+    }
+
+    dev->irq       = irq;
+    dev->version   = version;
+    dev->device_id = id;
+    dev->vendor_id = vio_r32(dev, VIRTIO_MMIO_VENDOR_ID);
+
+    /* "virtioN" */
+    const char* prefix = "virtio";
+    int n              = 0;
+    while (prefix[n]) {
+      dev->name[n] = prefix[n];
+      ++n;
+    }
+    if (this_slot >= 10) dev->name[n++] = (char)('0' + this_slot / 10u);
+    dev->name[n++] = (char)('0' + this_slot % 10u);
+    dev->name[n]   = '\0';
+
+    pr_info("virtio: %s @0x%lx irq %u id %u (%s) %s", dev->name,
+            (unsigned long)base, irq, id, virtio_id_name(id),
+            version == 1 ? "legacy" : "modern");
+    s_ndevs++;
+  }
+
+  return (int)s_ndevs;
+}
+
+virtio_dev_t* virtio_find_device(uint32_t device_id, uint32_t nth) {
+  for (uint32_t i = 0; i < s_ndevs; ++i) {
+    virtio_dev_t* dev = &s_devs[i];
+    if (dev->device_id != device_id || dev->claimed) continue;
+    if (nth-- == 0) {
+      dev->claimed = 1;
+      return dev;
+    }
+  }
+  return NULL;
+}
+
+/* ========== 设备状态 / 特性 ========== */
+
+static void virtio_set_status(virtio_dev_t* dev, uint32_t bits) {
+  vio_w32(dev, VIRTIO_MMIO_STATUS, vio_r32(dev, VIRTIO_MMIO_STATUS) | bits);
+}
+
+int virtio_dev_negotiate(virtio_dev_t* dev, uint64_t wanted) {
+  if (!dev) return -EINVAL;
+
+  /* 复位；modern 设备读回 0 才算完成 */
+  vio_w32(dev, VIRTIO_MMIO_STATUS, 0);
+  while (vio_r32(dev, VIRTIO_MMIO_STATUS) != 0) {
+  }
+  virtio_set_status(dev, VIRTIO_STATUS_ACKNOWLEDGE);
+  virtio_set_status(dev, VIRTIO_STATUS_DRIVER);
+
+  vio_w32(dev, VIRTIO_MMIO_DEVICE_FEATURES_SEL, 0);
+  uint64_t offered = vio_r32(dev, VIRTIO_MMIO_DEVICE_FEATURES);
+  if (dev->version >= 2) {
+    vio_w32(dev, VIRTIO_MMIO_DEVICE_FEATURES_SEL, 1);
+    offered |= (uint64_t)vio_r32(dev, VIRTIO_MMIO_DEVICE_FEATURES) << 32;
+    wanted |= VIRTIO_FEATURE(VIRTIO_F_VERSION_1);
+  }
+
+  uint64_t features = offered & wanted;
+  if (dev->version >= 2 && !(features & VIRTIO_FEATURE(VIRTIO_F_VERSION_1))) {
+    virtio_set_status(dev, VIRTIO_STATUS_FAILED);
+    return -EIO;
+  }
+
+  vio_w32(dev, VIRTIO_MMIO_DRIVER_FEATURES_SEL, 0);
+  vio_w32(dev, VIRTIO_MMIO_DRIVER_FEATURES, (uint32_t)features);
+  if (dev->version >= 2) {
+    vio_w32(dev, VIRTIO_MMIO_DRIVER_FEATURES_SEL, 1);
+    vio_w32(dev, VIRTIO_MMIO_DRIVER_FEATURES, (uint32_t)(features >> 32));
+
+    virtio_set_status(dev, VIRTIO_STATUS_FEATURES_OK);
+    if (!(vio_r32(dev, VIRTIO_MMIO_STATUS) & VIRTIO_STATUS_FEATURES_OK)) {
+      virtio_set_status(dev, VIRTIO_STATUS_FAILED);
+      return -EIO;
+    }
+  } else {
+    vio_w32(dev, VIRTIO_MMIO_GUEST_PAGE_SIZE, VIRTQ_ALIGN);
+  }
+
+  dev->features = features;
+  return 0;
+}
+
+void virtio_dev_ready(virtio_dev_t* dev) {
+  if (!dev->irq_registered) {
+    platform_register_irq_handler(dev->irq, virtio_mmio_irq, dev, dev->name);
+    dev->irq_registered = 1;
+  }
+  vio_mb();
+  virtio_set_status(dev, VIRTIO_STATUS_DRIVER_OK);
+  dev->ready = 1;
+}
+
+uint32_t virtio_config_read32(virtio_dev_t* dev, uint32_t off) {
+  if (dev->version < 2) return vio_r32(dev, VIRTIO_MMIO_CONFIG + off);
+
+  uint32_t gen, v;
+  do {
+    gen = vio_r32(dev, VIRTIO_MMIO_CONFIG_GENERATION);
+    v   = vio_r32(dev, VIRTIO_MMIO_CONFIG + off);
+  } while (gen != vio_r32(dev, VIRTIO_MMIO_CONFIG_GENERATION));
+  return v;
+}
+
+uint64_t virtio_config_read64(virtio_dev_t* dev, uint32_t off) {
+  uint32_t gen = 0, lo, hi;
+  do {
+    if (dev->version >= 2) gen = vio_r32(dev, VIRTIO_MMIO_CONFIG_GENERATION);
+    lo = vio_r32(dev, VIRTIO_MMIO_CONFIG + off);
+    hi = vio_r32(dev, VIRTIO_MMIO_CONFIG + off + 4u);
+  } while (dev->version >= 2 &&
+           gen != vio_r32(dev, VIRTIO_MMIO_CONFIG_GENERATION));
+  return ((uint64_t)hi << 32) | lo;
+}
+
+/* ========== virtqueue ========== */
+
+virtq_t* virtq_alloc(virtio_dev_t* dev, uint32_t index, virtq_callback_t cb) {
+  if (!dev || index >= VIRTIO_DEV_MAX_VQS || dev->vqs[index]) return NULL;
+  if (s_nvqs >= VIRTIO_MAX_VQS) return NULL;
+
+  vio_w32(dev, VIRTIO_MMIO_QUEUE_SEL, index);
+  if (dev->version >= 2 ? vio_r32(dev, VIRTIO_MMIO_QUEUE_READY)
+                        : vio_r32(dev, VIRTIO_MMIO_QUEUE_PFN)) {
+    return NULL;  /* 已经在用 */
+  }
+  uint32_t max = vio_r32(dev, VIRTIO_MMIO_QUEUE_NUM_MAX);
+  if (max == 0) return NULL;
+
+  uint32_t num = VIRTQ_SIZE;
+  while (num > max) num >>= 1;
+
+  uint32_t slot = s_nvqs++;
+  uint8_t* mem  = s_vq_mem[slot];
+  memset(mem, 0, VIRTQ_MEM_BYTES);
+
+  virtq_t* vq   = &s_vqs[slot];
+  vq->dev       = dev;
+  vq->index     = index;
+  vq->num       = num;
+  vq->desc      = (volatile struct virtq_desc*)mem;
+  vq->avail     = (volatile struct virtq_avail*)(mem + VIRTQ_DESC_BYTES(num));
+  vq->used      = (volatile struct virtq_used*)(mem + VIRTQ_USED_OFF(num));
+  vq->used_event  = &vq->avail->ring[num];
+  vq->avail_event = (volatile uint16_t*)&vq->used->ring[num];
+  vq->indirect  = s_vq_indirect[slot];
+  vq->callback  = cb;
+  vq->free_head = 0;
+  vq->num_free  = (uint16_t)num;
+  vq->cb_enabled = 1;
+  for (uint32_t i = 0; i < num; ++i) {
+    vq->desc[i].next = (uint16_t)(i + 1u);
+  }
+
+  vio_w32(dev, VIRTIO_MMIO_QUEUE_NUM, num);
+  if (dev->version >= 2) {
+    uint64_t d = (uintptr_t)vq->desc;
+    uint64_t a = (uintptr_t)vq->avail;
+    uint64_t u = (uintptr_t)vq->used;
+    vio_w32(dev, VIRTIO_MMIO_QUEUE_DESC_LOW, (uint32_t)d);
+    vio_w32(dev, VIRTIO_MMIO_QUEUE_DESC_HIGH, (uint32_t)(d >> 32));
+    vio_w32(dev, VIRTIO_MMIO_QUEUE_DRIVER_LOW, (uint32_t)a);
+    vio_w32(dev, VIRTIO_MMIO_QUEUE_DRIVER_HIGH, (uint32_t)(a >> 32));
+    vio_w32(dev, VIRTIO_MMIO_QUEUE_DEVICE_LOW, (uint32_t)u);
+    vio_w32(dev, VIRTIO_MMIO_QUEUE_DEVICE_HIGH, (uint32_t)(u >> 32));
+    vio_w32(dev, VIRTIO_MMIO_QUEUE_READY, 1);
+  } else {
+    vio_w32(dev, VIRTIO_MMIO_QUEUE_ALIGN, VIRTQ_ALIGN);
+    vio_w32(dev, VIRTIO_MMIO_QUEUE_PFN, (uint32_t)((uintptr_t)mem / VIRTQ_ALIGN));
+  }
+
+  dev->vqs[index] = vq;
+  return vq;
+}
+
+int virtq_add(virtq_t* vq, const virtq_buf_t* bufs, uint32_t n_out,
+              uint32_t n_in, void* token) {
+  const uint32_t total = n_out + n_in;
+  if (!vq || !bufs || total == 0) return -EINVAL;
+
+  const int indirect = total > 1 && total <= VIRTQ_INDIRECT_MAX &&
+                       virtio_has_feature(vq->dev, VIRTIO_F_INDIRECT_DESC);
+  if (vq->num_free < (indirect ? 1u : total)) return -ENOSPC;
+
+  const uint16_t head = vq->free_head;
+
+  if (indirect) {
+    struct virtq_desc* tbl = vq->indirect[head];
+    for (uint32_t i = 0; i < total; ++i) {
+      tbl[i].addr  = (uintptr_t)bufs[i].addr;
+      tbl[i].len   = bufs[i].len;
+      tbl[i].flags = (uint16_t)((i >= n_out ? VIRTQ_DESC_F_WRITE : 0u) |
+                                (i + 1u < total ? VIRTQ_DESC_F_NEXT : 0u));
+      tbl[i].next  = (uint16_t)(i + 1u);
+    }
+
+    volatile struct virtq_desc* d = &vq->desc[head];
+    d->addr       = (uintptr_t)tbl;
+    d->len        = total * (uint32_t)sizeof(struct virtq_desc);
+    d->flags      = VIRTQ_DESC_F_INDIRECT;
+    vq->free_head = d->next;
+    vq->num_free--;
+    vq->indirect_adds++;
+  } else {
+    /* 空闲链本身就是 next 串起来的，按顺序填，最后一个去掉 NEXT */
+    uint16_t idx = head;
+    for (uint32_t i = 0; i < total; ++i) {
+      volatile struct virtq_desc* d = &vq->desc[idx];
+      d->addr  = (uintptr_t)bufs[i].addr;
+      d->len   = bufs[i].len;
+      d->flags = (uint16_t)((i >= n_out ? VIRTQ_DESC_F_WRITE : 0u) |
+                            (i + 1u < total ? VIRTQ_DESC_F_NEXT : 0u));
+      idx      = d->next;
+    }
+    vq->free_head = idx;
+    vq->num_free  = (uint16_t)(vq->num_free - total);
+  }
+
+  vq->token[head] = token;
+  vq->avail->ring[vq->avail_idx & (vq->num - 1u)] = head;
+  vq->avail_idx++;
+  return 0;
+}
+
+/* virtio spec 2.7.10：new_idx 越过 event 时才需要通知 */
+static inline int vring_need_event(uint16_t event, uint16_t new_idx,
+                                   uint16_t old_idx) {
+  return (uint16_t)(new_idx - event - 1u) < (uint16_t)(new_idx - old_idx);
+}
+
+void virtq_kick(virtq_t* vq) {
+  const uint16_t old_idx = vq->kicked_idx;
+  const uint16_t new_idx = vq->avail_idx;
+  if (old_idx == new_idx) return;
+
+  __asm__ volatile("fence w,w" ::: "memory");  /* ring[] -> idx */
+  vq->avail->idx = new_idx;
+  vq->kicked_idx = new_idx;
+  vio_mb();  /* 发布 idx 之后再看设备要不要通知 */
+
+  int need;
+  if (virtio_has_feature(vq->dev, VIRTIO_F_EVENT_IDX)) {
+    need = vring_need_event(*vq->avail_event, new_idx, old_idx);
+  } else {
+    need = !(vq->used->flags & VIRTQ_USED_F_NO_NOTIFY);
+  }
+
+  if (need) {
+    vio_w32(vq->dev, VIRTIO_MMIO_QUEUE_NOTIFY, vq->index);
+    vq->kicks++;
+  } else {
+    vq->kicks_suppressed++;
+  }
+}
+
+void* virtq_get_buf(virtq_t* vq, uint32_t* len) {
+  if (vq->last_used == vq->used->idx) return NULL;
+  __asm__ volatile("fence r,r" ::: "memory");  /* used idx -> ring[] */
+
+  const volatile struct virtq_used_elem* e =
+      &vq->used->ring[vq->last_used & (vq->num - 1u)];
+  const uint16_t head = (uint16_t)e->id;
+  if (len) *len = e->len;
+  vq->last_used++;
+
+  /* 整条链还回空闲链表 */
+  uint16_t idx = head;
+  uint16_t n   = 1;
+  while (vq->desc[idx].flags & VIRTQ_DESC_F_NEXT) {
+    idx = vq->desc[idx].next;
+    n++;
+  }
+  vq->desc[idx].next = vq->free_head;
+  vq->free_head      = head;
+  vq->num_free       = (uint16_t)(vq->num_free + n);
+
+  void* token     = vq->token[head];
+  vq->token[head] = NULL;
+
+  /* 回调开着：每收一个就把 used_event 往前推 */
+  if (vq->cb_enabled && virtio_has_feature(vq->dev, VIRTIO_F_EVENT_IDX)) {
+    *vq->used_event = vq->last_used;
+  }
+  return token;
+}
+
+void virtq_disable_cb(virtq_t* vq) {
+  vq->cb_enabled = 0;
+  /* EVENT_IDX 下不再推进 used_event 就不会来中断，flags 被设备忽略 */
+  if (!virtio_has_feature(vq->dev, VIRTIO_F_EVENT_IDX)) {
+    vq->avail->flags |= VIRTQ_AVAIL_F_NO_INTERRUPT;
+  }
+}
+
+int virtq_enable_cb(virtq_t* vq) {
+  vq->cb_enabled = 1;
+  if (virtio_has_feature(vq->dev, VIRTIO_F_EVENT_IDX)) {
+    *vq->used_event = vq->last_used;
+  } else {
+    vq->avail->flags &= (uint16_t)~VIRTQ_AVAIL_F_NO_INTERRUPT;
+  }
+  vio_mb();
+  return vq->last_used != vq->used->idx;
+}
+
+/* ========== IRQ ========== */
+
+void virtio_mmio_irq(uint32_t irq, void* arg) {
+  (void)irq;
+  virtio_dev_t* dev = (virtio_dev_t*)arg;
+
+  uint32_t isr = vio_r32(dev, VIRTIO_MMIO_INTERRUPT_STATUS);
+  vio_w32(dev, VIRTIO_MMIO_INTERRUPT_ACK, isr);
+
+  if (isr & VIRTIO_MMIO_INT_VRING) {
+    for (uint32_t i = 0; i < VIRTIO_DEV_MAX_VQS; ++i) {
+      virtq_t* vq = dev->vqs[i];
+      if (!vq || !vq->callback) continue;
+      vq->irqs++;
+      vq->callback(vq);
+    }
+  }
+  if ((isr & VIRTIO_MMIO_INT_CONFIG) && dev->config_changed) {
+    dev->config_changed(dev);
+  }
+}
@@ -0,0 +1,222 @@
+/* tools/mkefs/mkefs.c */
+
+/*
+ * 宿主机工具：生成 efs 镜像（格式见 kernel/include/efs_format.h）。
+ *
+ *   mkefs <image> <size_mb> [root_dir]
+ *
+ * root_dir 下的普通文件和子目录递归拷进去；每个文件的数据只占一段连续
+ * extent（按遍历顺序依次往后分配），所以镜像里的文件都是一段。
+ * 符号链接、设备文件等跳过。由 mk/fsimg.mk 调用。
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "efs_format.h"
+
+#define MKEFS_INODES_PER_MB 64u
+#define MKEFS_MIN_INODES    64u
+
+static uint8_t *s_img;
+static struct efs_super s_sb;
+static uint32_t s_next_ino  = EFS_ROOT_INO;
+static uint32_t s_next_data;
+static uint64_t s_now;
+
+static void
+die(const char *fmt, ...)
+{
+  va_list ap;
+  va_start(ap, fmt);
+  fprintf(stderr, "mkefs: ");
+  vfprintf(stderr, fmt, ap);
+  fprintf(stderr, "\n");
+  va_end(ap);
+  exit(1);
+}
+
+static uint8_t *
+blk(uint32_t bno)
+{
+  return s_img + (size_t)bno * EFS_BLOCK_SIZE;
+}
+
+static struct efs_dinode *
+dinode(uint32_t ino)
+{
+  return (struct efs_dinode *)(blk(s_sb.inode_start + ino / EFS_INODES_PER_BLOCK) +
+                               (ino % EFS_INODES_PER_BLOCK) * EFS_INODE_SIZE);
+}
+
+static uint32_t
+ialloc(uint16_t type)
+{
+  if (s_next_ino >= s_sb.ninodes) die("out of inodes (%u)", s_sb.ninodes);
+  uint32_t ino          = s_next_ino++;
+  struct efs_dinode *di = dinode(ino);
+  memset(di, 0, sizeof(*di));
+  di->type  = type;
+  di->nlink = 1;
+  di->mtime = s_now;
+  return ino;
+}
+
+/* 给 ino 分配一段能装下 size 字节的连续块，返回数据起点 */
+static uint8_t *
+alloc_data(uint32_t ino, uint64_t size)
+{
+  struct efs_dinode *di = dinode(ino);
+  uint64_t nb           = (size + EFS_BLOCK_SIZE - 1u) / EFS_BLOCK_SIZE;
+
+  di->size = size;
+  if (nb == 0) return NULL;
+  if (nb > s_sb.nblocks - s_next_data) die("image full (%llu more blocks)",
+                                           (unsigned long long)nb);
+  di->nextents   = 1;
+  di->ext[0]     = (struct efs_extent){s_next_data, (uint32_t)nb};
+  uint8_t *data  = blk(s_next_data);
+  s_next_data   += (uint32_t)nb;
+  return data;
+}
+
+static void
+add_file(uint32_t ino, const char *path, uint64_t size)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f) die("%s: %s", path, strerror(errno));
+
+  uint8_t *data = alloc_data(ino, size);
+  if (size && fread(data, 1, size, f) != size) die("%s: short read", path);
+  fclose(f);
+}
+
+typedef struct {
+  char name[EFS_NAME_MAX + 1];
+  char path[4096];
+  int is_dir;
+  uint64_t size;
+} entry_t;
+
+static int
+entry_cmp(const void *a, const void *b)
+{
+  return strcmp(((const entry_t *)a)->name, ((const entry_t *)b)->name);
+}
+
+/* 先给所有子项分配 inode 和数据，再写目录本身（目录大小这时才知道） */
+static void
+add_dir(uint32_t ino, const char *path)
+{
+  DIR *d = opendir(path);
+  if (!d) die("%s: %s", path, strerror(errno));
+
+  entry_t *ents = NULL;
+  size_t n = 0, cap = 0;
+  struct dirent *de;
+  while ((de = readdir(d)) != NULL) {
+    if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) continue;
+    if (strlen(de->d_name) > EFS_NAME_MAX) {
+      fprintf(stderr, "mkefs: skip %s/%s: name too long\n", path, de->d_name);
+      continue;
+    }
+
+    entry_t e = {0};
+    snprintf(e.path, sizeof(e.path), "%s/%s", path, de->d_name);
+    struct stat st;
+    if (lstat(e.path, &st) != 0) die("%s: %s", e.path, strerror(errno));
+    if (!S_ISREG(st.st_mode) && !S_ISDIR(st.st_mode)) continue;
+    strcpy(e.name, de->d_name);
+    e.is_dir = S_ISDIR(st.st_mode);
+    e.size   = (uint64_t)st.st_size;
+
+    if (n == cap) {
+      cap  = cap ? cap * 2u : 16u;
+      ents = realloc(ents, cap * sizeof(*ents));
+      if (!ents) die("out of memory");
+    }
+    ents[n++] = e;
+  }
+  closedir(d);
+  if (n) qsort(ents, n, sizeof(*ents), entry_cmp);
+
+  struct efs_dirent *tab = calloc(n ? n : 1u, sizeof(*tab));
+  if (!tab) die("out of memory");
+  for (size_t i = 0; i < n; ++i) {
+    uint32_t child = ialloc(ents[i].is_dir ? EFS_T_DIR : EFS_T_FILE);
+    tab[i].ino     = child;
+    memcpy(tab[i].name, ents[i].name, sizeof(tab[i].name));
+    if (ents[i].is_dir) {
+      add_dir(child, ents[i].path);
+    } else {
+      add_file(child, ents[i].path, ents[i].size);
+    }
+  }
+
+  uint8_t *data = alloc_data(ino, (uint64_t)n * EFS_DIRENT_SIZE);
+  if (n) memcpy(data, tab, n * EFS_DIRENT_SIZE);
+  free(tab);
+  free(ents);
+}
+
+int
+main(int argc, char **argv)
+{
+  if (argc < 3 || argc > 4) {
+    fprintf(stderr, "usage: mkefs <image> <size_mb> [root_dir]\n");
+    return 2;
+  }
+  const char *out  = argv[1];
+  long size_mb     = strtol(argv[2], NULL, 0);
+  const char *root = (argc == 4) ? argv[3] : NULL;
+  if (size_mb <= 0 || size_mb > 4096) die("bad size %s", argv[2]);
+
+  const uint32_t nblocks = (uint32_t)size_mb * (1024u * 1024u / EFS_BLOCK_SIZE);
+  uint32_t ninodes       = (uint32_t)size_mb * MKEFS_INODES_PER_MB;
+  if (ninodes < MKEFS_MIN_INODES) ninodes = MKEFS_MIN_INODES;
+
+  s_sb.magic          = EFS_MAGIC;
+  s_sb.version        = EFS_VERSION;
+  s_sb.block_size     = EFS_BLOCK_SIZE;
+  s_sb.nblocks        = nblocks;
+  s_sb.ninodes        = ninodes;
+  s_sb.inode_start    = 1;
+  s_sb.ninode_blocks  = (ninodes + EFS_INODES_PER_BLOCK - 1u) / EFS_INODES_PER_BLOCK;
+  s_sb.bitmap_start   = s_sb.inode_start + s_sb.ninode_blocks;
+  s_sb.nbitmap_blocks = (nblocks + EFS_BITS_PER_BLOCK - 1u) / EFS_BITS_PER_BLOCK;
+  s_sb.data_start     = s_sb.bitmap_start + s_sb.nbitmap_blocks;
+  s_sb.root_ino       = EFS_ROOT_INO;
+  if (s_sb.data_start >= nblocks) die("image too small");
+
+  s_img = calloc(nblocks, EFS_BLOCK_SIZE);
+  if (!s_img) die("out of memory");
+  s_next_data = s_sb.data_start;
+  s_now       = (uint64_t)time(NULL);
+
+  uint32_t root_ino = ialloc(EFS_T_DIR);
+  if (root) {
+    add_dir(root_ino, root);
+  }
+
+  /* 元数据 + 已分配的数据块：[0, s_next_data) 全部标成已用 */
+  uint8_t *bm = blk(s_sb.bitmap_start);
+  for (uint32_t b = 0; b < s_next_data; ++b) bm[b / 8u] |= (uint8_t)(1u << (b % 8u));
+  memcpy(blk(0), &s_sb, sizeof(s_sb));
+
+  FILE *f = fopen(out, "wb");
+  if (!f) die("%s: %s", out, strerror(errno));
+  if (fwrite(s_img, EFS_BLOCK_SIZE, nblocks, f) != nblocks) die("%s: write failed", out);
+  fclose(f);
+
+  printf("mkefs: %s: %u blocks, %u/%u inodes, %u/%u data blocks used\n", out,
+         nblocks, s_next_ino - 1u, ninodes, s_next_data - s_sb.data_start,
+         nblocks - s_sb.data_start);
+  free(s_img);
+  return 0;
+}
@@ -0,0 +1,1693 @@
+/* bench.c */
+
+/*
+ * 用户态微基准（shell: bench <sub> [args]）。
+ * 计时统一用 time CSR（rdtime），再按 vdso 里的 timebase 换算成 ns。
+ */
+
+#include <stdint.h>
+
+#include "bench.h"
+#include "chan.h"
+#include "ring.h"
+#include "syscall.h"
+#include "uapi.h"
+#include "ulib.h"
+#include "uerrno.h"
+#include "uthread.h"
+#include "utime.h"
+#include "usyscall.h"
+#include "uvdso.h"
+
+#define BENCH_DEFAULT_ITERS 10000u
+#define BENCH_DEFAULT_HZ    10000000ull  /* QEMU virt 默认 10MHz */
+
+/* ---- helpers ---- */
+
+static inline uint64_t
+bench_ticks(void)
+{
+  uint64_t t;
+  __asm__ volatile("rdtime %0" : "=r"(t));
+  return t;
+}
+
+static uint64_t
+bench_ticks_to_ns(uint64_t ticks)
+{
+  uint64_t hz = __vdso_data.timebase_hz ? __vdso_data.timebase_hz
+                                        : BENCH_DEFAULT_HZ;
+  uint64_t sec = ticks / hz;
+  uint64_t rem = ticks - sec * hz;
+  return sec * 1000000000ull + (rem * 1000000000ull) / hz;
+}
+
+/* 打印每次调用的平均耗时，保留一位小数 */
+static void
+bench_report(const char* what, uint64_t ticks, uint32_t iters)
+{
+  uint64_t ns10 = bench_ticks_to_ns(ticks) * 10u / (iters ? iters : 1u);
+  u_printf("  %-26s %6llu.%llu ns/call  (%u calls, %llu ticks)\n", what,
+           (unsigned long long)(ns10 / 10u), (unsigned long long)(ns10 % 10u),
+           (unsigned)iters, (unsigned long long)ticks);
+}
+
+static uint32_t
+bench_parse_iters(int argc, char** argv, int idx)
+{
+  if (argc > idx) {
+    int n = u_atoi(argv[idx]);
+    if (n > 0) return (uint32_t)n;
+  }
+  return BENCH_DEFAULT_ITERS;
+}
+
+/* ---- bench time: vdso 快速路径 vs 真 syscall ---- */
+
+static void
+bench_time(int argc, char** argv)
+{
+  uint32_t iters = bench_parse_iters(argc, argv, 2);
+  struct timespec ts;
+  uint64_t t0;
+  volatile int sink = 0;
+
+  u_printf("bench time: iters=%u vdso=%s\n", (unsigned)iters,
+           __vdso_data.ready ? "ready" : "off");
+
+  t0 = bench_ticks();
+  for (uint32_t i = 0; i < iters; ++i) {
+    clock_gettime_syscall(CLOCK_MONOTONIC, &ts);
+  }
+  bench_report("clock_gettime (syscall)", bench_ticks() - t0, iters);
+
+  t0 = bench_ticks();
+  for (uint32_t i = 0; i < iters; ++i) {
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+  }
+  bench_report("clock_gettime (vdso)", bench_ticks() - t0, iters);
+
+  t0 = bench_ticks();
+  for (uint32_t i = 0; i < iters; ++i) {
+    sink += get_hartid_syscall();
+  }
+  bench_report("get_hartid (syscall)", bench_ticks() - t0, iters);
+
+  t0 = bench_ticks();
+  for (uint32_t i = 0; i < iters; ++i) {
+    sink += get_hartid();
+  }
+  bench_report("get_hartid (vdso)", bench_ticks() - t0, iters);
+
+  (void)sink;
+}
+
+/* ---- bench ring: 每行一次 write() vs 批量 ring vs SQPOLL ---- */
+
+#define BENCH_RING_DEFAULT_LINES 64u
+#define BENCH_RING_DEFAULT_BATCH 16u
+
+static struct sysstat_user s_bench_sysstat[MAX_HARTS * SYSSTAT_MAX_NR];
+static struct uring s_bench_ring;
+static const char s_bench_line[] = "bench ring: ................................\n";
+
+/* 所有 hart 上的 syscall（陷入）总数 */
+static uint64_t
+bench_syscalls(void)
+{
+  long n = sysstat_get(s_bench_sysstat, MAX_HARTS * SYSSTAT_MAX_NR, 0);
+  uint64_t total = 0;
+  for (long i = 0; i < n; ++i) {
+    total += s_bench_sysstat[i].count;
+  }
+  return total;
+}
+
+typedef struct {
+  const char* what;
+  uint64_t ticks;
+  uint64_t traps;
+} bench_ring_result_t;
+
+static void
+bench_ring_wait_cqes(struct uring* r, uint32_t n)
+{
+  while (n > 0) {
+    struct uring_cqe* cqe = ring_peek_cqe(r);
+    if (!cqe) {
+      if (r->setup_flags & URING_SETUP_SQPOLL) yield();
+      continue;
+    }
+    ring_cqe_seen(r);
+    n--;
+  }
+}
+
+/* 用 ring 打印 lines 行，每 batch 行提交一次；每批末尾带一个 clock_gettime */
+static int
+bench_ring_run(uint32_t flags, uint32_t lines, uint32_t batch,
+               bench_ring_result_t* out)
+{
+  struct uring* r = &s_bench_ring;
+  struct timespec ts;
+
+  int rc = ring_init(r, URING_MAX_ENTRIES, flags);
+  if (rc < 0) return rc;
+
+  uint64_t traps0 = bench_syscalls();
+  uint64_t t0     = bench_ticks();
+
+  for (uint32_t i = 0; i < lines;) {
+    uint32_t n = 0;
+    for (; n < batch && i < lines; ++n, ++i) {
+      ring_prep_write(r, FD_STDOUT, s_bench_line, sizeof(s_bench_line) - 1, i);
+    }
+
+    struct uring_sqe* sqe = ring_get_sqe(r);
+    if (sqe) {
+      sqe->op        = URING_OP_CLOCK_GETTIME;
+      sqe->fd        = CLOCK_MONOTONIC;
+      sqe->addr      = (uint64_t)(uintptr_t)&ts;
+      sqe->len       = 0;
+      sqe->user_data = ~0ull;
+      n++;
+    }
+
+    long sub = ring_submit(r);
+    if (sub < 0) {
+      ring_exit(r);
+      return (int)sub;
+    }
+    bench_ring_wait_cqes(r, n);
+  }
+
+  out->ticks = bench_ticks() - t0;
+  out->traps = bench_syscalls() - traps0 - 1u;  /* 去掉 bench_syscalls 自己 */
+  ring_exit(r);
+  return 0;
+}
+
+static void
+bench_ring_report(const bench_ring_result_t* res, uint32_t lines)
+{
+  uint64_t tpl100 = res->traps * 100u / (lines ? lines : 1u);
+  uint64_t ns     = bench_ticks_to_ns(res->ticks) / (lines ? lines : 1u);
+  u_printf("  %-16s %6llu ns/line  %4llu traps  %llu.%02llu traps/line\n",
+           res->what, (unsigned long long)ns, (unsigned long long)res->traps,
+           (unsigned long long)(tpl100 / 100u),
+           (unsigned long long)(tpl100 % 100u));
+}
+
+static void
+bench_ring(int argc, char** argv)
+{
+  uint32_t lines = BENCH_RING_DEFAULT_LINES;
+  uint32_t batch = BENCH_RING_DEFAULT_BATCH;
+  if (argc > 2 && u_atoi(argv[2]) > 0) lines = (uint32_t)u_atoi(argv[2]);
+  if (argc > 3 && u_atoi(argv[3]) > 0) batch = (uint32_t)u_atoi(argv[3]);
+  if (batch > URING_MAX_ENTRIES - 1u) batch = URING_MAX_ENTRIES - 1u;
+
+  bench_ring_result_t res[3] = {
+      {"write()", 0, 0}, {"ring", 0, 0}, {"ring+sqpoll", 0, 0}};
+  int rc;
+
+  /* 1) 每行一次 write syscall */
+  u_fflush();
+  uint64_t traps0 = bench_syscalls();
+  uint64_t t0     = bench_ticks();
+  for (uint32_t i = 0; i < lines; ++i) {
+    write(FD_STDOUT, s_bench_line, sizeof(s_bench_line) - 1);
+  }
+  res[0].ticks = bench_ticks() - t0;
+  res[0].traps = bench_syscalls() - traps0 - 1u;
+
+  /* 2) 批量提交：每 batch 行一次 SYS_RING_ENTER */
+  rc = bench_ring_run(0, lines, batch, &res[1]);
+  if (rc < 0) {
+    u_printf("bench ring: ring_init failed (%d)\n", rc);
+    return;
+  }
+
+  /* 3) SQPOLL：内核线程轮询，正常情况下不陷入 */
+  rc = bench_ring_run(URING_SETUP_SQPOLL, lines, batch, &res[2]);
+  if (rc < 0) {
+    u_printf("bench ring: sqpoll ring_init failed (%d)\n", rc);
+    return;
+  }
+
+  u_printf("bench ring: lines=%u batch=%u\n", (unsigned)lines, (unsigned)batch);
+  for (int i = 0; i < 3; ++i) {
+    bench_ring_report(&res[i], lines);
+  }
+}
+
+/* ---- bench string: 正确性语料 + cycles/byte ----
+ * 标量路径就是内核 lib/string.c 用的 string_word.h，语料一并覆盖内核的实现 */
+
+#define BENCH_STR_MAX   (64u * 1024u)
+#define BENCH_STR_SLACK 64u
+
+static unsigned char s_str_a[BENCH_STR_MAX + BENCH_STR_SLACK]
+    __attribute__((aligned(64)));
+static unsigned char s_str_b[BENCH_STR_MAX + BENCH_STR_SLACK]
+    __attribute__((aligned(64)));
+static unsigned char s_str_c[BENCH_STR_MAX + BENCH_STR_SLACK]
+    __attribute__((aligned(64)));
+
+static inline uint64_t
+bench_cycles(void)
+{
+  uint64_t c;
+  __asm__ volatile("rdcycle %0" : "=r"(c));
+  return c;
+}
+
+/* 逐字节参考实现（构建带 -fno-tree-loop-distribute-patterns，不会被改成库调用） */
+static void
+ref_memmove(unsigned char* d, const unsigned char* s, size_t n)
+{
+  if (d < s) {
+    for (size_t i = 0; i < n; ++i) d[i] = s[i];
+  } else {
+    for (size_t i = n; i > 0; --i) d[i - 1] = s[i - 1];
+  }
+}
+
+static int
+ref_sign(int v)
+{
+  return (v > 0) - (v < 0);
+}
+
+static uint32_t s_str_seed = 12345u;
+
+static unsigned char
+bench_rand8(void)
+{
+  s_str_seed = s_str_seed * 1103515245u + 12345u;
+  return (unsigned char)(s_str_seed >> 16);
+}
+
+static void
+bench_str_fill(void)
+{
+  for (size_t i = 0; i < 512; ++i) {
+    s_str_a[i] = bench_rand8();
+    s_str_b[i] = s_str_c[i] = bench_rand8();
+  }
+}
+
+/* 长度 0..160 × src/dst 对齐 0..7，逐项和参考实现对比；返回失败数 */
+static uint32_t
+bench_string_check(void)
+{
+  uint32_t fails = 0;
+
+#define STR_FAIL(what)                                                     \
+  do {                                                                     \
+    if (fails++ < 8) {                                                     \
+      u_printf("  FAIL %s n=%u so=%u do=%u\n", what, (unsigned)n,          \
+               (unsigned)so, (unsigned)dof);                               \
+    }                                                                      \
+  } while (0)
+
+  for (size_t n = 0; n <= 160; ++n) {
+    for (size_t so = 0; so < 8; ++so) {
+      for (size_t dof = 0; dof < 8; ++dof) {
+        unsigned char* a = s_str_a;
+        unsigned char* b = s_str_b;
+        unsigned char* c = s_str_c;
+
+        bench_str_fill();
+        u_memcpy(b + dof, a + so, n);
+        ref_memmove(c + dof, a + so, n);
+        for (size_t i = 0; i < 512; ++i) {
+          if (b[i] != c[i]) { STR_FAIL("memcpy"); break; }
+        }
+
+        u_memset(b + dof, (int)(so * 37u), n);
+        for (size_t i = 0; i < n; ++i) c[dof + i] = (unsigned char)(so * 37u);
+        for (size_t i = 0; i < 512; ++i) {
+          if (b[i] != c[i]) { STR_FAIL("memset"); break; }
+        }
+
+        /* 重叠 memmove，两个方向 */
+        for (size_t i = 0; i < 512; ++i) b[i] = c[i] = a[i];
+        u_memmove(b + 64 + dof, b + 64 + so + 8, n);
+        ref_memmove(c + 64 + dof, c + 64 + so + 8, n);
+        u_memmove(b + 64 + so + 8, b + 64 + dof, n);
+        ref_memmove(c + 64 + so + 8, c + 64 + dof, n);
+        for (size_t i = 0; i < 512; ++i) {
+          if (b[i] != c[i]) { STR_FAIL("memmove"); break; }
+        }
+
+        /* memcmp：相等，以及每隔几个字节翻一位 */
+        for (size_t i = 0; i < n; ++i) b[dof + i] = a[so + i];
+        if (u_memcmp(b + dof, a + so, n) != 0) STR_FAIL("memcmp==");
+        for (size_t k = 0; k < n; k += 5) {
+          b[dof + k] ^= 0x81u;
+          int want = ref_sign((int)b[dof + k] - (int)a[so + k]);
+          if (ref_sign(u_memcmp(b + dof, a + so, n)) != want) STR_FAIL("memcmp");
+          b[dof + k] ^= 0x81u;
+        }
+
+        /* strlen/strchr/memchr：非零字节串 */
+        for (size_t i = 0; i < n + 16; ++i) {
+          b[dof + i] = (unsigned char)(1u + i % 251u);
+        }
+        b[dof + n] = 0;
+        const char* str = (const char*)(b + dof);
+        if (u_strlen(str) != n) STR_FAIL("strlen");
+        for (int ch = 1; ch < 256; ch += 17) {
+          const char* want = 0;
+          for (size_t i = 0; i < n; ++i) {
+            if ((unsigned char)str[i] == (unsigned char)ch) {
+              want = str + i;
+              break;
+            }
+          }
+          if (u_strchr(str, ch) != want) STR_FAIL("strchr");
+          if (u_memchr(str, ch, n) != want) STR_FAIL("memchr");
+        }
+        if (u_strchr(str, 0) != str + n) STR_FAIL("strchr\\0");
+      }
+    }
+  }
+#undef STR_FAIL
+
+  return fails;
+}
+
+typedef enum {
+  STR_OP_MEMCPY,
+  STR_OP_MEMSET,
+  STR_OP_MEMMOVE,
+  STR_OP_STRLEN,
+} str_op_t;
+
+static uint64_t
+bench_string_one(str_op_t op, size_t size, size_t misalign, uint32_t reps)
+{
+  unsigned char* dst = s_str_b;
+  unsigned char* src = s_str_a + misalign;
+  volatile size_t sink = 0;
+
+  if (op == STR_OP_STRLEN) {
+    u_memset(src, 'x', size);
+    src[size] = 0;
+  }
+
+  uint64_t c0 = bench_cycles();
+  for (uint32_t r = 0; r < reps; ++r) {
+    switch (op) {
+      case STR_OP_MEMCPY:  u_memcpy(dst, src, size); break;
+      case STR_OP_MEMSET:  u_memset(dst, (int)r, size); break;
+      case STR_OP_MEMMOVE: u_memmove(dst + 8, dst, size); break;
+      case STR_OP_STRLEN:  sink += u_strlen((const char*)src); break;
+    }
+  }
+  (void)sink;
+  return bench_cycles() - c0;
+}
+
+static void
+bench_string_table(void)
+{
+  static const struct {
+    const char* name;
+    str_op_t op;
+    size_t misalign;
+  } ops[] = {
+      {"memcpy", STR_OP_MEMCPY, 0},   {"memcpy+3", STR_OP_MEMCPY, 3},
+      {"memset", STR_OP_MEMSET, 0},   {"memmove", STR_OP_MEMMOVE, 0},
+      {"strlen", STR_OP_STRLEN, 0},
+  };
+  static const size_t sizes[] = {8, 64, 512, 4096, 65536};
+
+  u_printf("  %-10s", "size");
+  for (size_t j = 0; j < sizeof(sizes) / sizeof(sizes[0]); ++j) {
+    u_printf(" %8u", (unsigned)sizes[j]);
+  }
+  u_putchar('\n');
+
+  for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); ++i) {
+    u_printf("  %-10s", ops[i].name);
+    for (size_t j = 0; j < sizeof(sizes) / sizeof(sizes[0]); ++j) {
+      size_t size   = sizes[j];
+      uint32_t reps = (uint32_t)((256u * 1024u) / size);
+      if (reps < 4) reps = 4;
+
+      bench_string_one(ops[i].op, size, ops[i].misalign, 1);  /* warm up */
+      uint64_t cyc = bench_string_one(ops[i].op, size, ops[i].misalign, reps);
+      uint64_t cpb100 = cyc * 100u / ((uint64_t)size * reps);
+      u_printf(" %8llu", (unsigned long long)cpb100);
+    }
+    u_putchar('\n');
+  }
+}
+
+static void
+bench_string(int argc, char** argv)
+{
+  (void)argc;
+  (void)argv;
+
+  static const struct {
+    int impl;
+    const char* name;
+  } impls[] = {
+      {U_STRING_IMPL_SCALAR, "scalar (word, = kernel)"},
+      {U_STRING_IMPL_RVV, "rvv"},
+  };
+  const int saved = u_string_impl();
+
+  for (size_t k = 0; k < sizeof(impls) / sizeof(impls[0]); ++k) {
+    if (u_string_set_impl(impls[k].impl) != 0) {
+      u_printf("bench string [%s]: not available (no V in vdso hwcap)\n",
+               impls[k].name);
+      continue;
+    }
+
+    u_printf("bench string [%s]: correctness (len 0..160, all alignments)\n",
+             impls[k].name);
+    uint32_t fails = bench_string_check();
+    u_printf("  %s (%u failures)\n", fails ? "FAILED" : "ok", (unsigned)fails);
+
+    u_printf("bench string [%s]: cycles/byte (x100)\n", impls[k].name);
+    bench_string_table();
+  }
+
+  u_string_set_impl(saved);
+}
+
+/* ---- bench trap: 陷入往返 cycles（syscall 快路径：不切换线程就不搬 s0..s11） ---- */
+
+/* 所有 hart 上 SYS_NOP 在内核里（分发 + handler）花的 ticks */
+static uint64_t
+bench_nop_kernel_ticks(uint64_t* count)
+{
+  long n = sysstat_get(s_bench_sysstat, MAX_HARTS * SYSSTAT_MAX_NR, 0);
+  uint64_t ticks = 0;
+  *count = 0;
+  for (long i = 0; i < n; ++i) {
+    if (s_bench_sysstat[i].nr != SYS_NOP) continue;
+    ticks += s_bench_sysstat[i].total_ticks;
+    *count += s_bench_sysstat[i].count;
+  }
+  return ticks;
+}
+
+static void
+bench_trap(int argc, char** argv)
+{
+  uint32_t iters = bench_parse_iters(argc, argv, 2);
+  volatile long sink = 0;
+  uint64_t c0, cnt0, cnt1;
+
+  u_printf("bench trap: iters=%u (kernel .text / trap_entry size: make size)\n",
+           (unsigned)iters);
+
+  /* SYS_NOP：handler 什么都不做，量到的就是陷入 + 快路径返回 */
+  uint64_t k0 = bench_nop_kernel_ticks(&cnt0);
+  c0 = bench_cycles();
+  uint64_t t0 = bench_ticks();
+  for (uint32_t i = 0; i < iters; ++i) {
+    sink += nop_syscall();
+  }
+  uint64_t nop_ticks = bench_ticks() - t0;
+  uint64_t nop       = bench_cycles() - c0;
+  uint64_t k1        = bench_nop_kernel_ticks(&cnt1);
+
+  c0 = bench_cycles();
+  for (uint32_t i = 0; i < iters; ++i) {
+    sink += get_hartid_syscall();
+  }
+  uint64_t ecall = bench_cycles() - c0;
+
+  /* 没有别的可运行线程时 yield 也不切换：schedule() 往返 + 快路径 */
+  c0 = bench_cycles();
+  for (uint32_t i = 0; i < iters; ++i) {
+    yield();
+  }
+  uint64_t yld = bench_cycles() - c0;
+
+  u_printf("  %-26s %6llu cycles/trap\n", "ecall nop",
+           (unsigned long long)(nop / iters));
+  u_printf("  %-26s %6llu cycles/trap\n", "ecall get_hartid",
+           (unsigned long long)(ecall / iters));
+  u_printf("  %-26s %6llu cycles/trap\n", "ecall yield (no switch)",
+           (unsigned long long)(yld / iters));
+
+  /* sysstat 只量 syscall_handler 里那一段；剩下的是 trap.S 入口/出口 + 锁 */
+  bench_report("ecall nop", nop_ticks, iters);
+  if (cnt1 > cnt0) {
+    bench_report("  in syscall_handler", k1 - k0, (uint32_t)(cnt1 - cnt0));
+  }
+
+  t0 = bench_ticks();
+  for (uint32_t i = 0; i < iters; ++i) {
+    sink += get_hartid();
+  }
+  bench_report("no trap (vdso get_hartid)", bench_ticks() - t0, iters);
+  (void)sink;
+}
+
+/* ---- bench fp: FP 吞吐 + 上下文切换代价（FS 干净 vs 脏） ---- */
+
+#define BENCH_FP_DEFAULT_ROUNDS 2000u
+#define BENCH_FP_THREADS_MAX    8u
+#define BENCH_FP_VEC_LEN        256u
+
+#ifdef CONFIG_RISCV_FP
+
+static volatile uint32_t s_bench_fp_rounds;
+static volatile uint32_t s_bench_fp_dirty;  /* 1 = 每轮 yield 前写 FP 寄存器 */
+static double s_bench_fp_a[BENCH_FP_VEC_LEN];
+static double s_bench_fp_b[BENCH_FP_VEC_LEN];
+
+static void __attribute__((noreturn))
+bench_fp_worker(void* arg)
+{
+  volatile double acc = 1.0 + (double)(uintptr_t)arg;
+
+  for (uint32_t i = 0; i < s_bench_fp_rounds; ++i) {
+    if (s_bench_fp_dirty) {
+      acc = acc * 1.000001 + 0.5;  /* FS -> Dirty，切走时要保存 */
+    }
+    yield();
+  }
+
+  thread_exit(0);
+}
+
+/* threads 个线程各 yield rounds 次，返回总 ticks */
+static uint64_t
+bench_fp_switch_run(uint32_t threads, uint32_t rounds, uint32_t dirty)
+{
+  tid_t tids[BENCH_FP_THREADS_MAX];
+  uint32_t n = 0;
+
+  s_bench_fp_rounds = rounds;
+  s_bench_fp_dirty  = dirty;
+
+  uint64_t t0 = bench_ticks();
+  for (uint32_t i = 0; i < threads; ++i) {
+    tid_t tid = thread_create(bench_fp_worker, (void*)(uintptr_t)i, "bench-fp");
+    if (tid < 0) break;
+    tids[n++] = tid;
+  }
+  for (uint32_t i = 0; i < n; ++i) {
+    int status = 0;
+    thread_join(tids[i], &status);
+  }
+  return bench_ticks() - t0;
+}
+
+static double
+bench_fp_dot(const double* a, const double* b, uint32_t n)
+{
+  double sum = 0.0;
+  for (uint32_t i = 0; i < n; ++i) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+static void
+bench_fp(int argc, char** argv)
+{
+  uint32_t rounds = (argc > 2 && u_atoi(argv[2]) > 0) ? (uint32_t)u_atoi(argv[2])
+                                                      : BENCH_FP_DEFAULT_ROUNDS;
+
+  if (!(__vdso_data.hwcap & VDSO_HWCAP_FD)) {
+    u_puts("bench fp: kernel did not enable F/D (see vdso hwcap)");
+    return;
+  }
+
+  /* 1) 吞吐：double 点积 */
+  for (uint32_t i = 0; i < BENCH_FP_VEC_LEN; ++i) {
+    s_bench_fp_a[i] = (double)i * 0.5;
+    s_bench_fp_b[i] = 1.0 / (double)(i + 1u);
+  }
+
+  const uint32_t reps = 200u;
+  volatile double sink = 0.0;
+  uint64_t c0 = bench_cycles();
+  for (uint32_t r = 0; r < reps; ++r) {
+    sink += bench_fp_dot(s_bench_fp_a, s_bench_fp_b, BENCH_FP_VEC_LEN);
+  }
+  uint64_t cyc = bench_cycles() - c0;
+  u_printf("bench fp: dot product len=%u: %llu.%02llu cycles/element\n",
+           (unsigned)BENCH_FP_VEC_LEN,
+           (unsigned long long)(cyc / ((uint64_t)reps * BENCH_FP_VEC_LEN)),
+           (unsigned long long)(cyc * 100u / ((uint64_t)reps * BENCH_FP_VEC_LEN) % 100u));
+  (void)sink;
+
+  /* 2) 上下文切换：每个 hart 两个线程互相 yield，保证每次 yield 都真的切换 */
+  uint32_t harts   = __vdso_data.nr_harts ? __vdso_data.nr_harts : 1u;
+  uint32_t threads = 2u * harts;
+  if (threads > BENCH_FP_THREADS_MAX) threads = BENCH_FP_THREADS_MAX;
+
+  /* 并行跑在 harts 个 hart 上：按每个 hart 的切换次数算平均。
+   * dirty 一行 = 切走时保存 f0-f31 + 回来后第一条 FP 指令陷入恢复。
+   */
+  uint32_t per_hart = (uint32_t)((uint64_t)threads * rounds / harts);
+
+  u_printf("bench fp: context switch, threads=%u rounds=%u\n", (unsigned)threads,
+           (unsigned)rounds);
+  bench_report("yield, FP untouched (Off)", bench_fp_switch_run(threads, rounds, 0),
+               per_hart);
+  bench_report("yield, FP dirty each round", bench_fp_switch_run(threads, rounds, 1),
+               per_hart);
+}
+
+#else
+
+static void
+bench_fp(int argc, char** argv)
+{
+  (void)argc;
+  (void)argv;
+  u_puts("bench fp: needs a RISCV_FP=YES (rv64gc) build");
+}
+
+#endif /* CONFIG_RISCV_FP */
+
+/* ---- stress: lockless introspection vs. thread churn ---- */
+
+/*
+ * 一个 monitor 线程不停地调 thread_list / runqueue_snapshot / irq_get_stats /
+ * clock_gettime（都是免锁 syscall），同时若干 spawner 线程反复 create+join
+ * 短命线程，让线程槽和 runqueue 一直在变。monitor 检查每份快照的自洽性：
+ * tid 合法且不重复、名字非空、runqueue 里没有重复 tid、MONOTONIC 不倒退。
+ */
+
+#define BENCH_STRESS_DEFAULT_MS  2000u
+#define BENCH_STRESS_SPAWNERS    4u
+#define BENCH_STRESS_CHILD_YIELD 3u
+
+static volatile uint32_t s_stress_stop;
+static volatile uint64_t s_stress_spawned;
+static volatile uint32_t s_stress_full;  /* create 失败（槽满）次数 */
+
+static struct u_thread_info s_stress_threads[THREAD_MAX];
+static struct rq_state s_stress_rqs[MAX_HARTS];
+static struct irqstat_user s_stress_irqs[IRQSTAT_MAX_IRQ];
+
+typedef struct {
+  uint64_t polls;
+  uint64_t errors;
+  uint64_t poll_ticks;
+  uint64_t poll_max;
+} stress_mon_t;
+
+static stress_mon_t s_stress_mon;
+
+static void __attribute__((noreturn))
+bench_stress_child(void* arg)
+{
+  (void)arg;
+  for (uint32_t i = 0; i < BENCH_STRESS_CHILD_YIELD; ++i) {
+    yield();
+  }
+  thread_exit(0);
+}
+
+static void __attribute__((noreturn))
+bench_stress_spawner(void* arg)
+{
+  (void)arg;
+  while (!s_stress_stop) {
+    tid_t tid = thread_create(bench_stress_child, NULL, "stress-child");
+    if (tid < 0) {
+      s_stress_full++;
+      yield();
+      continue;
+    }
+    int status = 0;
+    thread_join(tid, &status);
+    __atomic_fetch_add(&s_stress_spawned, 1u, __ATOMIC_RELAXED);
+  }
+  thread_exit(0);
+}
+
+/* 返回本轮发现的不一致个数 */
+static uint32_t
+bench_stress_check(int nthreads, int nrqs)
+{
+  uint8_t seen[THREAD_MAX];
+  uint32_t bad = 0;
+
+  u_memset(seen, 0, sizeof(seen));
+  for (int i = 0; i < nthreads; ++i) {
+    const struct u_thread_info* ti = &s_stress_threads[i];
+    if (ti->tid < 0 || ti->tid >= THREAD_MAX || seen[ti->tid]) {
+      bad++;
+      continue;
+    }
+    seen[ti->tid] = 1;
+    if (ti->name[0] == '\0' || ti->state == THREAD_UNUSED) bad++;
+  }
+
+  for (int h = 0; h < nrqs; ++h) {
+    const struct rq_state* rs = &s_stress_rqs[h];
+    if (rs->len > RQ_MAX_TIDS) {
+      bad++;
+      continue;
+    }
+    u_memset(seen, 0, sizeof(seen));
+    for (uint32_t i = 0; i < rs->len; ++i) {
+      tid_t t = rs->tids[i];
+      if (t < 0 || t >= THREAD_MAX || seen[t]) {
+        bad++;
+        break;
+      }
+      seen[t] = 1;
+    }
+  }
+  return bad;
+}
+
+static void __attribute__((noreturn))
+bench_stress_monitor(void* arg)
+{
+  (void)arg;
+  stress_mon_t* m = &s_stress_mon;
+  uint64_t last_mono = 0;
+
+  while (!s_stress_stop) {
+    struct timespec ts;
+    uint64_t t0 = bench_ticks();
+
+    int nthreads = thread_list(s_stress_threads, THREAD_MAX);
+    int nrqs     = runqueue_snapshot(s_stress_rqs, MAX_HARTS);
+    long nirqs   = irq_get_stats(s_stress_irqs, IRQSTAT_MAX_IRQ);
+    int clk      = clock_gettime_syscall(CLOCK_MONOTONIC, &ts);
+
+    uint64_t dt = bench_ticks() - t0;
+    m->polls++;
+    m->poll_ticks += dt;
+    if (dt > m->poll_max) m->poll_max = dt;
+
+    if (nthreads < 0 || nrqs < 0 || nirqs < 0 || clk != 0) {
+      m->errors++;
+      continue;
+    }
+    m->errors += bench_stress_check(nthreads, nrqs);
+
+    uint64_t mono = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    if (mono < last_mono) m->errors++;
+    last_mono = mono;
+
+    /* mon 的节奏：每轮让一下，别把自己的 hart 占满 */
+    yield();
+  }
+  thread_exit(0);
+}
+
+static void
+bench_stress(int argc, char** argv)
+{
+  uint32_t ms = (argc > 2 && u_atoi(argv[2]) > 0) ? (uint32_t)u_atoi(argv[2])
+                                                  : BENCH_STRESS_DEFAULT_MS;
+  uint64_t hz = __vdso_data.timebase_hz ? __vdso_data.timebase_hz
+                                        : BENCH_DEFAULT_HZ;
+  tid_t tids[1u + BENCH_STRESS_SPAWNERS];
+  uint32_t n = 0;
+
+  s_stress_stop    = 0;
+  s_stress_spawned = 0;
+  s_stress_full    = 0;
+  s_stress_mon     = (stress_mon_t){0};
+
+  tid_t mon = thread_create(bench_stress_monitor, NULL, "stress-mon");
+  if (mon < 0) {
+    u_puts("bench stress: cannot create monitor thread");
+    return;
+  }
+  tids[n++] = mon;
+  for (uint32_t i = 0; i < BENCH_STRESS_SPAWNERS; ++i) {
+    tid_t tid = thread_create(bench_stress_spawner, NULL, "stress-spawn");
+    if (tid < 0) break;
+    tids[n++] = tid;
+  }
+
+  u_printf("bench stress: 1 monitor + %u spawners for %u ms\n",
+           (unsigned)(n - 1u), (unsigned)ms);
+  uint64_t deadline = bench_ticks() + (uint64_t)ms * hz / 1000u;
+  while (bench_ticks() < deadline) {
+    sleep(1);
+  }
+  s_stress_stop = 1;
+
+  for (uint32_t i = 0; i < n; ++i) {
+    int status = 0;
+    thread_join(tids[i], &status);
+  }
+
+  const stress_mon_t* m = &s_stress_mon;
+  u_printf("  spawned+joined   %llu threads (%u create failures: slots full)\n",
+           (unsigned long long)s_stress_spawned, (unsigned)s_stress_full);
+  u_printf("  monitor polls    %llu, inconsistent snapshots %llu\n",
+           (unsigned long long)m->polls, (unsigned long long)m->errors);
+  if (m->polls) {
+    bench_report("monitor poll (4 syscalls)", m->poll_ticks, (uint32_t)m->polls);
+    u_printf("  worst poll       %llu ns\n",
+             (unsigned long long)bench_ticks_to_ns(m->poll_max));
+  }
+  u_puts(m->errors ? "bench stress: FAIL" : "bench stress: OK");
+}
+
+/* ---- bench blk: virtio-blk 顺序 / 随机 4 KiB ---- */
+
+/*
+ * 每个 4 KiB 块的前 8 字节写块号，读回来校验；随机模式的块号落在
+ * 前 BENCH_BLK_SPAN_SECT 个扇区（或整盘，取小）里。
+ * 一次 blk_io 提交 qd 个请求，相当于队列深度 qd。
+ */
+#define BENCH_BLK_BS          4096u
+#define BENCH_BLK_SECT        (BENCH_BLK_BS / BLK_SECTOR_SIZE)
+#define BENCH_BLK_SPAN_SECT   (32u * 2048u)  /* 32 MiB */
+#define BENCH_BLK_DEFAULT_OPS 2048u
+#define BENCH_BLK_DEFAULT_QD  16u
+
+static uint8_t s_blk_buf[BLK_IO_MAX_BATCH][BENCH_BLK_BS]
+    __attribute__((aligned(BENCH_BLK_BS)));
+static struct blk_io s_blk_iov[BLK_IO_MAX_BATCH];
+
+static uint64_t s_blk_rand = 0x9e3779b97f4a7c15ull;
+
+static uint64_t
+bench_blk_rand(void)
+{
+  /* xorshift64 */
+  s_blk_rand ^= s_blk_rand << 13;
+  s_blk_rand ^= s_blk_rand >> 7;
+  s_blk_rand ^= s_blk_rand << 17;
+  return s_blk_rand;
+}
+
+static void
+bench_blk_fill(uint8_t* buf, uint64_t sector)
+{
+  u_memset(buf, (int)(sector & 0xffu), BENCH_BLK_BS);
+  u_memcpy(buf, &sector, sizeof(sector));
+}
+
+typedef struct {
+  const char* name;
+  uint32_t op;
+  int random;
+} bench_blk_pat_t;
+
+static void
+bench_blk_run(uint32_t dev, const bench_blk_pat_t* pat, uint32_t qd,
+              uint32_t ops, uint64_t span_blocks)
+{
+  struct blkstat_user st;
+  blk_stat(dev, &st, BLKSTAT_F_RESET);
+
+  uint64_t next_blk = 0;
+  uint32_t done     = 0;
+  uint32_t bad      = 0;
+  long err          = 0;
+  uint64_t t0       = bench_ticks();
+
+  while (done < ops && !err) {
+    uint32_t n = (ops - done < qd) ? ops - done : qd;
+    for (uint32_t i = 0; i < n; ++i) {
+      uint64_t blk = pat->random ? bench_blk_rand() % span_blocks
+                                 : next_blk++ % span_blocks;
+      uint64_t sector = blk * BENCH_BLK_SECT;
+      if (pat->op == BLK_OP_WRITE) bench_blk_fill(s_blk_buf[i], sector);
+
+      s_blk_iov[i] = (struct blk_io){
+          .op     = pat->op,
+          .nsect  = BENCH_BLK_SECT,
+          .sector = sector,
+          .buf    = (uint64_t)(uintptr_t)s_blk_buf[i],
+      };
+    }
+
+    long r = blk_io(dev, s_blk_iov, n);
+    if (r < 0) {
+      err = r;
+      break;
+    }
+    if (pat->op == BLK_OP_READ) {
+      for (uint32_t i = 0; i < n; ++i) {
+        uint64_t tag;
+        u_memcpy(&tag, s_blk_buf[i], sizeof(tag));
+        /* 没写过的块是 0，也算对 */
+        if (tag != s_blk_iov[i].sector && tag != 0) bad++;
+      }
+    }
+    done += n;
+  }
+  uint64_t ticks = bench_ticks() - t0;
+
+  if (err) {
+    u_printf("  %-10s failed (%ld)\n", pat->name, err);
+    return;
+  }
+
+  blk_stat(dev, &st, 0);
+  uint64_t ns    = bench_ticks_to_ns(ticks);
+  uint64_t iops  = ns ? (uint64_t)done * 1000000000ull / ns : 0;
+  uint64_t kibps = iops * (BENCH_BLK_BS / 1024u);
+  u_printf("  %-10s %7llu %5llu.%02llu %8llu %7llu %6llu %6llu %6llu %5u\n",
+           pat->name, (unsigned long long)iops,
+           (unsigned long long)(kibps / 1024u),
+           (unsigned long long)((kibps % 1024u) * 100u / 1024u),
+           (unsigned long long)(st.reqs[pat->op]
+                                    ? bench_ticks_to_ns(st.lat_ticks) /
+                                          1000u / st.reqs[pat->op]
+                                    : 0),
+           (unsigned long long)st.hw_reqs, (unsigned long long)st.merges,
+           (unsigned long long)st.kicks, (unsigned long long)st.irqs,
+           (unsigned)bad);
+}
+
+static void
+bench_blk(int argc, char** argv)
+{
+  static const bench_blk_pat_t pats[] = {
+      {"seq-write", BLK_OP_WRITE, 0},
+      {"seq-read", BLK_OP_READ, 0},
+      {"rand-write", BLK_OP_WRITE, 1},
+      {"rand-read", BLK_OP_READ, 1},
+  };
+
+  uint32_t qd  = (argc > 2 && u_atoi(argv[2]) > 0) ? (uint32_t)u_atoi(argv[2])
+                                                   : BENCH_BLK_DEFAULT_QD;
+  uint32_t ops = (argc > 3 && u_atoi(argv[3]) > 0) ? (uint32_t)u_atoi(argv[3])
+                                                   : BENCH_BLK_DEFAULT_OPS;
+  uint32_t dev = (argc > 4) ? (uint32_t)u_atoi(argv[4]) : 0u;
+  if (qd > BLK_IO_MAX_BATCH) qd = BLK_IO_MAX_BATCH;
+
+  struct blkstat_user st;
+  long rc = blk_stat(dev, &st, 0);
+  if (rc < 0) {
+    u_printf("bench blk: no block device %u (%ld)\n", (unsigned)dev, rc);
+    return;
+  }
+
+  uint64_t span = st.nsectors < BENCH_BLK_SPAN_SECT ? st.nsectors
+                                                    : BENCH_BLK_SPAN_SECT;
+  span /= BENCH_BLK_SECT;
+  if (span == 0) {
+    u_puts("bench blk: device too small");
+    return;
+  }
+
+  u_printf("bench blk: %s, %u x 4 KiB per pattern, qd %u, span %llu KiB "
+           "(hw qd %u, %u segs/req)\n",
+           st.name, (unsigned)ops, (unsigned)qd,
+           (unsigned long long)(span * (BENCH_BLK_BS / 1024u)),
+           (unsigned)st.max_inflight, (unsigned)st.max_segs);
+  u_printf("  pattern       IOPS   MiB/s  lat(us)  hw-req  merge  kicks   irqs   bad\n");
+  for (size_t i = 0; i < sizeof(pats) / sizeof(pats[0]); ++i) {
+    bench_blk_run(dev, &pats[i], qd, ops, span);
+  }
+
+  struct blk_io fl = {.op = BLK_OP_FLUSH};
+  long fr          = blk_io(dev, &fl, 1);
+  u_printf("  flush: %s\n", fr < 0 ? "failed" : "ok");
+}
+
+/* ---- bench cache: 块缓存命中 / 预读 / 写回 ---- */
+
+/*
+ * 经 SYS_BCACHE_IO 按 1 KiB 块读写（默认用 ram0，没有就 dev 0）。块数默认比缓存
+ * 大几倍，顺序读会不断换出，靠预读；小工作集的重复读应当全部命中。
+ * 每个块前 8 字节写块号，读回校验。
+ */
+#define BENCH_CACHE_DEFAULT_BLOCKS 512u
+#define BENCH_CACHE_WSET           64u
+
+static uint8_t s_cache_buf[1024] __attribute__((aligned(64)));
+
+typedef struct {
+  const char* name;
+  uint32_t op;      /* BCACHE_OP_READ / WRITE */
+  uint32_t span;    /* 块号范围 [0, span) */
+  int random;
+  uint32_t ops;
+} bench_cache_pat_t;
+
+static void
+bench_cache_run(uint32_t dev, const bench_cache_pat_t* pat)
+{
+  struct cachestat_user cs;
+  cachestat_get(&cs, CACHESTAT_F_RESET);
+
+  uint32_t bad = 0;
+  long err     = 0;
+  uint64_t t0  = bench_ticks();
+  for (uint32_t i = 0; i < pat->ops && !err; ++i) {
+    uint64_t blk = pat->random ? bench_blk_rand() % pat->span : i % pat->span;
+    if (pat->op == BCACHE_OP_WRITE) {
+      u_memset(s_cache_buf, (int)(blk & 0xffu), sizeof(s_cache_buf));
+      u_memcpy(s_cache_buf, &blk, sizeof(blk));
+    }
+    long r = bcache_io(dev, pat->op, (uint32_t)blk, s_cache_buf);
+    if (r < 0) {
+      err = r;
+      break;
+    }
+    if (pat->op == BCACHE_OP_READ) {
+      uint64_t tag;
+      u_memcpy(&tag, s_cache_buf, sizeof(tag));
+      if (tag != blk) bad++;
+    }
+  }
+  uint64_t ns = bench_ticks_to_ns(bench_ticks() - t0);
+
+  if (err) {
+    u_printf("  %-10s failed (%ld)\n", pat->name, err);
+    return;
+  }
+
+  cachestat_get(&cs, 0);
+  u_printf("  %-10s %6u %8llu %6llu %6llu %6llu %6llu %6llu %5u\n", pat->name,
+           (unsigned)pat->ops,
+           (unsigned long long)(pat->ops ? ns / pat->ops : 0),
+           (unsigned long long)cs.hits, (unsigned long long)cs.misses,
+           (unsigned long long)cs.ra_hits, (unsigned long long)cs.evictions,
+           (unsigned long long)cs.writebacks, (unsigned)bad);
+}
+
+static void
+bench_cache(int argc, char** argv)
+{
+  uint32_t dev    = 0;
+  int have_dev    = 0;
+  uint32_t blocks = BENCH_CACHE_DEFAULT_BLOCKS;
+  if (argc > 2) {
+    dev      = (uint32_t)u_atoi(argv[2]);
+    have_dev = 1;
+  }
+  if (argc > 3 && u_atoi(argv[3]) > 0) blocks = (uint32_t)u_atoi(argv[3]);
+
+  struct blkstat_user st;
+  if (!have_dev) {
+    /* 默认找 ram0：不依赖任何设备驱动 */
+    for (uint32_t d = 0; blk_stat(d, &st, 0) == 0; ++d) {
+      if (!u_strcmp(st.name, "ram0")) {
+        dev = d;
+        break;
+      }
+    }
+  }
+  if (blk_stat(dev, &st, 0) < 0) {
+    u_printf("bench cache: no block device %u\n", (unsigned)dev);
+    return;
+  }
+  uint64_t nblocks = st.nsectors / (1024u / BLK_SECTOR_SIZE);
+  if (blocks > nblocks) blocks = (uint32_t)nblocks;
+  if (blocks < BENCH_CACHE_WSET) {
+    u_puts("bench cache: device too small");
+    return;
+  }
+
+  struct cachestat_user cs;
+  cachestat_get(&cs, 0);
+  u_printf("bench cache: %s, %u blocks of %u B, cache %u buffers\n", st.name,
+           (unsigned)blocks, (unsigned)cs.block_size, (unsigned)cs.nbuf);
+
+  const bench_cache_pat_t pats[] = {
+      {"seq-write", BCACHE_OP_WRITE, blocks, 0, blocks},
+      {"seq-read", BCACHE_OP_READ, blocks, 0, blocks},
+      {"hot-read", BCACHE_OP_READ, BENCH_CACHE_WSET, 0, 4u * BENCH_CACHE_WSET},
+      {"rand-hot", BCACHE_OP_READ, BENCH_CACHE_WSET, 1, 4u * BENCH_CACHE_WSET},
+      {"rand-wide", BCACHE_OP_READ, blocks, 1, blocks},
+  };
+  u_puts("  pattern       ops   ns/op   hits   miss  ra-hit  evict  wback   bad");
+  for (size_t i = 0; i < sizeof(pats) / sizeof(pats[0]); ++i) {
+    bench_cache_run(dev, &pats[i]);
+    if (i == 0) {
+      /* 写完先 sync 一次：后面的读不和写回抢设备 */
+      cachestat_get(&cs, CACHESTAT_F_RESET);
+      uint64_t t0 = bench_ticks();
+      long r      = bcache_io(dev, BCACHE_OP_SYNC, 0, NULL);
+      uint64_t us = bench_ticks_to_ns(bench_ticks() - t0) / 1000u;
+      cachestat_get(&cs, 0);
+      u_printf("  sync: %s in %llu us, %llu blocks in %llu batches\n",
+               r < 0 ? "failed" : "ok", (unsigned long long)us,
+               (unsigned long long)cs.writebacks,
+               (unsigned long long)cs.flush_batches);
+    }
+  }
+}
+
+/* ---- bench fs: 文件读写带宽（tmpfs / efs） ---- */
+
+/*
+ * 用 open/write/read 顺序写一个文件再读回，每种块大小一轮。默认写
+ * /tmp（tmpfs，整页拷贝）；给 efs 上的路径就能和块缓存 + extent 直读对比。
+ * 每块前 8 字节写文件偏移，读回校验。
+ */
+#define BENCH_FS_DEFAULT_KB 1024u
+#define BENCH_FS_CHUNK_MAX  16384u
+
+static uint8_t s_fs_buf[BENCH_FS_CHUNK_MAX] __attribute__((aligned(64)));
+
+static void
+bench_fs_mibps(uint64_t bytes, uint64_t ns, uint64_t* whole, uint64_t* frac)
+{
+  /* MiB/s，两位小数 */
+  uint64_t kibps = ns ? bytes * 1000000000ull / ns / 1024u : 0;
+  *whole         = kibps / 1024u;
+  *frac          = (kibps % 1024u) * 100u / 1024u;
+}
+
+static void
+bench_fs_run(const char* path, uint64_t size, uint32_t chunk)
+{
+  long err = 0;
+
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC);
+  if (fd < 0) {
+    u_printf("  %6u  open failed (%d)\n", (unsigned)chunk, fd);
+    return;
+  }
+  uint64_t t0 = bench_ticks();
+  for (uint64_t off = 0; off < size && !err; off += chunk) {
+    u_memset(s_fs_buf, (int)((off / chunk) & 0xffu), chunk);
+    u_memcpy(s_fs_buf, &off, sizeof(off));
+    long r = (long)write(fd, s_fs_buf, chunk);
+    if (r != (long)chunk) err = (r < 0) ? r : -ENOSPC;
+  }
+  uint64_t wns = bench_ticks_to_ns(bench_ticks() - t0);
+  (void)close(fd);
+  if (err) {
+    u_printf("  %6u  write failed (%ld)\n", (unsigned)chunk, err);
+    return;
+  }
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    u_printf("  %6u  reopen failed (%d)\n", (unsigned)chunk, fd);
+    return;
+  }
+  uint32_t bad = 0;
+  t0           = bench_ticks();
+  for (uint64_t off = 0; off < size && !err; off += chunk) {
+    long r = (long)read(fd, s_fs_buf, chunk);
+    if (r != (long)chunk) {
+      err = (r < 0) ? r : -EIO;
+      break;
+    }
+    uint64_t tag;
+    u_memcpy(&tag, s_fs_buf, sizeof(tag));
+    if (tag != off) bad++;
+  }
+  uint64_t rns = bench_ticks_to_ns(bench_ticks() - t0);
+  (void)close(fd);
+  if (err) {
+    u_printf("  %6u  read failed (%ld)\n", (unsigned)chunk, err);
+    return;
+  }
+
+  uint64_t ww, wf, rw, rf;
+  bench_fs_mibps(size, wns, &ww, &wf);
+  bench_fs_mibps(size, rns, &rw, &rf);
+  u_printf("  %6u %8llu.%02llu %8llu.%02llu %8llu %8llu %5u\n", (unsigned)chunk,
+           (unsigned long long)ww, (unsigned long long)wf,
+           (unsigned long long)rw, (unsigned long long)rf,
+           (unsigned long long)(wns / (size / chunk)),
+           (unsigned long long)(rns / (size / chunk)), (unsigned)bad);
+}
+
+static void
+bench_fs(int argc, char** argv)
+{
+  static const uint32_t chunks[] = {512u, 4096u, BENCH_FS_CHUNK_MAX};
+
+  const char* path = (argc > 2) ? argv[2] : "/tmp/bench.dat";
+  uint32_t kb      = (argc > 3 && u_atoi(argv[3]) > 0) ? (uint32_t)u_atoi(argv[3])
+                                                       : BENCH_FS_DEFAULT_KB;
+  /* 按最大块对齐，每轮都是整数个块 */
+  uint64_t size = ((uint64_t)kb * 1024u + BENCH_FS_CHUNK_MAX - 1u) /
+                  BENCH_FS_CHUNK_MAX * BENCH_FS_CHUNK_MAX;
+
+  u_printf("bench fs: %s, %llu KiB per pass\n", path,
+           (unsigned long long)(size / 1024u));
+  u_puts("   chunk  wr MiB/s  rd MiB/s  wr ns/op rd ns/op   bad");
+  for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); ++i) {
+    bench_fs_run(path, size, chunks[i]);
+  }
+
+  /* 截掉，不占 tmpfs 页池 */
+  int fd = open(path, O_WRONLY | O_TRUNC);
+  if (fd >= 0) (void)close(fd);
+}
+
+/* ---- bench pipe: 管道吞吐 ---- */
+
+/*
+ * 写线程（同一线程组，共用 fd 表）按块往管道里写 size 字节再关写端，本
+ * 线程按同样的块读到 EOF。每种块大小前清零 pipestat，之后报告经过环形
+ * 缓冲和直接交接（写端 buf -> 读端 buf）的字节数，以及两边阻塞的次数。
+ */
+#define BENCH_PIPE_DEFAULT_KB 4096u
+#define BENCH_PIPE_CHUNK_MAX  16384u
+
+static uint8_t s_pipe_wbuf[BENCH_PIPE_CHUNK_MAX] __attribute__((aligned(64)));
+static uint8_t s_pipe_rbuf[BENCH_PIPE_CHUNK_MAX] __attribute__((aligned(64)));
+
+typedef struct {
+  int fd;
+  uint32_t chunk;
+  uint64_t size;
+  volatile long err;
+} bench_pipe_arg_t;
+
+static void __attribute__((noreturn))
+bench_pipe_writer(void* arg)
+{
+  bench_pipe_arg_t* a = (bench_pipe_arg_t*)arg;
+  for (uint64_t off = 0; off < a->size; off += a->chunk) {
+    long r = (long)write(a->fd, s_pipe_wbuf, a->chunk);
+    if (r != (long)a->chunk) {
+      a->err = (r < 0) ? r : -EIO;
+      break;
+    }
+  }
+  (void)close(a->fd);  /* 读端看到 EOF */
+  thread_exit(0);
+}
+
+static void
+bench_pipe_run(uint64_t size, uint32_t chunk)
+{
+  int fds[2];
+  int rc = pipe(fds);
+  if (rc < 0) {
+    u_printf("  %6u  pipe failed (%d)\n", (unsigned)chunk, rc);
+    return;
+  }
+
+  struct pipestat_user st;
+  (void)pipestat_get(&st, PIPESTAT_F_RESET);
+
+  bench_pipe_arg_t arg = {.fd = fds[1], .chunk = chunk, .size = size};
+  uint64_t t0          = bench_ticks();
+  tid_t tid = thread_create(bench_pipe_writer, &arg, "bench-pipe");
+  if (tid < 0) {
+    u_printf("  %6u  thread_create failed (%d)\n", (unsigned)chunk, tid);
+    (void)close(fds[0]);
+    (void)close(fds[1]);
+    return;
+  }
+
+  uint64_t got = 0;
+  long r;
+  while ((r = (long)read(fds[0], s_pipe_rbuf, chunk)) > 0) {
+    got += (uint64_t)r;
+  }
+  uint64_t ns = bench_ticks_to_ns(bench_ticks() - t0);
+  int status  = 0;
+  thread_join(tid, &status);
+  (void)close(fds[0]);
+  (void)pipestat_get(&st, 0);
+
+  if (r < 0 || arg.err || got != size) {
+    u_printf("  %6u  failed: read %ld, write %ld, got %llu\n", (unsigned)chunk,
+             r, arg.err, (unsigned long long)got);
+    return;
+  }
+
+  uint64_t w, f;
+  bench_fs_mibps(size, ns, &w, &f);
+  uint64_t moved = st.bytes_ring + st.bytes_direct;
+  u_printf("  %6u %8llu.%02llu %8llu %7llu%% %8llu %8llu\n", (unsigned)chunk,
+           (unsigned long long)w, (unsigned long long)f,
+           (unsigned long long)(ns / (size / chunk)),
+           (unsigned long long)(moved ? st.bytes_direct * 100u / moved : 0),
+           (unsigned long long)st.read_blocks,
+           (unsigned long long)st.write_blocks);
+}
+
+static void
+bench_pipe(int argc, char** argv)
+{
+  static const uint32_t chunks[] = {64u, 512u, 4096u, BENCH_PIPE_CHUNK_MAX};
+
+  uint32_t kb   = (argc > 2 && u_atoi(argv[2]) > 0) ? (uint32_t)u_atoi(argv[2])
+                                                    : BENCH_PIPE_DEFAULT_KB;
+  uint64_t size = ((uint64_t)kb * 1024u + BENCH_PIPE_CHUNK_MAX - 1u) /
+                  BENCH_PIPE_CHUNK_MAX * BENCH_PIPE_CHUNK_MAX;
+
+  for (uint32_t i = 0; i < BENCH_PIPE_CHUNK_MAX; ++i) {
+    s_pipe_wbuf[i] = (uint8_t)i;
+  }
+
+  u_printf("bench pipe: %llu KiB per pass, ring %u bytes\n",
+           (unsigned long long)(size / 1024u), (unsigned)PIPE_BUF_SIZE);
+  u_puts("   chunk    MiB/s  ns/write  direct   rd blk   wr blk");
+  for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); ++i) {
+    bench_pipe_run(size, chunks[i]);
+  }
+}
+
+/* ---- bench chan: 线程间消息通道 ---- */
+
+/*
+ * 生产者在消息里放发送时的 rdtime，消费者收到时算延迟。SPSC 一个生产者，
+ * MPSC 三个；生产者 / 消费者由调度器摊到各个 hart 上（打印各自最后所在
+ * 的 hart）。报告 msgs/s、延迟 p50/p90/p99/max，以及快路径走不通、真的
+ * futex 睡下去的次数。
+ */
+#define BENCH_CHAN_DEFAULT_MSGS 200000u
+#define BENCH_CHAN_CAP          256u
+#define BENCH_CHAN_PRODUCERS    3u
+#define BENCH_CHAN_SAMPLES      4096u
+
+static uint64_t s_chan_spsc_slots[BENCH_CHAN_CAP];
+static chan_slot_t s_chan_mpsc_slots[BENCH_CHAN_CAP];
+static chan_spsc_t s_chan_spsc;
+static chan_mpsc_t s_chan_mpsc;
+static uint64_t s_chan_lat[BENCH_CHAN_SAMPLES];
+static volatile uint32_t s_chan_msgs;  /* 每个生产者发的条数 */
+static volatile int s_chan_hart[BENCH_CHAN_PRODUCERS];
+
+static void __attribute__((noreturn))
+bench_chan_spsc_producer(void* arg)
+{
+  (void)arg;
+  for (uint32_t i = 0; i < s_chan_msgs; ++i) {
+    chan_spsc_send(&s_chan_spsc, bench_ticks());
+  }
+  s_chan_hart[0] = get_hartid();
+  thread_exit(0);
+}
+
+static void __attribute__((noreturn))
+bench_chan_mpsc_producer(void* arg)
+{
+  uint32_t id = (uint32_t)(uintptr_t)arg;
+  for (uint32_t i = 0; i < s_chan_msgs; ++i) {
+    chan_mpsc_send(&s_chan_mpsc, bench_ticks());
+  }
+  s_chan_hart[id] = get_hartid();
+  thread_exit(0);
+}
+
+/* 样本不多，希尔排序够用 */
+static void
+bench_sort_u64(uint64_t* a, uint32_t n)
+{
+  for (uint32_t gap = n / 2u; gap > 0; gap /= 2u) {
+    for (uint32_t i = gap; i < n; ++i) {
+      uint64_t v = a[i];
+      uint32_t j = i;
+      for (; j >= gap && a[j - gap] > v; j -= gap) a[j] = a[j - gap];
+      a[j] = v;
+    }
+  }
+}
+
+static void
+bench_chan_run(const char* what, uint32_t nprod)
+{
+  uint32_t total  = s_chan_msgs * nprod;
+  uint32_t every  = (total + BENCH_CHAN_SAMPLES - 1u) / BENCH_CHAN_SAMPLES;
+  uint32_t nlat   = 0;
+  tid_t tids[BENCH_CHAN_PRODUCERS];
+  uint32_t n      = 0;
+
+  uint64_t t0 = bench_ticks();
+  for (uint32_t i = 0; i < nprod; ++i) {
+    tid_t tid = (nprod == 1u)
+                    ? thread_create(bench_chan_spsc_producer, 0, "chan-prod")
+                    : thread_create(bench_chan_mpsc_producer,
+                                    (void*)(uintptr_t)i, "chan-prod");
+    if (tid < 0) break;
+    tids[n++] = tid;
+  }
+  if (n != nprod) {
+    /* 没起全：收不够条数，不能继续等 */
+    u_printf("  %-5s thread_create failed\n", what);
+    for (uint32_t i = 0; i < n; ++i) {
+      int status = 0;
+      (void)thread_kill(tids[i]);
+      thread_join(tids[i], &status);
+    }
+    return;
+  }
+
+  for (uint32_t i = 0; i < total; ++i) {
+    uint64_t sent = (nprod == 1u) ? chan_spsc_recv(&s_chan_spsc)
+                                  : chan_mpsc_recv(&s_chan_mpsc);
+    if (i % every == 0 && nlat < BENCH_CHAN_SAMPLES) {
+      s_chan_lat[nlat++] = bench_ticks() - sent;
+    }
+  }
+  uint64_t ns = bench_ticks_to_ns(bench_ticks() - t0);
+  for (uint32_t i = 0; i < n; ++i) {
+    int status = 0;
+    thread_join(tids[i], &status);
+  }
+
+  const chan_stat_t* st =
+      (nprod == 1u) ? &s_chan_spsc.stat : &s_chan_mpsc.stat;
+  bench_sort_u64(s_chan_lat, nlat);
+  u_printf("  %-5s %10llu %7llu %7llu %7llu %8llu %6u %6u %6u  %d/%d\n", what,
+           (unsigned long long)(ns ? (uint64_t)total * 1000000000ull / ns : 0),
+           (unsigned long long)bench_ticks_to_ns(s_chan_lat[nlat / 2u]),
+           (unsigned long long)bench_ticks_to_ns(s_chan_lat[nlat * 9u / 10u]),
+           (unsigned long long)bench_ticks_to_ns(s_chan_lat[nlat * 99u / 100u]),
+           (unsigned long long)bench_ticks_to_ns(s_chan_lat[nlat - 1u]),
+           (unsigned)st->send_waits, (unsigned)st->recv_waits,
+           (unsigned)st->wakes, s_chan_hart[0], get_hartid());
+}
+
+static void
+bench_chan(int argc, char** argv)
+{
+  s_chan_msgs = (argc > 2 && u_atoi(argv[2]) > 0) ? (uint32_t)u_atoi(argv[2])
+                                                  : BENCH_CHAN_DEFAULT_MSGS;
+
+  u_printf("bench chan: %u msgs per producer, %u slots, spin %u\n",
+           (unsigned)s_chan_msgs, (unsigned)BENCH_CHAN_CAP, (unsigned)CHAN_SPIN);
+  u_puts("  chan       msgs/s  p50 ns  p90 ns  p99 ns   max ns  swait  rwait  wakes  "
+         "hart p/c");
+
+  (void)chan_spsc_init(&s_chan_spsc, s_chan_spsc_slots, BENCH_CHAN_CAP);
+  bench_chan_run("spsc", 1u);
+
+  (void)chan_mpsc_init(&s_chan_mpsc, s_chan_mpsc_slots, BENCH_CHAN_CAP);
+  bench_chan_run("mpsc", BENCH_CHAN_PRODUCERS);
+}
+
+/* ---- bench timer: 周期任务的节拍漂移 ---- */
+
+/*
+ * 同一个“monitor 一轮”（thread_list + 把每行格式化进缓冲区，不打到控制台）
+ * 各按两种方式定拍跑 n 轮：
+ *   sleep    每轮结束后 sleep(period)，周期 = period + 这一轮的耗时 + 唤醒延迟
+ *   timerfd  read 到期次数，截止时间由内核按上一次截止时间往后排
+ * 先跑 timerfd，把它的平均周期当作理想周期；漂移 = 实际平均周期 - 理想。
+ * missed 是 timerfd 一次读到 > 1 次到期时多出来的周期。
+ * 最后一行是 eventfd 两线程乒乓的往返延迟。
+ */
+#define BENCH_TIMER_DEFAULT_PERIOD 2u
+#define BENCH_TIMER_DEFAULT_ROUNDS 50u
+#define BENCH_TIMER_PINGS          2000u
+
+static struct u_thread_info s_timer_infos[32];
+static char s_timer_line[96];
+static int s_timer_efd[2];  /* [0] 主线程 -> pong，[1] pong -> 主线程 */
+
+static void
+bench_timer_work(void)
+{
+  int n = thread_list(s_timer_infos, 32);
+  for (int i = 0; i < n; ++i) {
+    const struct u_thread_info* ti = &s_timer_infos[i];
+    u_snprintf(s_timer_line, sizeof(s_timer_line), " %-4d %-9s %6u %9llu %s",
+               ti->tid, thread_state_name(ti->state), (unsigned)ti->migrations,
+               (unsigned long long)ti->runs, ti->name);
+  }
+}
+
+/* 跑 rounds 轮；返回总 ns，*periods 是经过的周期数，*max_ns 是最长的一轮间隔 */
+static uint64_t
+bench_timer_run(int tfd, uint32_t period, uint32_t rounds, uint64_t* periods,
+                uint64_t* max_ns)
+{
+  uint64_t exp = 0;
+  *periods     = 0;
+  *max_ns      = 0;
+
+  /* 先对齐到一个节拍边界再开始计时 */
+  if (tfd >= 0) {
+    (void)read(tfd, &exp, sizeof(exp));
+  } else {
+    sleep(period);
+  }
+
+  uint64_t t0   = bench_ticks();
+  uint64_t last = t0;
+  for (uint32_t i = 0; i < rounds; ++i) {
+    bench_timer_work();
+    if (tfd >= 0) {
+      if (read(tfd, &exp, sizeof(exp)) != sizeof(exp)) break;
+      *periods += exp;
+    } else {
+      sleep(period);
+      *periods += 1u;
+    }
+    uint64_t now = bench_ticks();
+    uint64_t d   = bench_ticks_to_ns(now - last);
+    if (d > *max_ns) *max_ns = d;
+    last = now;
+  }
+  return bench_ticks_to_ns(last - t0);
+}
+
+static void __attribute__((noreturn))
+bench_timer_pong(void* arg)
+{
+  uint32_t n = (uint32_t)(uintptr_t)arg;
+  uint64_t v = 0;
+  for (uint32_t i = 0; i < n; ++i) {
+    if (read(s_timer_efd[0], &v, sizeof(v)) != sizeof(v)) break;
+    (void)write(s_timer_efd[1], &v, sizeof(v));
+  }
+  thread_exit(0);
+}
+
+/* 两个 eventfd 一来一回；返回完成的往返次数 */
+static uint32_t
+bench_timer_pingpong(uint64_t* ticks)
+{
+  tid_t tid = thread_create(bench_timer_pong,
+                            (void*)(uintptr_t)BENCH_TIMER_PINGS, "evfd-pong");
+  if (tid < 0) return 0;
+
+  uint64_t v  = 1;
+  uint32_t i  = 0;
+  uint64_t t0 = bench_ticks();
+  for (; i < BENCH_TIMER_PINGS; ++i) {
+    if (write(s_timer_efd[0], &v, sizeof(v)) != sizeof(v)) break;
+    if (read(s_timer_efd[1], &v, sizeof(v)) != sizeof(v)) break;
+  }
+  *ticks = bench_ticks() - t0;
+  if (i != BENCH_TIMER_PINGS) (void)thread_kill(tid);
+  int status = 0;
+  thread_join(tid, &status);
+  return i;
+}
+
+static void
+bench_timer_ping(void)
+{
+  s_timer_efd[0] = eventfd(0, 0);
+  s_timer_efd[1] = eventfd(0, 0);
+  if (s_timer_efd[0] < 0 || s_timer_efd[1] < 0) {
+    u_printf("  eventfd failed rc=%d/%d\n", s_timer_efd[0], s_timer_efd[1]);
+  } else {
+    uint64_t ticks = 0;
+    uint32_t n     = bench_timer_pingpong(&ticks);
+    if (n) {
+      bench_report("eventfd ping-pong", ticks, n);
+    } else {
+      u_puts("  eventfd: thread_create failed");
+    }
+  }
+  if (s_timer_efd[0] >= 0) close(s_timer_efd[0]);
+  if (s_timer_efd[1] >= 0) close(s_timer_efd[1]);
+}
+
+static void
+bench_timer(int argc, char** argv)
+{
+  uint32_t period = (argc > 2 && u_atoi(argv[2]) > 0) ? (uint32_t)u_atoi(argv[2])
+                                                      : BENCH_TIMER_DEFAULT_PERIOD;
+  uint32_t rounds = (argc > 3 && u_atoi(argv[3]) > 0) ? (uint32_t)u_atoi(argv[3])
+                                                      : BENCH_TIMER_DEFAULT_ROUNDS;
+
+  int tfd = timerfd_create();
+  if (tfd < 0 || timerfd_settime(tfd, period, period) < 0) {
+    u_printf("bench timer: timerfd failed rc=%d\n", tfd);
+    if (tfd >= 0) close(tfd);
+    return;
+  }
+
+  u_printf("bench timer: period %u ticks, %u rounds\n", (unsigned)period,
+           (unsigned)rounds);
+  u_puts("  pacing    total ms  periods  ns/period  drift ns/period   max gap ns");
+
+  uint64_t tp, tmax;
+  uint64_t tns   = bench_timer_run(tfd, period, rounds, &tp, &tmax);
+  uint64_t ideal = tp ? tns / tp : 0;  /* 一个周期的实际长度 */
+  close(tfd);
+
+  uint64_t sp, smax;
+  uint64_t sns = bench_timer_run(-1, period, rounds, &sp, &smax);
+  /* sleep 一轮算一个“周期”，实际上每轮都比理想周期长 */
+  uint64_t sper = sp ? sns / sp : 0;
+
+  u_printf("  sleep   %10llu %8llu %10llu %16lld %12llu\n",
+           (unsigned long long)(sns / 1000000u), (unsigned long long)sp,
+           (unsigned long long)sper, (long long)(sper - ideal),
+           (unsigned long long)smax);
+  u_printf("  timerfd %10llu %8llu %10llu %16lld %12llu  missed %llu\n",
+           (unsigned long long)(tns / 1000000u), (unsigned long long)tp,
+           (unsigned long long)ideal, 0ll, (unsigned long long)tmax,
+           (unsigned long long)(tp - rounds));
+
+  bench_timer_ping();
+}
+
+/* ---- shell cmd ---- */
+
+typedef struct {
+  const char* name;
+  void (*fn)(int argc, char** argv);
+  const char* help;
+} bench_cmd_t;
+
+static const bench_cmd_t s_bench_cmds[] = {
+    {"time", bench_time, "bench time [iters]   clock_gettime/get_hartid: syscall vs vdso"},
+    {"ring", bench_ring, "bench ring [lines] [batch]   stdout via write() vs ring vs sqpoll"},
+    {"string", bench_string, "bench string   mem/str routines: correctness corpus + cycles/byte"},
+    {"trap", bench_trap, "bench trap [iters]   syscall trap round-trip: nop/get_hartid/yield, vdso floor"},
+    {"fp", bench_fp, "bench fp [rounds]   FP throughput + yield cost with FS clean vs dirty"},
+    {"stress", bench_stress, "bench stress [ms]   lockless introspection syscalls vs thread churn"},
+    {"blk", bench_blk, "bench blk [qd] [ops] [dev]   virtio-blk seq/rand 4 KiB IOPS + MiB/s"},
+    {"cache", bench_cache, "bench cache [dev] [blocks]   block cache hits, read-ahead, write-back"},
+    {"fs", bench_fs, "bench fs [path] [KiB]   file write/read MiB/s (default /tmp, tmpfs)"},
+    {"pipe", bench_pipe, "bench pipe [KiB]   pipe MiB/s per chunk, ring vs direct handoff"},
+    {"chan", bench_chan, "bench chan [msgs]   SPSC/MPSC channels: msgs/s + latency percentiles"},
+    {"timer", bench_timer, "bench timer [period] [n]   periodic loop drift: sleep vs timerfd; eventfd RTT"},
+};
+
+static void
+bench_usage(void)
+{
+  u_puts("usage:");
+  for (size_t i = 0; i < sizeof(s_bench_cmds) / sizeof(s_bench_cmds[0]); ++i) {
+    u_printf("  %s\n", s_bench_cmds[i].help);
+  }
+}
+
+void
+bench(int argc, char** argv)
+{
+  if (argc < 2) {
+    bench_usage();
+    return;
+  }
+
+  for (size_t i = 0; i < sizeof(s_bench_cmds) / sizeof(s_bench_cmds[0]); ++i) {
+    if (!u_strcmp(argv[1], s_bench_cmds[i].name)) {
+      s_bench_cmds[i].fn(argc, argv);
+      return;
+    }
+  }
+
+  bench_usage();
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void bench(int argc, char** argv);
@@ -0,0 +1,235 @@
+/* chan.c */
+
+#include <stdint.h>
+
+#include "chan.h"
+#include "syscall.h"
+#include "uapi.h"
+#include "uerrno.h"
+
+static inline uint32_t
+load_acquire(const volatile uint32_t *p)
+{
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void
+store_release(volatile uint32_t *p, uint32_t v)
+{
+  __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static inline void
+stat_inc(uint32_t *p)
+{
+  __atomic_fetch_add(p, 1u, __ATOMIC_RELAXED);
+}
+
+/*
+ * 等 *word 离开 seen。先自旋；再登记 waiting 后复查一次，仍没变才睡。
+ * 对方是“先改 word、再看 waiting”，两边中间都有全屏障，所以要么对方
+ * 看到登记会来 WAKE，要么这边复查时已经看到新值（内核里 WAIT 还会在
+ * 锁下再比一次）。可能假醒：调用方总是重新检查条件。
+ */
+static void
+chan_wait(volatile uint32_t *waiting, volatile uint32_t *word, uint32_t seen,
+          uint32_t *nwaits)
+{
+  for (uint32_t i = 0; i < CHAN_SPIN; ++i) {
+    if (load_acquire(word) != seen) return;
+    __asm__ volatile("" ::: "memory");
+  }
+
+  __atomic_fetch_add(waiting, 1u, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(word, __ATOMIC_SEQ_CST) == seen) {
+    stat_inc(nwaits);
+    (void)futex(word, FUTEX_WAIT, seen);
+  }
+  __atomic_fetch_sub(waiting, 1u, __ATOMIC_SEQ_CST);
+}
+
+/* 刚改完 word：有人登记等待才陷入 */
+static inline void
+chan_wake(volatile uint32_t *waiting, volatile uint32_t *word, uint32_t n,
+          uint32_t *nwakes)
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(waiting, __ATOMIC_RELAXED) == 0) return;
+  stat_inc(nwakes);
+  (void)futex(word, FUTEX_WAKE, n);
+}
+
+static int
+chan_cap_ok(uint32_t cap)
+{
+  return cap != 0 && (cap & (cap - 1u)) == 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* SPSC                                                                       */
+/* -------------------------------------------------------------------------- */
+
+int
+chan_spsc_init(chan_spsc_t *c, uint64_t *slots, uint32_t cap)
+{
+  if (!c || !slots || !chan_cap_ok(cap)) return -EINVAL;
+  c->tail         = 0;
+  c->head_cache   = 0;
+  c->head         = 0;
+  c->tail_cache   = 0;
+  c->send_waiting = 0;
+  c->recv_waiting = 0;
+  c->stat         = (chan_stat_t){0};
+  c->slots        = slots;
+  c->mask         = cap - 1u;
+  return 0;
+}
+
+int
+chan_spsc_try_send(chan_spsc_t *c, uint64_t msg)
+{
+  uint32_t t = c->tail;
+  if (t - c->head_cache > c->mask) {
+    c->head_cache = load_acquire(&c->head);
+    if (t - c->head_cache > c->mask) return -EAGAIN;
+  }
+  c->slots[t & c->mask] = msg;
+  store_release(&c->tail, t + 1u);
+  chan_wake(&c->recv_waiting, &c->tail, 1u, &c->stat.wakes);
+  return 0;
+}
+
+int
+chan_spsc_try_recv(chan_spsc_t *c, uint64_t *msg)
+{
+  uint32_t h = c->head;
+  if (h == c->tail_cache) {
+    c->tail_cache = load_acquire(&c->tail);
+    if (h == c->tail_cache) return -EAGAIN;
+  }
+  *msg = c->slots[h & c->mask];
+  store_release(&c->head, h + 1u);
+  chan_wake(&c->send_waiting, &c->head, 1u, &c->stat.wakes);
+  return 0;
+}
+
+void
+chan_spsc_send(chan_spsc_t *c, uint64_t msg)
+{
+  while (chan_spsc_try_send(c, msg) < 0) {
+    /* 满：head 一动就有空位 */
+    chan_wait(&c->send_waiting, &c->head, c->head_cache, &c->stat.send_waits);
+  }
+}
+
+uint64_t
+chan_spsc_recv(chan_spsc_t *c)
+{
+  uint64_t msg;
+  while (chan_spsc_try_recv(c, &msg) < 0) {
+    chan_wait(&c->recv_waiting, &c->tail, c->tail_cache, &c->stat.recv_waits);
+  }
+  return msg;
+}
+
+/* -------------------------------------------------------------------------- */
+/* MPSC                                                                       */
+/* -------------------------------------------------------------------------- */
+
+int
+chan_mpsc_init(chan_mpsc_t *c, chan_slot_t *slots, uint32_t cap)
+{
+  if (!c || !slots || !chan_cap_ok(cap)) return -EINVAL;
+  for (uint32_t i = 0; i < cap; ++i) {
+    slots[i].seq = i;
+    slots[i].msg = 0;
+  }
+  c->tail         = 0;
+  c->head         = 0;
+  c->send_waiting = 0;
+  c->recv_waiting = 0;
+  c->stat         = (chan_stat_t){0};
+  c->slots        = slots;
+  c->mask         = cap - 1u;
+  return 0;
+}
+
+/* 抢一个可写的格子；满了返回 NULL，*seen 是那一格当前的 seq */
+static chan_slot_t *
+mpsc_claim(chan_mpsc_t *c, uint32_t *seen)
+{
+  uint32_t pos = __atomic_load_n(&c->tail, __ATOMIC_RELAXED);
+  for (;;) {
+    chan_slot_t *s = &c->slots[pos & c->mask];
+    uint32_t seq   = load_acquire(&s->seq);
+    int32_t dif    = (int32_t)(seq - pos);
+    if (dif == 0) {
+      if (__atomic_compare_exchange_n(&c->tail, &pos, pos + 1u, 1,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        return s;
+      }
+      /* 失败时 pos 已更新成当前 tail */
+    } else if (dif < 0) {
+      *seen = seq;  /* 上一圈的消息还没被取走 */
+      return NULL;
+    } else {
+      pos = __atomic_load_n(&c->tail, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+int
+chan_mpsc_try_send(chan_mpsc_t *c, uint64_t msg)
+{
+  uint32_t seen;
+  chan_slot_t *s = mpsc_claim(c, &seen);
+  if (!s) return -EAGAIN;
+
+  uint32_t pos = s->seq;
+  s->msg       = msg;
+  store_release(&s->seq, pos + 1u);
+  /* 消费者睡在这一格的 seq 上 */
+  chan_wake(&c->recv_waiting, &s->seq, 1u, &c->stat.wakes);
+  return 0;
+}
+
+int
+chan_mpsc_try_recv(chan_mpsc_t *c, uint64_t *msg)
+{
+  uint32_t h     = c->head;
+  chan_slot_t *s = &c->slots[h & c->mask];
+  if (load_acquire(&s->seq) != h + 1u) return -EAGAIN;
+
+  *msg = s->msg;
+  store_release(&s->seq, h + c->mask + 1u);  /* 留给下一圈 */
+  store_release(&c->head, h + 1u);
+  /* 满时所有生产者都等在这一格上 */
+  chan_wake(&c->send_waiting, &s->seq, UINT32_MAX, &c->stat.wakes);
+  return 0;
+}
+
+void
+chan_mpsc_send(chan_mpsc_t *c, uint64_t msg)
+{
+  while (chan_mpsc_try_send(c, msg) < 0) {
+    uint32_t pos   = __atomic_load_n(&c->tail, __ATOMIC_RELAXED);
+    chan_slot_t *s = &c->slots[pos & c->mask];
+    uint32_t seq   = load_acquire(&s->seq);
+    if ((int32_t)(seq - pos) >= 0) continue;  /* 刚空出来 */
+    chan_wait(&c->send_waiting, &s->seq, seq, &c->stat.send_waits);
+  }
+}
+
+uint64_t
+chan_mpsc_recv(chan_mpsc_t *c)
+{
+  uint64_t msg;
+  while (chan_mpsc_try_recv(c, &msg) < 0) {
+    chan_slot_t *s = &c->slots[c->head & c->mask];
+    uint32_t seq   = load_acquire(&s->seq);
+    if (seq == c->head + 1u) continue;
+    /* 空，或生产者抢到格子还没写完：都等这一格的 seq 变 */
+    chan_wait(&c->recv_waiting, &s->seq, seq, &c->stat.recv_waits);
+  }
+  return msg;
+}
@@ -0,0 +1,66 @@
+/* chan.h */
+#pragma once
+
+/*
+ * 线程间消息通道，消息是一个 uint64_t（数值或指针）：
+ *   chan_spsc_t  单生产者 / 单消费者有界环
+ *   chan_mpsc_t  多生产者 / 单消费者有界队列（每格带序号，生产者 CAS 抢 tail）
+ *
+ * 快路径只有原子读写，不陷入。空 / 满时先自旋 CHAN_SPIN 次，还不行才
+ * FUTEX_WAIT 睡在对方会改的那个字上；对方只在有人登记等待时才
+ * FUTEX_WAKE。槽数组由调用者提供，容量必须是 2 的幂。
+ */
+
+#include <stdint.h>
+
+#define CHAN_SPIN 128u
+
+typedef struct {
+  uint32_t send_waits;  /* 满了睡下去的次数 */
+  uint32_t recv_waits;  /* 空了睡下去的次数 */
+  uint32_t wakes;       /* 发出的 FUTEX_WAKE */
+} chan_stat_t;
+
+typedef struct {
+  /* 生产者独占 */
+  volatile uint32_t tail __attribute__((aligned(64)));
+  uint32_t head_cache;  /* 上次看到的 head：不满就不去读对方的 line */
+  /* 消费者独占 */
+  volatile uint32_t head __attribute__((aligned(64)));
+  uint32_t tail_cache;
+  /* 只在慢路径上写 */
+  volatile uint32_t send_waiting __attribute__((aligned(64)));
+  volatile uint32_t recv_waiting;
+  chan_stat_t stat;
+  uint64_t *slots;
+  uint32_t mask;
+} chan_spsc_t;
+
+typedef struct {
+  volatile uint32_t seq;  /* == 下标：空，可写；== 下标 + 1：有消息 */
+  uint32_t _pad;
+  uint64_t msg;
+} chan_slot_t;
+
+typedef struct {
+  volatile uint32_t tail __attribute__((aligned(64)));  /* 生产者 CAS */
+  volatile uint32_t head __attribute__((aligned(64)));  /* 消费者独占 */
+  volatile uint32_t send_waiting __attribute__((aligned(64)));
+  volatile uint32_t recv_waiting;
+  chan_stat_t stat;
+  chan_slot_t *slots;
+  uint32_t mask;
+} chan_mpsc_t;
+
+/* 0，或 -EINVAL（cap 不是 2 的幂） */
+int  chan_spsc_init(chan_spsc_t *c, uint64_t *slots, uint32_t cap);
+int  chan_spsc_try_send(chan_spsc_t *c, uint64_t msg);   /* 0 / -EAGAIN（满） */
+int  chan_spsc_try_recv(chan_spsc_t *c, uint64_t *msg);  /* 0 / -EAGAIN（空） */
+void chan_spsc_send(chan_spsc_t *c, uint64_t msg);
+uint64_t chan_spsc_recv(chan_spsc_t *c);
+
+int  chan_mpsc_init(chan_mpsc_t *c, chan_slot_t *slots, uint32_t cap);
+int  chan_mpsc_try_send(chan_mpsc_t *c, uint64_t msg);
+int  chan_mpsc_try_recv(chan_mpsc_t *c, uint64_t *msg);
+void chan_mpsc_send(chan_mpsc_t *c, uint64_t msg);
+uint64_t chan_mpsc_recv(chan_mpsc_t *c);
@@ -8,6 +8,7 @@ void user_main(void *arg)
 {
   (void)arg;
 
+  u_string_init();  /* 按 vdso hwcap 选择 mem/str 实现 */
   u_puts("Welcome, hacker!");
 
   for (;;) {
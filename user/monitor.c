@@ -24,10 +24,13 @@ typedef struct {
   uint32_t period;    /* Period in ticks. */
   int32_t  remaining; /* <0: forever, >=0: countdown. */
   uint32_t flags;     /* Filter/option bitmask. */
+  int      own_fds;   /* Started with thread_spawn: may hold a timerfd. */
+  uint32_t missed;    /* Periods skipped because a round ran late. */
 } mon_ctx_t;
 
 static mon_ctx_t g_mons[MON_MAX];
 static struct u_thread_info g_mon_infos[MON_MAX][MON_THREAD_LIST_MAX];
+static struct u_thread_info g_watch_infos[MON_THREAD_LIST_MAX];
 
 /* Format a hart id for table output: -1 -> "---". */
 static void
@@ -82,6 +85,31 @@ print_threads_table(const mon_ctx_t *m, const struct u_thread_info *infos, int n
   }
 }
 
+/*
+ * Pace one period. With a timerfd the deadlines are absolute (kernel rearms
+ * from the previous deadline), so printing time does not accumulate as drift;
+ * an expiration count > 1 means whole periods were missed.
+ */
+static void
+mon_wait_period(mon_ctx_t *m, int tfd)
+{
+  if (tfd < 0) {
+    sleep(m->period);
+    return;
+  }
+  uint64_t exp = 0;
+  if (read(tfd, &exp, sizeof(exp)) == sizeof(exp) && exp > 1) {
+    m->missed += (uint32_t)(exp - 1);
+  }
+}
+
+static __attribute__((noreturn)) void
+mon_exit(int tfd, int code)
+{
+  if (tfd >= 0) close(tfd);
+  thread_exit(code);
+}
+
 static __attribute__((noreturn)) void
 monitor_main(void *arg)
 {
@@ -91,21 +119,34 @@ monitor_main(void *arg)
     thread_exit(-1);
   }
 
-  /* Note: if the shell kills this thread, the cleanup below might not run. */
+  /*
+   * Only use a timerfd with a private fd table: when this thread exits or is
+   * killed, the kernel closes that table at once, even if nobody ever joins
+   * it (count-limited monitors are never joined). A thread sharing the
+   * shell's table would leak the fd on kill, so it falls back to sleep().
+   */
+  int tfd = m->own_fds ? timerfd_create() : -1;
+  if (tfd >= 0 && timerfd_settime(tfd, m->period, m->period) < 0) {
+    close(tfd);
+    tfd = -1;
+  }
+
   for (;;) {
     if (!m->used) {
-      thread_exit(0);
+      mon_exit(tfd, 0);
     }
 
-    sleep(m->period);
+    mon_wait_period(m, tfd);
 
     struct u_thread_info *infos = g_mon_infos[idx];
     int n = thread_list(infos, MON_THREAD_LIST_MAX);
     if (n < 0) {
       u_printf("\n[mon tid=%d] thread_list failed rc=%d\n", (int)m->tid, n);
     } else {
-      u_printf("\n[mon tid=%d seq=%u period=%u flags=0x%x]\n", (int)m->tid,
-               (unsigned)m->seq++, (unsigned)m->period, (unsigned)m->flags);
+      u_printf("\n[mon tid=%d seq=%u period=%u flags=0x%x missed=%u%s]\n",
+               (int)m->tid, (unsigned)m->seq++, (unsigned)m->period,
+               (unsigned)m->flags, (unsigned)m->missed,
+               tfd >= 0 ? "" : " sleep");
       print_threads_table(m, infos, n);
     }
 
@@ -113,7 +154,7 @@ monitor_main(void *arg)
       m->remaining--;
       if (m->remaining == 0) {
         m->used = 0;  /* Normal exit: release the slot. */
-        thread_exit(0);
+        mon_exit(tfd, 0);
       }
     }
   }
@@ -130,6 +171,8 @@ mon_alloc(void)
       g_mons[i].period    = 10;
       g_mons[i].remaining = -1;
       g_mons[i].flags     = 0;
+      g_mons[i].own_fds   = 0;
+      g_mons[i].missed    = 0;
       return &g_mons[i];
     }
   }
@@ -163,7 +206,13 @@ tid_t mon_start_ex(uint32_t period_ticks, int32_t count, uint32_t flags) {
   m->remaining = count;
   m->flags     = flags;
 
-  tid_t tid    = thread_create(monitor_main, m, "monitor");
+  /* Own fd table first (stdio inherited); out of tables -> share the shell's. */
+  m->own_fds = 1;
+  tid_t tid  = thread_spawn(monitor_main, m, "monitor", NULL);
+  if (tid < 0) {
+    m->own_fds = 0;
+    tid        = thread_create(monitor_main, m, "monitor");
+  }
   if (tid < 0) {
     m->used = 0;
     return tid;
@@ -195,10 +244,10 @@ void mon_list(void) {
   u_printf("Active monitors:\n");
   for (int i = 0; i < MON_MAX; ++i) {
     if (g_mons[i].used) {
-      u_printf("  tid=%d period=%u remaining=%d seq=%u flags=0x%x\n",
+      u_printf("  tid=%d period=%u remaining=%d seq=%u flags=0x%x missed=%u\n",
                (int)g_mons[i].tid, (unsigned)g_mons[i].period,
                (int)g_mons[i].remaining, (unsigned)g_mons[i].seq,
-               (unsigned)g_mons[i].flags);
+               (unsigned)g_mons[i].flags, (unsigned)g_mons[i].missed);
     }
   }
 }
@@ -220,3 +269,59 @@ void mon_once(void) {
     u_puts("mon: output truncated (increase MON_THREAD_LIST_MAX if needed)");
   }
 }
+
+static void
+mon_watch_draw(mon_ctx_t *m)
+{
+  int n = thread_list(g_watch_infos, MON_THREAD_LIST_MAX);
+  if (n < 0) {
+    u_printf("mon watch: thread_list failed rc=%d\n", n);
+    return;
+  }
+  u_printf("\n[mon watch seq=%u period=%u flags=0x%x]\n", (unsigned)m->seq++,
+           (unsigned)m->period, (unsigned)m->flags);
+  print_threads_table(m, g_watch_infos, n);
+}
+
+/*
+ * 前台监视：同一个线程既定时刷新又处理按键。poll 等 stdin，超时就是
+ * 刷新周期，所以没有按键时一直睡着，不轮询。
+ *   q / Ctrl-C 退出，r 立即刷新，u 只看用户线程，i 隐藏 idle。
+ * 每次刷新后重新计周期；count >= 0 时刷新 count 次后退出。
+ */
+void mon_watch(uint32_t period_ticks, int32_t count)
+{
+  if (period_ticks == 0) period_ticks = 1;
+
+  mon_ctx_t ctx = {0};
+  ctx.period    = period_ticks;
+  ctx.remaining = count;
+
+  u_puts("mon watch: q quit, r refresh, u user-only, i hide idle");
+  struct pollfd_user pfd = {.fd = FD_STDIN, .events = POLLIN};
+  for (;;) {
+    mon_watch_draw(&ctx);
+    if (ctx.remaining >= 0 && --ctx.remaining <= 0) break;
+
+    for (;;) {
+      u_fflush();
+      int n = poll(&pfd, 1u, (int64_t)ctx.period);
+      if (n < 0) {
+        u_printf("mon watch: poll failed rc=%d\n", n);
+        return;
+      }
+      if (n == 0) break;  /* 到点刷新 */
+
+      char c = 0;
+      if (!(pfd.revents & POLLIN) || read(FD_STDIN, &c, 1) <= 0) {
+        pfd.fd = -1;  /* stdin 关了（管道）：之后只按周期刷新 */
+        continue;
+      }
+      if (c == 'q' || c == 0x03) return;
+      if (c == 'u') ctx.flags ^= MON_F_USER_ONLY;
+      if (c == 'i') ctx.flags ^= MON_F_HIDE_IDLE;
+      if (c == 'r' || c == 'u' || c == 'i') break;
+    }
+  }
+}
+
@@ -7,5 +7,6 @@ tid_t mon_start(uint32_t period_ticks, int32_t count);
 int   mon_stop(tid_t tid);
 void  mon_list(void);
 void  mon_once(void);
+void  mon_watch(uint32_t period_ticks, int32_t count);
 
 #endif /* MONITOR_H */
@@ -0,0 +1,101 @@
+/* ring.c */
+
+#include <stdint.h>
+
+#include "ring.h"
+#include "syscall.h"
+#include "uerrno.h"
+
+static inline void
+ring_fence_w(void)
+{
+  __asm__ volatile("fence w,w" ::: "memory");
+}
+
+int
+ring_init(struct uring *r, uint32_t entries, uint32_t flags)
+{
+  long rc = ring_setup(r, entries, flags);
+  if (rc < 0) return (int)rc;
+  r->sq_local_tail = r->sq_tail;
+  return 0;
+}
+
+void
+ring_exit(struct uring *r)
+{
+  /* SQPOLL：等 sqpoll 线程把已发布的 SQE 消费完再注销 */
+  while ((r->setup_flags & URING_SETUP_SQPOLL) && r->sq_head != r->sq_tail) {
+    if (r->sq_flags & URING_SQ_NEED_WAKEUP) {
+      ring_enter(0, 0, URING_ENTER_SQ_WAKEUP);
+    }
+    yield();
+  }
+  ring_setup(0, 0, 0);
+}
+
+struct uring_sqe *
+ring_get_sqe(struct uring *r)
+{
+  uint32_t tail = r->sq_local_tail;
+  if ((uint32_t)(tail - r->sq_head) >= r->entries) return 0;
+
+  struct uring_sqe *sqe = &r->sqes[tail & (r->entries - 1u)];
+  sqe->flags       = 0;
+  sqe->_pad        = 0;
+  r->sq_local_tail = tail + 1u;
+  return sqe;
+}
+
+long
+ring_submit(struct uring *r)
+{
+  uint32_t n = r->sq_local_tail - r->sq_tail;
+
+  ring_fence_w();  /* SQE -> sq_tail */
+  r->sq_tail = r->sq_local_tail;
+
+  if (r->setup_flags & URING_SETUP_SQPOLL) {
+    __asm__ volatile("fence rw,rw" ::: "memory");  /* sq_tail -> sq_flags */
+    if (r->sq_flags & URING_SQ_NEED_WAKEUP) {
+      long rc = ring_enter(0, 0, URING_ENTER_SQ_WAKEUP);
+      if (rc < 0) return rc;
+    }
+    return (long)n;
+  }
+
+  /* 连同上次因 CQ 满而剩下的一起提交 */
+  uint32_t pending = r->sq_tail - r->sq_head;
+  if (pending == 0) return 0;
+  return ring_enter(pending, 0, 0);
+}
+
+struct uring_cqe *
+ring_peek_cqe(struct uring *r)
+{
+  if (r->cq_head == r->cq_tail) return 0;
+  __asm__ volatile("fence r,r" ::: "memory");  /* cq_tail -> cqe */
+  return &r->cqes[r->cq_head & (2u * r->entries - 1u)];
+}
+
+void
+ring_cqe_seen(struct uring *r)
+{
+  __asm__ volatile("fence rw,w" ::: "memory");
+  r->cq_head++;
+}
+
+int
+ring_prep_write(struct uring *r, int fd, const void *buf, uint64_t len,
+                uint64_t user_data)
+{
+  struct uring_sqe *sqe = ring_get_sqe(r);
+  if (!sqe) return -EAGAIN;
+
+  sqe->op        = URING_OP_WRITE;
+  sqe->fd        = fd;
+  sqe->addr      = (uint64_t)(uintptr_t)buf;
+  sqe->len       = len;
+  sqe->user_data = user_data;
+  return 0;
+}
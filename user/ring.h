@@ -0,0 +1,31 @@
+/* ring.h */
+#pragma once
+
+/*
+ * uring.h 的用户态封装：
+ *   ring_init → ring_get_sqe/填写 → ring_submit → ring_peek_cqe/ring_cqe_seen
+ */
+
+#include <stdint.h>
+
+#include "uring.h"
+
+int  ring_init(struct uring *r, uint32_t entries, uint32_t flags);  /* 0 或 -errno */
+void ring_exit(struct uring *r);
+
+/* SQ 满时返回 NULL；填好后由 ring_submit 发布 */
+struct uring_sqe *ring_get_sqe(struct uring *r);
+
+/* 发布已填写的 SQE。
+ * 普通模式：陷入一次 SYS_RING_ENTER，返回内核消费的条数。
+ * SQPOLL：只在 sqpoll 线程要求时陷入（URING_SQ_NEED_WAKEUP），返回发布的条数。
+ */
+long ring_submit(struct uring *r);
+
+/* 没有 CQE 时返回 NULL；用完调用 ring_cqe_seen */
+struct uring_cqe *ring_peek_cqe(struct uring *r);
+void ring_cqe_seen(struct uring *r);
+
+/* 提交一条 write 的便捷函数（不 submit） */
+int ring_prep_write(struct uring *r, int fd, const void *buf, uint64_t len,
+                    uint64_t user_data);
@@ -1,11 +1,14 @@
 /* shell.c */
 
+#include "bench.h"
 #include "datetime.h"
 #include "monitor.h"
 #include "shell.h"
 #include "spawn.h"
 #include "syscall.h"
+#include "uerrno.h"
 #include "ulib.h"
+#include "usyscall.h"
 #include "uthread.h"
 #include "utime.h"
 
@@ -17,15 +20,20 @@
 #define SHELL_MAX_ARGS  8
 #define SHELL_MAX_PROCS 4
 #define SHELL_THREAD_LIST_MAX 32
+#define SHELL_SYSSTAT_MAX (MAX_HARTS * SYSSTAT_MAX_NR)
 
 typedef struct ShellProc {
   int  in_use;
+  int  piped;  /* 管道里的一段：stdout 是管道时整块缓冲 */
   char line[SHELL_MAX_LINE];
 } ShellProc;
 
 static ShellProc g_procs[SHELL_MAX_PROCS];
 static struct irqstat_user g_irqstat_buf[IRQSTAT_MAX_IRQ];
 static struct u_thread_info g_thread_infos[SHELL_THREAD_LIST_MAX];
+static struct sysstat_user g_sysstat_buf[SHELL_SYSSTAT_MAX];
+static struct lockstat_user g_lockstat_buf[LOCKSTAT_MAX_LOCKS];
+static struct cpustat_user g_cpustat_buf[MAX_HARTS];
 
 static ShellProc*
 shell_proc_alloc(const char* line)
@@ -34,6 +42,7 @@ shell_proc_alloc(const char* line)
     ShellProc* p = &g_procs[i];
     if (!p->in_use) {
       p->in_use = 1;
+      p->piped  = 0;
 
       /* Copy the command line safely and ensure it is NUL-terminated. */
       int j     = 0;
@@ -62,6 +71,14 @@ shell_proc_free(ShellProc* p)
 /* Utility helpers.                                                           */
 /* -------------------------------------------------------------------------- */
 
+/* stdin 是管道（或文件）而不是控制台：cat / grep 不带文件时从它读 */
+static int
+shell_stdin_piped(void)
+{
+  struct stat_user st;
+  return fstat(FD_STDIN, &st) == 0 && st.type != STAT_T_CHR;
+}
+
 /* Lightweight decimal atoi with optional +/- prefix and no error checks. */
 static int
 shell_atoi(const char* s)
@@ -168,12 +185,23 @@ static void cmd_uptime(int argc, char** argv);
 static void cmd_irqstat(int argc, char** argv);
 static void cmd_spawn(int argc, char** argv);
 static void cmd_mon(int argc, char** argv);
+static void cmd_bench(int argc, char** argv);
+static void cmd_sysstat(int argc, char** argv);
+static void cmd_lockstat(int argc, char** argv);
+static void cmd_cpustat(int argc, char** argv);
+static void cmd_irqaffinity(int argc, char** argv);
+static void cmd_cachestat(int argc, char** argv);
+static void cmd_cat(int argc, char** argv);
+static void cmd_ls(int argc, char** argv);
+static void cmd_write(int argc, char** argv);
+static void cmd_grep(int argc, char** argv);
+static void cmd_pipestat(int argc, char** argv);
 
 /* Command table. */
 static const shell_cmd_t g_shell_cmds[] = {
     {"help",    cmd_help,    "show this help",                                  1},
     {"echo",    cmd_echo,    "echo arguments",                                  1}, /* Could also run via sh-cmd if desired. */
-    {"sleep",   cmd_sleep,   "sleep <ticks> (thread sleep)",                    0},
+    {"sleep",   cmd_sleep,   "sleep <ticks> (any key interrupts)",              0},
     {"ps",      cmd_ps,      "list threads",                                    1},
     {"jobs",    cmd_jobs,    "list user threads",                               1},
     {"kill",    cmd_kill,    "kill <tid>",                                      1},
@@ -183,8 +211,21 @@ static const shell_cmd_t g_shell_cmds[] = {
     {"irqstat", cmd_irqstat, "irqstat",                                         0},
     {"spawn",   cmd_spawn,   "spawn test threads (spin/yield/sleep/list/kill)", 1},
     {"mon",     cmd_mon,
-     "monitor: mon once | mon start <ticks> [count] | mon stop <tid> | mon "
-     "list",                                                                    0},
+     "monitor: mon once | mon start <ticks> [count] | mon watch <ticks> "
+     "[count] | mon stop <tid> | mon list",                                     0},
+    {"sysstat", cmd_sysstat, "per-syscall counts/latency: sysstat [reset]",     1},
+    {"lockstat", cmd_lockstat, "per-lock contention: lockstat [reset]",          1},
+    {"cpustat", cmd_cpustat,
+     "irq-off time / bottom halves: cpustat [reset] [inline|defer]",            1},
+    {"irqaffinity", cmd_irqaffinity,
+     "irq -> hart: irqaffinity [<irq> <mask> | balance | auto on|off]",   1},
+    {"cachestat", cmd_cachestat, "block cache hit/miss/writeback: cachestat [reset]", 1},
+    {"cat",     cmd_cat,     "print files (or piped stdin): cat [path]...",     0},
+    {"ls",      cmd_ls,      "list a directory: ls [path] (default /)",         0},
+    {"write",   cmd_write,   "write text to a file: write [-a] <path> <text>...", 0},
+    {"grep",    cmd_grep,    "filter piped stdin: ... | grep [-v] <text>",      0},
+    {"pipestat", cmd_pipestat, "pipe ring/direct bytes and blocks: pipestat [reset]", 1},
+    {"bench",   cmd_bench,   "micro benchmarks: bench <sub> [args]",            0},
 
     {"exit",    cmd_exit,    "exit shell",                                      1},
 };
@@ -247,8 +288,17 @@ cmd_sleep(int argc, char** argv)
     return;
   }
 
+  /* 控制台上按任意键提前结束：poll 等 stdin，超时就是睡够了 */
+  struct pollfd_user pfd = {.fd = FD_STDIN, .events = POLLIN};
+  if (shell_stdin_piped()) pfd.fd = -1;
+
   u_printf("sleeping %d ticks...\n", ticks);
-  sleep((uint64_t)ticks);
+  u_fflush();
+  char c;
+  if (poll(&pfd, 1u, (int64_t)ticks) > 0 && read(FD_STDIN, &c, 1) > 0) {
+    u_puts("interrupted.");
+    return;
+  }
   u_puts("done.");
 }
 
@@ -447,8 +497,11 @@ cmd_irqstat(int argc, char** argv)
     return;
   }
 
-  u_printf(
-      "irq  count            last_tick(ns)        max_delta(ns)       name\n");
+  u_printf("irq  count            last_tick(ns)        max_delta(ns)      ");
+  for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+    u_printf("      h%u", (unsigned)h);
+  }
+  u_printf("  name\n");
 
   for (long i = 0; i < n; ++i) {
     if (g_irqstat_buf[i].count == 0) {
@@ -457,11 +510,478 @@ cmd_irqstat(int argc, char** argv)
 
     const char* name = g_irqstat_buf[i].name[0] ? g_irqstat_buf[i].name : "-";
 
-    u_printf("%3u  %10llu   0x%016llx   0x%016llx   %s\n",
+    u_printf("%3u  %10llu   0x%016llx   0x%016llx ",
              (unsigned)g_irqstat_buf[i].irq,
              (unsigned long long)g_irqstat_buf[i].count,
              (unsigned long long)g_irqstat_buf[i].last_tick,
-             (unsigned long long)g_irqstat_buf[i].max_delta, name);
+             (unsigned long long)g_irqstat_buf[i].max_delta);
+    for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+      u_printf(" %7llu", (unsigned long long)g_irqstat_buf[i].hart_count[h]);
+    }
+    u_printf("  %s\n", name);
+  }
+}
+
+static void
+cmd_sysstat(int argc, char** argv)
+{
+  uint32_t flags = 0;
+  if (argc >= 2 && !u_strcmp(argv[1], "reset")) {
+    flags = SYSSTAT_F_RESET;
+  }
+
+  long n = sysstat_get(g_sysstat_buf, SHELL_SYSSTAT_MAX, flags);
+  if (n < 0) {
+    u_printf("sysstat: syscall failed (%ld)\n", n);
+    return;
+  }
+
+  u_printf(" NR NAME                    CALLS   AVG(t)   MAX(t)  PER-HART\n");
+  u_printf(" -- ------------------ ---------- -------- -------- ----------\n");
+
+  uint64_t all_calls = 0;
+  for (uint32_t nr = 0; nr < SYSSTAT_MAX_NR; ++nr) {
+    uint64_t count = 0, total = 0, max = 0;
+    for (long i = 0; i < n; ++i) {
+      const struct sysstat_user* st = &g_sysstat_buf[i];
+      if (st->nr != nr) continue;
+      count += st->count;
+      total += st->total_ticks;
+      if (st->max_ticks > max) max = st->max_ticks;
+    }
+    if (count == 0) continue;
+    all_calls += count;
+
+    /* Average with one decimal digit. */
+    uint64_t avg10 = total * 10u / count;
+    u_printf(" %2u %-18s %10llu %6llu.%llu %8llu ", (unsigned)nr,
+             syscall_name(nr), (unsigned long long)count,
+             (unsigned long long)(avg10 / 10u), (unsigned long long)(avg10 % 10u),
+             (unsigned long long)max);
+    for (long i = 0; i < n; ++i) {
+      const struct sysstat_user* st = &g_sysstat_buf[i];
+      if (st->nr != nr) continue;
+      u_printf(" h%u:%llu", (unsigned)st->hart, (unsigned long long)st->count);
+    }
+    u_printf("\n");
+  }
+
+  u_printf("total syscalls: %llu%s\n", (unsigned long long)all_calls,
+           (flags & SYSSTAT_F_RESET) ? " (counters reset)" : "");
+}
+
+static void
+cmd_lockstat(int argc, char** argv)
+{
+  uint32_t flags = 0;
+  if (argc >= 2 && !u_strcmp(argv[1], "reset")) {
+    flags = LOCKSTAT_F_RESET;
+  }
+
+  long n = lockstat_get(g_lockstat_buf, LOCKSTAT_MAX_LOCKS, flags);
+  if (n == -ENOSYS) {
+    u_puts("lockstat: kernel built without LOCKSTAT=YES");
+    return;
+  }
+  if (n < 0) {
+    u_printf("lockstat: syscall failed (%ld)\n", n);
+    return;
+  }
+
+  u_printf(" NAME         KIND        ACQ    CONTENDED  AVGSPIN(t) MAXSPIN(t) MAXHOLD(t)\n");
+  u_printf(" ------------ ------ ---------- ---------- ---------- ---------- ----------\n");
+  for (long i = 0; i < n; ++i) {
+    const struct lockstat_user* ls = &g_lockstat_buf[i];
+    uint64_t avg = ls->contended ? ls->spin_ticks / ls->contended : 0;
+    u_printf(" %-12s %-6s %10llu %10llu %10llu %10llu %10llu\n", ls->name,
+             ls->kind ? "mcs" : "ticket", (unsigned long long)ls->acquisitions,
+             (unsigned long long)ls->contended, (unsigned long long)avg,
+             (unsigned long long)ls->spin_max, (unsigned long long)ls->hold_max);
+  }
+  if (flags & LOCKSTAT_F_RESET) {
+    u_puts("(counters reset)");
+  }
+}
+
+/* 十进制或 0x 开头的十六进制 */
+static uint32_t
+shell_parse_mask(const char* s)
+{
+  if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+    uint32_t v = 0;
+    for (s += 2; *s; ++s) {
+      char c = *s;
+      if (c >= '0' && c <= '9') {
+        v = v * 16u + (uint32_t)(c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        v = v * 16u + (uint32_t)(c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        v = v * 16u + (uint32_t)(c - 'A' + 10);
+      } else {
+        break;
+      }
+    }
+    return v;
+  }
+  return (uint32_t)u_atol(s);
+}
+
+static void
+cmd_irqaffinity(int argc, char** argv)
+{
+  if (argc == 3 && !u_strcmp(argv[1], "auto")) {
+    int on = !u_strcmp(argv[2], "on");
+    if (!on && u_strcmp(argv[2], "off")) {
+      u_puts("usage: irqaffinity auto on|off");
+      return;
+    }
+    long r = irq_affinity(0, 0, on ? IRQ_AFF_AUTO_ON : IRQ_AFF_AUTO_OFF);
+    if (r < 0) {
+      u_printf("irqaffinity: failed (%ld)\n", r);
+      return;
+    }
+    u_printf("irqaffinity: auto balance %s\n", on ? "on" : "off");
+    return;
+  }
+
+  if (argc == 2 && !u_strcmp(argv[1], "balance")) {
+    long r = irq_affinity(0, 0, IRQ_AFF_BALANCE);
+    if (r < 0) {
+      u_printf("irqaffinity: failed (%ld)\n", r);
+      return;
+    }
+    u_printf("irqaffinity: moved %ld source(s)\n", r);
+    return;
+  }
+
+  if (argc == 3) {
+    uint32_t irq  = (uint32_t)u_atoi(argv[1]);
+    uint32_t mask = shell_parse_mask(argv[2]);
+    long r        = irq_affinity(irq, mask, IRQ_AFF_SET);
+    if (r < 0) {
+      u_printf("irqaffinity: irq %u mask 0x%x failed (%ld)\n", (unsigned)irq,
+               (unsigned)mask, r);
+      return;
+    }
+    u_printf("irqaffinity: irq %u -> 0x%x\n", (unsigned)irq, (unsigned)r);
+    return;
+  }
+
+  if (argc != 1) {
+    u_puts("usage: irqaffinity [<irq> <mask> | balance | auto on|off]");
+    return;
+  }
+
+  long n = irq_get_stats(g_irqstat_buf, IRQSTAT_MAX_IRQ);
+  if (n < 0) {
+    u_printf("irqaffinity: syscall failed (%ld)\n", n);
+    return;
+  }
+
+  u_printf("irq  mask        mode     ");
+  for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+    u_printf("      h%u", (unsigned)h);
+  }
+  u_printf("  name\n");
+
+  for (long i = 0; i < n; ++i) {
+    const struct irqstat_user* st = &g_irqstat_buf[i];
+    if (!(st->flags & IRQSTAT_F_REGISTERED)) continue;
+
+    u_printf("%3u  0x%08x  %-8s", (unsigned)st->irq, (unsigned)st->affinity,
+             (st->flags & IRQSTAT_F_THREADED) ? "threaded" : "hardirq");
+    for (uint32_t h = 0; h < (uint32_t)MAX_HARTS; ++h) {
+      u_printf(" %7llu", (unsigned long long)st->hart_count[h]);
+    }
+    u_printf("  %s\n", st->name[0] ? st->name : "-");
+  }
+}
+
+static void
+cmd_cpustat(int argc, char** argv)
+{
+  static const char* const cls_name[CPUSTAT_TRAP_NR] = {
+      "ext-irq", "timer", "ipi", "syscall", "other"};
+  uint32_t flags = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!u_strcmp(argv[i], "reset")) {
+      flags |= CPUSTAT_F_RESET;
+    } else if (!u_strcmp(argv[i], "inline")) {
+      flags |= CPUSTAT_F_BH_INLINE;
+    } else if (!u_strcmp(argv[i], "defer")) {
+      flags |= CPUSTAT_F_BH_DEFER;
+    } else {
+      u_puts("usage: cpustat [reset] [inline|defer]");
+      return;
+    }
+  }
+
+  long n = cpustat_get(g_cpustat_buf, MAX_HARTS, flags);
+  if (n < 0) {
+    u_printf("cpustat: syscall failed (%ld)\n", n);
+    return;
+  }
+
+  u_printf("bottom halves: %s\n",
+           (n > 0 && g_cpustat_buf[0].bh_inline) ? "inline (hard irq)"
+                                                 : "deferred (kworker)");
+  u_printf(" HART CLASS          COUNT  IRQOFF(t)    AVG(t)    MAX(t)\n");
+  u_printf(" ---- -------- ---------- ---------- --------- ---------\n");
+  for (long i = 0; i < n; ++i) {
+    const struct cpustat_user* cs = &g_cpustat_buf[i];
+    for (uint32_t c = 0; c < CPUSTAT_TRAP_NR; ++c) {
+      if (cs->trap_count[c] == 0) continue;
+      u_printf(" %4u %-8s %10llu %10llu %9llu %9llu\n", (unsigned)cs->hart,
+               cls_name[c], (unsigned long long)cs->trap_count[c],
+               (unsigned long long)cs->trap_ticks[c],
+               (unsigned long long)(cs->trap_ticks[c] / cs->trap_count[c]),
+               (unsigned long long)cs->trap_max[c]);
+    }
+  }
+
+  u_printf(" HART  WAKEUPS  SOFTIRQS  SIRQ(t)    WORKS  WORK(t)\n");
+  for (long i = 0; i < n; ++i) {
+    const struct cpustat_user* cs = &g_cpustat_buf[i];
+    uint64_t sirqs = 0;
+    for (uint32_t k = 0; k < CPUSTAT_SOFTIRQ_MAX; ++k) {
+      sirqs += cs->softirq_count[k];
+    }
+    u_printf(" %4u %8llu %9llu %8llu %8llu %8llu\n", (unsigned)cs->hart,
+             (unsigned long long)cs->kworker_wakeups, (unsigned long long)sirqs,
+             (unsigned long long)cs->softirq_ticks,
+             (unsigned long long)cs->work_count,
+             (unsigned long long)cs->work_ticks);
+  }
+  if (flags & CPUSTAT_F_RESET) {
+    u_puts("(counters reset)");
+  }
+}
+
+static void
+cmd_cachestat(int argc, char** argv)
+{
+  uint32_t flags = 0;
+  if (argc == 2 && !u_strcmp(argv[1], "reset")) {
+    flags = CACHESTAT_F_RESET;
+  } else if (argc != 1) {
+    u_puts("usage: cachestat [reset]");
+    return;
+  }
+
+  struct cachestat_user cs;
+  long rc = cachestat_get(&cs, flags);
+  if (rc < 0) {
+    u_printf("cachestat: syscall failed (%ld)\n", rc);
+    return;
+  }
+
+  uint64_t lookups = cs.hits + cs.misses;
+  uint64_t permil  = lookups ? cs.hits * 1000u / lookups : 0;
+  u_printf("buffers %u x %u B, valid %u, dirty %u\n", (unsigned)cs.nbuf,
+           (unsigned)cs.block_size, (unsigned)cs.nvalid, (unsigned)cs.ndirty);
+  u_printf("  hits %llu  misses %llu  hit-rate %llu.%llu%%  evictions %llu\n",
+           (unsigned long long)cs.hits, (unsigned long long)cs.misses,
+           (unsigned long long)(permil / 10u), (unsigned long long)(permil % 10u),
+           (unsigned long long)cs.evictions);
+  u_printf("  readahead %llu issued, %llu used\n",
+           (unsigned long long)cs.ra_issued, (unsigned long long)cs.ra_hits);
+  u_printf("  writeback %llu blocks in %llu batches, sync writes %llu\n",
+           (unsigned long long)cs.writebacks,
+           (unsigned long long)cs.flush_batches,
+           (unsigned long long)cs.sync_writes);
+  u_printf("  direct reads %llu blocks in %llu requests\n",
+           (unsigned long long)cs.direct_blocks,
+           (unsigned long long)cs.direct_reqs);
+  u_printf("  waits: buffer lock %llu, free buffer %llu\n",
+           (unsigned long long)cs.lock_waits,
+           (unsigned long long)cs.alloc_waits);
+  if (flags & CACHESTAT_F_RESET) {
+    u_puts("(counters reset)");
+  }
+}
+
+static void
+cmd_cat(int argc, char** argv)
+{
+  char buf[512];
+  if (argc < 2) {
+    if (!shell_stdin_piped()) {
+      u_puts("usage: cat <path>...");
+      return;
+    }
+    long n;
+    while ((n = (long)read(FD_STDIN, buf, sizeof(buf))) > 0) {
+      write(FD_STDOUT, buf, (uint64_t)n);
+    }
+    return;
+  }
+
+  for (int i = 1; i < argc; ++i) {
+    int fd = open(argv[i], O_RDONLY);
+    if (fd < 0) {
+      u_printf("cat: %s: error %d\n", argv[i], fd);
+      continue;
+    }
+    for (;;) {
+      long n = (long)read(fd, buf, sizeof(buf));
+      if (n < 0) {
+        u_printf("cat: %s: read error %ld\n", argv[i], n);
+        break;
+      }
+      if (n == 0) break;
+      u_fflush();  /* 前面 u_printf 的缓冲先出去 */
+      write(FD_STDOUT, buf, (uint64_t)n);
+    }
+    (void)close(fd);
+  }
+}
+
+static void
+cmd_ls(int argc, char** argv)
+{
+  const char* dir = (argc > 1) ? argv[1] : "/";
+  if (argc > 2) {
+    u_puts("usage: ls [path]");
+    return;
+  }
+
+  int fd = open(dir, O_RDONLY);
+  if (fd < 0) {
+    u_printf("ls: %s: error %d\n", dir, fd);
+    return;
+  }
+
+  struct dirent_user ents[8];
+  char path[PATH_MAX];
+  size_t dlen = u_strlen(dir);
+  long n;
+  while ((n = getdents(fd, ents, 8u)) > 0) {
+    for (long i = 0; i < n; ++i) {
+      if (ents[i].type == STAT_T_DIR) {
+        u_printf("%10s  %s/\n", "<dir>", ents[i].name);
+        continue;
+      }
+      /* 大小要 fstat：按 dir + "/" + name 再打开一次 */
+      struct stat_user st = {0};
+      u_snprintf(path, sizeof(path), "%s%s%s", dir,
+                 (dlen && dir[dlen - 1] == '/') ? "" : "/", ents[i].name);
+      int f = open(path, O_RDONLY);
+      if (f >= 0) {
+        (void)fstat(f, &st);
+        (void)close(f);
+      }
+      u_printf("%10llu  %s\n", (unsigned long long)st.size, ents[i].name);
+    }
+  }
+  if (n < 0) u_printf("ls: %s: error %ld\n", dir, n);
+  (void)close(fd);
+}
+
+static void
+cmd_write(int argc, char** argv)
+{
+  uint32_t flags = O_WRONLY | O_CREAT | O_TRUNC;
+  int i          = 1;
+  if (argc > 1 && !u_strcmp(argv[1], "-a")) {
+    flags = O_WRONLY | O_CREAT | O_APPEND;
+    i++;
+  }
+  if (argc - i < 1) {
+    u_puts("usage: write [-a] <path> <text>...");
+    return;
+  }
+
+  const char* path = argv[i++];
+  int fd           = open(path, flags);
+  if (fd < 0) {
+    u_printf("write: %s: error %d\n", path, fd);
+    return;
+  }
+  /* 参数用空格连起来，最后补换行 */
+  for (; i < argc; ++i) {
+    long r = (long)write(fd, argv[i], u_strlen(argv[i]));
+    if (r >= 0 && i + 1 < argc) r = (long)write(fd, " ", 1);
+    if (r < 0) {
+      u_printf("write: %s: error %ld\n", path, r);
+      break;
+    }
+  }
+  if (i == argc) (void)write(fd, "\n", 1);
+  (void)close(fd);
+}
+
+/* 一行里含 pat（或 -v 时不含）就打印 */
+static void
+grep_line(char* line, size_t len, const char* pat, size_t plen, int invert)
+{
+  int hit = 0;
+  for (size_t k = 0; k + plen <= len && !hit; ++k) {
+    hit = (u_memcmp(line + k, pat, plen) == 0);
+  }
+  if (hit != invert) {
+    line[len] = '\0';
+    u_puts(line);
+  }
+}
+
+static void
+cmd_grep(int argc, char** argv)
+{
+  int invert      = (argc > 1 && !u_strcmp(argv[1], "-v"));
+  const char* pat = (argc == 2 + invert) ? argv[1 + invert] : NULL;
+  if (!pat || !shell_stdin_piped()) {
+    u_puts("usage: <cmd> | grep [-v] <text>");
+    return;
+  }
+
+  /* 按行切；超过 line 的长行截成几段各自匹配 */
+  char buf[256];
+  char line[256];
+  size_t plen = u_strlen(pat);
+  size_t len  = 0;
+  long n;
+  while ((n = (long)read(FD_STDIN, buf, sizeof(buf))) > 0) {
+    for (long i = 0; i < n; ++i) {
+      if (buf[i] == '\n' || len == sizeof(line) - 1) {
+        grep_line(line, len, pat, plen, invert);
+        len = 0;
+        if (buf[i] == '\n') continue;
+      }
+      line[len++] = buf[i];
+    }
+  }
+  if (len > 0) grep_line(line, len, pat, plen, invert);
+  if (n < 0) u_printf("grep: read error %ld\n", n);
+}
+
+static void
+cmd_pipestat(int argc, char** argv)
+{
+  uint32_t flags = 0;
+  if (argc > 1 && !u_strcmp(argv[1], "reset")) {
+    flags = PIPESTAT_F_RESET;
+  } else if (argc > 1) {
+    u_puts("usage: pipestat [reset]");
+    return;
+  }
+
+  struct pipestat_user st;
+  long rc = pipestat_get(&st, flags);
+  if (rc < 0) {
+    u_printf("pipestat: error %ld\n", rc);
+    return;
+  }
+  u_printf("pipes     : %u open, %llu created\n", st.npipes,
+           (unsigned long long)st.created);
+  u_printf("bytes     : ring %llu, direct %llu\n",
+           (unsigned long long)st.bytes_ring,
+           (unsigned long long)st.bytes_direct);
+  u_printf("blocks    : read %llu, write %llu\n",
+           (unsigned long long)st.read_blocks,
+           (unsigned long long)st.write_blocks);
+  if (flags & PIPESTAT_F_RESET) {
+    u_puts("(counters reset)");
   }
 }
 
@@ -471,6 +991,12 @@ cmd_spawn(int argc, char** argv)
   spawn(argc, argv);
 }
 
+static void
+cmd_bench(int argc, char** argv)
+{
+  bench(argc, argv);
+}
+
 static void
 cmd_mon(int argc, char** argv)
 {
@@ -479,6 +1005,7 @@ cmd_mon(int argc, char** argv)
         "usage:\n"
         "  mon once\n"
         "  mon start <period_ticks> [count]\n"
+        "  mon watch <period_ticks> [count]   (foreground, keys: q r u i)\n"
         "  mon stop <tid>\n"
         "  mon list\n");
     return;
@@ -513,6 +1040,17 @@ cmd_mon(int argc, char** argv)
     return;
   }
 
+  if (!u_strcmp(argv[1], "watch")) {
+    if (argc < 3) {
+      u_puts("mon watch: missing period_ticks\n");
+      return;
+    }
+    uint32_t period = (uint32_t)u_atoi(argv[2]);
+    int32_t count   = (argc >= 4) ? (int32_t)u_atoi(argv[3]) : -1;
+    mon_watch(period, count);
+    return;
+  }
+
   if (!u_strcmp(argv[1], "stop")) {
     if (argc < 3) {
       u_puts("mon stop: missing tid\n");
@@ -546,8 +1084,15 @@ static void __attribute__((noreturn)) shell_cmd_worker(void* arg) {
   }
 
   /* This "process" is no longer needed; release the slot. */
+  int piped = proc->piped;
   shell_proc_free(proc);
 
+  /* 输出进管道：攒满一块再写，少几次陷入和唤醒 */
+  struct stat_user st;
+  if (piped && fstat(FD_STDOUT, &st) == 0 && st.type == STAT_T_FIFO) {
+    u_setvbuf(U_IOFBF);
+  }
+
   /* 2. Parse into argc/argv. */
   char* argv[SHELL_MAX_ARGS];
   int argc = shell_parse_line(line, argv, SHELL_MAX_ARGS);
@@ -604,7 +1149,95 @@ static int shell_run_command(const char* line) {
   return status;  /* Similar to waitpid's WEXITSTATUS. */
 }
 
+/*
+ * Run "a | b | ..." in the foreground.
+ *   - 每一段一个 sh-cmd 线程，用 thread_spawn 给它单独的 fd 表：
+ *     0 = 上一段的读端，1 = 下一段的写端，2 照抄 shell 的。
+ *   - shell 自己不留任何管道端，否则读端永远等不到 EOF。
+ *   - line 会被原地切开。
+ */
+static void shell_run_pipeline(char* line) {
+  char* stages[SHELL_MAX_PROCS];
+  int nstages = 0;
+
+  for (char* s = line;; ++s) {
+    char* bar = u_strchr(s, '|');
+    if (nstages == SHELL_MAX_PROCS) {
+      u_printf("shell: at most %d pipeline stages\n", SHELL_MAX_PROCS);
+      return;
+    }
+    stages[nstages++] = s;
+    if (!bar) break;
+    *bar = '\0';
+    s    = bar;
+  }
+
+  /* 先全部检查一遍，别起了一半才发现命令不存在 */
+  for (int i = 0; i < nstages; ++i) {
+    char tmp[SHELL_MAX_LINE];
+    char* argv[SHELL_MAX_ARGS];
+    u_strncpy(tmp, stages[i], sizeof(tmp) - 1);
+    tmp[sizeof(tmp) - 1] = '\0';
+    if (shell_parse_line(tmp, argv, SHELL_MAX_ARGS) == 0) {
+      u_puts("shell: empty pipeline stage");
+      return;
+    }
+    if (!shell_find_cmd(argv[0])) {
+      u_printf("unknown command: %s\n", argv[0]);
+      return;
+    }
+  }
+
+  tid_t tids[SHELL_MAX_PROCS];
+  int nspawned = 0;
+  int in       = -1;  /* 上一段的读端；-1 = 控制台 */
+  for (int i = 0; i < nstages; ++i) {
+    int fds[2] = {-1, -1};
+    if (i + 1 < nstages) {
+      int rc = pipe(fds);
+      if (rc < 0) {
+        u_printf("shell: pipe failed, rc=%d\n", rc);
+        break;
+      }
+    }
+
+    ShellProc* proc = shell_proc_alloc(stages[i]);
+    tid_t tid       = -1;
+    if (proc) {
+      int stdio[3] = {in, fds[1], -1};
+      proc->piped  = 1;
+      tid          = thread_spawn(shell_cmd_worker, (void*)proc, "sh-pipe",
+                                  stdio);
+      if (tid < 0) shell_proc_free(proc);
+    }
+
+    /* 子线程已经有自己的一份，shell 这边的都关掉 */
+    if (in >= 0) (void)close(in);
+    if (fds[1] >= 0) (void)close(fds[1]);
+    in = fds[0];
+
+    if (tid < 0) {
+      u_puts("shell: failed to start pipeline stage");
+      break;
+    }
+    tids[nspawned++] = tid;
+  }
+  if (in >= 0) (void)close(in);
+
+  /* 起不来的后半段：前面的写端会拿到 EPIPE，照样能结束 */
+  for (int i = 0; i < nspawned; ++i) {
+    int status = 0;
+    int rc     = thread_join(tids[i], &status);
+    if (rc < 0) u_printf("shell: thread_join failed, rc=%d\n", rc);
+  }
+}
+
 static void shell_dispatch_line(char* line) {
+  if (u_strchr(line, '|')) {
+    shell_run_pipeline(line);
+    return;
+  }
+
   /* Copy argv for builtin detection. */
   char raw_line[SHELL_MAX_LINE];
 
@@ -630,7 +1263,10 @@ static void shell_dispatch_line(char* line) {
 
   /* Commands that must run inside the shell thread (exit/ps/jobs/kill/etc.). */
   if (cmd->run_in_shell) {
+    /* 整张表攒满再写：ps 之类只需几次 write */
+    u_setvbuf(U_IOFBF);
     cmd->fn(argc, argv);
+    u_setvbuf(U_IOLBF);
     return;
   }
 
@@ -4,9 +4,11 @@
 
 #include "syscall.h"
 #include "ulib.h"     /* u_printf/u_puts/sleep/u_atoi... */
+#include "uvdso.h"
 
 /* ---- spawn config ---- */
 #define SPAWN_MAX 16
+#define SPAWN_DEFAULT_WORK_LOOPS 200000u
 
 typedef enum {
   SPAWN_MODE_SPIN  = 0,
@@ -29,7 +31,8 @@ typedef struct {
   volatile int      last_hart;   /* Last hart this thread ran on. */
   volatile uint32_t migrations;  /* Number of hart changes observed. */
   volatile uint32_t prints;      /* Number of log lines printed. */
-} spawn_cfg_t;
+  volatile uint64_t rounds;      /* Completed loop iterations (spawn rate). */
+} __attribute__((aligned(64))) spawn_cfg_t;  /* 每个 worker 独占 cache line：统计字段各写各的 */
 
 static spawn_cfg_t s_spawn_cfg[SPAWN_MAX];
 static int s_spawn_active = 0;
@@ -86,6 +89,7 @@ spawn_worker(void* arg)
 
     /* 4) Print occasionally. */
     it++;
+    c->rounds++;
     if (c->print_every && (it % c->print_every) == 0) {
       c->prints++;
       /* Keep each print on a single line to minimize interleave. */
@@ -96,6 +100,53 @@ spawn_worker(void* arg)
   }
 }
 
+/* ---- spawn rate: 窗口内每个 worker 跑了多少轮 ---- */
+#define SPAWN_RATE_DEFAULT_TICKS 100u
+
+static inline uint64_t
+spawn_now(void)
+{
+  uint64_t t;
+  __asm__ volatile("rdtime %0" : "=r"(t));
+  return t;
+}
+
+static void
+spawn_rate(uint32_t ticks)
+{
+  uint64_t before[SPAWN_MAX];
+
+  if (ticks == 0) ticks = SPAWN_RATE_DEFAULT_TICKS;
+  if (s_spawn_active == 0) {
+    u_puts("spawn rate: no workers (try: spawn yield 4)");
+    return;
+  }
+
+  for (int i = 0; i < SPAWN_MAX; ++i) {
+    before[i] = s_spawn_cfg[i].rounds;
+  }
+  uint64_t t0 = spawn_now();
+  sleep(ticks);
+  uint64_t dt = spawn_now() - t0;
+
+  uint64_t hz = __vdso_data.timebase_hz ? __vdso_data.timebase_hz : 10000000ull;
+  if (dt == 0) dt = 1;
+
+  uint64_t total = 0;
+  u_printf(" WID  TID  MODE  ROUNDS/S\n");
+  for (int i = 0; i < SPAWN_MAX; ++i) {
+    spawn_cfg_t* c = &s_spawn_cfg[i];
+    if (c->tid < 0) continue;
+    uint64_t d = c->rounds - before[i];
+    total += d;
+    u_printf(" %-4d %-4d %-4d  %llu\n", c->wid, c->tid, (int)c->mode,
+             (unsigned long long)(d * hz / dt));
+  }
+  u_printf(" total %llu rounds/s over %llu us\n",
+           (unsigned long long)(total * hz / dt),
+           (unsigned long long)(dt * 1000000ull / hz));
+}
+
 /* ---- shell cmd ---- */
 static void
 spawn_usage(void)
@@ -103,9 +154,10 @@ spawn_usage(void)
   u_puts(
       "usage:\n"
       "  spawn spin  N [print_every]\n"
-      "  spawn yield N [print_every]\n"
+      "  spawn yield N [print_every] [work_loops]\n"
       "  spawn sleep N <sleep_ticks> [print_every]\n"
       "  spawn list\n"
+      "  spawn rate [ticks]   rounds/s per worker over a window\n"
       "  spawn kill\n"
       "notes:\n"
       "  - print_every is in 'iterations' (not ticks)\n"
@@ -136,7 +188,7 @@ spawn_find_free_wid(void)
 
 static void
 spawn_cfg_init(spawn_cfg_t* c, int wid, spawn_mode_t mode, uint32_t sleep_ticks,
-               uint32_t print_every)
+               uint32_t print_every, uint32_t work_loops)
 {
   c->wid         = wid;
   c->tid         = -1;
@@ -144,22 +196,23 @@ spawn_cfg_init(spawn_cfg_t* c, int wid, spawn_mode_t mode, uint32_t sleep_ticks,
   c->sleep_ticks = sleep_ticks;
   c->print_every = print_every;  /* 0 disables printing. */
 
-  c->work_loops  = 200000;
+  c->work_loops  = work_loops;
 
   c->last_hart   = -1;
   c->migrations  = 0;
   c->prints      = 0;
+  c->rounds      = 0;
 }
 
 static int
 spawn_add(spawn_mode_t mode, uint32_t sleep_ticks, uint32_t print_every,
-          const char* name_prefix)
+          uint32_t work_loops, const char* name_prefix)
 {
   int wid = spawn_find_free_wid();
   if (wid < 0) return -1;
 
   spawn_cfg_t* c = &s_spawn_cfg[wid];
-  spawn_cfg_init(c, wid, mode, sleep_ticks, print_every);
+  spawn_cfg_init(c, wid, mode, sleep_ticks, print_every, work_loops);
 
   static char names[SPAWN_MAX][8];
   make_name(names[wid], (int)sizeof(names[wid]), name_prefix, wid);
@@ -197,6 +250,11 @@ spawn(int argc, char** argv)
     return;
   }
 
+  if (!u_strcmp(sub, "rate")) {
+    spawn_rate(argc >= 3 ? (uint32_t)u_atoi(argv[2]) : 0);
+    return;
+  }
+
   if (!u_strcmp(sub, "kill")) {
     /*
      * Make kill deterministic:
@@ -251,7 +309,8 @@ spawn(int argc, char** argv)
     if (argc >= 4) print_every = (uint32_t)u_atoi(argv[3]);
 
     for (int i = 0; i < n; ++i) {
-      int tid = spawn_add(SPAWN_MODE_SPIN, 0, print_every, "sp");
+      int tid = spawn_add(SPAWN_MODE_SPIN, 0, print_every,
+                          SPAWN_DEFAULT_WORK_LOOPS, "sp");
       if (tid < 0) {
         u_puts("spawn: create failed\n");
         break;
@@ -265,10 +324,12 @@ spawn(int argc, char** argv)
 
   if (!u_strcmp(sub, "yield")) {
     uint32_t print_every = 0;
+    uint32_t work_loops  = SPAWN_DEFAULT_WORK_LOOPS;
     if (argc >= 4) print_every = (uint32_t)u_atoi(argv[3]);
+    if (argc >= 5) work_loops = (uint32_t)u_atoi(argv[4]);  /* 0 = 纯 yield */
 
     for (int i = 0; i < n; ++i) {
-      int tid = spawn_add(SPAWN_MODE_YIELD, 0, print_every, "y");
+      int tid = spawn_add(SPAWN_MODE_YIELD, 0, print_every, work_loops, "y");
       if (tid < 0) {
         u_puts("spawn: create failed\n");
         break;
@@ -288,7 +349,8 @@ spawn(int argc, char** argv)
     if (argc >= 5) print_every = (uint32_t)u_atoi(argv[4]);
 
     for (int i = 0; i < n; ++i) {
-      int tid = spawn_add(SPAWN_MODE_SLEEP, sleep_ticks, print_every, "sl");
+      int tid = spawn_add(SPAWN_MODE_SLEEP, sleep_ticks, print_every,
+                          SPAWN_DEFAULT_WORK_LOOPS, "sl");
       if (tid < 0) {
         u_puts("spawn: create failed\n");
         break;
@@ -1,6 +1,7 @@
 /* syscall.c */
 
 #include "syscall.h"
+#include "ulib.h"
 #include "usyscall.h"
 
 uint64_t write(int fd, const void *buf, uint64_t len)
@@ -41,9 +42,29 @@ void sleep(uint64_t ticks)
   __asm__ volatile("ecall" : "+r"(a0), "+r"(a1) : : "memory");
 }
 
+/* 同 thread_create，但新线程用新的 fd 表：0/1/2 = 本线程的 stdio[0..2] */
+tid_t thread_spawn(thread_entry_t entry, void *arg, const char *name,
+                   const int stdio[3])
+{
+  register uintptr_t a0 asm("a0") = SYS_THREAD_SPAWN;
+  register uintptr_t a1 asm("a1") = (uintptr_t)entry;
+  register uintptr_t a2 asm("a2") = (uintptr_t)arg;
+  register uintptr_t a3 asm("a3") = (uintptr_t)name;
+  register uintptr_t a4 asm("a4") = (uintptr_t)stdio;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3), "+r"(a4)
+                   :
+                   : "memory");
+
+  return (tid_t)a0;
+}
+
 /* User-side thread_exit: never returns. */
 void thread_exit(int exit_code)
 {
+  u_fflush();  /* 缓冲里的 stdout 不能随线程丢掉 */
+
   register uintptr_t a0 asm("a0") = SYS_THREAD_EXIT;
   register uintptr_t a1 asm("a1") = (uintptr_t)exit_code;
 
@@ -96,6 +117,9 @@ int thread_kill(tid_t tid)
   register uintptr_t a1 asm("a1") = (uintptr_t)tid;
 
   __asm__ volatile("ecall" : "+r"(a0), "+r"(a1) : : "memory");
+
+  /* 被杀的线程来不及 flush，丢弃它的 stdout 缓冲，免得 tid 复用时串出来 */
+  if ((int)a0 == 0) u_stdout_discard(tid);
   return (int)a0;
 }
 
@@ -118,7 +142,7 @@ int runqueue_snapshot(struct rq_state *buf, size_t max)
   return (int)a0; /* number of entries filled, or <0 on error */
 }
 
-int clock_gettime(int clock_id, struct timespec *ts)
+int clock_gettime_syscall(int clock_id, struct timespec *ts)
 {
   register uintptr_t a0 asm("a0") = SYS_CLOCK_GETTIME;  /* syscall number */
   register uintptr_t a1 asm("a1") = (uintptr_t)clock_id;
@@ -141,13 +165,332 @@ long irq_get_stats(struct irqstat_user *buf, size_t n)
   return (long)a0;  /* Entries written, or <0 on error. */
 }
 
-int get_hartid(void) {
+int get_hartid_syscall(void) {
   register long a0 asm("a0") = SYS_GET_HARTID;
   asm volatile("ecall" : "+r"(a0) : : "memory");
   return (int)a0;
 }
 
+long nop_syscall(void) {
+  register long a0 asm("a0") = SYS_NOP;
+  asm volatile("ecall" : "+r"(a0) : : "memory");
+  return a0;
+}
+
 void yield() {
   register long a0 asm("a0") = SYS_YIELD;
   asm volatile("ecall" : "+r"(a0) : : "memory");
 }
+
+long sysstat_get(struct sysstat_user *buf, size_t n, uint32_t flags)
+{
+  register uintptr_t a0 asm("a0") = SYS_SYSSTAT;
+  register uintptr_t a1 asm("a1") = (uintptr_t)buf;
+  register uintptr_t a2 asm("a2") = (uintptr_t)n;
+  register uintptr_t a3 asm("a3") = (uintptr_t)flags;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (long)a0;  /* Rows written, or <0 on error. */
+}
+
+long lockstat_get(struct lockstat_user *buf, size_t n, uint32_t flags)
+{
+  register uintptr_t a0 asm("a0") = SYS_LOCKSTAT;
+  register uintptr_t a1 asm("a1") = (uintptr_t)buf;
+  register uintptr_t a2 asm("a2") = (uintptr_t)n;
+  register uintptr_t a3 asm("a3") = (uintptr_t)flags;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (long)a0;  /* Rows written, or <0 on error. */
+}
+
+long cpustat_get(struct cpustat_user *buf, size_t n, uint32_t flags)
+{
+  register uintptr_t a0 asm("a0") = SYS_CPUSTAT;
+  register uintptr_t a1 asm("a1") = (uintptr_t)buf;
+  register uintptr_t a2 asm("a2") = (uintptr_t)n;
+  register uintptr_t a3 asm("a3") = (uintptr_t)flags;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (long)a0;  /* Rows written, or <0 on error. */
+}
+
+long irq_affinity(uint32_t irq, uint32_t hart_mask, uint32_t op)
+{
+  register uintptr_t a0 asm("a0") = SYS_IRQ_AFFINITY;
+  register uintptr_t a1 asm("a1") = (uintptr_t)irq;
+  register uintptr_t a2 asm("a2") = (uintptr_t)hart_mask;
+  register uintptr_t a3 asm("a3") = (uintptr_t)op;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (long)a0;
+}
+
+long blk_io(uint32_t dev, struct blk_io *iov, uint32_t n)
+{
+  register uintptr_t a0 asm("a0") = SYS_BLK_IO;
+  register uintptr_t a1 asm("a1") = (uintptr_t)dev;
+  register uintptr_t a2 asm("a2") = (uintptr_t)iov;
+  register uintptr_t a3 asm("a3") = (uintptr_t)n;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (long)a0;
+}
+
+long blk_stat(uint32_t dev, struct blkstat_user *out, uint32_t flags)
+{
+  register uintptr_t a0 asm("a0") = SYS_BLK_STAT;
+  register uintptr_t a1 asm("a1") = (uintptr_t)dev;
+  register uintptr_t a2 asm("a2") = (uintptr_t)out;
+  register uintptr_t a3 asm("a3") = (uintptr_t)flags;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (long)a0;
+}
+
+long bcache_io(uint32_t dev, uint32_t op, uint32_t blockno, void *buf)
+{
+  register uintptr_t a0 asm("a0") = SYS_BCACHE_IO;
+  register uintptr_t a1 asm("a1") = (uintptr_t)dev;
+  register uintptr_t a2 asm("a2") = (uintptr_t)op;
+  register uintptr_t a3 asm("a3") = (uintptr_t)blockno;
+  register uintptr_t a4 asm("a4") = (uintptr_t)buf;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3), "+r"(a4)
+                   :
+                   : "memory");
+
+  return (long)a0;
+}
+
+long cachestat_get(struct cachestat_user *out, uint32_t flags)
+{
+  register uintptr_t a0 asm("a0") = SYS_CACHESTAT;
+  register uintptr_t a1 asm("a1") = (uintptr_t)out;
+  register uintptr_t a2 asm("a2") = (uintptr_t)flags;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2)
+                   :
+                   : "memory");
+
+  return (long)a0;
+}
+
+int open(const char *path, uint32_t flags)
+{
+  register uintptr_t a0 asm("a0") = SYS_OPEN;
+  register uintptr_t a1 asm("a1") = (uintptr_t)path;
+  register uintptr_t a2 asm("a2") = (uintptr_t)flags;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2)
+                   :
+                   : "memory");
+
+  return (int)a0;
+}
+
+int close(int fd)
+{
+  register uintptr_t a0 asm("a0") = SYS_CLOSE;
+  register uintptr_t a1 asm("a1") = (uintptr_t)fd;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1)
+                   :
+                   : "memory");
+
+  return (int)a0;
+}
+
+long lseek(int fd, int64_t off, int whence)
+{
+  register uintptr_t a0 asm("a0") = SYS_LSEEK;
+  register uintptr_t a1 asm("a1") = (uintptr_t)fd;
+  register uintptr_t a2 asm("a2") = (uintptr_t)off;
+  register uintptr_t a3 asm("a3") = (uintptr_t)whence;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (long)a0;
+}
+
+int fstat(int fd, struct stat_user *st)
+{
+  register uintptr_t a0 asm("a0") = SYS_FSTAT;
+  register uintptr_t a1 asm("a1") = (uintptr_t)fd;
+  register uintptr_t a2 asm("a2") = (uintptr_t)st;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2)
+                   :
+                   : "memory");
+
+  return (int)a0;
+}
+
+long getdents(int fd, struct dirent_user *ents, uint32_t n)
+{
+  register uintptr_t a0 asm("a0") = SYS_GETDENTS;
+  register uintptr_t a1 asm("a1") = (uintptr_t)fd;
+  register uintptr_t a2 asm("a2") = (uintptr_t)ents;
+  register uintptr_t a3 asm("a3") = (uintptr_t)n;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (long)a0;
+}
+
+int pipe(int fds[2])
+{
+  register uintptr_t a0 asm("a0") = SYS_PIPE;
+  register uintptr_t a1 asm("a1") = (uintptr_t)fds;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1)
+                   :
+                   : "memory");
+
+  return (int)a0;
+}
+
+long pipestat_get(struct pipestat_user *out, uint32_t flags)
+{
+  register uintptr_t a0 asm("a0") = SYS_PIPESTAT;
+  register uintptr_t a1 asm("a1") = (uintptr_t)out;
+  register uintptr_t a2 asm("a2") = (uintptr_t)flags;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2)
+                   :
+                   : "memory");
+
+  return (long)a0;
+}
+
+long futex(volatile uint32_t *addr, uint32_t op, uint32_t val)
+{
+  register uintptr_t a0 asm("a0") = SYS_FUTEX;
+  register uintptr_t a1 asm("a1") = (uintptr_t)addr;
+  register uintptr_t a2 asm("a2") = (uintptr_t)op;
+  register uintptr_t a3 asm("a3") = (uintptr_t)val;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (long)a0;
+}
+
+int poll(struct pollfd_user *fds, uint32_t nfds, int64_t timeout)
+{
+  register uintptr_t a0 asm("a0") = SYS_POLL;
+  register uintptr_t a1 asm("a1") = (uintptr_t)fds;
+  register uintptr_t a2 asm("a2") = (uintptr_t)nfds;
+  register uintptr_t a3 asm("a3") = (uintptr_t)timeout;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (int)a0;
+}
+
+int eventfd(uint64_t initval, uint32_t flags)
+{
+  register uintptr_t a0 asm("a0") = SYS_EVENTFD;
+  register uintptr_t a1 asm("a1") = (uintptr_t)initval;
+  register uintptr_t a2 asm("a2") = (uintptr_t)flags;
+
+  __asm__ volatile("ecall" : "+r"(a0), "+r"(a1), "+r"(a2) : : "memory");
+
+  return (int)a0;
+}
+
+int timerfd_create(void)
+{
+  register uintptr_t a0 asm("a0") = SYS_TIMERFD_CREATE;
+
+  __asm__ volatile("ecall" : "+r"(a0) : : "memory");
+
+  return (int)a0;
+}
+
+int timerfd_settime(int fd, uint64_t first, uint64_t period)
+{
+  register uintptr_t a0 asm("a0") = SYS_TIMERFD_SETTIME;
+  register uintptr_t a1 asm("a1") = (uintptr_t)fd;
+  register uintptr_t a2 asm("a2") = (uintptr_t)first;
+  register uintptr_t a3 asm("a3") = (uintptr_t)period;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (int)a0;
+}
+
+long ring_setup(struct uring *ring, uint32_t entries, uint32_t flags)
+{
+  register uintptr_t a0 asm("a0") = SYS_RING_SETUP;
+  register uintptr_t a1 asm("a1") = (uintptr_t)ring;
+  register uintptr_t a2 asm("a2") = (uintptr_t)entries;
+  register uintptr_t a3 asm("a3") = (uintptr_t)flags;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (long)a0;
+}
+
+long ring_enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags)
+{
+  register uintptr_t a0 asm("a0") = SYS_RING_ENTER;
+  register uintptr_t a1 asm("a1") = (uintptr_t)to_submit;
+  register uintptr_t a2 asm("a2") = (uintptr_t)min_complete;
+  register uintptr_t a3 asm("a3") = (uintptr_t)flags;
+
+  __asm__ volatile("ecall"
+                   : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3)
+                   :
+                   : "memory");
+
+  return (long)a0;  /* SQEs consumed, or <0 on error. */
+}
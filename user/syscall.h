@@ -20,6 +20,9 @@ void     sleep(uint64_t ticks);
 
 int   thread_join(tid_t tid, int *status_out);
 tid_t thread_create(thread_entry_t entry, void *arg, const char *name);
+/* 新线程组（新 fd 表）：0/1/2 = 本线程的 stdio[i]，-1 / NULL = 照抄 */
+tid_t thread_spawn(thread_entry_t entry, void *arg, const char *name,
+                   const int stdio[3]);
 void  thread_exit(int exit_code) __attribute__((noreturn));
 
 int thread_list(struct u_thread_info *buf, int max);  /* Count returned or <0 on error. */
@@ -27,11 +30,66 @@ int thread_kill(tid_t tid);                           /* 0 on success, <0 on err
 int thread_detach(tid_t tid);                         /* 0 on success, <0 on error. */
 int runqueue_snapshot(struct rq_state *buf, size_t max);  /* returns count or <0 */
 
-/* clock_id support CLOCK_REALTIME(0) only */
+/* clock_id: CLOCK_REALTIME / CLOCK_MONOTONIC.
+ * clock_gettime/get_hartid 走 vdso（见 vdso.c），*_syscall 是真正陷入内核的版本。
+ */
 int clock_gettime(int clock_id, struct timespec *ts);
+int clock_gettime_syscall(int clock_id, struct timespec *ts);
 
 long irq_get_stats(struct irqstat_user *ubuf, size_t n);
 int  get_hartid(void);
+int  get_hartid_syscall(void);
+tid_t thread_self(void);  /* vdso：按 sp 算出的自己的 tid，不陷入；未知时 -1 */
 void yield(void);
+long nop_syscall(void);  /* SYS_NOP：空 syscall，只用来测陷入开销 */
+
+/* Per-(syscall, hart) counters; flags: SYSSTAT_F_RESET. Rows or <0. */
+long sysstat_get(struct sysstat_user *buf, size_t n, uint32_t flags);
+
+/* Per-lock contention stats; flags: LOCKSTAT_F_RESET. Rows, -ENOSYS without LOCKSTAT. */
+long lockstat_get(struct lockstat_user *buf, size_t n, uint32_t flags);
+
+/* Per-hart irq-off / bottom-half stats; flags: CPUSTAT_F_*. Rows or <0. */
+long cpustat_get(struct cpustat_user *buf, size_t n, uint32_t flags);
+
+/* op = IRQ_AFF_*：SET 返回新的 hart 位图，BALANCE 返回迁移的源个数；或 -errno */
+long irq_affinity(uint32_t irq, uint32_t hart_mask, uint32_t op);
+
+/* 块设备：一批 n 个请求全部完成才返回；n 或第一个错误的 -errno（见 uapi.h） */
+long blk_io(uint32_t dev, struct blk_io *iov, uint32_t n);
+/* flags: BLKSTAT_F_RESET；0 或 -ENODEV */
+long blk_stat(uint32_t dev, struct blkstat_user *out, uint32_t flags);
+
+/* 经块缓存读写一个 1 KiB 块：op = BCACHE_OP_*；块大小 / 0（SYNC）或 -errno */
+long bcache_io(uint32_t dev, uint32_t op, uint32_t blockno, void *buf);
+/* flags: CACHESTAT_F_RESET；0 或 -EINVAL */
+long cachestat_get(struct cachestat_user *out, uint32_t flags);
+
+/* 文件（uapi.h 的 O_* / SEEK_*）：fd / 0 / 新偏移，或 -errno。
+ * read/write 对普通文件同样适用，0/1/2 是控制台 */
+int  open(const char *path, uint32_t flags);
+int  close(int fd);
+long lseek(int fd, int64_t off, int whence);
+int  fstat(int fd, struct stat_user *st);
+/* 目录项：项数（0 = 读完）或 -errno */
+long getdents(int fd, struct dirent_user *ents, uint32_t n);
+/* fds[0] 读端，fds[1] 写端；0 或 -errno */
+int  pipe(int fds[2]);
+/* flags: PIPESTAT_F_RESET；0 或 -EINVAL */
+long pipestat_get(struct pipestat_user *out, uint32_t flags);
+/* op: FUTEX_WAIT（*addr == val 才睡）/ FUTEX_WAKE（最多 val 个） */
+long futex(volatile uint32_t *addr, uint32_t op, uint32_t val);
+/* timeout 单位 tick：< 0 一直等，0 只查；返回就绪项数（超时 0）或 -errno */
+int  poll(struct pollfd_user *fds, uint32_t nfds, int64_t timeout);
+/* read 8 字节拿计数 / 到期次数，write 8 字节加计数（uapi.h 的 EFD_*）。fd 或 -errno */
+int  eventfd(uint64_t initval, uint32_t flags);
+int  timerfd_create(void);
+/* first / period 单位 tick：first = 0 停止，period = 0 一次性。0 或 -errno */
+int  timerfd_settime(int fd, uint64_t first, uint64_t period);
+
+/* 批量 syscall ring（布局见 uapi/uring.h）；一般通过 ring.c / ring.h 的封装使用。0/count 或 -errno */
+struct uring;
+long ring_setup(struct uring *ring, uint32_t entries, uint32_t flags);
+long ring_enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags);
 
 #endif  /* SYSCALL_H */
@@ -16,6 +16,17 @@ void *u_memcpy(void *dst, const void *src, size_t n);
 void *u_memmove(void *dst, const void *src, size_t n);
 void *u_memset(void *s, int c, size_t n);
 int u_memcmp(const void *s1, const void *s2, size_t n);
+void *u_memchr(const void *s, int c, size_t n);
+
+/* 分派：默认标量按字实现；u_string_init() 在 vdso 报告 RVV 时切到向量版本
+ * （u_memcpy/u_memset/u_memcmp/u_strlen）。
+ */
+#define U_STRING_IMPL_SCALAR 0
+#define U_STRING_IMPL_RVV    1
+
+void u_string_init(void);
+int u_string_set_impl(int impl);  /* 0，或 -1 = 硬件不支持 */
+int u_string_impl(void);
 
 /* ===== string ===== */
 
@@ -33,6 +44,20 @@ int u_atoi(const char *s);
 
 /* ===== Tiny stdio based on write() ===== */
 
+/* stdout 按线程（tid）各有一块缓冲；stderr 不缓冲。
+ *   U_IOLBF（默认）：遇到 '\n' 或缓冲满时 write 一次
+ *   U_IOFBF：只在缓冲满 / u_fflush / thread_exit / 读 stdin 前 write
+ *   U_IONBF：每次输出直接 write
+ */
+#define U_IOLBF        0
+#define U_IOFBF        1
+#define U_IONBF        2
+#define U_STDOUT_BUFSZ 512
+
+int u_setvbuf(int mode);  /* 设置当前线程 stdout 模式（先 flush），返回旧模式 */
+int u_fflush(void);       /* 写出当前线程 stdout 缓冲，返回写出字节数或 <0 */
+void u_stdout_discard(int tid);  /* 丢弃 tid 的缓冲（被 kill 的线程） */
+
 int u_putchar(int c);                /* Emit a single character to stdout. */
 int u_puts(const char *s);           /* Print string + '\n'. */
 int u_printf(const char *fmt, ...);  /* Minimal printf: %s %d %u %x %p %c %% */
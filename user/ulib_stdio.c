@@ -4,6 +4,7 @@
 
 #include "syscall.h"
 #include "ulib.h"
+#include "uthread.h"
 
 /* Internal helper: write a buffer to stdout. */
 static int
@@ -14,11 +15,102 @@ write_all(const char *buf, size_t len)
   return rc;
 }
 
+/* -------------------------------------------------------------------------- */
+/* Per-thread stdout buffer                                                   */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  uint16_t len;
+  uint16_t mode;  /* 零值即 U_IOLBF */
+  char buf[U_STDOUT_BUFSZ];
+} u_stdout_t;
+
+/* 每个线程只碰自己那一格：tid 按 sp 算（thread_self），抢占 / 迁移后也还是自己的；
+ * 算不出来（vdso 未设置、栈不在线程栈数组里）就不缓冲，直接 write */
+static u_stdout_t s_stdout[THREAD_MAX];
+
+static inline u_stdout_t *
+stdout_self(void)
+{
+  tid_t tid = thread_self();
+  if (tid < 0 || tid >= THREAD_MAX) return NULL;
+  return &s_stdout[tid];
+}
+
+static int
+stdout_flush(u_stdout_t *so)
+{
+  if (so->len == 0) return 0;
+  int rc  = write_all(so->buf, so->len);
+  so->len = 0;
+  return rc;
+}
+
+/* 追加到 stdout；按模式决定何时真正 write */
+static int
+stdout_put(const char *s, size_t len)
+{
+  u_stdout_t *so = stdout_self();
+  if (!so || so->mode == U_IONBF) {
+    return write_all(s, len);
+  }
+
+  /* 放不下：先清空；仍放不下就直接写 */
+  if ((size_t)so->len + len > U_STDOUT_BUFSZ) {
+    stdout_flush(so);
+    if (len > U_STDOUT_BUFSZ) {
+      return write_all(s, len);
+    }
+  }
+
+  u_memcpy(so->buf + so->len, s, len);
+  so->len += (uint16_t)len;
+
+  if (so->mode == U_IOLBF) {
+    for (size_t i = len; i > 0; --i) {
+      if (s[i - 1] == '\n') {
+        stdout_flush(so);
+        break;
+      }
+    }
+  }
+  return (int)len;
+}
+
+int
+u_setvbuf(int mode)
+{
+  if (mode != U_IOFBF && mode != U_IOLBF && mode != U_IONBF) return -1;
+
+  u_stdout_t *so = stdout_self();
+  if (!so) return -1;
+
+  int old = so->mode;
+  stdout_flush(so);
+  so->mode = (uint16_t)mode;
+  return old;
+}
+
+int
+u_fflush(void)
+{
+  u_stdout_t *so = stdout_self();
+  return so ? stdout_flush(so) : 0;
+}
+
+void
+u_stdout_discard(int tid)
+{
+  if (tid < 0 || tid >= THREAD_MAX) return;
+  s_stdout[tid].len  = 0;
+  s_stdout[tid].mode = U_IOLBF;
+}
+
 int
 u_putchar(int c)
 {
   char ch = (char)c;
-  int rc  = write_all(&ch, 1);
+  int rc  = stdout_put(&ch, 1);
   return (rc == 1) ? c : -1;
 }
 
@@ -26,8 +118,8 @@ int
 u_puts(const char *s)
 {
   size_t len = u_strlen(s);
-  int rc1    = write_all(s, len);
-  int rc2    = write_all("\n", 1);
+  int rc1    = stdout_put(s, len);
+  int rc2    = stdout_put("\n", 1);
   if (rc1 < 0 || rc2 < 0) {
     return -1;
   }
@@ -318,7 +410,7 @@ int u_printf(const char *fmt, ...)
   if (n > 0) {
     /* u_vsnprintf reports the theoretical length, which may exceed buf. */
     size_t to_write = (n < (int)sizeof(buf)) ? (size_t)n : sizeof(buf) - 1;
-    write_all(buf, to_write);
+    stdout_put(buf, to_write);
   }
   return n;
 }
@@ -366,6 +458,7 @@ int u_read_line(int fd, char *buf, int buf_size)
 int u_getchar(void)
 {
   unsigned char ch;
+  u_fflush();
   for (;;) {
     int n = read(FD_STDIN, &ch, 1);
     if (n > 0) {
@@ -390,6 +483,7 @@ int u_gets(char *buf, int buf_size)
 
   for (;;) {
     char c;
+    u_fflush();  /* 提示符 / 上一个字符的回显：阻塞读之前先写出去 */
     int n = read(FD_STDIN, &c, 1);
     if (n < 0) {
       /* Genuine read error: return the code. */
@@ -1,79 +1,50 @@
 /* ulib_string.c */
 
+#include "string_word.h"
 #include "ulib.h"
+#include "uvdso.h"
+
+/*
+ * 标量路径和内核 lib/string.c 是同一份按字实现（string_word.h）；
+ * 有 V 时 u_string_init 换成 ulib_string_rvv.S。
+ */
 
 /* ===== memory ===== */
 
-void *u_memcpy(void *dst, const void *src, size_t n)
+static void *u_memcpy_scalar(void *dst, const void *src, size_t n)
 {
-  unsigned char *d       = (unsigned char *)dst;
-  const unsigned char *s = (const unsigned char *)src;
-
-  for (size_t i = 0; i < n; ++i) {
-    d[i] = s[i];
-  }
+  strw_copy_fwd((unsigned char *)dst, (const unsigned char *)src, n);
   return dst;
 }
 
 /* Supports overlapping regions. */
 void *u_memmove(void *dst, const void *src, size_t n)
 {
-  unsigned char *d       = (unsigned char *)dst;
-  const unsigned char *s = (const unsigned char *)src;
-
-  if (d == s || n == 0) {
-    return dst;
-  }
-
-  if (d < s) {
-    /* Forward copy. */
-    for (size_t i = 0; i < n; ++i) {
-      d[i] = s[i];
-    }
-  } else {
-    /* Reverse copy to avoid overwrite. */
-    for (size_t i = n; i > 0; --i) {
-      d[i - 1] = s[i - 1];
-    }
-  }
-  return dst;
+  return strw_memmove(dst, src, n);
 }
 
-void *u_memset(void *s, int c, size_t n)
+static void *u_memset_scalar(void *s, int c, size_t n)
 {
-  unsigned char *p = (unsigned char *)s;
-  unsigned char v  = (unsigned char)c;
-
-  for (size_t i = 0; i < n; ++i) {
-    p[i] = v;
-  }
-  return s;
+  return strw_memset(s, c, n);
 }
 
-int u_memcmp(const void *s1, const void *s2, size_t n)
+static int u_memcmp_scalar(const void *s1, const void *s2, size_t n)
 {
-  const unsigned char *a = (const unsigned char *)s1;
-  const unsigned char *b = (const unsigned char *)s2;
-
-  for (size_t i = 0; i < n; ++i) {
-    if (a[i] != b[i]) {
-      return (int)a[i] - (int)b[i];
-    }
-  }
-  return 0;
+  return strw_memcmp(s1, s2, n);
 }
 
-/* ===== string ===== */
+void *u_memchr(const void *s, int c, size_t n)
+{
+  return strw_memchr(s, c, n);
+}
 
-size_t u_strlen(const char *s)
+static size_t u_strlen_scalar(const char *s)
 {
-  size_t n = 0;
-  while (s[n] != '\0') {
-    ++n;
-  }
-  return n;
+  return strw_strlen(s);
 }
 
+/* ===== string ===== */
+
 int u_strcmp(const char *a, const char *b)
 {
   while (*a && (*a == *b)) {
@@ -123,17 +94,69 @@ char *u_strncpy(char *dst, const char *src, size_t n)
   return ret;
 }
 
-char *u_strchr(const char *s, int c)
+/* ===== RVV dispatch ===== */
+
+/* ulib_string_rvv.S */
+void *u_memcpy_rvv(void *dst, const void *src, size_t n);
+void *u_memset_rvv(void *s, int c, size_t n);
+int u_memcmp_rvv(const void *s1, const void *s2, size_t n);
+size_t u_strlen_rvv(const char *s);
+
+/* 默认标量，u_string_init() 之前调用也安全 */
+static void *(*s_memcpy_fn)(void *, const void *, size_t) = u_memcpy_scalar;
+static void *(*s_memset_fn)(void *, int, size_t)          = u_memset_scalar;
+static int (*s_memcmp_fn)(const void *, const void *, size_t) =
+    u_memcmp_scalar;
+static size_t (*s_strlen_fn)(const char *) = u_strlen_scalar;
+
+int u_string_set_impl(int impl)
 {
-  char ch = (char)c;
+  if (impl == U_STRING_IMPL_RVV) {
+    if (!(__vdso_data.hwcap & VDSO_HWCAP_V)) return -1;
+    s_memcpy_fn = u_memcpy_rvv;
+    s_memset_fn = u_memset_rvv;
+    s_memcmp_fn = u_memcmp_rvv;
+    s_strlen_fn = u_strlen_rvv;
+    return 0;
+  }
+
+  s_memcpy_fn = u_memcpy_scalar;
+  s_memset_fn = u_memset_scalar;
+  s_memcmp_fn = u_memcmp_scalar;
+  s_strlen_fn = u_strlen_scalar;
+  return 0;
+}
 
-  while (*s) {
-    if (*s == ch) {
-      return (char *)s;
-    }
-    ++s;
+int u_string_impl(void)
+{
+  return (s_memcpy_fn == u_memcpy_rvv) ? U_STRING_IMPL_RVV
+                                       : U_STRING_IMPL_SCALAR;
+}
+
+void u_string_init(void)
+{
+  if (u_string_set_impl(U_STRING_IMPL_RVV) != 0) {
+    u_string_set_impl(U_STRING_IMPL_SCALAR);
   }
-  return (ch == '\0') ? (char *)s : NULL;
+}
+
+void *u_memcpy(void *dst, const void *src, size_t n)
+{
+  return s_memcpy_fn(dst, src, n);
+}
+
+void *u_memset(void *s, int c, size_t n) { return s_memset_fn(s, c, n); }
+
+int u_memcmp(const void *s1, const void *s2, size_t n)
+{
+  return s_memcmp_fn(s1, s2, n);
+}
+
+size_t u_strlen(const char *s) { return s_strlen_fn(s); }
+
+char *u_strchr(const char *s, int c)
+{
+  return strw_strchr(s, c);
 }
 
 char *u_strrchr(const char *s, int c)
@@ -0,0 +1,107 @@
+/* vdso.c */
+
+/*
+ * clock_gettime / get_hartid 的用户态快速路径：
+ * 直接读内核维护的 __vdso_data + time CSR，不陷入内核。
+ * vdso 还没 ready（time_init 之前）时回落到真正的 syscall。
+ */
+
+#include <stdint.h>
+
+#include "syscall.h"
+#include "utime.h"
+#include "uvdso.h"
+
+static inline uint64_t
+vdso_rdtime(void)
+{
+  uint64_t t;
+  __asm__ volatile("rdtime %0" : "=r"(t));
+  return t;
+}
+
+static inline uint32_t
+vdso_read_begin(const struct vdso_data *vd)
+{
+  uint32_t seq;
+  while ((seq = vd->seq) & 1u) {
+    __asm__ volatile("" ::: "memory");
+  }
+  __asm__ volatile("fence r,r" ::: "memory");
+  return seq;
+}
+
+static inline int
+vdso_read_retry(const struct vdso_data *vd, uint32_t seq)
+{
+  __asm__ volatile("fence r,r" ::: "memory");
+  return vd->seq != seq;
+}
+
+int clock_gettime(int clock_id, struct timespec *ts)
+{
+  const struct vdso_data *vd = &__vdso_data;
+
+  if (!vd->ready) {
+    return clock_gettime_syscall(clock_id, ts);
+  }
+  if (!ts || (clock_id != CLOCK_REALTIME && clock_id != CLOCK_MONOTONIC)) {
+    return -1;
+  }
+
+  uint64_t ns;
+  uint32_t seq;
+  do {
+    seq            = vdso_read_begin(vd);
+    uint64_t delta = vdso_rdtime() - vd->base_ticks;
+    ns = vd->base_real_ns +
+         (uint64_t)(((unsigned __int128)delta * vd->mult) >> VDSO_MULT_SHIFT);
+    if (clock_id == CLOCK_MONOTONIC) {
+      ns -= vd->boot_real_ns;
+    }
+  } while (vdso_read_retry(vd, seq));
+
+  ts->tv_sec  = ns / 1000000000ull;
+  ts->tv_nsec = (uint32_t)(ns % 1000000000ull);
+  return 0;
+}
+
+/*
+ * 按 sp 找自己的栈槽：sp 是线程自己的寄存器，中途被抢占 / 迁移也不会变。
+ * thread_current() 经 tp 读 cpu_t.current_tid，两次访存之间换了 hart 就会读到别人的 tid。
+ */
+tid_t thread_self(void)
+{
+  const struct vdso_data *vd = &__vdso_data;
+  uint32_t stride            = vd->stack_stride;
+  if (stride == 0) return -1;
+  __asm__ volatile("fence r,r" ::: "memory");
+
+  uintptr_t sp;
+  __asm__ volatile("mv %0, sp" : "=r"(sp));
+
+  /* 栈向下长，sp 落在 (槽底, 槽顶]：减 1 再除，空栈时也算进自己那一格 */
+  if (sp <= vd->stack_base) return -1;
+  uintptr_t idx = (sp - 1u - vd->stack_base) / stride;
+  if (idx >= vd->nr_stacks) return -1;
+  return (tid_t)idx;
+}
+
+int get_hartid(void)
+{
+  const struct vdso_data *vd = &__vdso_data;
+
+  if (!vd->ready) {
+    return get_hartid_syscall();
+  }
+
+  /* trap 返回 U-mode 不恢复 tp，tp 仍是当前 hart 的 cpu_t* */
+  uintptr_t tp;
+  __asm__ volatile("mv %0, tp" : "=r"(tp));
+
+  uintptr_t idx = (tp - vd->cpu_base) / vd->cpu_stride;
+  if (tp < vd->cpu_base || idx >= vd->nr_harts) {
+    return get_hartid_syscall();
+  }
+  return (int)vd->harts[idx].hartid;
+}